@@ -0,0 +1,253 @@
+"""
+@file check_converters.py
+@brief Checks the model importers of dtc_pygen: small models are trained (or generated) and converted, then the predictions of the binaries
+       (with the double feature type) are compared with the ones of the original libraries (LightGBM, onnxruntime), on samples with missing values.
+       Build the libraries with make, then run python check_converters.py (or make check).
+
+
+@copyright Copyright (C) 2024 Antonio Emmanuele
+
+This file is part of DTC Decision Tree in C-lang
+
+DTC is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+DTC is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with DTC. If not, see <https://www.gnu.org/licenses/>.
+"""
+import contextlib
+import gc
+import io
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import warnings
+import numpy as np
+import dtc
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "dtc_pygen"))
+import dtc_pygen
+# Node structure of the double feature type, set once as the ctypes fields are final.
+dtc_pygen.set_fields(dtc_pygen.TreeNode, dtc_pygen.feature_types["double"])
+
+NUM_FEATURES = 6
+NUM_SAMPLES = 2000
+
+def make_data(rng):
+    """ Returns training features without and with NaN, regression, binary and 3-class targets, and test samples with NaN. """
+    features = rng.normal(size = (NUM_SAMPLES, NUM_FEATURES))
+    target = 2 * features[:, 0] + np.sin(3 * features[:, 1]) - features[:, 2] * features[:, 3] + 0.1 * rng.normal(size = NUM_SAMPLES)
+    features_nan = features.copy()
+    features_nan[rng.random(features.shape) < 0.1] = np.nan
+    test = rng.normal(size = (NUM_SAMPLES, NUM_FEATURES))
+    test[rng.random(test.shape) < 0.1] = np.nan
+    return features, features_nan, target, (target > 0).astype(int), np.digitize(target, [-1, 1]), test
+
+def convert(convert_function, *args):
+    """ Runs a converter, hiding its messages. """
+    with contextlib.redirect_stdout(io.StringIO()):
+        convert_function(*args)
+
+def compare(name, model_path, samples, expected, rtol = 1e-9, atol = 1e-12, feature_type = "double"):
+    """ Predicts the samples with the binary and returns the number of predictions different from the expected ones. """
+    with dtc.Forest(model_path, feature_type) as forest:
+        predictions = forest.predict(np.ascontiguousarray(samples, dtype = dtc.feature_dtypes[feature_type]))
+    predictions = predictions.reshape(expected.shape)
+    mismatches = int(np.count_nonzero(~np.isclose(predictions, expected, rtol = rtol, atol = atol)))
+    print(f"{name}: {mismatches} mismatches in {expected.size} predictions")
+    return mismatches, expected.size
+
+def check_lightgbm(tmp_dir, rng):
+    """
+    LightGBM models with NaN in the training set have the NaN missing type, the others the None one, for which NaN is replaced by 0.
+    The random forest mode (boosting=rf) averages the trees, as flagged by the average_output line of the text format.
+    """
+    import lightgbm as lgb
+    features, features_nan, target, binary, multiclass, test = make_data(rng)
+    rf = {"boosting": "rf", "bagging_fraction": 0.7, "bagging_freq": 1}
+    cases = [
+        ("gbdt regression, NaN missing type", {"objective": "regression"}, features_nan, target),
+        ("gbdt regression, None missing type", {"objective": "regression"}, features, target),
+        ("rf regression, NaN missing type", {"objective": "regression", **rf}, features_nan, target),
+        ("rf binary, None missing type", {"objective": "binary", **rf}, features, binary),
+        ("gbdt multiclass, NaN missing type", {"objective": "multiclass", "num_class": 3}, features_nan, multiclass),
+        ("gbdt binary sigmoid 0.5, None missing type", {"objective": "binary", "sigmoid": 0.5}, features, binary),
+    ]
+    mismatches, total = 0, 0
+    for name, params, train, labels in cases:
+        booster = lgb.train({**params, "num_leaves": 15, "min_data_in_leaf": 5, "verbose": -1, "seed": 1}, lgb.Dataset(train, labels), num_boost_round = 20)
+        expected = booster.predict(test)
+        text_path, json_path, bin_path = (os.path.join(tmp_dir, f"lightgbm{suffix}") for suffix in (".txt", ".json", ".bin"))
+        booster.save_model(text_path)
+        if "rf" == params.get("boosting"):
+            with open(text_path) as in_file:
+                if "average_output" not in in_file.read().split("\n"):
+                    raise RuntimeError("The LightGBM random forest model does not contain the average_output line.")
+        with open(json_path, "w") as out_file:
+            json.dump(booster.dump_model(), out_file)
+        for format_name, convert_function, path in (("text", dtc_pygen.lightgbm_text_parser, text_path), ("json", dtc_pygen.json_parser, json_path)):
+            convert(convert_function, path, bin_path)
+            m, n = compare(f"LightGBM {name} ({format_name})", bin_path, test, expected)
+            mismatches, total = mismatches + m, total + n
+    return mismatches, total
+
+def onnx_regressor(path, num_trees, depth, aggregate_function, rng, equal_tracks_true = False):
+    """
+    Writes a TreeEnsembleRegressor of complete trees with random modes and nodes_missing_value_tracks_true flags (never set on BRANCH_EQ,
+    unless equal_tracks_true). Thresholds and leaf weights are multiples of 1/8, exact in float32, the type of onnxruntime.
+    """
+    from onnx import TensorProto, helper, save
+    modes = ["BRANCH_LEQ", "BRANCH_LT", "BRANCH_GTE", "BRANCH_GT", "BRANCH_EQ", "BRANCH_NEQ"]
+    nodes = {key: [] for key in ("treeids", "nodeids", "featureids", "values", "modes", "truenodeids", "falsenodeids", "missing_value_tracks_true")}
+    targets = {key: [] for key in ("treeids", "nodeids", "ids", "weights")}
+    num_internal = (1 << depth) - 1
+    for tree in range(num_trees):
+        for node in range(2 * num_internal + 1):
+            is_leaf = node >= num_internal
+            mode = "LEAF" if is_leaf else modes[rng.integers(len(modes))]
+            tracks_true = not is_leaf and (mode != "BRANCH_EQ" or equal_tracks_true) and bool(rng.integers(2))
+            for key, value in (("treeids", tree), ("nodeids", node), ("featureids", 0 if is_leaf else int(rng.integers(NUM_FEATURES))),
+                               ("values", 0.0 if is_leaf else float(rng.integers(-8, 9)) / 8), ("modes", mode),
+                               ("truenodeids", 0 if is_leaf else 2 * node + 1), ("falsenodeids", 0 if is_leaf else 2 * node + 2),
+                               ("missing_value_tracks_true", int(tracks_true))):
+                nodes[key].append(value)
+            if is_leaf:
+                for key, value in (("treeids", tree), ("nodeids", node), ("ids", 0), ("weights", float(rng.integers(-64, 65)) / 8)):
+                    targets[key].append(value)
+    ensemble = helper.make_node("TreeEnsembleRegressor", ["X"], ["Y"], domain = "ai.onnx.ml", n_targets = 1, aggregate_function = aggregate_function,
+                                base_values = [0.5], post_transform = "NONE", **{f"nodes_{key}": value for key, value in nodes.items()},
+                                **{f"target_{key}": value for key, value in targets.items()})
+    graph = helper.make_graph([ensemble], "ensemble", [helper.make_tensor_value_info("X", TensorProto.FLOAT, [None, NUM_FEATURES])],
+                              [helper.make_tensor_value_info("Y", TensorProto.FLOAT, [None, 1])])
+    model = helper.make_model(graph, opset_imports = [helper.make_opsetid("", 17), helper.make_opsetid("ai.onnx.ml", 3)])
+    model.ir_version = 8
+    save(model, path)
+
+def check_onnx(tmp_dir, rng):
+    """
+    ONNX regressors using every node mode, on samples with NaN and ties with the thresholds, compared with onnxruntime.
+    BRANCH_EQ nodes with nodes_missing_value_tracks_true can not be converted, and must be rejected.
+    """
+    import onnxruntime as ort
+    onnx_path, bin_path = os.path.join(tmp_dir, "model.onnx"), os.path.join(tmp_dir, "onnx.bin")
+    samples = (rng.integers(-10, 11, size = (NUM_SAMPLES, NUM_FEATURES)) / 8).astype(np.float32)
+    samples[rng.random(samples.shape) < 0.2] = np.nan
+    mismatches, total = 0, 0
+    for aggregate_function in ("SUM", "AVERAGE"):
+        onnx_regressor(onnx_path, 20, 4, aggregate_function, rng)
+        expected = ort.InferenceSession(onnx_path, providers = ["CPUExecutionProvider"]).run(None, {"X": samples})[0].astype(np.float64)
+        convert(dtc_pygen.onnx_parser, onnx_path, bin_path)
+        # onnxruntime aggregates in float32, i.e. with an error relative to the magnitude of the leaf weights.
+        m, n = compare(f"ONNX regressor {aggregate_function}", bin_path, samples, expected, rtol = 1e-6, atol = 1e-5)
+        mismatches, total = mismatches + m, total + n
+    onnx_regressor(onnx_path, 20, 4, "SUM", rng, equal_tracks_true = True)
+    try:
+        convert(dtc_pygen.onnx_parser, onnx_path, bin_path)
+        print("ONNX regressor with BRANCH_EQ tracking missing values: converted instead of rejected")
+        mismatches += 1
+    except ValueError:
+        print("ONNX regressor with BRANCH_EQ tracking missing values: rejected")
+    return mismatches, total + 1
+
+def tie_samples(thresholds, rng):
+    """
+    Float samples whose features are, for each threshold of the feature, its nearest float value or one of the two adjacent ones.
+    Features without splits are normal.
+    """
+    columns = []
+    for feature_thresholds in thresholds:
+        if not feature_thresholds:
+            columns.append(rng.normal(size = NUM_SAMPLES).astype(np.float32))
+            continue
+        nearest = np.asarray(feature_thresholds, dtype = np.float32)
+        candidates = np.concatenate([nearest, np.nextafter(nearest, np.float32(-np.inf)), np.nextafter(nearest, np.float32(np.inf))])
+        columns.append(rng.choice(candidates, NUM_SAMPLES))
+    return np.stack(columns, axis = 1)
+
+def check_float_thresholds(tmp_dir, rng):
+    """
+    Models trained in double, whose thresholds are mostly not float values, converted with the float feature type: the predictions of
+    samples tied with the float values closest to the thresholds must follow the double comparisons of LightGBM and sklearn.
+    The models are converted by a dtc_pygen process, as the node layout of this one is the double one.
+    """
+    import joblib
+    import lightgbm as lgb
+    from sklearn.ensemble import RandomForestRegressor
+    features, _, target, _, _, _ = make_data(rng)
+    booster = lgb.train({"objective": "regression", "num_leaves": 15, "min_data_in_leaf": 5, "verbose": -1, "seed": 1},
+                        lgb.Dataset(features, target), num_boost_round = 20)
+    forest = RandomForestRegressor(n_estimators = 10, max_depth = 8, random_state = 1).fit(features, target)
+    lightgbm_thresholds, sklearn_thresholds = [[] for _ in range(NUM_FEATURES)], [[] for _ in range(NUM_FEATURES)]
+    def add_lightgbm_thresholds(node):
+        if "split_index" in node:
+            lightgbm_thresholds[node["split_feature"]].append(node["threshold"])
+            add_lightgbm_thresholds(node["left_child"])
+            add_lightgbm_thresholds(node["right_child"])
+    for tree in booster.dump_model()["tree_info"]:
+        add_lightgbm_thresholds(tree["tree_structure"])
+    for estimator in forest.estimators_:
+        internal = estimator.tree_.children_left != -1
+        for feature, threshold in zip(estimator.tree_.feature[internal], estimator.tree_.threshold[internal]):
+            sklearn_thresholds[feature].append(threshold)
+    text_path, json_path, joblib_path, bin_path = (os.path.join(tmp_dir, f"tie{suffix}") for suffix in (".txt", ".json", ".joblib", ".bin"))
+    booster.save_model(text_path)
+    with open(json_path, "w") as out_file:
+        json.dump(booster.dump_model(), out_file)
+    joblib.dump(forest, joblib_path)
+    lightgbm_samples, sklearn_samples = tie_samples(lightgbm_thresholds, rng), tie_samples(sklearn_thresholds, rng)
+    cases = [
+        ("LightGBM gbdt regression (text)", text_path, lightgbm_samples, booster.predict(lightgbm_samples.astype(np.float64))),
+        ("LightGBM gbdt regression (json)", json_path, lightgbm_samples, booster.predict(lightgbm_samples.astype(np.float64))),
+        ("sklearn random forest regression (joblib)", joblib_path, sklearn_samples, forest.predict(sklearn_samples)),
+    ]
+    mismatches, total = 0, 0
+    for name, model_path, samples, expected in cases:
+        subprocess.run([sys.executable, dtc_pygen.__file__, "parse", "--feature_type", "float", "--input_model", model_path, "--output_bin", bin_path],
+                       check = True, stdout = subprocess.DEVNULL)
+        # The leaves are accumulated in float.
+        m, n = compare(f"{name}, float thresholds tied with the samples", bin_path, samples, expected, rtol = 1e-5, atol = 1e-5, feature_type = "float")
+        mismatches, total = mismatches + m, total + n
+    return mismatches, total
+
+def check_dataset(tmp_dir, rng):
+    """
+    The views of a Dataset must keep the mapping alive: features are read after the Dataset is dropped, and after it is closed, which
+    must warn. Closing a Dataset without views must not warn.
+    """
+    dataset_path = os.path.join(tmp_dir, "dataset.bin")
+    dtc_pygen.synthetic_dataset(dataset_path, NUM_SAMPLES, NUM_FEATURES, "float", seed = 1)
+    expected = np.random.default_rng(1).random((NUM_SAMPLES, NUM_FEATURES), dtype = np.float32)
+    failures = 0
+    features = dtc.Dataset(dataset_path, "float").features[1:]
+    gc.collect()
+    failures += not np.array_equal(features, expected[1:])
+    with warnings.catch_warnings(record = True) as caught:
+        warnings.simplefilter("always")
+        with dtc.Dataset(dataset_path, "float") as dataset:
+            features = dataset.features
+        failures += len(caught) != 1 or not np.array_equal(features, expected)
+        del features
+        with dtc.Dataset(dataset_path, "float") as dataset:
+            failures += not np.array_equal(dataset.features, expected)
+        failures += len(caught) != 1
+    print(f"Dataset views: {failures} failures in 4 checks")
+    return failures, 4
+
+if __name__ == "__main__":
+    rng = np.random.default_rng(0)
+    mismatches, total = 0, 0
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        for check in (check_lightgbm, check_onnx, check_float_thresholds, check_dataset):
+            m, n = check(tmp_dir, rng)
+            mismatches, total = mismatches + m, total + n
+    print(f"Converter check: {mismatches} mismatches in {total} predictions")
+    sys.exit(0 if mismatches == 0 else 1)
@@ -0,0 +1,352 @@
+"""
+@file dtc.py
+@brief This file contains the ctypes bindings of the DTC library, predicting numpy matrices without copies.
+
+
+@copyright Copyright (C) 2024 Antonio Emmanuele
+
+This file is part of DTC Decision Tree in C-lang
+
+DTC is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+DTC is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with DTC. If not, see <https://www.gnu.org/licenses/>.
+"""
+import ctypes
+import os
+import warnings
+import weakref
+from concurrent.futures import ThreadPoolExecutor
+import numpy as np
+
+CONF_OK = 0
+DATASET_OK = 0
+DATASET_ERR_TYPE = -5
+CLASSIFICATION_NO_MEMORY = -4
+
+""" numpy dtype of the features of each build of the library, i.e. of the USE_FLOAT values. """
+feature_dtypes = {"float": np.dtype(np.float32), "double": np.dtype(np.float64)}
+
+""" Maximum number of rows of a single call, as the C functions count the samples with a uint32_t. """
+max_batch_rows = 1 << 30
+
+class ConfigTrailer(ctypes.Structure):
+    _fields_ = [
+        ("num_classes", ctypes.c_uint16),
+        ("num_features", ctypes.c_uint16),
+        ("num_trees", ctypes.c_uint16),
+    ]
+
+class ConfigOptimizeStats(ctypes.Structure):
+    _fields_ = [
+        ("nodes_before", ctypes.c_uint32),
+        ("nodes_after", ctypes.c_uint32),
+        ("collapsed_splits", ctypes.c_uint32),
+        ("shared_nodes", ctypes.c_uint32),
+    ]
+
+def get_library_types(feature_ctype):
+    """ Returns the boosting_t, tree_conf_t, dataset_header_t and tree_dataset_t structures of a build, whose layout depends on the feature type. """
+    class Boosting(ctypes.Structure):
+        _fields_ = [
+            ("objective", ctypes.c_uint16),
+            ("num_outputs", ctypes.c_uint16),
+            ("base_scores", ctypes.POINTER(feature_ctype)),
+            ("tree_outputs", ctypes.POINTER(ctypes.c_uint16)),
+        ]
+    class TreeConf(ctypes.Structure):
+        # Nodes are only handled by the library, so they are opaque pointers.
+        _fields_ = [
+            ("trailer", ConfigTrailer),
+            ("trees", ctypes.POINTER(ctypes.c_void_p)),
+            ("num_nodes", ctypes.POINTER(ctypes.c_uint16)),
+            ("max_depth", ctypes.POINTER(ctypes.c_uint16)),
+            ("leaf_probabilities", ctypes.POINTER(ctypes.POINTER(ctypes.c_float))),
+            ("boosting", ctypes.POINTER(Boosting)),
+            ("node_pool", ctypes.c_void_p),
+        ]
+    class DatasetHeader(ctypes.Structure):
+        _fields_ = [
+            ("magic", ctypes.c_uint32),
+            ("version", ctypes.c_uint16),
+            ("feature_size", ctypes.c_uint16),
+            ("num_samples", ctypes.c_uint64),
+            ("num_features", ctypes.c_uint16),
+            ("reserved_16", ctypes.c_uint16),
+            ("reserved_32", ctypes.c_uint32),
+            ("features_offset", ctypes.c_uint64),
+            ("labels_offset", ctypes.c_uint64),
+            ("reserved", ctypes.c_uint8 * 24),
+        ]
+    class TreeDataset(ctypes.Structure):
+        _fields_ = [
+            ("header", DatasetHeader),
+            ("features", ctypes.POINTER(feature_ctype)),
+            ("labels", ctypes.POINTER(ctypes.c_int16)),
+            ("data", ctypes.c_void_p),
+            ("data_size", ctypes.c_size_t),
+        ]
+    return Boosting, TreeConf, DatasetHeader, TreeDataset
+
+class Library:
+    """
+    A build of the library for a feature type, i.e. libdtc_float.so or libdtc_double.so of the Makefile of this folder.
+    Functions are called through ctypes.CDLL, which releases the GIL for the duration of each call.
+    """
+    def __init__(self, feature_type, path = None):
+        feature_ctype = ctypes.c_float if feature_type == "float" else ctypes.c_double
+        self.feature_type = feature_type
+        self.feature_ctype = feature_ctype
+        self.dtype = feature_dtypes[feature_type]
+        self.Boosting, self.TreeConf, self.DatasetHeader, self.TreeDataset = get_library_types(feature_ctype)
+        path = path or os.path.join(os.path.dirname(os.path.abspath(__file__)), f"libdtc_{feature_type}.so")
+        self.lib = ctypes.CDLL(path)
+        features = ctypes.POINTER(feature_ctype)
+        trees = ctypes.POINTER(ctypes.c_void_p)
+        probabilities = ctypes.POINTER(ctypes.POINTER(ctypes.c_float))
+        self.declare("load_tree_conf", ctypes.c_int, ctypes.c_char_p, ctypes.POINTER(self.TreeConf))
+        self.declare("free_tree_conf", None, ctypes.POINTER(self.TreeConf))
+        self.declare("optimize_tree_conf", ctypes.c_int, ctypes.POINTER(self.TreeConf), ctypes.POINTER(ConfigOptimizeStats))
+        self.declare("load_tree_dataset", ctypes.c_int, ctypes.c_char_p, ctypes.POINTER(self.TreeDataset))
+        self.declare("free_tree_dataset", None, ctypes.POINTER(self.TreeDataset))
+        self.declare("visit_rf_majority_voting_batch", ctypes.c_int, trees, ctypes.c_uint16, ctypes.c_uint16, features, ctypes.c_uint32,
+                        ctypes.c_uint16, ctypes.POINTER(ctypes.c_int16), ctypes.POINTER(ctypes.c_uint16))
+        self.declare("visit_rf_class_probabilities_batch", ctypes.c_int, trees, ctypes.c_uint16, ctypes.c_uint16, probabilities, features,
+                        ctypes.c_uint32, ctypes.c_uint16, ctypes.POINTER(ctypes.c_float))
+        self.declare("visit_rf_mean_batch", ctypes.c_int, trees, ctypes.c_uint16, features, ctypes.c_uint32, ctypes.c_uint16, features)
+        self.declare("visit_gbdt_batch", ctypes.c_int, trees, ctypes.c_uint16, ctypes.POINTER(self.Boosting), features, ctypes.c_uint32,
+                        ctypes.c_uint16, features)
+
+    def declare(self, name, restype, *argtypes):
+        function = getattr(self.lib, name)
+        function.restype = restype
+        function.argtypes = argtypes
+
+""" Loaded builds, one per feature type. """
+libraries = {}
+
+def get_library(feature_type):
+    """ Returns the build of the library for the feature type ("float" or "double"), loading it on the first use. """
+    if feature_type not in feature_dtypes:
+        raise ValueError(f"Invalid feature type {feature_type}, it must be in {list(feature_dtypes)}.")
+    if feature_type not in libraries:
+        libraries[feature_type] = Library(feature_type)
+    return libraries[feature_type]
+
+def as_pointer(array, ctype):
+    """ Returns a pointer to the data of an array, without copies. """
+    return array.ctypes.data_as(ctypes.POINTER(ctype))
+
+class Forest:
+    """
+    A binary configuration loaded once by load_tree_conf, predicting numpy matrices with the batched functions of the library.
+    Inputs must be C-contiguous [number_samples x num_features] matrices with the dtype of the feature type of the binary (float32 for "float",
+    float64 for "double"), so they are passed to the library without copies. Other matrices are rejected instead of being silently copied,
+    use np.ascontiguousarray(X, dtype = forest.dtype) to convert them.
+    The GIL is released during inference. With threads > 1 the rows are split in contiguous chunks predicted in parallel by a thread pool,
+    writing disjoint slices of the output.
+    """
+    def __init__(self, model_path, feature_type = "float", optimize = False):
+        self.conf = None
+        self.library = get_library(feature_type)
+        self.dtype = self.library.dtype
+        self.conf = self.library.TreeConf()
+        status = self.library.lib.load_tree_conf(os.fsencode(model_path), ctypes.byref(self.conf))
+        if status != CONF_OK:
+            self.conf = None
+            raise ValueError(f"Can not load {model_path} (error {status}), check that it was generated with the {feature_type} feature type.")
+        self.optimize_stats = None
+        if optimize:
+            self.optimize_stats = ConfigOptimizeStats()
+            status = self.library.lib.optimize_tree_conf(ctypes.byref(self.conf), ctypes.byref(self.optimize_stats))
+            if status != CONF_OK:
+                self.close()
+                raise ValueError(f"Can not optimize {model_path} (error {status}).")
+
+    @property
+    def num_classes(self):
+        return self.conf.trailer.num_classes
+
+    @property
+    def num_features(self):
+        return self.conf.trailer.num_features
+
+    @property
+    def num_trees(self):
+        return self.conf.trailer.num_trees
+
+    @property
+    def is_boosted(self):
+        return bool(self.conf.boosting)
+
+    @property
+    def num_outputs(self):
+        """ Number of columns of predict for boosted models. """
+        return self.conf.boosting.contents.num_outputs if self.is_boosted else 1
+
+    def close(self):
+        """ Releases the classifier, also done when the object is collected. """
+        if self.conf is not None:
+            self.library.lib.free_tree_conf(ctypes.byref(self.conf))
+            self.conf = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __del__(self):
+        self.close()
+
+    def check_features(self, features):
+        if self.conf is None:
+            raise ValueError("The forest is closed.")
+        if not isinstance(features, np.ndarray) or features.ndim != 2 or features.shape[1] != self.num_features:
+            raise ValueError(f"Features must be a [number_samples x {self.num_features}] numpy matrix.")
+        if features.dtype != self.dtype or not features.flags.c_contiguous:
+            raise ValueError(f"Features must be a C-contiguous {self.dtype} matrix, they are not copied.")
+
+    def run_batches(self, features, threads, visit):
+        """ Calls visit(begin, end) on chunks of rows, in parallel if threads > 1. """
+        rows = len(features)
+        chunk = min(max_batch_rows, max(1, -(-rows // max(1, threads))))
+        bounds = [(begin, min(rows, begin + chunk)) for begin in range(0, rows, chunk)]
+        if threads > 1 and len(bounds) > 1:
+            with ThreadPoolExecutor(threads) as pool:
+                list(pool.map(lambda bound: visit(*bound), bounds))
+        else:
+            for begin, end in bounds:
+                visit(begin, end)
+
+    def predict(self, features, threads = 1):
+        """
+        Predicts a matrix of samples:
+            - classification forests: the majority voting class of each sample (int16, -1 without votes), see predict_votes;
+            - regression forests: the mean of the leaf values;
+            - boosted models: the [number_samples x num_outputs] transformed margins.
+        """
+        if self.is_boosted:
+            return self.predict_gbdt(features, threads)
+        if self.num_classes == 0:
+            return self.predict_mean(features, threads)
+        return self.predict_votes(features, threads)[0]
+
+    def predict_votes(self, features, threads = 1):
+        """ Returns the majority voting class (int16, -1 without votes) and its number of votes (uint16) of each sample. """
+        self.check_features(features)
+        classes = np.empty(len(features), dtype = np.int16)
+        votes = np.empty(len(features), dtype = np.uint16)
+        lib, conf, feature_ctype = self.library.lib, self.conf, self.library.feature_ctype
+        def visit(begin, end):
+            status = lib.visit_rf_majority_voting_batch(conf.trees, conf.trailer.num_trees, conf.trailer.num_classes,
+                                                          as_pointer(features[begin:end], feature_ctype), end - begin, conf.trailer.num_features,
+                                                          as_pointer(classes[begin:end], ctypes.c_int16), as_pointer(votes[begin:end], ctypes.c_uint16))
+            if status == CLASSIFICATION_NO_MEMORY:
+                raise MemoryError("Can not allocate the vote counters of the majority voting.")
+        self.run_batches(features, threads, visit)
+        return classes, votes
+
+    def predict_proba(self, features, threads = 1):
+        """
+        Returns the [number_samples x num_classes] float32 class distributions of a classification forest: the average of the leaf distributions
+        if the binary contains them, the fraction of the trees voting each class otherwise.
+        """
+        self.check_features(features)
+        if self.num_classes == 0 or self.is_boosted:
+            raise ValueError("Class distributions are only computed for classification forests.")
+        probabilities = np.empty((len(features), self.num_classes), dtype = np.float32)
+        lib, conf, feature_ctype = self.library.lib, self.conf, self.library.feature_ctype
+        def visit(begin, end):
+            return lib.visit_rf_class_probabilities_batch(conf.trees, conf.trailer.num_trees, conf.trailer.num_classes, conf.leaf_probabilities,
+                                                            as_pointer(features[begin:end], feature_ctype), end - begin, conf.trailer.num_features,
+                                                            as_pointer(probabilities[begin:end], ctypes.c_float))
+        self.run_batches(features, threads, visit)
+        return probabilities
+
+    def predict_mean(self, features, threads = 1):
+        """ Returns the mean of the leaf values of a regression forest for each sample. """
+        self.check_features(features)
+        means = np.empty(len(features), dtype = self.dtype)
+        lib, conf, feature_ctype = self.library.lib, self.conf, self.library.feature_ctype
+        def visit(begin, end):
+            return lib.visit_rf_mean_batch(conf.trees, conf.trailer.num_trees, as_pointer(features[begin:end], feature_ctype), end - begin,
+                                            conf.trailer.num_features, as_pointer(means[begin:end], feature_ctype))
+        self.run_batches(features, threads, visit)
+        return means
+
+    def predict_gbdt(self, features, threads = 1):
+        """ Returns the [number_samples x num_outputs] transformed margins of a boosted model. """
+        self.check_features(features)
+        if not self.is_boosted:
+            raise ValueError("The binary does not contain a boosted model.")
+        outputs = np.empty((len(features), self.num_outputs), dtype = self.dtype)
+        lib, conf, feature_ctype = self.library.lib, self.conf, self.library.feature_ctype
+        def visit(begin, end):
+            return lib.visit_gbdt_batch(conf.trees, conf.trailer.num_trees, conf.boosting, as_pointer(features[begin:end], feature_ctype),
+                                        end - begin, conf.trailer.num_features, as_pointer(outputs[begin:end], feature_ctype))
+        self.run_batches(features, threads, visit)
+        return outputs
+
+class DatasetMapping:
+    """ A dataset mapped by load_tree_dataset, unmapped with free_tree_dataset when the last reference (a Dataset or a view) is collected. """
+    def __init__(self, library, dataset):
+        self.library = library
+        self.dataset = dataset
+
+    def __del__(self):
+        self.library.lib.free_tree_dataset(ctypes.byref(self.dataset))
+
+class Dataset:
+    """
+    A binary dataset of the gen_test_bin command of dtc_pygen, mapped by load_tree_dataset. features and labels (None if absent) are
+    read-only numpy views of the mapping, so they can be predicted without copies. The views (and their slices) keep the mapping alive, so
+    they remain valid after the Dataset is collected or closed; the mapping is released with the last of them.
+    """
+    def __init__(self, dataset_path, feature_type = "float"):
+        self.mapping = None
+        library = get_library(feature_type)
+        dataset = library.TreeDataset()
+        status = library.lib.load_tree_dataset(os.fsencode(dataset_path), ctypes.byref(dataset))
+        if status != DATASET_OK:
+            reason = f"it was not generated with the {feature_type} feature type" if status == DATASET_ERR_TYPE else f"error {status}"
+            raise ValueError(f"Can not load {dataset_path}, {reason}.")
+        self.mapping = DatasetMapping(library, dataset)
+        header = dataset.header
+        self.features = self.view(dataset.features, (header.num_samples, header.num_features))
+        self.labels = self.view(dataset.labels, (header.num_samples,)) if dataset.labels else None
+
+    def view(self, pointer, shape):
+        """ Returns a read-only numpy view of the mapping, whose base is a ctypes array referencing the mapping to keep it alive. """
+        count = int(np.prod(shape))
+        buffer = ctypes.cast(pointer, ctypes.POINTER(pointer._type_ * count)).contents
+        buffer.mapping = self.mapping
+        array = np.frombuffer(buffer, dtype = np.dtype(pointer._type_)).reshape(shape)
+        array.flags.writeable = False
+        return array
+
+    def close(self):
+        """
+        Releases the mapping. It is unmapped at once, unless views of features or labels are still referenced: a RuntimeWarning is
+        then emitted, and the mapping is unmapped when the last of them is collected.
+        """
+        if self.mapping is not None:
+            mapping = weakref.ref(self.mapping)
+            self.features, self.labels, self.mapping = None, None, None
+            if mapping() is not None:
+                warnings.warn("Dataset closed while views of its features or labels are alive, it is unmapped when they are collected.",
+                              RuntimeWarning, stacklevel = 2)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
@@ -0,0 +1,49 @@
+"""
+@file example.py
+@brief Example of the Python bindings: accuracy and throughput of a binary configuration on a binary dataset.
+       Build the libraries with make, then run python example.py [--feature_type double] [--input_bin model.bin] [--input_dataset dataset.dtcd].
+
+
+@copyright Copyright (C) 2024 Antonio Emmanuele
+
+This file is part of DTC Decision Tree in C-lang
+
+DTC is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+DTC is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with DTC. If not, see <https://www.gnu.org/licenses/>.
+"""
+import argparse
+import os
+import time
+import numpy as np
+import dtc
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Accuracy and throughput of a binary configuration with the Python bindings.")
+    parser.add_argument("--feature_type",  type=str, help="Feature type of the binary configuration and of the dataset.", default = "double")
+    parser.add_argument("--input_bin",  type=str, help="Path of the binary configuration.", default = "../../examples/desktop/inference_accuracy/statlog_rf5.bin")
+    parser.add_argument("--input_dataset",  type=str, help="Path of the binary dataset of gen_test_bin.", default = "../../examples/desktop/dataset_accuracy/test_dataset.dtcd")
+    parser.add_argument("--threads",  type=int, help="Number of threads predicting the rows.", default = os.cpu_count())
+    parser.add_argument("--repetitions",  type=int, help="Number of predictions of the whole dataset for the throughput.", default = 100)
+    args = parser.parse_args()
+    with dtc.Forest(args.input_bin, args.feature_type) as forest, dtc.Dataset(args.input_dataset, args.feature_type) as dataset:
+        print(f"Num Trees: {forest.num_trees}, classes: {forest.num_classes}, features: {forest.num_features}")
+        predictions = forest.predict(dataset.features, args.threads)
+        if dataset.labels is not None and forest.num_classes > 0 and not forest.is_boosted:
+            correct = int(np.count_nonzero(predictions == dataset.labels))
+            print(f"Number of correctly classified samples {correct} Accuracy : {correct / len(dataset.labels) * 100:f}")
+        for threads in sorted({1, args.threads}):
+            start = time.perf_counter()
+            for _ in range(args.repetitions):
+                forest.predict(dataset.features, threads)
+            elapsed = time.perf_counter() - start
+            print(f"{threads} threads: {len(dataset.features) * args.repetitions / elapsed / 1e6:.3f} M samples/s")
@@ -23,6 +23,17 @@ along with DTC. If not, see <https://www.gnu.org/licenses/>.
 import xml.etree.ElementTree as ET
 import ctypes
 import argparse
+import collections
+import io
+import multiprocessing
+import os
+import re
+import json
+import math
+import functools
+import shutil
+import tempfile
+import time
 import joblib 
 import numpy as np
 from sklearn.tree import DecisionTreeClassifier
@@ -40,22 +51,6 @@ operators_map = {
     "notEqual": 5,
 }
 
-def find_feature_index_by_name(data, input_name):
-    """
-    Finds the index of the dictionary in the list where the 'name' field matches the input string.
-
-    Parameters:
-        data (list): A list of dictionaries, each containing a 'name' key.
-        input_name (str): The name to search for.
-
-    Returns:
-        int: The index of the dictionary with the matching 'name', or -1 if not found.
-    """
-    for index, item in enumerate(data):
-        if item.get('name') == input_name:
-            return index
-    assert 1 == 0, "Invalid PMML, feature provided by the node is not present in the model features."
-
 # Define the tree node c structure
 class TreeNode(ctypes.Structure):
     def __init__(self, *args, **kw):
@@ -85,14 +80,6 @@ def set_fields(tree_node_class: TreeNode, feature_type: str):
         ("threshold", feature_type),
     ]
 
-# Internal representation of the node used during the parsing.
-class NodeConfig:
-    def __init__(self, tree_node_struct, id, left_node, right_node):
-        self.tree_node_struct = tree_node_struct
-        self.id = id
-        self.left_node = left_node
-        self.right_node = right_node
-
 # Model Trailer
 class ConfigTrailer(ctypes.Structure):
     _fields_ = [
@@ -101,193 +88,1289 @@ class ConfigTrailer(ctypes.Structure):
         ("num_trees", ctypes.c_uint16),
     ]
 
-def print_tree(node_list):
+""" Identifiers of the optional sections following the trees. If the C defines are altered then this map must be changed accordingly."""
+sections_map = {
+    "leaf_proba": 1,
+    "boosting": 2,
+}
+
+""" Transformations of the margins of boosted models. If the C defines are altered then this map must be changed accordingly."""
+boosting_objectives_map = {
+    "raw": 0,
+    "sigmoid": 1,
+    "softmax": 2,
+}
+
+# Header of an optional section
+class SectionHeader(ctypes.Structure):
+    _fields_ = [
+        ("section_id", ctypes.c_uint16),
+        ("reserved", ctypes.c_uint16),
+        ("section_size", ctypes.c_uint32),
+    ]
+
+# Header of the boosting section
+class BoostingHeader(ctypes.Structure):
+    _fields_ = [
+        ("objective", ctypes.c_uint16),
+        ("num_outputs", ctypes.c_uint16),
+    ]
+
+# Header of a binary dataset, DATASET_ALIGNMENT bytes long.
+class DatasetHeader(ctypes.Structure):
+    _fields_ = [
+        ("magic", ctypes.c_uint32),
+        ("version", ctypes.c_uint16),
+        ("feature_size", ctypes.c_uint16),
+        ("num_samples", ctypes.c_uint64),
+        ("num_features", ctypes.c_uint16),
+        ("reserved_16", ctypes.c_uint16),
+        ("reserved_32", ctypes.c_uint32),
+        ("features_offset", ctypes.c_uint64),
+        ("labels_offset", ctypes.c_uint64),
+        ("reserved", ctypes.c_uint8 * 24),
+    ]
+
+""" Constants of the binary dataset format. If the C defines are altered then these values must be changed accordingly."""
+DATASET_MAGIC = 0x44435444
+DATASET_VERSION = 1
+DATASET_ALIGNMENT = 64
+
+# Additive structure of a gradient boosted model.
+class BoostingConfig:
+    def __init__(self, objective, base_scores, tree_outputs):
+        self.objective = objective          # Key of boosting_objectives_map.
+        self.base_scores = base_scores      # Initial value of each margin.
+        self.tree_outputs = tree_outputs    # Margin to which each tree contributes.
+
+class PmmlTreeBuilder:
     """
-    Prints the entire tree, highlighting left and right children IDs for each node.
+    Builds the nodes of a PMML TreeModel from its start and end parsing events, using an explicit stack instead of recursion.
+    In a PMML file the split of a node is the predicate of its first child Node, while the predicate of the second child is the
+    complementary condition. Nodes are numbered in pre-order (parent, left subtree, right subtree) as they are opened, 
+    so that the root is in 0.
 
     Parameters:
-        node_list (list): List of NodeConfig objects representing the tree.
+        features (list): Names of the features of the model. IT IS FUNDAMENTAL that their order is identical to the one of the input sample.
+        classes (list): Classes of the model, used to order the class distribution of the leaves. If empty, leaves carry their value.
     """
-    for node in node_list:
-        left_id = node.tree_node_struct.left_node
-        right_id = node.tree_node_struct.right_node
-        print(f"Node ID: {node.id}, Left Child ID: {left_id}, Right Child ID: {right_id}")
+    def __init__(self, features, classes):
+        self.feature_index = {name: idx for idx, name in enumerate(features)}
+        self.classes = classes
+        self.operator, self.feature, self.threshold, self.left, self.right = [], [], [], [], []
+        self.class_res, self.value, self.is_leaf = [], [], []
+        self.leaf_proba = {}
+        # Frames of the open PMML Nodes: [node index, number of children, has the predicate been read, score distribution].
+        self.stack = []
 
-def get_xmlns_uri(elem):
-    """ This function is directly taken from the pyALS-RF project. See https://github.com/SalvatoreBarone/pyALS-RF/tree/master for more info. """
-    if elem.tag[0] == "{":
-        uri, ignore, tag = elem.tag[1:].partition("}")
-    else:
-        uri = None
-    return uri
-
-def get_features_and_classes_from_pmml(root, pmml_namespace):
-    """ This function is directly taken from the pyALS-RF project. See https://github.com/SalvatoreBarone/pyALS-RF/tree/master for more info. """
-    model_features = []
-    model_classes = []
-    for child in root.find("pmml:DataDictionary", pmml_namespace).findall('pmml:DataField', pmml_namespace):
-        if child.attrib["optype"] == "continuous":
-            # the child is PROBABLY a feature
-            model_features.append({
-                "name": child.attrib['name'].replace('-', '_'),
-                "type": "double" if child.attrib['dataType'] == "double" else "int"})
-        elif child.attrib["optype"] == "categorical":
-            # the child PROBABLY specifies model-classes
-            for element in child.findall("pmml:Value",pmml_namespace):
-                model_classes.append(element.attrib['value'].replace('-', '_'))
-    return model_features, model_classes
-
-def get_tree_model_from_pmml(namespaces, tree_model_root, features, id=0):
-    tree = []
-    get_tree_nodes_from_pmml_recursively(namespaces, tree_model_root, tree, features, id)
-    return tree
-
-""" This function is used to recursively construct a decision tree like structure of a decision tree classifier.
-    namespaces = Root namespace previously initialized.
-    element_tree_node = Current node for which the two children are inspected.
-    nodes_list  =       list of nodes of the decision tree, every time a new node is discovered then it is appended to this list.
-    features    =       List of feature names of the model. This is used for mapping the feature of a node to its index in the feature vector.
-                        IT IS FUNDAMENTAL that the order of features (i.e. its indexing) is identical to the one of input sample.
-                        So check the PMML before writing C code :) 
-    id          =       No use for now. 
+    def start(self, tag, elem):
+        if tag != "Node":
+            return
+        idx = len(self.is_leaf)
+        if idx > 0xFFFF:
+            raise ValueError("Trees with more than 65535 nodes are not supported.")
+        for column in (self.operator, self.feature, self.threshold, self.class_res, self.value):
+            column.append(0)
+        self.left.append(-1)
+        self.right.append(-1)
+        self.is_leaf.append(False)
+        if self.stack:
+            parent = self.stack[-1]
+            if parent[1] == 0:
+                self.left[parent[0]] = idx
+            elif parent[1] == 1:
+                self.right[parent[0]] = idx
+            else:
+                raise ValueError("Only binary trees are supported. Aborting.")
+            parent[1] += 1
+        self.stack.append([idx, 0, False, {}])
 
-"""
-def get_tree_nodes_from_pmml_recursively(namespaces, element_tree_node, nodes_list, features, id=0):
-    # Find the children of the current node.
-    children = element_tree_node.findall("pmml:Node", namespaces)
-    # The children in PMML are not corresponding to a maximum of 2 children in the tree.
-    # Indeed in a PMML file, two children represent a single node of the tree.
-    # For example Node_0 is always true, while Node_1 correspond to the first node ( with the <=) condition while Node_2 to the second node (with the > condition).
-    # These two node corresponds to a single node Node_x.
-    assert len(children) == 2, f"Only binary trees are supported. Aborting. {children}" 
-    children_list = []
-    # Find the left and right children and save their attributes. 
-    for child in children:
-        predicate = None
-        # Parse the predicate.
-        if compound_predicate := child.find("pmml:CompoundPredicate", namespaces):
-            predicate = next(item for item in compound_predicate.findall("pmml:SimplePredicate", namespaces) if item.attrib["operator"] != "isMissing")
+    def end(self, tag, elem):
+        if not self.stack:
+            return
+        frame = self.stack[-1]
+        if tag == "SimplePredicate":
+            # The split of the parent is the first predicate of its first child, skipping the isMissing surrogates.
+            if frame[2] or elem.attrib["operator"] == "isMissing" or len(self.stack) < 2:
+                return
+            frame[2] = True
+            parent = self.stack[-2]
+            if parent[1] == 1:
+                field = elem.attrib["field"].replace('-', '_')
+                if field not in self.feature_index:
+                    raise ValueError("Invalid PMML, feature provided by the node is not present in the model features.")
+                self.feature[parent[0]] = self.feature_index[field]
+                self.operator[parent[0]] = operators_map[elem.attrib["operator"]]
+                self.threshold[parent[0]] = float(elem.attrib["value"])
+        elif tag == "ScoreDistribution":
+            # The probability attribute is used when available, otherwise the confidence or, finally, the record count.
+            for attrib in ("probability", "confidence", "recordCount"):
+                if attrib in elem.attrib:
+                    frame[3][elem.attrib["value"].replace('-', '_')] = float(elem.attrib[attrib])
+                    break
+        elif tag == "Node":
+            self.stack.pop()
+            idx, num_children, _, distribution = frame
+            if num_children == 1:
+                raise ValueError("Only binary trees are supported. Aborting.")
+            if num_children == 0:
+                self.is_leaf[idx] = True
+                score = elem.attrib["score"]
+                if len(self.classes) == 0:
+                    self.value[idx] = float(score)
+                else:
+                    self.class_res[idx] = int(score.replace('-', '_'))
+                    if distribution:
+                        self.leaf_proba[idx] = [distribution.get(c, 0.0) for c in self.classes]
+
+    def result(self):
+        """
+        Returns the structured array of the nodes and, for classification trees, the [number_of_nodes x num_classes] leaf distributions.
+        Leaves without a ScoreDistribution get the one-hot distribution of their class.
+        """
+        is_leaf = np.asarray(self.is_leaf)
+        regression = len(self.classes) == 0
+        nodes = build_tree_nodes(is_leaf, np.asarray(self.operator), np.asarray(self.feature), np.asarray(self.threshold),
+                                    np.asarray(self.left), np.asarray(self.right),
+                                    class_res = None if regression else np.asarray(self.class_res),
+                                    leaf_value = np.asarray(self.value, dtype = np.float64) if regression else None)
+        if regression:
+            return nodes, None
+        leaf_proba = np.zeros((len(is_leaf), len(self.classes)), dtype = np.float32)
+        for idx in np.flatnonzero(is_leaf):
+            distribution = self.leaf_proba.get(idx)
+            if distribution is not None and sum(distribution) > 0:
+                leaf_proba[idx] = np.asarray(distribution) / sum(distribution)
+            elif 0 <= self.class_res[idx] < len(self.classes):
+                leaf_proba[idx, self.class_res[idx]] = 1.0
+        return nodes, leaf_proba
+
+def get_tree_section(nodes):
+    """ Returns the section of a tree, i.e. its number of nodes followed by the nodes, as a single buffer. """
+    if len(nodes) > 0xFFFF:
+        raise ValueError("Trees with more than 65535 nodes are not supported.")
+    if nodes.dtype != get_node_dtype():
+        raise ValueError(f"Invalid node table {nodes.dtype}, trees must be built with the dtype of get_node_dtype.")
+    section = np.zeros(ctypes.sizeof(ctypes.c_uint16) + nodes.nbytes, dtype = np.uint8)
+    section[:2] = np.frombuffer(np.uint16(len(nodes)).tobytes(), dtype = np.uint8)
+    # Structured assignments copy field by field, so the padding bytes stay zero whatever the source array contains.
+    section[2:].view(nodes.dtype)[...] = nodes
+    return section
+
+def write_tree(out_file, nodes):
+    """ Writes the section of a tree with a single write. """
+    out_file.write(get_tree_section(nodes))
+
+""" Start and end tags of a TreeModel, with any namespace prefix. TreeModels can not be nested, so each match delimits a tree. """
+pmml_tree_model_start = re.compile(rb"<(?:[\w.-]+:)?TreeModel[\s>/]")
+pmml_tree_model_end = re.compile(rb"</(?:[\w.-]+:)?TreeModel\s*>")
+
+def get_pmml_schema(file_path):
+    """
+    Parses the PMML file until its first TreeModel, returning the features, the classes and the namespace declarations of the document.
+    Features are the continuous DataFields, except the targets of the mining schema. Classes are the values of the categorical ones.
+    """
+    data_fields = []
+    targets = set()
+    namespaces = {}
+    for event, elem in ET.iterparse(file_path, events = ("start", "end", "start-ns")):
+        if event == "start-ns":
+            namespaces.setdefault(elem[0], elem[1])
+            continue
+        tag = elem.tag.rpartition("}")[2]
+        if event == "start":
+            if tag == "TreeModel":
+                features = [name for name, optype, _ in data_fields if optype == "continuous" and name not in targets]
+                classes = [value for _, optype, values in data_fields if optype == "categorical" for value in values]
+                return features, classes, namespaces
+        elif tag == "DataField":
+            data_fields.append((elem.attrib["name"].replace('-', '_'), elem.attrib["optype"],
+                                [v.attrib["value"].replace('-', '_') for v in elem if v.tag.rpartition("}")[2] == "Value"]))
+        elif tag == "MiningField" and elem.attrib.get("usageType") in ("target", "predicted"):
+            targets.add(elem.attrib["name"].replace('-', '_'))
+    raise ValueError("The PMML file does not contain any TreeModel.")
+
+def get_pmml_tree_models(file_path, chunk_size = 1 << 20):
+    """
+    Yields the (start, end) byte offsets of each TreeModel of the PMML file, scanning the file in chunks without parsing it.
+    The tail of each chunk is kept, so that tags split across two chunks are found in the next one.
+    """
+    with open(file_path, "rb") as in_file:
+        buffer, offset, start = b"", 0, None
+        while True:
+            data = in_file.read(chunk_size)
+            buffer += data
+            position = 0
+            while True:
+                pattern = pmml_tree_model_start if start is None else pmml_tree_model_end
+                match = pattern.search(buffer, position)
+                if match is None:
+                    break
+                position = match.end()
+                if start is None:
+                    start = offset + match.start()
+                else:
+                    yield start, offset + match.end()
+                    start = None
+            if not data:
+                if start is not None:
+                    raise ValueError("Invalid PMML, unterminated TreeModel.")
+                return
+            consumed = max(position, len(buffer) - 64)
+            buffer, offset = buffer[consumed:], offset + consumed
+
+def init_pmml_worker(feature_ctype):
+    """ Sets the feature type of the nodes in the workers, which do not inherit it when they are spawned instead of forked. """
+    if "_fields_" not in TreeNode.__dict__:
+        set_fields(TreeNode, feature_ctype)
+
+def convert_pmml_tree_model(task):
+    """
+    Converts a single TreeModel, read from its byte range of the PMML file, in a tree section and its leaf distributions.
+    The TreeModel is wrapped in an element declaring the namespaces of the document, so that it can be parsed on its own.
+    Run by the workers of pmml_parser, so arguments and results are plain picklable values.
+    """
+    file_path, start, end, namespaces, features, classes = task
+    with open(file_path, "rb") as in_file:
+        in_file.seek(start)
+        fragment = in_file.read(end - start)
+    declarations = "".join(f' xmlns:{prefix}="{uri}"' if prefix else f' xmlns="{uri}"' for prefix, uri in namespaces.items())
+    document = io.BytesIO(f"<Fragment{declarations}>".encode() + fragment + b"</Fragment>")
+    builder = PmmlTreeBuilder(features, classes)
+    parents = []
+    for event, elem in ET.iterparse(document, events = ("start", "end")):
+        tag = elem.tag.rpartition("}")[2]
+        if event == "start":
+            builder.start(tag, elem)
+            parents.append(elem)
+            continue
+        parents.pop()
+        builder.end(tag, elem)
+        # Free the parsed nodes.
+        if tag == "Node" and parents:
+            parents[-1].remove(elem)
+    nodes, matrix = builder.result()
+    return get_tree_section(nodes), matrix
+
+def pmml_parser(file_path, out_path, leaf_proba = False, jobs = None):
+    """
+    Converts a PMML model, converting its TreeModels (i.e. the Segments of a MiningModel) in parallel in a pool of jobs processes.
+    The parent only parses the schema of the model and scans the file for the byte range of each TreeModel, while the workers parse the 
+    ranges and build the tree sections. Sections are written in the order of the trees as they complete, keeping at most two tasks per
+    worker in flight so that memory does not depend on the size of the model. The number of trees is patched in the trailer at the end,
+    while the leaf distributions, which follow the trees, are buffered in a temporary file.
+    """
+    features, classes, namespaces = get_pmml_schema(file_path)
+    print("Model features: ", features)
+    print("Model classes: ", classes)
+    if len(classes) == 0:
+        print("No classes found, the model is parsed as a regression model")
+    jobs = jobs or os.cpu_count() or 1
+    trailer = ConfigTrailer(len(classes), len(features), 0)
+    tasks = ((file_path, start, end, namespaces, features, classes) for start, end in get_pmml_tree_models(file_path))
+    proba_file = tempfile.TemporaryFile() if leaf_proba else None
+
+    # Counted in a Python int, as the uint16_t field of the trailer would wrap around.
+    num_trees = 0
+
+    def write_result(out_file, result):
+        nonlocal num_trees
+        if num_trees == 0xFFFF:
+            raise ValueError("Models with more than 65535 trees are not supported.")
+        section, matrix = result
+        out_file.write(section)
+        if proba_file is not None and matrix is not None:
+            proba_file.write(matrix.tobytes())
+        num_trees += 1
+
+    try:
+        with open(out_path, "wb") as out_file:
+            out_file.write(bytearray(trailer))
+            if jobs == 1:
+                for task in tasks:
+                    write_result(out_file, convert_pmml_tree_model(task))
+            else:
+                with multiprocessing.Pool(jobs, initializer = init_pmml_worker, initargs = (dict(TreeNode._fields_)["threshold"],)) as pool:
+                    pending = collections.deque()
+                    for task in tasks:
+                        pending.append(pool.apply_async(convert_pmml_tree_model, (task,)))
+                        if len(pending) >= 2 * jobs:
+                            write_result(out_file, pending.popleft().get())
+                    while pending:
+                        write_result(out_file, pending.popleft().get())
+            if proba_file is not None and trailer.num_classes > 0:
+                out_file.write(bytearray(SectionHeader(sections_map["leaf_proba"], 0, proba_file.tell())))
+                proba_file.seek(0)
+                shutil.copyfileobj(proba_file, out_file)
+            trailer.num_trees = num_trees
+            out_file.seek(0)
+            out_file.write(bytearray(trailer))
+    except BaseException:
+        # The partial binary is removed, its trailer does not declare the written trees.
+        os.remove(out_path)
+        raise
+    print(f"Binary file written, number of trees {trailer.num_trees}")
+
+def sklearn_tree_nodes(tree, class_map):
+    """
+    Converts the tree_ arrays of a fitted sklearn estimator in a DTC tree, with a single vectorized pass.
+    sklearn takes the left child if feature <= threshold, and marks leaves with children_left == -1.
+    Node indices are kept as they are, as the root is already in 0.
+
+    Parameters:
+        tree: The tree_ attribute of the estimator.
+        class_map (np.ndarray): Class written in the leaves for each column of tree.value, or None for regression trees.
+
+    Returns:
+        tuple: The structured array of the nodes, and the [number_of_nodes x num_classes] leaf distributions (None for regression trees).
+    """
+    is_leaf = tree.children_left == -1
+    feature_index = np.where(is_leaf, 0, tree.feature)
+    operator = np.full(tree.node_count, operators_map["lessOrEqual"])
+    if class_map is None:
+        nodes = build_tree_nodes(is_leaf, operator, feature_index, tree.threshold, tree.children_left, tree.children_right, leaf_value = tree.value[:, 0, 0])
+        return nodes, None
+    # Values are either the class counts or, in recent versions, the class fractions of the samples of each node.
+    value = tree.value[:, 0, :]
+    totals = value.sum(axis = 1, keepdims = True)
+    leaf_proba = np.where(is_leaf[:, None], value / np.where(totals > 0, totals, 1), 0)
+    nodes = build_tree_nodes(is_leaf, operator, feature_index, tree.threshold, tree.children_left, tree.children_right, class_res = class_map[np.argmax(value, axis = 1)])
+    return nodes, leaf_proba
+
+def joblib_parser(file_path, out_path, leaf_proba = False):
+    """
+    Converts a sklearn model saved with joblib, reading the tree_ arrays of its estimators.
+    Supported models are DecisionTreeClassifier, RandomForestClassifier and ExtraTreesClassifier, as well as their regression counterparts.
+    Classes are written as they are when they are the integers 0..num_classes-1, as in the PMML models. Otherwise the index of the class is used.
+    """
+    model = joblib.load(file_path)
+    estimators = model.estimators_ if hasattr(model, "estimators_") else [model]
+    if not hasattr(estimators[0], "tree_"):
+        raise ValueError(f"Unsupported model {type(model).__name__}, only decision trees and random forests are supported.")
+    if getattr(model, "n_outputs_", 1) > 1:
+        raise ValueError("Multi-output models are not supported.")
+    num_features = model.n_features_in_
+    if hasattr(model, "classes_"):
+        classes = np.asarray(model.classes_)
+        if np.issubdtype(classes.dtype, np.integer) and np.array_equal(classes, np.arange(len(classes))):
+            class_map = classes.astype(np.int16)
         else:
-            predicate = child.find("pmml:SimplePredicate", namespaces)
-        # Get infos.
-        if predicate is not None:
-            feature = predicate.attrib['field'].replace('-', '_')
-            operator = predicate.attrib['operator']
-            threshold_value = predicate.attrib['value']   
-        # Append to the list of children.
-        children_list.append({"children": child, "feature": feature, "operator": operator, "threshold_value": threshold_value})
-    
-    # Instantiate the left node 
-    tree_node_feature = find_feature_index_by_name(features, children_list[0]["feature"])
-    tree_node_operator = operators_map[children_list[0]["operator"]]
-    tree_node_threshold = float(children_list[0]["threshold_value"]) # For now only double are supported
-    # This node will be the first one to be inspected.
-    tree_node_right = 0
-    tree_node_left = 0
-    class_res = -1
-    #nodes_list.append(TreeNode(tree_node_operator, tree_node_feature, tree_node_threshold, class_res, tree_node_left, tree_node_right))
-    tree_node_c_struct = TreeNode(tree_node_operator, tree_node_feature, class_res, tree_node_left, tree_node_right, tree_node_threshold)
-    # After instantiating the left node this function will be able to reconstruct the code 
-    parent_node = NodeConfig(tree_node_c_struct, id, None, None)
-    nodes_list.append(parent_node)
-
-    #print("Node : Feature: ", tree_node_feature, "Operator: ", tree_node_operator, "Threshold: ", tree_node_threshold)
-    # Set the left node index.
-    parent_node.tree_node_struct.left_node = len(nodes_list)
-    # Continue inspecting if the left node is not a leaf
-    if children_list[0]["children"].find("pmml:Node", namespaces) is not None:
-        get_tree_nodes_from_pmml_recursively(namespaces, children_list[0]["children"], nodes_list, features, len(nodes_list))
+            class_map = np.arange(len(classes), dtype = np.int16)
+            print("Classes are written as their index: ", dict(enumerate(classes.tolist())))
+        num_classes = len(classes)
     else:
-        # Otherwise, instantiate the node.
-        operator = 0 
-        feature_index = 0
-        threshold = 0
-        class_res =  int(children_list[0]["children"].attrib['score'].replace('-', '_'))
-        left_node = -1
-        right_node = -1
-        tree_node_c_struct = TreeNode(operator, feature_index, class_res, left_node, right_node, threshold)
-        left_node = NodeConfig(tree_node_c_struct, len(nodes_list), None, None)
-        nodes_list.append(left_node)
-    
-    # Set the right node index.
-    parent_node.tree_node_struct.right_node = len(nodes_list)
-    if children_list[1]["children"].find("pmml:Node", namespaces) is not None:
-        get_tree_nodes_from_pmml_recursively(namespaces, children_list[1]["children"], nodes_list, features, len(nodes_list))
+        class_map = None
+        num_classes = 0
+        print("No classes found, the model is parsed as a regression model")
+    print(f"Model {type(model).__name__}: {len(estimators)} trees, {num_features} features, {num_classes} classes")
+    trees = []
+    leaf_proba_matrices = []
+    for estimator in estimators:
+        # Estimators of a forest share the classes of the forest, and are fitted on their indices.
+        nodes, matrix = sklearn_tree_nodes(estimator.tree_, class_map)
+        trees.append(nodes)
+        leaf_proba_matrices.append(matrix)
+    trailer = ConfigTrailer(num_classes, num_features, len(trees))
+    write_bin(trailer, trees, out_path, leaf_proba and class_map is not None, leaf_proba_matrices = leaf_proba_matrices)
+
+def get_node_dtype():
+    """
+    Returns the numpy structured dtype with the same layout (field offsets and padding) of the TreeNode structure,
+    so that a whole tree can be built with vectorized operations and serialized with a single tobytes.
+    """
+    return get_node_dtype_for(dict(TreeNode._fields_)["threshold"])
+
+@functools.lru_cache(maxsize = None)
+def get_node_dtype_for(feature_ctype):
+    """ Builds the dtype of get_node_dtype, once per feature type. """
+    field_types = {
+        ctypes.c_uint16: np.uint16,
+        ctypes.c_int16: np.int16,
+        ctypes.c_int32: np.int32,
+        ctypes.c_float: np.float32,
+        ctypes.c_double: np.float64,
+    }
+    return np.dtype({
+        "names": [name for name, _ in TreeNode._fields_],
+        "formats": [field_types[ctype] for _, ctype in TreeNode._fields_],
+        "offsets": [getattr(TreeNode, name).offset for name, _ in TreeNode._fields_],
+        "itemsize": ctypes.sizeof(TreeNode),
+    })
+
+def build_tree_nodes(is_leaf, operator, feature_index, threshold, left_node, right_node, class_res = None, leaf_value = None):
+    """
+    Builds the structured array of the nodes of a tree, in a single vectorized pass.
+    Leaves get the operator, feature and children of the leaves of the C code, and carry either a class or a value (in the threshold field).
+
+    Parameters:
+        is_leaf (np.ndarray): Boolean mask of the leaves.
+        operator, feature_index, threshold, left_node, right_node (np.ndarray): Split of the internal nodes, ignored for leaves.
+        class_res (np.ndarray): Class of the leaves, or None for regression and boosted trees.
+        leaf_value (np.ndarray): Value of the leaves, or None for classification trees.
+    """
+    nodes = np.zeros(len(is_leaf), dtype = get_node_dtype())
+    threshold = round_thresholds(operator, threshold, nodes.dtype["threshold"])
+    nodes["operator"] = np.where(is_leaf, 0, operator)
+    nodes["feature_index"] = np.where(is_leaf, 0, feature_index)
+    nodes["class_res"] = np.where(is_leaf, class_res, -1) if class_res is not None else np.where(is_leaf, 0, -1)
+    nodes["left_node"] = np.where(is_leaf, -1, left_node)
+    nodes["right_node"] = np.where(is_leaf, -1, right_node)
+    nodes["threshold"] = np.where(is_leaf, leaf_value, threshold) if leaf_value is not None else np.where(is_leaf, 0, threshold)
+    return nodes
+
+def round_thresholds(operator, threshold, feature_dtype):
+    """
+    Converts the thresholds of the splits in the feature type, so that each comparison of a feature of that type gives the same result
+    as with the original (double) threshold. Rounding to nearest would move ties, e.g. a feature equal to a float threshold rounded
+    above the double one would take the left child of lessOrEqual instead of the right one: thresholds of lessOrEqual and greaterThan
+    are rounded down, the ones of lessThan and greaterOrEqual up. equal and notEqual keep the nearest value.
+    """
+    threshold = np.asarray(threshold, dtype = np.float64)
+    if feature_dtype == np.float64:
+        return threshold
+    # Thresholds beyond the range of the type round to infinity, and are brought back to the largest finite value.
+    with np.errstate(over = "ignore"):
+        rounded = threshold.astype(feature_dtype)
+        widened = rounded.astype(np.float64)
+        down = np.isin(operator, [operators_map["lessOrEqual"], operators_map["greaterThan"]]) & (widened > threshold)
+        up = np.isin(operator, [operators_map["lessThan"], operators_map["greaterOrEqual"]]) & (widened < threshold)
+        rounded = np.where(down, np.nextafter(rounded, feature_dtype.type(-np.inf)), rounded)
+        return np.where(up, np.nextafter(rounded, feature_dtype.type(np.inf)), rounded)
+
+""" Operator evaluating to the opposite condition of each operator in operators_map, indexed by operator. """
+negated_operators = np.array([
+    operators_map["greaterThan"],       # lessOrEqual
+    operators_map["greaterOrEqual"],    # lessThan
+    operators_map["lessThan"],          # greaterOrEqual
+    operators_map["lessOrEqual"],       # greaterThan
+    operators_map["notEqual"],          # equal
+    operators_map["equal"],             # notEqual
+])
+
+def apply_missing_direction(operator, left_node, right_node, missing_left):
+    """
+    Encodes the default direction of missing values (NaN) without any support in the C code.
+    Except for notEqual, comparisons with NaN are false, so NaN already follows the right child. 
+    Nodes sending NaN to the left child are rewritten with the negated operator and swapped children, which is the same split for
+    every other value while NaN now follows the original left child. 
+    notEqual already sends NaN to the left child, while equal can not: the negated operator (notEqual) is true for NaN, so NaN would still
+    follow the original right child. Callers must reject the equal nodes sending NaN to the left child.
+
+    Parameters:
+        operator, left_node, right_node (np.ndarray): Split of the nodes, the left node is taken when the operator is true.
+        missing_left (np.ndarray): Boolean mask of the nodes sending missing values to the left child.
+
+    Returns:
+        tuple: The rewritten (operator, left_node, right_node) arrays.
+    """
+    swap = missing_left & (operator != operators_map["notEqual"]) & (operator != operators_map["equal"])
+    return (np.where(swap, negated_operators[operator], operator),
+            np.where(swap, right_node, left_node),
+            np.where(swap, left_node, right_node))
+
+def parse_float_list(value):
+    """ Parses numbers stored as strings, possibly as vectors like "[5E-1,5E-1]" (e.g. the XGBoost base_score). """
+    return [float(v) for v in str(value).strip("[]").split(",")]
+
+def xgboost_parser(model, out_path):
+    """
+    Converts a model saved by the XGBoost save_model in the JSON format.
+    Nodes are already stored as flat arrays, with the root in 0, so each tree is converted with vectorized operations.
+    XGBoost takes the left child if feature < split_condition, or if the feature is missing and default_left is set.
+    """
+    learner = model["learner"]
+    booster = learner["gradient_booster"]
+    objective = learner["objective"]["name"]
+    model_param = learner["learner_model_param"]
+    num_features = int(model_param["num_feature"])
+    num_class = int(model_param.get("num_class", 0))
+    if int(model_param.get("num_target", 1)) > 1:
+        raise ValueError("Multi-target XGBoost models are not supported.")
+    # Dart boosters wrap a gbtree one, and weight each tree.
+    tree_weights = None
+    if booster["name"] == "dart":
+        tree_weights = booster["weight_drop"]
+        booster = booster["gbtree"]
+    trees_json = booster["model"]["trees"]
+    tree_info = booster["model"]["tree_info"]
+    # Base score is stored in the probability space of the objective.
+    base_scores = parse_float_list(model_param["base_score"])
+    if objective in ("binary:logistic", "binary:logitraw", "reg:logistic"):
+        base_scores = [math.log(b / (1 - b)) for b in base_scores]
+        transformation = "raw" if objective == "binary:logitraw" else "sigmoid"
+        num_classes = 2
+        num_outputs = 1
+    elif objective in ("multi:softprob", "multi:softmax"):
+        transformation = "softmax"
+        num_classes = num_class
+        num_outputs = num_class
+    elif objective.startswith("reg:") and objective not in ("reg:gamma", "reg:tweedie"):
+        transformation = "raw"
+        num_classes = 0
+        num_outputs = 1
     else:
-        operator = 0 
-        feature_index = 0
-        threshold = 0
-        class_res =  int(children_list[1]["children"].attrib['score'].replace('-', '_'))
-        left_node = -1
-        right_node = -1
-        tree_node_c_struct = TreeNode(operator, feature_index, class_res, left_node, right_node, threshold)
-        left_node = NodeConfig(tree_node_c_struct, len(nodes_list), None, None)
-        nodes_list.append(left_node)
-
-def pmml_parser(file_path, out_path):
-    # Get the tree like structure of the PMML.
-    # Note that this is not the decision tree but the tree-structure of the pmml root
-    tree = ET.parse(file_path)
-    # Get the root 
-    root = tree.getroot()
-    namespaces = {}
-    namespaces["pmml"] = get_xmlns_uri(root)
-    if namespaces is None:
-        raise ValueError("The PMML file does not have the correct namespace")
+        raise ValueError(f"Unsupported XGBoost objective {objective}.")
+    if len(base_scores) != num_outputs:
+        base_scores = [base_scores[0]] * num_outputs
+    print(f"XGBoost model: objective {objective}, {len(trees_json)} trees, {num_features} features, {num_outputs} outputs")
+
+    trees = []
+    for idx, tree_json in enumerate(trees_json):
+        if any(tree_json.get("split_type", [])):
+            raise ValueError(f"Tree {idx} contains categorical splits, which are not supported.")
+        left_node = np.asarray(tree_json["left_children"], dtype = np.int32)
+        right_node = np.asarray(tree_json["right_children"], dtype = np.int32)
+        split_conditions = np.asarray(tree_json["split_conditions"], dtype = np.float64)
+        is_leaf = left_node == -1
+        operator = np.full(len(left_node), operators_map["lessThan"])
+        operator, left_node, right_node = apply_missing_direction(operator, left_node, right_node, np.asarray(tree_json["default_left"], dtype = bool))
+        leaf_value = split_conditions * (tree_weights[idx] if tree_weights is not None else 1.0)
+        trees.append(build_tree_nodes(is_leaf, operator, np.asarray(tree_json["split_indices"]), split_conditions, left_node, right_node, leaf_value = leaf_value))
+    trailer = ConfigTrailer(num_classes, num_features, len(trees))
+    write_bin(trailer, trees, out_path, boosting = BoostingConfig(transformation, base_scores, [int(t) for t in tree_info]))
+
+def get_lightgbm_objective(objective, num_class):
+    """
+    Returns (transformation, num_classes, num_outputs, score_scale) of a LightGBM objective string, e.g. "binary sigmoid:1".
+    The sigmoid parameter scales the margins, so it is folded into the leaf values through score_scale.
+    """
+    name, *params = objective.split(" ")
+    params = dict(p.split(":") for p in params if ":" in p)
+    if name in ("binary", "cross_entropy", "xentropy"):
+        return "sigmoid", 2, 1, float(params.get("sigmoid", 1.0))
+    if name in ("multiclass", "softmax"):
+        return "softmax", num_class, num_class, 1.0
+    if name in ("multiclassova", "multiclass_ova", "ova", "ovr"):
+        return "sigmoid", num_class, num_class, float(params.get("sigmoid", 1.0))
+    if name in ("regression", "regression_l2", "regression_l1", "huber", "fair", "quantile", "mape", "l2", "l1", "mse", "mae", "rmse"):
+        return "raw", 0, 1, 1.0
+    raise ValueError(f"Unsupported LightGBM objective {objective}.")
+
+""" Missing types of the LightGBM splits, i.e. bits 2-3 of decision_type or the missing_type of dump_model. """
+lightgbm_missing_types = {"None": 0, "Zero": 1, "NaN": 2}
+
+def lightgbm_tree_nodes(split_feature, threshold, default_left, missing_type, left_child, right_child, leaf_value):
+    """
+    Converts the arrays of a LightGBM tree in a DTC tree with vectorized operations.
+    LightGBM stores internal nodes and leaves in two arrays, negative children (~index) refer to leaves.
+    Here internal nodes come first, followed by the leaves, so the root (internal node 0) stays in 0.
+    LightGBM takes the left child if feature <= threshold, or if the feature is missing and default_left is set.
+    Except for the NaN missing type, NaN is replaced by 0 before the split: with the None type it follows the comparison of 0 with
+    the threshold, with the Zero type the default direction (as zeros, which are not supported and follow the threshold comparison).
+    """
+    num_internal = len(split_feature)
+    if num_internal == 0:
+        # Single leaf tree.
+        return build_tree_nodes(np.ones(1, dtype = bool), 0, 0, 0, 0, 0, leaf_value = leaf_value)
+    to_node = lambda child: np.where(child >= 0, child, num_internal + np.invert(child))
+    left_node = np.concatenate([to_node(left_child), np.zeros(len(leaf_value), dtype = np.int32)])
+    right_node = np.concatenate([to_node(right_child), np.zeros(len(leaf_value), dtype = np.int32)])
+    is_leaf = np.arange(len(left_node)) >= num_internal
+    operator = np.full(len(left_node), operators_map["lessOrEqual"])
+    nan_left = np.where(missing_type == lightgbm_missing_types["None"], threshold >= 0, default_left)
+    missing_left = np.concatenate([nan_left, np.zeros(len(leaf_value), dtype = bool)])
+    operator, left_node, right_node = apply_missing_direction(operator, left_node, right_node, missing_left)
+    pad = np.zeros(len(leaf_value))
+    return build_tree_nodes(is_leaf, operator, np.concatenate([split_feature, pad]), np.concatenate([threshold, pad]), left_node, right_node,
+                            leaf_value = np.concatenate([np.zeros(num_internal), leaf_value]))
+
+def lightgbm_text_parser(file_path, out_path):
+    """
+    Converts a model saved by the LightGBM save_model (or model_to_string) in the text format.
+    decision_type is a bit field: bit 0 categorical, bit 1 default left, bits 2-3 missing type (0 none, 1 zero, 2 NaN).
+    """
+    header = {}
+    trees_fields = []
+    current = header
+    with open(file_path, "r") as in_file:
+        for line in in_file:
+            line = line.strip()
+            if line.startswith("Tree="):
+                current = {}
+                trees_fields.append(current)
+            elif line == "end of trees":
+                break
+            elif "=" in line:
+                key, value = line.split("=", 1)
+                current[key] = value
+            elif line:
+                # Flags without value, e.g. average_output of the random forest mode.
+                current[line] = ""
+    num_class = int(header.get("num_class", 1))
+    num_tree_per_iteration = int(header.get("num_tree_per_iteration", 1))
+    transformation, num_classes, num_outputs, score_scale = get_lightgbm_objective(header.get("objective", "regression"), num_class)
+    if "average_output" in header:
+        score_scale /= max(1, len(trees_fields) // num_tree_per_iteration)
+    num_features = int(header["max_feature_idx"]) + 1
+    print(f"LightGBM model: objective {header.get('objective')}, {len(trees_fields)} trees, {num_features} features, {num_outputs} outputs")
+
+    to_array = lambda fields, key, dtype: np.array(fields[key].split(" "), dtype = dtype) if fields.get(key, "") != "" else np.zeros(0, dtype = dtype)
+    trees = []
+    for idx, fields in enumerate(trees_fields):
+        if int(fields.get("num_cat", 0)) > 0:
+            raise ValueError(f"Tree {idx} contains categorical splits, which are not supported.")
+        decision_type = to_array(fields, "decision_type", np.int32)
+        missing_type = (decision_type >> 2) & 3
+        if np.any(missing_type == lightgbm_missing_types["Zero"]):
+            print(f"[Tree-ID: {idx}] Warning: zero as missing value is not supported, zeros follow the threshold comparison.")
+        trees.append(lightgbm_tree_nodes(to_array(fields, "split_feature", np.int32), to_array(fields, "threshold", np.float64),
+                                            (decision_type & 2) != 0, missing_type,
+                                            to_array(fields, "left_child", np.int32), to_array(fields, "right_child", np.int32),
+                                            to_array(fields, "leaf_value", np.float64) * score_scale))
+    trailer = ConfigTrailer(num_classes, num_features, len(trees))
+    tree_outputs = [idx % num_tree_per_iteration for idx in range(len(trees))]
+    write_bin(trailer, trees, out_path, boosting = BoostingConfig(transformation, [0.0] * num_outputs, tree_outputs))
+
+def lightgbm_json_parser(model, out_path):
+    """
+    Converts a model dumped by the LightGBM dump_model in the JSON format.
+    The nested tree_structure is flattened with an explicit stack in the arrays of the text format, then converted as the text format.
+    """
+    num_class = int(model.get("num_class", 1))
+    num_tree_per_iteration = int(model.get("num_tree_per_iteration", 1))
+    transformation, num_classes, num_outputs, score_scale = get_lightgbm_objective(model.get("objective", "regression"), num_class)
+    if model.get("average_output", False):
+        score_scale /= max(1, len(model["tree_info"]) // num_tree_per_iteration)
+    num_features = int(model["max_feature_idx"]) + 1
+    print(f"LightGBM model: objective {model.get('objective')}, {len(model['tree_info'])} trees, {num_features} features, {num_outputs} outputs")
+
+    trees = []
+    for idx, tree_info in enumerate(model["tree_info"]):
+        num_leaves = int(tree_info["num_leaves"])
+        split_feature = np.zeros(num_leaves - 1, dtype = np.int32)
+        threshold = np.zeros(num_leaves - 1)
+        default_left = np.zeros(num_leaves - 1, dtype = bool)
+        missing_type = np.zeros(num_leaves - 1, dtype = np.int32)
+        left_child = np.zeros(num_leaves - 1, dtype = np.int32)
+        right_child = np.zeros(num_leaves - 1, dtype = np.int32)
+        leaf_value = np.zeros(num_leaves)
+        # The child index of the text format, negative for leaves.
+        child_index = lambda node: node["split_index"] if "split_index" in node else ~node.get("leaf_index", 0)
+        stack = [tree_info["tree_structure"]]
+        while stack:
+            node = stack.pop()
+            if "split_index" not in node:
+                leaf_value[node.get("leaf_index", 0)] = node["leaf_value"]
+                continue
+            if node["decision_type"] != "<=":
+                raise ValueError(f"Tree {idx} contains categorical splits, which are not supported.")
+            i = node["split_index"]
+            split_feature[i] = node["split_feature"]
+            threshold[i] = node["threshold"]
+            default_left[i] = node["default_left"]
+            missing_type[i] = lightgbm_missing_types[node["missing_type"]]
+            left_child[i] = child_index(node["left_child"])
+            right_child[i] = child_index(node["right_child"])
+            stack += [node["left_child"], node["right_child"]]
+        if np.any(missing_type == lightgbm_missing_types["Zero"]):
+            print(f"[Tree-ID: {idx}] Warning: zero as missing value is not supported, zeros follow the threshold comparison.")
+        trees.append(lightgbm_tree_nodes(split_feature, threshold, default_left, missing_type, left_child, right_child, leaf_value * score_scale))
+    trailer = ConfigTrailer(num_classes, num_features, len(trees))
+    tree_outputs = [idx % num_tree_per_iteration for idx in range(len(trees))]
+    write_bin(trailer, trees, out_path, boosting = BoostingConfig(transformation, [0.0] * num_outputs, tree_outputs))
+
+def json_parser(file_path, out_path):
+    """ Dispatches a JSON model to the XGBoost or LightGBM importer, depending on its content. """
+    with open(file_path, "r") as in_file:
+        model = json.load(in_file)
+    if "learner" in model:
+        xgboost_parser(model, out_path)
+    elif "tree_info" in model:
+        lightgbm_json_parser(model, out_path)
     else:
-        print("The PMML file has the correct namespace: ", namespaces)
-    model_features, model_classes = get_features_and_classes_from_pmml(root, namespaces)
-    print("Model features: ", model_features)
-    print("Model classes: ", model_classes)
-    trailer = ConfigTrailer(len(model_classes), len(model_features), 0)
+        raise ValueError("Unknown JSON model, only XGBoost save_model and LightGBM dump_model files are supported.")
+
+""" Map of the modes of the ONNX-ML TreeEnsemble nodes to operators_map. The true branch of ONNX is the left child of the C code."""
+onnx_modes_map = {
+    "BRANCH_LEQ": operators_map["lessOrEqual"],
+    "BRANCH_LT": operators_map["lessThan"],
+    "BRANCH_GTE": operators_map["greaterOrEqual"],
+    "BRANCH_GT": operators_map["greaterThan"],
+    "BRANCH_EQ": operators_map["equal"],
+    "BRANCH_NEQ": operators_map["notEqual"],
+    "LEAF": 0,
+}
+
+def get_onnx_attributes(node):
+    """ Returns the attributes of an ONNX node as a dictionary of numpy arrays and strings, resolving the *_as_tensor variants. """
+    from onnx import helper, numpy_helper
+    attributes = {}
+    for attribute in node.attribute:
+        value = helper.get_attribute_value(attribute)
+        name = attribute.name
+        if name.endswith("_as_tensor"):
+            name, value = name[:-len("_as_tensor")], numpy_helper.to_array(value)
+        elif isinstance(value, bytes):
+            value = value.decode()
+        elif isinstance(value, list):
+            value = np.array([v.decode() for v in value]) if value and isinstance(value[0], bytes) else np.asarray(value)
+        attributes[name] = value
+    return attributes
+
+def onnx_tree_ensemble_nodes(attributes, prefix):
+    """
+    Converts the flat node arrays of a TreeEnsembleClassifier or TreeEnsembleRegressor in DTC trees, with vectorized operations.
+    Nodes are sorted by (tree, node) id, so that each tree is a contiguous range and child ids are mapped to node indices with a binary search.
+    The root, i.e. the only node that is not a child, is moved in 0. Leaf weights (prefix "class" or "target") are summed per node and output.
+
+    Returns:
+        tuple: The list of the structured arrays of the trees, the list of their [number_of_nodes x num_outputs] leaf weights, 
+               and the list of the outputs to which the leaves of each tree contribute.
+    """
+    tree_ids = np.asarray(attributes["nodes_treeids"], dtype = np.int64)
+    node_ids = np.asarray(attributes["nodes_nodeids"], dtype = np.int64)
+    keys = (tree_ids << 32) | node_ids
+    order = np.argsort(keys, kind = "stable")
+    keys, tree_ids, node_ids = keys[order], tree_ids[order], node_ids[order]
+    if np.any(np.diff(keys) == 0):
+        raise ValueError("Invalid ONNX model, duplicated node ids.")
+    modes = np.asarray(attributes["nodes_modes"])[order]
+    unknown = set(np.unique(modes)) - set(onnx_modes_map)
+    if unknown:
+        raise ValueError(f"Unsupported node modes {sorted(unknown)}.")
+    is_leaf = modes == "LEAF"
+    operator = np.vectorize(onnx_modes_map.get, otypes = [np.int64])(modes)
+    feature_index = np.asarray(attributes["nodes_featureids"], dtype = np.int64)[order]
+    threshold = np.asarray(attributes["nodes_values"], dtype = np.float64)[order]
+    true_keys = (tree_ids << 32) | np.asarray(attributes["nodes_truenodeids"], dtype = np.int64)[order]
+    false_keys = (tree_ids << 32) | np.asarray(attributes["nodes_falsenodeids"], dtype = np.int64)[order]
+    missing_true = np.asarray(attributes.get("nodes_missing_value_tracks_true", np.zeros(len(keys))), dtype = bool)
+    missing_true = missing_true[order] if len(missing_true) == len(keys) else np.zeros(len(keys), dtype = bool)
+    # BRANCH_NEQ is true for NaN, so NaN takes its true branch with or without the flag. No operator sends NaN to the true branch of BRANCH_EQ.
+    if np.any(missing_true & (modes == "BRANCH_EQ")):
+        raise ValueError("BRANCH_EQ nodes with nodes_missing_value_tracks_true are not supported, NaN can not follow their true branch.")
+    # Global index of the children, checked to be in the same tree.
+    left_node = np.searchsorted(keys, np.where(is_leaf, keys, true_keys))
+    right_node = np.searchsorted(keys, np.where(is_leaf, keys, false_keys))
+    if np.any(left_node >= len(keys)) or np.any(right_node >= len(keys)) or \
+        np.any(keys[np.minimum(left_node, len(keys) - 1)] != np.where(is_leaf, keys, true_keys)) or \
+        np.any(keys[np.minimum(right_node, len(keys) - 1)] != np.where(is_leaf, keys, false_keys)):
+        raise ValueError("Invalid ONNX model, a child node does not exist.")
+    # Leaf weights, summed per node and output.
+    weight_keys = (np.asarray(attributes[f"{prefix}_treeids"], dtype = np.int64) << 32) | np.asarray(attributes[f"{prefix}_nodeids"], dtype = np.int64)
+    weight_nodes = np.searchsorted(keys, weight_keys)
+    if np.any(weight_nodes >= len(keys)) or np.any(keys[np.minimum(weight_nodes, len(keys) - 1)] != weight_keys):
+        raise ValueError("Invalid ONNX model, a leaf weight refers to a node that does not exist.")
+    weight_outputs = np.asarray(attributes[f"{prefix}_ids"], dtype = np.int64)
+    weights = np.zeros((len(keys), weight_outputs.max(initial = 0) + 1))
+    np.add.at(weights, (weight_nodes, weight_outputs), np.asarray(attributes[f"{prefix}_weights"], dtype = np.float64))
+    has_weight = np.zeros(weights.shape, dtype = bool)
+    has_weight[weight_nodes, weight_outputs] = True
+
+    trees, leaf_weights, tree_outputs = [], [], []
+    bounds = np.concatenate([[0], np.flatnonzero(np.diff(tree_ids)) + 1, [len(keys)]])
+    for begin, end in zip(bounds[:-1], bounds[1:]):
+        tree_leaf = is_leaf[begin:end]
+        left, right = left_node[begin:end] - begin, right_node[begin:end] - begin
+        is_child = np.zeros(end - begin, dtype = bool)
+        is_child[left[~tree_leaf]] = True
+        is_child[right[~tree_leaf]] = True
+        roots = np.flatnonzero(~is_child)
+        if len(roots) != 1:
+            raise ValueError(f"Invalid ONNX model, tree {tree_ids[begin]} has {len(roots)} roots.")
+        # Permutation moving the root in 0.
+        permutation = np.concatenate([roots, np.delete(np.arange(end - begin), roots[0])])
+        position = np.empty(end - begin, dtype = np.int64)
+        position[permutation] = np.arange(end - begin)
+        index = begin + permutation
+        tree_operator, tree_left, tree_right = apply_missing_direction(operator[index], position[left[permutation]], position[right[permutation]], missing_true[index])
+        trees.append(build_tree_nodes(is_leaf[index], tree_operator, feature_index[index], threshold[index], tree_left, tree_right,
+                                        leaf_value = np.zeros(end - begin)))
+        leaf_weights.append(weights[index])
+        tree_outputs.append(np.flatnonzero(has_weight[index].any(axis = 0)))
+    return trees, leaf_weights, tree_outputs
+
+def onnx_parser(file_path, out_path, leaf_proba = False):
+    """
+    Converts an ONNX model containing an ai.onnx.ml TreeEnsembleClassifier or TreeEnsembleRegressor, whose nodes are already flat arrays.
+    - Classifiers without post transform are forests: leaves vote for the class with the highest weight, and their normalized weights 
+      are the leaf distributions. 
+    - Classifiers with the LOGISTIC or SOFTMAX post transform are boosted models, whose trees must contribute to a single class.
+    - Regressors with the AVERAGE aggregation are regression forests, with the base value folded in the leaves. 
+    - Regressors with the SUM aggregation are boosted models.
+    NaN follows the true branch of the nodes with nodes_missing_value_tracks_true, see apply_missing_direction, except for BRANCH_EQ nodes,
+    which are rejected.
+    onnx is only imported here, so that it is not required by the other formats.
+    """
+    import onnx
+    model = onnx.load(file_path)
+    ensembles = [node for node in model.graph.node if node.domain == "ai.onnx.ml" and node.op_type in ("TreeEnsembleClassifier", "TreeEnsembleRegressor")]
+    if len(ensembles) != 1:
+        raise ValueError("The ONNX model must contain exactly one TreeEnsembleClassifier or TreeEnsembleRegressor node.")
+    ensemble = ensembles[0]
+    attributes = get_onnx_attributes(ensemble)
+    is_classifier = ensemble.op_type == "TreeEnsembleClassifier"
+    trees, leaf_weights, tree_outputs = onnx_tree_ensemble_nodes(attributes, "class" if is_classifier else "target")
+    # Number of features from the input shape, or from the used features if it is dynamic.
+    dims = model.graph.input[0].type.tensor_type.shape.dim
+    num_features = dims[-1].dim_value if len(dims) > 0 and dims[-1].dim_value > 0 else int(np.max(attributes["nodes_featureids"], initial = 0)) + 1
+    post_transform = attributes.get("post_transform", "NONE")
+    base_values = np.asarray(attributes.get("base_values", []), dtype = np.float64)
+    print(f"ONNX {ensemble.op_type}: {len(trees)} trees, {num_features} features, post transform {post_transform}")
+
+    if is_classifier:
+        classes = attributes.get("classlabels_int64s", attributes.get("classlabels_strings"))
+        if np.issubdtype(classes.dtype, np.integer) and np.array_equal(classes, np.arange(len(classes))):
+            class_map = classes.astype(np.int16)
+        else:
+            class_map = np.arange(len(classes), dtype = np.int16)
+            print("Classes are written as their index: ", dict(enumerate(classes.tolist())))
+        num_classes = len(classes)
+        if post_transform == "NONE":
+            if np.any(base_values != 0) or any(len(outputs) != num_classes for outputs in tree_outputs):
+                raise ValueError("Classifiers without post transform must have the weights of every class in their leaves, and no base values.")
+            leaf_proba_matrices = []
+            for idx, (nodes, matrix) in enumerate(zip(trees, leaf_weights)):
+                leaves = nodes["left_node"] == -1
+                nodes["class_res"][leaves] = class_map[np.argmax(matrix[leaves], axis = 1)]
+                totals = matrix.sum(axis = 1, keepdims = True)
+                leaf_proba_matrices.append(np.where(leaves[:, None], matrix / np.where(totals > 0, totals, 1), 0))
+            trailer = ConfigTrailer(num_classes, num_features, len(trees))
+            write_bin(trailer, trees, out_path, leaf_proba, leaf_proba_matrices = leaf_proba_matrices)
+            return
+        if post_transform not in ("LOGISTIC", "SOFTMAX"):
+            raise ValueError(f"Unsupported post transform {post_transform}.")
+        if any(len(outputs) != 1 for outputs in tree_outputs):
+            raise ValueError("Boosted classifiers must have trees contributing to a single class.")
+        outputs = np.array([outputs[0] for outputs in tree_outputs])
+        # Binary models add the margin of the positive class only.
+        num_outputs = 1 if num_classes == 2 and len(np.unique(outputs)) == 1 else num_classes
+        base_scores = [base_values[outputs[0]] if len(base_values) > outputs[0] else 0.0] if num_outputs == 1 else \
+                        (base_values.tolist() if len(base_values) == num_classes else [0.0] * num_classes)
+        boosting = BoostingConfig("sigmoid" if post_transform == "LOGISTIC" else "softmax", base_scores, outputs.tolist() if num_outputs > 1 else [0] * len(trees))
+    else:
+        if int(attributes.get("n_targets", 1)) != 1:
+            raise ValueError("Multi-target ONNX regressors are not supported.")
+        if post_transform != "NONE":
+            raise ValueError(f"Unsupported post transform {post_transform} for a regressor.")
+        num_classes = 0
+        base_value = base_values[0] if len(base_values) > 0 else 0.0
+        aggregate_function = attributes.get("aggregate_function", "SUM")
+        if aggregate_function == "AVERAGE":
+            for nodes, matrix in zip(trees, leaf_weights):
+                leaves = nodes["left_node"] == -1
+                nodes["threshold"][leaves] = matrix[leaves, 0] + base_value
+            trailer = ConfigTrailer(num_classes, num_features, len(trees))
+            write_bin(trailer, trees, out_path)
+            return
+        if aggregate_function != "SUM":
+            raise ValueError(f"Unsupported aggregate function {aggregate_function}.")
+        outputs = np.zeros(len(trees), dtype = np.int64)
+        boosting = BoostingConfig("raw", [base_value], [0] * len(trees))
+    for nodes, matrix, output in zip(trees, leaf_weights, outputs):
+        leaves = nodes["left_node"] == -1
+        nodes["threshold"][leaves] = matrix[leaves, output]
+    trailer = ConfigTrailer(num_classes, num_features, len(trees))
+    write_bin(trailer, trees, out_path, boosting = boosting)
+
+def write_leaf_proba_section(out_file, trailer, trees, leaf_proba_matrices = None):
+    """
+    Writes the BIN_SECTION_LEAF_PROBA section: for each tree, a [number_of_nodes x num_classes] float matrix
+    whose rows are the class distributions of the leaves, or zeros for the internal nodes.
+    Trees without a matrix get the one-hot distribution of the class of their leaves.
+    The size of the section is known from the trees, so matrices are written one at a time after the header.
+    """
+    if leaf_proba_matrices is None:
+        leaf_proba_matrices = [None] * len(trees)
+    section_size = sum(len(tree) for tree in trees) * trailer.num_classes * ctypes.sizeof(ctypes.c_float)
+    out_file.write(bytearray(SectionHeader(sections_map["leaf_proba"], 0, section_size)))
+    for tree, matrix in zip(trees, leaf_proba_matrices):
+        if matrix is None:
+            matrix = np.zeros((len(tree), trailer.num_classes), dtype = np.float32)
+            leaves = np.flatnonzero((tree["left_node"] == -1) & (tree["right_node"] == -1))
+            matrix[leaves, tree["class_res"][leaves]] = 1.0
+        out_file.write(np.ascontiguousarray(matrix, dtype = np.float32))
+
+def get_boosting_section(boosting):
+    """
+    Serializes the BIN_SECTION_BOOSTING section: the header, the base scores (with the feature type of the nodes) and the output of each tree.
+    """
+    feature_ctype = dict(TreeNode._fields_)["threshold"]
+    section = bytearray(BoostingHeader(boosting_objectives_map[boosting.objective], len(boosting.base_scores)))
+    section += bytearray((feature_ctype * len(boosting.base_scores))(*boosting.base_scores))
+    section += bytearray((ctypes.c_uint16 * len(boosting.tree_outputs))(*boosting.tree_outputs))
+    header = SectionHeader(sections_map["boosting"], 0, len(section))
+    return bytearray(header) + section
+
+def write_bin(trailer, trees, out_path, leaf_proba = False, boosting = None, leaf_proba_matrices = None):
+    """
+    Streams the binary configuration to out_path: the trailer, the section of each tree and the optional sections.
+    Trees are the structured arrays of build_tree_nodes, so each one is serialized with a single copy and the export time is linear
+    in the number of nodes.
+
+    Parameters:
+        trailer (ConfigTrailer): Trailer of the model, num_trees must be the number of trees.
+        trees (list): Structured arrays of the nodes of each tree.
+        leaf_proba (bool): Append the BIN_SECTION_LEAF_PROBA section.
+        boosting (BoostingConfig): Append the BIN_SECTION_BOOSTING section, None for forests.
+        leaf_proba_matrices (list): Leaf distributions of each tree, see write_leaf_proba_section.
+    """
+    if len(trees) > 0xFFFF:
+        raise ValueError("Models with more than 65535 trees are not supported.")
+    if trailer.num_trees != len(trees):
+        raise ValueError(f"The trailer declares {trailer.num_trees} trees, {len(trees)} provided.")
+    with open(out_path, "wb") as out_file:
+        out_file.write(bytearray(trailer))
+        for tree in trees:
+            write_tree(out_file, tree)
+        if leaf_proba:
+            write_leaf_proba_section(out_file, trailer, trees, leaf_proba_matrices)
+        if boosting is not None:
+            out_file.write(get_boosting_section(boosting))
+        print(f"Binary file written, {len(trees)} trees, {sum(len(tree) for tree in trees)} nodes, written size {out_file.tell()}")
+
+def read_bin(in_path):
+    """
+    Reads a binary configuration written by write_bin, with the feature type set in TreeNode.
+
+    Returns:
+        tuple: The ConfigTrailer, the list of the structured arrays of the trees, the list of their leaf distributions 
+               (None without the BIN_SECTION_LEAF_PROBA section) and the BoostingConfig (None without the BIN_SECTION_BOOSTING section).
+    """
+    data = np.fromfile(in_path, dtype = np.uint8)
+    node_dtype = get_node_dtype()
+    trailer = ConfigTrailer.from_buffer_copy(data, 0)
+    offset = ctypes.sizeof(ConfigTrailer)
     trees = []
-    segmentation = root.find("pmml:MiningModel/pmml:Segmentation", namespaces)
-    if segmentation is not None:  # If the model has a segmentation it consists of multiple trees  
-        print("Segmentation found")
-        for tree_id, segment in enumerate(segmentation.findall("pmml:Segment", namespaces)):
-            tree_model_root = segment.find("pmml:TreeModel", namespaces).find("pmml:Node", namespaces)
-            trailer.num_trees += 1
-            print(f"Tree found Id {tree_id}")
-            tree = get_tree_model_from_pmml(namespaces, tree_model_root, model_features, 0)
-            trees.append(tree)
-            #print_tree(tree)
+    for _ in range(trailer.num_trees):
+        num_nodes = int(np.frombuffer(data, dtype = np.uint16, count = 1, offset = offset)[0])
+        offset += ctypes.sizeof(ctypes.c_uint16)
+        trees.append(np.frombuffer(data, dtype = node_dtype, count = num_nodes, offset = offset).copy())
+        offset += num_nodes * node_dtype.itemsize
+    leaf_proba_matrices, boosting = None, None
+    while offset < len(data):
+        header = SectionHeader.from_buffer_copy(data, offset)
+        offset += ctypes.sizeof(SectionHeader)
+        if header.section_id == sections_map["leaf_proba"]:
+            values = np.frombuffer(data, dtype = np.float32, count = header.section_size // 4, offset = offset)
+            bounds = np.cumsum([0] + [len(tree) * trailer.num_classes for tree in trees])
+            leaf_proba_matrices = [values[b:e].reshape(-1, trailer.num_classes).copy() for b, e in zip(bounds[:-1], bounds[1:])]
+        elif header.section_id == sections_map["boosting"]:
+            boosting_header = BoostingHeader.from_buffer_copy(data, offset)
+            feature_dtype = node_dtype["threshold"]
+            base_offset = offset + ctypes.sizeof(BoostingHeader)
+            base_scores = np.frombuffer(data, dtype = feature_dtype, count = boosting_header.num_outputs, offset = base_offset)
+            tree_outputs = np.frombuffer(data, dtype = np.uint16, count = trailer.num_trees, offset = base_offset + base_scores.nbytes)
+            objective = {value: key for key, value in boosting_objectives_map.items()}[boosting_header.objective]
+            boosting = BoostingConfig(objective, base_scores.tolist(), tree_outputs.tolist())
+        else:
+            raise ValueError(f"Unknown section {header.section_id}.")
+        offset += header.section_size
+    return trailer, trees, leaf_proba_matrices, boosting
+
+def read_test_bin(in_path):
+    """ Maps a binary dataset written by gen_test_bin, returning the [num_samples x num_features] features and the labels (None if absent). """
+    header = DatasetHeader.from_buffer_copy(np.fromfile(in_path, dtype = np.uint8, count = ctypes.sizeof(DatasetHeader)))
+    if header.magic != DATASET_MAGIC or header.version != DATASET_VERSION:
+        raise ValueError(f"{in_path} is not a binary dataset.")
+    feature_dtype = np.float32 if header.feature_size == 4 else np.float64
+    features = np.memmap(in_path, dtype = feature_dtype, mode = "r", offset = header.features_offset, shape = (header.num_samples, header.num_features))
+    labels = np.memmap(in_path, dtype = np.int16, mode = "r", offset = header.labels_offset, shape = (header.num_samples,)) if header.labels_offset else None
+    return features, labels
+
+def post_order(nodes):
+    """
+    Yields the nodes reachable from the root of a tree, or of a tree whose subtrees are shared (see optimize_tree), in post-order and once each.
+    It uses an explicit stack, so that deep trees do not hit the recursion limit, and raises ValueError on cycles and on invalid children.
+    """
+    left, right = nodes["left_node"].tolist(), nodes["right_node"].tolist()
+    state = bytearray(len(left)) # 0 not visited, 1 on the path from the root, 2 yielded.
+    stack = [0] if len(left) > 0 else []
+    while stack:
+        node = stack[-1]
+        if state[node] == 2:
+            stack.pop()
+            continue
+        children = [child for child in (right[node], left[node]) if child != -1]
+        if len(children) == 1 or any(not 0 <= child < len(left) for child in children):
+            raise ValueError(f"Node {node} has invalid children.")
+        pending = [child for child in children if state[child] != 2]
+        if pending:
+            if state[node] == 1:
+                raise ValueError(f"Node {node} is part of a cycle.")
+            state[node] = 1
+            stack.extend(pending)
+            continue
+        state[node] = 2
+        stack.pop()
+        yield node
+
+def tree_paths(nodes):
+    """ Returns the number of root-to-leaf paths of a tree, their average length (i.e. internal nodes visited) and the maximum one. """
+    left, right = nodes["left_node"].tolist(), nodes["right_node"].tolist()
+    paths, total, depth = [0] * len(left), [0] * len(left), [0] * len(left)
+    for node in post_order(nodes):
+        if left[node] == -1:
+            paths[node] = 1
+            continue
+        l, r = left[node], right[node]
+        paths[node] = paths[l] + paths[r]
+        total[node] = total[l] + paths[l] + total[r] + paths[r]
+        depth[node] = 1 + max(depth[l], depth[r])
+    return paths[0], total[0] / paths[0], depth[0]
+
+def optimize_tree(nodes, leaf_proba = None):
+    """
+    Lossless optimization of a tree. Visiting it bottom-up, splits whose children are identical are replaced by their child, so that
+    the paths crossing them are one node shorter, and identical subtrees are hash-consed, i.e. stored once and shared by all their parents.
+    Nodes are identical if they have the same operator, feature, class, threshold bits (the value of the leaves of regression and boosted
+    trees), children and, when given, leaf distribution, so every sample still reaches a leaf with the same outcome.
+    Children are indexes relative to the root, so a node can have several parents and the visiting functions read the result unmodified.
+    Nodes are renumbered in pre-order, so that the left child follows its parent.
+
+    Returns:
+        tuple: The nodes, their leaf distributions (None if not given), the number of collapsed splits and the number of shared nodes.
+    """
+    bits = nodes["threshold"].view(np.uint32 if nodes.dtype["threshold"].itemsize == 4 else np.uint64)
+    fields = list(zip(nodes["operator"].tolist(), nodes["feature_index"].tolist(), nodes["class_res"].tolist(), bits.tolist()))
+    left, right = nodes["left_node"].tolist(), nodes["right_node"].tolist()
+    canon = [-1] * len(nodes)
+    table, sources, children = {}, [], []
+    collapsed, shared = 0, 0
+    for node in post_order(nodes):
+        if left[node] == -1:
+            key = fields[node] + (-1, -1, leaf_proba[node].tobytes() if leaf_proba is not None else None)
+        else:
+            l, r = canon[left[node]], canon[right[node]]
+            if l == r:
+                canon[node] = l
+                collapsed += 1
+                continue
+            key = fields[node] + (l, r)
+        canon[node] = table.get(key, -1)
+        if canon[node] != -1:
+            shared += 1
+            continue
+        canon[node] = table[key] = len(sources)
+        sources.append(node)
+        children.append(key[4:6])
+    # Pre-order renumbering of the canonical nodes.
+    position = np.full(len(sources) + 1, -1, dtype = np.int64) # The last entry maps the -1 children of the leaves on -1.
+    order = []
+    stack = [canon[0]]
+    while stack:
+        node = stack.pop()
+        if position[node] != -1:
+            continue
+        position[node] = len(order)
+        order.append(node)
+        if children[node][0] != -1:
+            stack.extend((children[node][1], children[node][0]))
+    order = np.asarray(order, dtype = np.int64)
+    source = np.asarray(sources, dtype = np.int64)[order]
+    links = np.asarray(children, dtype = np.int64).reshape(-1, 2)[order]
+    optimized = nodes[source]
+    optimized["left_node"] = position[links[:, 0]]
+    optimized["right_node"] = position[links[:, 1]]
+    return optimized, leaf_proba[source] if leaf_proba is not None else None, collapsed, shared
+
+def optimize_bin(in_path, out_path):
+    """
+    Applies optimize_tree to all the trees of a binary configuration, keeping its sections, and prints the node and path savings.
+    The leaf distributions take part in the comparison of the leaves, so class probabilities do not change either.
+
+    Returns:
+        dict: Number of nodes, average and maximum path length before and after the optimization, collapsed splits and shared nodes.
+    """
+    trailer, trees, leaf_proba_matrices, boosting = read_bin(in_path)
+    matrices = leaf_proba_matrices or [None] * len(trees)
+    report = {"nodes_before": 0, "nodes_after": 0, "collapsed_splits": 0, "shared_nodes": 0}
+    paths_before, paths_after, optimized, optimized_matrices = [], [], [], []
+    for tree, matrix in zip(trees, matrices):
+        paths_before.append(tree_paths(tree))
+        nodes, matrix, collapsed, shared = optimize_tree(tree, matrix)
+        paths_after.append(tree_paths(nodes))
+        optimized.append(nodes)
+        optimized_matrices.append(matrix)
+        report["nodes_before"] += len(tree)
+        report["nodes_after"] += len(nodes)
+        report["collapsed_splits"] += collapsed
+        report["shared_nodes"] += shared
+    for name, paths in (("before", paths_before), ("after", paths_after)):
+        report[f"avg_path_{name}"] = sum(count * length for count, length, _ in paths) / sum(count for count, _, _ in paths)
+        report[f"max_path_{name}"] = max(depth for _, _, depth in paths)
+    write_bin(trailer, optimized, out_path, leaf_proba_matrices is not None, boosting, optimized_matrices)
+    print(f"Nodes: {report['nodes_before']} -> {report['nodes_after']} ({report['collapsed_splits']} collapsed splits, {report['shared_nodes']} shared nodes)")
+    print(f"Average path: {report['avg_path_before']:.3f} -> {report['avg_path_after']:.3f}, maximum path: {report['max_path_before']} -> {report['max_path_after']}")
+    return report
+
+""" Distributions of the number of nodes of the trees of synthetic_forest, see tree_sizes. """
+node_distributions = ("fixed", "uniform", "lognormal")
+
+def parse_size(value):
+    """ Parses a size in bytes with an optional K, M or G (powers of 1024) suffix. """
+    units = {"K": 1 << 10, "M": 1 << 20, "G": 1 << 30}
+    value = value.strip().upper().rstrip("B")
+    if value and value[-1] in units:
+        return int(float(value[:-1]) * units[value[-1]])
+    return int(value)
+
+def tree_sizes(num_trees, nodes_per_tree, distribution, rng):
+    """
+    Draws the target number of nodes of each tree: nodes_per_tree for all of them (fixed), uniform in [1, 2 * nodes_per_tree] (uniform),
+    or lognormal with mean nodes_per_tree and sigma 1 (lognormal), i.e. a few large trees and many small ones.
+    Sizes are clipped to [1, 65535] and made odd, as full binary trees have an odd number of nodes.
+    """
+    if distribution == "fixed":
+        sizes = np.full(num_trees, nodes_per_tree, dtype = np.float64)
+    elif distribution == "uniform":
+        sizes = rng.uniform(1, 2 * nodes_per_tree, num_trees)
+    elif distribution == "lognormal":
+        sizes = rng.lognormal(math.log(nodes_per_tree) - 0.5, 1.0, num_trees)
     else:
-        print("No segmentation found")
-        trailer.num_trees += 1
-        trees.append(get_tree_model_from_pmml(namespaces, tree_model_root, model_features, 0))
-    
-    write_bin(trailer, trees, out_path)
-    # trailer_bytes = bytearray(trailer)
-    # with open(out_path, "wb") as out_file:
-    #     out_file.write(trailer_bytes)
-    #     print("Trailer written")
-
-
-def joblib_parser(file_path):
-    print("Not implemented yet")
-    exit(1)
-
-def write_bin(trailer, trees, out_file):
-    final_bin = bytearray(trailer)
-    print("Written trailer of size: ", len(final_bin))
-    for idx, tree in enumerate(trees):
-        print(f"[Tree-ID: {idx}] Writing with number of nodes: ", len(tree))
-        # Append the tree node size.
-        final_bin += (bytearray(ctypes.c_uint16(len(tree))))
-        print(f"[Tree-ID: {idx}] Size of the trailer with Number-Nodes: ", len(final_bin))
-        for node in tree:
-            final_bin += bytearray(node.tree_node_struct)
-        print(f"[Tree-ID: {idx}] Size of the trailer with Tree: ", len(final_bin))
-    
-    with open(out_file, "wb") as out_file:
-        out_file.write(final_bin)
-        print(f"Binary file written, written size {len(final_bin)}")
+        raise ValueError(f"Unknown node distribution {distribution}, it must be in {node_distributions}.")
+    sizes = np.clip(np.rint(sizes), 1, 0xFFFF).astype(np.int64)
+    return sizes - (sizes + 1) % 2
+
+def synthetic_tree(num_nodes, max_depth, balance, num_features, num_classes, rng):
+    """
+    Grows a tree level by level until it has num_nodes nodes, or until max_depth is reached. At each level a fraction balance of the
+    leaves of the last level (at least one) is split: 1 grows complete trees, values close to 0 grow chains of depth max_depth.
+    Splits are lessOrEqual on a random feature with a threshold uniform in [0, 1), the range of the samples of synthetic_dataset, so that
+    every split sends about half of the samples to each side. Leaves get a random class, or a normal value if num_classes is 0 (regression).
+    Nodes are stored in breadth-first order.
+    """
+    left_node = np.full(num_nodes, -1, dtype = np.int64)
+    right_node = np.full(num_nodes, -1, dtype = np.int64)
+    frontier = np.zeros(1, dtype = np.int64)
+    count, depth, remaining = 1, 0, (num_nodes - 1) // 2
+    while remaining > 0 and depth < max_depth:
+        splits = min(remaining, len(frontier), max(1, int(len(frontier) * balance + 0.5)))
+        parents = frontier if splits == len(frontier) else np.sort(rng.choice(frontier, splits, replace = False))
+        children = count + np.arange(2 * splits, dtype = np.int64)
+        left_node[parents] = children[0::2]
+        right_node[parents] = children[1::2]
+        frontier = children
+        count += 2 * splits
+        remaining -= splits
+        depth += 1
+    left_node, right_node = left_node[:count], right_node[:count]
+    is_leaf = left_node == -1
+    operator = np.full(count, operators_map["lessOrEqual"])
+    feature_index = rng.integers(0, num_features, count)
+    threshold = rng.random(count)
+    if num_classes > 0:
+        return build_tree_nodes(is_leaf, operator, feature_index, threshold, left_node, right_node, class_res = rng.integers(0, num_classes, count))
+    return build_tree_nodes(is_leaf, operator, feature_index, threshold, left_node, right_node, leaf_value = rng.standard_normal(count))
 
-def parse(model_source : str, out_path: str):
+def synthetic_leaf_proba(nodes, num_classes, rng):
+    """
+    Draws a Dirichlet class distribution for each leaf (zeros for the internal nodes), and sets the class of the leaves to the most probable one,
+    so that majority voting and class probabilities agree as in trained forests.
+    """
+    matrix = np.zeros((len(nodes), num_classes), dtype = np.float32)
+    leaves = np.flatnonzero(nodes["left_node"] == -1)
+    matrix[leaves] = rng.dirichlet(np.ones(num_classes), len(leaves))
+    nodes["class_res"][leaves] = np.argmax(matrix[leaves], axis = 1)
+    return matrix
+
+def synthetic_forest(num_nodes, num_trees, num_features, num_classes, seed = 0, distribution = "fixed", max_depth = 32, balance = 1.0, leaf_proba = False):
+    """
+    Generates the trees of a random forest with about num_nodes nodes in total, one at a time, so that forests of several GB are never held in memory.
+    The number of nodes of each tree follows distribution (see tree_sizes) with mean num_nodes / num_trees, and trees are shaped by max_depth
+    and balance (see synthetic_tree): the defaults grow complete trees. num_classes 0 generates a regression forest.
+
+    Yields:
+        tuple: The structured array of the nodes of a tree and its leaf distributions (see synthetic_leaf_proba), None without leaf_proba.
+    """
+    nodes_per_tree = num_nodes // max(1, num_trees)
+    if num_trees < 1 or num_trees > 0xFFFF or nodes_per_tree < 1 or nodes_per_tree > 0xFFFF:
+        raise ValueError(f"Forests must have between 1 and 65535 trees of 1 to 65535 nodes, {num_trees} trees of {nodes_per_tree} nodes requested.")
+    if num_features < 1 or num_features > 0xFFFF or num_classes < 0 or num_classes > 0x7FFF:
+        raise ValueError("Forests must have between 1 and 65535 features, and at most 32767 classes.")
+    if leaf_proba and num_classes == 0:
+        raise ValueError("Regression forests have no leaf distributions.")
+    rng = np.random.default_rng(seed)
+    for size in tree_sizes(num_trees, nodes_per_tree, distribution, rng):
+        nodes = synthetic_tree(int(size), max_depth, balance, num_features, num_classes, rng)
+        yield nodes, synthetic_leaf_proba(nodes, num_classes, rng) if leaf_proba else None
+
+def synthetic_num_trees(target_size, nodes_per_tree, max_depth, num_classes, leaf_proba):
+    """
+    Estimates the number of trees of nodes_per_tree nodes (at most a complete tree of depth max_depth) giving a binary of target_size bytes.
+    Raises a ValueError if the binary would need more than 65535 trees.
+    """
+    tree_nodes = min(nodes_per_tree, (2 << min(max_depth, 16)) - 1)
+    tree_bytes = ctypes.sizeof(ctypes.c_uint16) + tree_nodes * (get_node_dtype().itemsize + ctypes.sizeof(ctypes.c_float) * leaf_proba * num_classes)
+    num_trees = max(1, round(target_size / tree_bytes))
+    if num_trees > 0xFFFF:
+        raise ValueError(f"A binary of {target_size} bytes needs {num_trees} trees of {tree_nodes} nodes, more than 65535: increase the nodes per tree.")
+    return num_trees
+
+def synthetic_forest_bin(out_path, num_nodes, num_trees, num_features = 32, num_classes = 8, seed = 0, distribution = "fixed", max_depth = 32,
+                         balance = 1.0, leaf_proba = False):
+    """
+    Writes a binary configuration of the trees of synthetic_forest, one at a time, buffering the leaf distributions in a temporary file.
+
+    Returns:
+        dict: Number of trees, nodes and leaves, and size of the binary in bytes.
+    """
+    report = {"trees": num_trees, "nodes": 0, "leaves": 0}
+    with open(out_path, "wb") as out_file, tempfile.TemporaryFile() as proba_file:
+        out_file.write(bytearray(ConfigTrailer(num_classes, num_features, num_trees)))
+        for nodes, matrix in synthetic_forest(num_nodes, num_trees, num_features, num_classes, seed, distribution, max_depth, balance, leaf_proba):
+            if leaf_proba:
+                proba_file.write(matrix)
+            write_tree(out_file, nodes)
+            report["nodes"] += len(nodes)
+            report["leaves"] += int(np.count_nonzero(nodes["left_node"] == -1))
+        if leaf_proba:
+            section_size = report["nodes"] * num_classes * ctypes.sizeof(ctypes.c_float)
+            if section_size > 0xFFFFFFFF:
+                raise ValueError("The leaf distributions exceed the 4 GB of a section, reduce the forest or the number of classes.")
+            out_file.write(bytearray(SectionHeader(sections_map["leaf_proba"], 0, section_size)))
+            proba_file.seek(0)
+            shutil.copyfileobj(proba_file, out_file)
+        report["size"] = out_file.tell()
+    return report
+
+def synthetic_dataset(out_path, num_samples, num_features, feature_type, seed = 0, chunk_size = 65536):
+    """
+    Writes a binary dataset (see gen_test_bin) of num_samples rows uniform in [0, 1), the range of the thresholds of synthetic_tree,
+    streamed in chunks of chunk_size rows. The dataset has no labels.
+    """
+    feature_dtype = np.float32 if feature_type == "float" else np.float64
+    rng = np.random.default_rng(seed)
+    header = DatasetHeader(DATASET_MAGIC, DATASET_VERSION, np.dtype(feature_dtype).itemsize, num_samples, num_features)
+    with open(out_path, "wb") as out_file:
+        out_file.write(bytearray(header))
+        header.features_offset = write_padding(out_file, DATASET_ALIGNMENT)
+        for begin in range(0, num_samples, chunk_size):
+            out_file.write(rng.random((min(chunk_size, num_samples - begin), num_features), dtype = feature_dtype))
+        out_file.seek(0)
+        out_file.write(bytearray(header))
+
+def bench_write_bin(out_path, num_nodes, num_trees, leaf_proba = False, repetitions = 3):
+    """
+    Benchmarks write_bin on a synthetic forest of num_nodes nodes, and on its halves and quarters to check that time scales linearly.
+    The best time of the repetitions is reported.
+    """
+    num_features, num_classes = 16, 8
+    trees = [nodes for nodes, _ in synthetic_forest(num_nodes, num_trees, num_features, num_classes)]
+    for fraction in (4, 2, 1):
+        subset = trees[:max(1, len(trees) // fraction)]
+        trailer = ConfigTrailer(num_classes, num_features, len(subset))
+        best = float("inf")
+        for _ in range(repetitions):
+            start = time.perf_counter()
+            write_bin(trailer, subset, out_path, leaf_proba)
+            best = min(best, time.perf_counter() - start)
+        subset_nodes = sum(len(tree) for tree in subset)
+        print(f"{len(subset)} trees, {subset_nodes} nodes: {best * 1e3:.1f} ms, {subset_nodes / best / 1e6:.2f} M nodes/s")
+
+def parse(model_source : str, out_path: str, leaf_proba : bool = False, jobs : int = None, optimize : bool = False):
         if model_source.endswith(".pmml"):
-            pmml_parser(model_source, out_path)
+            pmml_parser(model_source, out_path, leaf_proba, jobs)
         elif model_source.endswith(".joblib"):
-            joblib_parser(model_source)
+            joblib_parser(model_source, out_path, leaf_proba)
+        elif model_source.endswith(".json"):
+            json_parser(model_source, out_path)
+        elif model_source.endswith(".txt"):
+            lightgbm_text_parser(model_source, out_path)
+        elif model_source.endswith(".onnx"):
+            onnx_parser(model_source, out_path, leaf_proba)
+        if optimize:
+            optimize_bin(out_path, out_path)
 
 """ Generate a c module that contains a number_of_inputs, taken to X_test to the module.
     X_test : Set of possible inputs.
@@ -332,17 +1415,110 @@ def gen_test_vec(model_source, dataset_source, target_column, feature_type, out_
     render_module_test_header(inputs, dataset_outs, feature_type, out_path)   
     print(f"Test vectors generated in: {out_path}")
 
+def cpp_literal(value, feature_type):
+    """ Exact C++ literal of a threshold, hexadecimal so that no rounding happens in the conversion. """
+    if math.isnan(value):
+        return "std::numeric_limits<feature_type>::quiet_NaN()"
+    if math.isinf(value):
+        return f"{'-' if value < 0 else ''}std::numeric_limits<feature_type>::infinity()"
+    return float(value).hex() + ("f" if feature_type == "float" else "")
+
+def gen_cpp(in_path, feature_type, out_path, namespace = None):
+    """
+    Renders a binary configuration as a C++ header of constexpr node tables, evaluated by dtc::embedded_forest of src/dtc.hpp.
+    Boosted models are not supported, the leaf distributions are not embedded.
+    """
+    trailer, trees, _, boosting = read_bin(in_path)
+    if boosting is not None:
+        raise ValueError("Boosted models can not be embedded.")
+    namespace = namespace or re.sub(r"\W", "_", os.path.splitext(os.path.basename(out_path))[0])
+    rendered_trees = [[{"operation": int(node["operator"]), "feature_index": int(node["feature_index"]), "class_result": int(node["class_res"]),
+                        "left_node": int(node["left_node"]), "right_node": int(node["right_node"]),
+                        "threshold": cpp_literal(node["threshold"], feature_type)} for node in tree] for tree in trees]
+    env = Environment(loader = FileSystemLoader(searchpath = os.path.dirname(os.path.abspath(__file__))))
+    header = env.get_template("forest.hpp.template").render(
+                                    file_name       = os.path.basename(out_path),
+                                    source          = os.path.basename(in_path),
+                                    guard           = re.sub(r"\W", "_", os.path.basename(out_path)).upper(),
+                                    namespace       = namespace,
+                                    feature_type    = feature_type,
+                                    num_classes     = trailer.num_classes,
+                                    num_features    = trailer.num_features,
+                                    num_trees       = trailer.num_trees,
+                                    num_nodes       = sum(len(tree) for tree in trees),
+                                    trees           = rendered_trees,
+                                    )
+    with open(out_path, "w") as out_file:
+        out_file.write(header)
+    print(f"Embedded forest written in {out_path}: {trailer.num_trees} trees, namespace {namespace}")
+
+def write_padding(out_file, alignment):
+    """ Pads the file with zeros up to the next multiple of alignment, returning the new offset. """
+    out_file.write(bytes(-out_file.tell() % alignment))
+    return out_file.tell()
+
+def gen_test_bin(dataset_source, target_column, feature_type, out_path, csv_separator = ";", chunk_size = 65536):
+    """
+    Writes the dataset in the binary format read by load_tree_dataset (tree_dataset.c): a DatasetHeader, the row-major feature matrix
+    with the feature type of the C code, and the int16 label of each sample, both aligned to DATASET_ALIGNMENT bytes.
+    The csv is streamed in chunks of chunk_size rows, so that datasets with millions of rows are never fully loaded. The labels, which
+    follow the features, are buffered in a temporary file and the header is patched at the end.
+    """
+    feature_dtype = np.float32 if feature_type == "float" else np.float64
+    header = DatasetHeader(DATASET_MAGIC, DATASET_VERSION, np.dtype(feature_dtype).itemsize, 0, 0)
+    if ctypes.sizeof(header) != DATASET_ALIGNMENT:
+        raise ValueError("Invalid dataset header size.")
+    with open(out_path, "wb") as out_file, tempfile.TemporaryFile() as labels_file:
+        out_file.write(bytearray(header))
+        header.features_offset = write_padding(out_file, DATASET_ALIGNMENT)
+        for chunk in pd.read_csv(dataset_source, sep = csv_separator, chunksize = chunk_size):
+            labels = chunk[target_column].to_numpy()
+            features = chunk.drop(columns = [target_column]).to_numpy(dtype = feature_dtype)
+            if header.num_features == 0:
+                if features.shape[1] > 0xFFFF:
+                    raise ValueError("Datasets with more than 65535 features are not supported.")
+                header.num_features = features.shape[1]
+            if not np.all(np.mod(labels, 1) == 0) or np.any(np.abs(labels) > 0x7FFF):
+                raise ValueError("Labels must be integers in the range of class_t (int16).")
+            out_file.write(np.ascontiguousarray(features))
+            labels_file.write(labels.astype(np.int16).tobytes())
+            header.num_samples += len(chunk)
+        header.labels_offset = write_padding(out_file, DATASET_ALIGNMENT)
+        labels_file.seek(0)
+        shutil.copyfileobj(labels_file, out_file)
+        out_file.seek(0)
+        out_file.write(bytearray(header))
+    print(f"Binary dataset written in {out_path}: {header.num_samples} samples, {header.num_features} {feature_type} features")
 
 if __name__ == "__main__":
-    parser = argparse.ArgumentParser(description="Process and print NodeConfig data from a file.")
+    parser = argparse.ArgumentParser(description="Converts tree based models in the binary configuration of the DTC library.")
     parser.add_argument("command", type=str, help="The command to execute.")
     parser.add_argument("--feature_type",  type=str, help="Type of the feature in use.", default =  "float")
-    parser.add_argument("--input_model",  type=str, help="Path to the PMML or joblib files containing the model to serialize.", default =  "../datasets/statlog_segment/rf_5/rf_5.pmml")
+    parser.add_argument("--input_model",  type=str, help="Path to the PMML, joblib, ONNX, XGBoost/LightGBM JSON or LightGBM text files containing the model to serialize.", default =  "../datasets/statlog_segment/rf_5/rf_5.pmml")
     parser.add_argument("--output_bin",   type=str, help="Path to the output file to write the binary file.", default = "../examples/desktop/dtc_parse/statlog_rf5.bin")
     parser.add_argument("--input_dataset",  type=str, help="Path of the input dataset to parse", default =  "../datasets/statlog_segment/rf_5/test_dataset.csv")
     parser.add_argument("--output_test_vec",  type=str, help="Path to the output header containing the classification inputs and their outcomes", default = "../examples/desktop/inference_accuracy/model_test.h")
+    parser.add_argument("--output_test_bin",  type=str, help="Path to the output binary dataset containing the classification inputs and their outcomes", default = "../examples/desktop/dataset_accuracy/test_dataset.dtcd")
     parser.add_argument("--target_column",  type=str, help="Name of the target column of the input dataset", default = "Outcome")
+    parser.add_argument("--leaf_proba",  action="store_true", help="Append the class distribution of the leaves to the output binary.")
     parser.add_argument("--csv_separator",  type=str, help="Separator of the csv file of the dataset", default = ";")
+    parser.add_argument("--jobs",  type=int, help="Number of processes converting the trees of a PMML model, all the cores by default.", default = None)
+    parser.add_argument("--optimize",  action="store_true", help="Apply the lossless optimization of the optimize command to the output binary.")
+    parser.add_argument("--input_bin",  type=str, help="Path of the binary configuration to optimize.", default = None)
+    parser.add_argument("--num_nodes",  type=int, help="Number of nodes of the synthetic forest of bench_write_bin and synthetic.", default = 1000000)
+    parser.add_argument("--output_cpp",  type=str, help="Path to the output C++ header of the embedded forest of gen_cpp.", default = None)
+    parser.add_argument("--namespace",  type=str, help="Namespace of the embedded forest of gen_cpp, the name of the header by default.", default = None)
+    parser.add_argument("--num_trees",  type=int, help="Number of trees of the synthetic forest of bench_write_bin and synthetic.", default = 100)
+    parser.add_argument("--nodes_per_tree",  type=int, help="Mean number of nodes of a tree of synthetic, overriding num_nodes.", default = None)
+    parser.add_argument("--target_size",  type=str, help="Approximate size of the binary of synthetic (e.g. 10K, 64M, 4G), overriding num_trees.", default = None)
+    parser.add_argument("--node_distribution",  type=str, help=f"Distribution of the number of nodes of the trees of synthetic, in {node_distributions}.", default = "fixed")
+    parser.add_argument("--max_depth",  type=int, help="Maximum depth of the trees of synthetic.", default = 32)
+    parser.add_argument("--balance",  type=float, help="Fraction of the leaves split at each level by synthetic, in (0, 1]: 1 grows complete trees, lower values deeper ones.", default = 1.0)
+    parser.add_argument("--num_features",  type=int, help="Number of features of synthetic.", default = 32)
+    parser.add_argument("--num_classes",  type=int, help="Number of classes of synthetic, 0 for a regression forest.", default = 8)
+    parser.add_argument("--output_dataset",  type=str, help="Path of the binary dataset of random samples of synthetic, not written if not set.", default = None)
+    parser.add_argument("--num_samples",  type=int, help="Number of samples of the binary dataset of synthetic.", default = 100000)
+    parser.add_argument("--seed",  type=int, help="Seed of synthetic, the same arguments and seed give the same files.", default = 0)
     args = parser.parse_args()
     # Setup the feature type of the TreeNode class.
     if args.feature_type is None or args.feature_type not in feature_types.keys():
@@ -357,7 +1533,49 @@ if __name__ == "__main__":
         if args.output_bin is None or not args.output_bin.endswith(".bin"):
             print("Invalid output file. The output file must be a binary file.")
             exit(1)
-        parse(args.input_model, args.output_bin)
+        parse(args.input_model, args.output_bin, args.leaf_proba, args.jobs, args.optimize)
+    elif args.command == "optimize":
+        if args.input_bin is None or args.output_bin is None or not args.output_bin.endswith(".bin"):
+            print("The input binary and a .bin output file are required.")
+            exit(1)
+        optimize_bin(args.input_bin, args.output_bin)
+    elif args.command == "gen_cpp":
+        if args.input_bin is None or args.output_cpp is None or not args.output_cpp.endswith((".hpp", ".h")):
+            print("The input binary and a C++ header output file are required.")
+            exit(1)
+        gen_cpp(args.input_bin, args.feature_type, args.output_cpp, args.namespace)
+    elif args.command == "bench_write_bin":
+        if args.num_trees < 1 or args.num_trees > 0xFFFF or args.num_nodes < args.num_trees or args.num_nodes // args.num_trees > 0xFFFF:
+            print("Invalid synthetic forest, it must contain between 1 and 65535 trees of 1 to 65535 nodes.")
+            exit(1)
+        bench_write_bin(args.output_bin, args.num_nodes, args.num_trees, args.leaf_proba)
+    elif args.command == "synthetic":
+        if args.node_distribution not in node_distributions or not 0 < args.balance <= 1 or args.max_depth < 0:
+            print(f"Invalid tree shape, the node distribution must be in {node_distributions}, the balance in (0, 1] and the depth positive.")
+            exit(1)
+        nodes_per_tree = args.num_nodes // max(1, args.num_trees) if args.nodes_per_tree is None else args.nodes_per_tree
+        if nodes_per_tree < 1 or nodes_per_tree > 0xFFFF:
+            print(f"Invalid synthetic forest, trees have between 1 and 65535 nodes, {nodes_per_tree} requested.")
+            exit(1)
+        try:
+            if args.target_size is not None:
+                args.num_trees = synthetic_num_trees(parse_size(args.target_size), nodes_per_tree, args.max_depth, args.num_classes, args.leaf_proba)
+            start = time.perf_counter()
+            report = synthetic_forest_bin(args.output_bin, nodes_per_tree * args.num_trees, args.num_trees, args.num_features, args.num_classes,
+                                          args.seed, args.node_distribution, args.max_depth, args.balance, args.leaf_proba)
+        except ValueError as e:
+            print(f"Invalid synthetic forest: {e}")
+            exit(1)
+        print(f"Synthetic forest written in {args.output_bin}: {report['trees']} trees, {report['nodes']} nodes, {report['leaves']} leaves, "
+              f"{report['size'] / (1 << 20):.2f} MB in {time.perf_counter() - start:.1f} s")
+        # The depth, the balance and the 65535 nodes of a tree can keep the forest well below the requested size.
+        requested, achieved, unit = (parse_size(args.target_size), report["size"], "bytes") if args.target_size is not None else \
+                                    (nodes_per_tree * args.num_trees, report["nodes"], "nodes")
+        if abs(achieved - requested) > 0.1 * requested:
+            print(f"Warning: {requested} {unit} requested, {achieved} written, check max_depth, balance and node_distribution.")
+        if args.output_dataset is not None:
+            synthetic_dataset(args.output_dataset, args.num_samples, args.num_features, args.feature_type, args.seed + 1)
+            print(f"Binary dataset written in {args.output_dataset}: {args.num_samples} samples, {args.num_features} {args.feature_type} features")
     elif args.command == "gen_test_vec":
         if args.input_model is None:
             print("The input model file is required for the generation of the C-test vectors.")
@@ -372,6 +1590,11 @@ if __name__ == "__main__":
             print("The target column is required for the generation of the C-test vectors.")
             exit(1)
         gen_test_vec(args.input_model, args.input_dataset, args.target_column, args.feature_type, args.output_test_vec)    
+    elif args.command == "gen_test_bin":
+        if args.input_dataset is None or args.target_column is None:
+            print("The input dataset file and its target column are required for the generation of the binary dataset.")
+            exit(1)
+        gen_test_bin(args.input_dataset, args.target_column, args.feature_type, args.output_test_bin, args.csv_separator)
     else:
         print("Invalid command.")
         exit(1)    
@@ -1,6 +1,6 @@
 """
-@file dtc_pygen.py
-@brief This file contains the utils to generate a binary configurator for the c lib given a PMML file in input.
+@file pruning.py
+@brief This file contains the accuracy-aware pruning of the binary configurations generated by dtc_pygen.
 
 
 @copyright Copyright (C) 2024 Antonio Emmanuele
@@ -20,4 +20,264 @@ GNU General Public License for more details.
 You should have received a copy of the GNU General Public License
 along with DTC. If not, see <https://www.gnu.org/licenses/>.
 """
+import argparse
+import json
+import math
+import numpy as np
+import pandas as pd
+from dtc_pygen import TreeNode, ConfigTrailer, feature_types, operators_map, set_fields, read_bin, read_test_bin, write_bin
 
+def tree_leaves(nodes, features):
+    """
+    Visits a tree for all the samples at once, with the semantic of the C operators (comparisons with NaN are false, except notEqual).
+
+    Returns:
+        np.ndarray: Index of the leaf reached by each sample.
+    """
+    is_leaf = (nodes["left_node"] == -1) & (nodes["right_node"] == -1)
+    current = np.zeros(len(features), dtype = np.int64)
+    active = np.flatnonzero(~is_leaf[current])
+    with np.errstate(invalid = "ignore"):
+        while len(active) > 0:
+            node = current[active]
+            value = features[active, nodes["feature_index"][node]]
+            threshold = nodes["threshold"][node]
+            operator = nodes["operator"][node]
+            condition = np.select([operator == operators_map["lessOrEqual"], operator == operators_map["lessThan"],
+                                    operator == operators_map["greaterOrEqual"], operator == operators_map["greaterThan"],
+                                    operator == operators_map["equal"]],
+                                    [value <= threshold, value < threshold, value >= threshold, value > threshold, value == threshold],
+                                    value != threshold)
+            current[active] = np.where(condition, nodes["left_node"][node], nodes["right_node"][node])
+            active = active[~is_leaf[current[active]]]
+    return current
+
+def tree_structure(nodes):
+    """
+    Returns the depth of each node and the [begin, end) interval of the pre-order positions of its subtree, computed with an explicit stack.
+    A node belongs to the subtree of n if its position is in the interval of n. Unreachable nodes get the position -1.
+    """
+    depth = np.zeros(len(nodes), dtype = np.int64)
+    begin = np.full(len(nodes), -1, dtype = np.int64)
+    end = np.full(len(nodes), -1, dtype = np.int64)
+    position = 0
+    stack = [(0, False)]
+    while stack:
+        node, closing = stack.pop()
+        if closing:
+            end[node] = position
+            continue
+        begin[node] = position
+        position += 1
+        stack.append((node, True))
+        if nodes["left_node"][node] != -1:
+            for child in (nodes["right_node"][node], nodes["left_node"][node]):
+                depth[child] = depth[node] + 1
+                stack.append((child, False))
+    return depth, begin, end
+
+def compact_tree(nodes, leaf_proba = None):
+    """ Removes the nodes that are no longer reachable from the root, renumbering the remaining ones in pre-order. """
+    _, begin, _ = tree_structure(nodes)
+    reachable = np.flatnonzero(begin >= 0)
+    order = reachable[np.argsort(begin[reachable])]
+    new_index = np.full(len(nodes), -1, dtype = np.int64)
+    new_index[order] = np.arange(len(order))
+    compacted = nodes[order].copy()
+    is_leaf = compacted["left_node"] == -1
+    compacted["left_node"] = np.where(is_leaf, -1, new_index[compacted["left_node"]])
+    compacted["right_node"] = np.where(is_leaf, -1, new_index[compacted["right_node"]])
+    return compacted, (None if leaf_proba is None else leaf_proba[order])
+
+class ForestVotes:
+    """
+    Majority voting of the forest on the validation set, updated incrementally when the class of the leaves reached by a subset of the
+    samples changes. Ties are broken as in the C majority_voting: the winner is the first class reaching the maximum count, in tree order.
+    """
+    def __init__(self, tree_classes, labels, num_classes):
+        self.tree_classes = tree_classes                # [num_trees x num_samples] class voted by each tree.
+        self.labels = labels
+        self.num_classes = num_classes
+        self.counts = np.zeros((tree_classes.shape[1], num_classes), dtype = np.int64)
+        for classes in tree_classes:
+            self.add(np.arange(len(labels)), classes, 1)
+        self.predictions = self.predict(np.arange(len(labels)))
+        self.correct = int(np.sum(self.predictions == labels))
+
+    def add(self, samples, classes, sign):
+        valid = (classes >= 0) & (classes < self.num_classes)
+        np.add.at(self.counts, (samples[valid], classes[valid]), sign)
+
+    def predict(self, samples, counts = None, tree_classes = None):
+        """ Predictions for the samples, with the current counts unless counts and tree_classes are provided. """
+        counts = self.counts[samples] if counts is None else counts
+        tree_classes = self.tree_classes[:, samples] if tree_classes is None else tree_classes
+        predictions = np.argmax(counts, axis = 1)
+        maximum = counts[np.arange(len(samples)), predictions]
+        ties = np.flatnonzero(np.sum(counts == maximum[:, None], axis = 1) > 1)
+        if len(ties) > 0:
+            # The first class reaching the maximum is the one whose last vote comes first.
+            votes = tree_classes[:, ties][:, :, None] == np.arange(self.num_classes)
+            last_vote = np.max(np.where(votes, np.arange(len(tree_classes))[:, None, None], -1), axis = 0)
+            tied = counts[ties] == maximum[ties, None]
+            predictions[ties] = np.argmin(np.where(tied, last_vote, len(tree_classes)), axis = 1)
+        return predictions
+
+    def try_change(self, tree, samples, classes, min_correct):
+        """ Changes the class voted by tree for the samples, if the number of correct predictions stays at least min_correct. """
+        old_classes = self.tree_classes[tree, samples].copy()
+        self.add(samples, old_classes, -1)
+        self.add(samples, classes, 1)
+        self.tree_classes[tree, samples] = classes
+        predictions = self.predict(samples)
+        correct = self.correct + int(np.sum(predictions == self.labels[samples])) - int(np.sum(self.predictions[samples] == self.labels[samples]))
+        if correct < min_correct:
+            self.tree_classes[tree, samples] = old_classes
+            self.add(samples, classes, -1)
+            self.add(samples, old_classes, 1)
+            return False
+        self.predictions[samples] = predictions
+        self.correct = correct
+        return True
+
+def prune_tree(tree_idx, nodes, leaf_proba, leaves, votes, min_correct):
+    """
+    Reduced error pruning of a tree: internal nodes are visited bottom-up, and each one is collapsed in a leaf with the majority
+    class of the validation samples reaching it, if the accuracy of the forest stays within the tolerance.
+    Nodes not reached by any validation sample are collapsed in the majority class of their leaves.
+    """
+    depth, begin, end = tree_structure(nodes)
+    # Samples sorted by the position of their leaf, so that the samples reaching a node are a contiguous range.
+    sample_order = np.argsort(begin[leaves], kind = "stable")
+    sample_positions = begin[leaves][sample_order]
+    is_leaf = nodes["left_node"] == -1
+    leaf_order = np.flatnonzero(is_leaf & (begin >= 0))
+    leaf_positions = np.sort(begin[leaf_order])
+    leaf_classes = nodes["class_res"][leaf_order[np.argsort(begin[leaf_order])]]
+    internal = np.flatnonzero(~is_leaf & (begin >= 0))
+    # Deepest nodes first, so that children are considered before their parents.
+    for node in internal[np.argsort(-depth[internal], kind = "stable")]:
+        first, last = np.searchsorted(sample_positions, [begin[node], end[node]])
+        samples = sample_order[first:last]
+        if len(samples) > 0:
+            classes = votes.tree_classes[tree_idx, samples]
+            new_class = np.argmax(np.bincount(classes[classes >= 0], minlength = votes.num_classes))
+            if not votes.try_change(tree_idx, samples, np.full(len(samples), new_class, dtype = votes.tree_classes.dtype), min_correct):
+                continue
+        else:
+            first, last = np.searchsorted(leaf_positions, [begin[node], end[node]])
+            subtree_classes = leaf_classes[first:last]
+            new_class = np.argmax(np.bincount(subtree_classes[subtree_classes >= 0], minlength = votes.num_classes))
+        if leaf_proba is not None:
+            # The distribution of the new leaf is the average of the distributions of the leaves reaching it.
+            reached = leaves[samples]
+            leaf_proba[node] = np.mean(leaf_proba[reached], axis = 0) if len(samples) > 0 else np.eye(votes.num_classes)[new_class]
+        nodes[node] = (0, 0, new_class, -1, -1, 0)
+        leaves[samples] = node
+    return compact_tree(nodes, leaf_proba)
+
+def drop_trees(votes, min_correct):
+    """
+    Backward elimination of whole trees: at each step the tree whose removal keeps the highest accuracy is removed,
+    while the accuracy stays within the tolerance. At least a tree is kept.
+
+    Returns:
+        list: Indices of the kept trees.
+    """
+    kept = list(range(len(votes.tree_classes)))
+    samples = np.arange(len(votes.labels))
+    while len(kept) > 1:
+        best_tree, best_correct = None, -1
+        for tree in kept:
+            counts = votes.counts.copy()
+            classes = votes.tree_classes[tree]
+            valid = (classes >= 0) & (classes < votes.num_classes)
+            np.add.at(counts, (samples[valid], classes[valid]), -1)
+            others = [t for t in kept if t != tree]
+            correct = int(np.sum(votes.predict(samples, counts, votes.tree_classes[others]) == votes.labels))
+            if correct > best_correct:
+                best_tree, best_correct = tree, correct
+        if best_correct < min_correct:
+            break
+        kept.remove(best_tree)
+        votes.add(samples, votes.tree_classes[best_tree], -1)
+        votes.tree_classes[best_tree] = -1
+        votes.predictions = votes.predict(samples)
+        votes.correct = best_correct
+    return kept
+
+def forest_report(trees, features):
+    """ Returns the number of nodes of each tree, and the average length of the paths (internal nodes visited) of the validation samples. """
+    num_nodes = [len(nodes) for nodes in trees]
+    path_lengths = [float(np.mean(tree_structure(nodes)[0][tree_leaves(nodes, features)])) for nodes in trees]
+    return {"num_trees": len(trees), "num_nodes": int(sum(num_nodes)), "nodes_per_tree": num_nodes,
+            "avg_path_length": float(np.mean(path_lengths)), "path_length_per_tree": path_lengths}
+
+def prune(model_path, features, labels, out_path, tolerance, drop = False):
+    """
+    Prunes a classification forest on a validation set, keeping its accuracy at least equal to the original accuracy minus tolerance.
+    If drop is set whole trees are removed first, then the subtrees of the kept trees are collapsed with the remaining tolerance.
+
+    Returns:
+        dict: Report with the accuracy, the number of nodes and the average path length before and after the pruning.
+    """
+    trailer, trees, leaf_proba_matrices, boosting = read_bin(model_path)
+    if boosting is not None or trailer.num_classes == 0:
+        raise ValueError("Only classification forests can be pruned, as the pruning is driven by their majority voting.")
+    if features.shape[1] != trailer.num_features:
+        raise ValueError(f"The validation set has {features.shape[1]} features, the model {trailer.num_features}.")
+    features = np.asarray(features, dtype = trees[0]["threshold"].dtype)
+    labels = np.asarray(labels, dtype = np.int64)
+    before = forest_report(trees, features)
+    leaves = [tree_leaves(nodes, features) for nodes in trees]
+    votes = ForestVotes(np.stack([nodes["class_res"][leaf].astype(np.int64) for nodes, leaf in zip(trees, leaves)]), labels, trailer.num_classes)
+    accuracy = votes.correct / len(labels)
+    min_correct = math.ceil((accuracy - tolerance) * len(labels) - 1e-9)
+    print(f"Validation accuracy {accuracy * 100:.4f}%, minimum accepted {min_correct / len(labels) * 100:.4f}%")
+
+    kept = drop_trees(votes, min_correct) if drop else list(range(len(trees)))
+    for idx in kept:
+        matrix = None if leaf_proba_matrices is None else leaf_proba_matrices[idx]
+        trees[idx], matrix = prune_tree(idx, trees[idx], matrix, leaves[idx], votes, min_correct)
+        if leaf_proba_matrices is not None:
+            leaf_proba_matrices[idx] = matrix
+    trees = [trees[t] for t in kept]
+    if leaf_proba_matrices is not None:
+        leaf_proba_matrices = [leaf_proba_matrices[t] for t in kept]
+    write_bin(ConfigTrailer(trailer.num_classes, trailer.num_features, len(trees)), trees, out_path,
+                leaf_proba_matrices is not None, leaf_proba_matrices = leaf_proba_matrices)
+    after = forest_report(trees, features)
+    report = {"tolerance": tolerance, "accuracy_before": accuracy, "accuracy_after": votes.correct / len(labels), "before": before, "after": after}
+    print(f"Accuracy {report['accuracy_before'] * 100:.4f}% -> {report['accuracy_after'] * 100:.4f}%")
+    print(f"Trees {before['num_trees']} -> {after['num_trees']}, nodes {before['num_nodes']} -> {after['num_nodes']}, "
+          f"average path length {before['avg_path_length']:.3f} -> {after['avg_path_length']:.3f}")
+    return report
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Prunes a binary configuration keeping its accuracy on a validation set within a tolerance.")
+    parser.add_argument("--feature_type",  type=str, help="Type of the feature in use.", default = "float")
+    parser.add_argument("--input_bin",  type=str, help="Path of the binary configuration to prune.", default = "../examples/desktop/inference_accuracy/statlog_rf5.bin")
+    parser.add_argument("--output_bin",  type=str, help="Path of the pruned binary configuration.", default = "pruned.bin")
+    parser.add_argument("--input_dataset",  type=str, help="Validation set, either a binary dataset of gen_test_bin or a csv.", default = "../datasets/statlog_segment/rf_5/test_dataset.csv")
+    parser.add_argument("--target_column",  type=str, help="Name of the target column of a csv validation set.", default = "Outcome")
+    parser.add_argument("--csv_separator",  type=str, help="Separator of the csv validation set.", default = ";")
+    parser.add_argument("--tolerance",  type=float, help="Maximum accepted accuracy loss, as a fraction (e.g. 0.01 for one point).", default = 0.0)
+    parser.add_argument("--drop_trees",  action="store_true", help="Also remove whole trees from the ensemble.")
+    parser.add_argument("--report",  type=str, help="Path of the JSON report of the pruning.", default = None)
+    args = parser.parse_args()
+    if args.feature_type not in feature_types.keys():
+        print(f"Invalid feature type. The feature type must be in {feature_types.keys()}")
+        exit(1)
+    set_fields(TreeNode, feature_types[args.feature_type])
+    if args.input_dataset.endswith(".csv"):
+        df = pd.read_csv(args.input_dataset, sep = args.csv_separator)
+        features, labels = df.drop(columns = [args.target_column]).to_numpy(), df[args.target_column].to_numpy()
+    else:
+        features, labels = read_test_bin(args.input_dataset)
+        if labels is None:
+            print("The validation set must contain the labels.")
+            exit(1)
+    report = prune(args.input_bin, features, labels, args.output_bin, args.tolerance, args.drop_trees)
+    if args.report is not None:
+        with open(args.report, "w") as out_file:
+            json.dump(report, out_file, indent = 4)
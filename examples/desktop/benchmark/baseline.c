@@ -0,0 +1,294 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../../src/tree_conf.h"
+#include "baseline.h"
+
+/**
+ * @brief Value of the pooled samples of the Mann-Whitney test, with the sample it comes from.
+ */
+typedef struct{
+    double value;
+    int from_x;
+} ranked_value_t;
+
+static int compare_ranked(const void* a, const void* b){
+    double x = ((const ranked_value_t*) a)->value, y = ((const ranked_value_t*) b)->value;
+    return (x > y) - (x < y);
+}
+
+static double median(const bench_result_t* const result){
+    const int n = result->runs;
+    return (n % 2) ? result->ns_per_sample[n / 2] : 0.5 * (result->ns_per_sample[n / 2 - 1] + result->ns_per_sample[n / 2]);
+}
+
+/**
+ * @brief Interquartile range of the runs relative to their median, an estimate of the noise of the benchmark.
+ */
+static double relative_iqr(const bench_result_t* const result){
+    const int n = result->runs;
+    return (result->ns_per_sample[(3 * (n - 1)) / 4] - result->ns_per_sample[(n - 1) / 4]) / median(result);
+}
+
+static void print_misses(FILE* const out, const char* const name, const double misses){
+    if(misses < 0){
+        fprintf(out, "\"%s\": null, ", name);
+    }
+    else{
+        fprintf(out, "\"%s\": %.6f, ", name, misses);
+    }
+}
+
+int baseline_write(const char* const path, const bench_result_t* const results, const int count){
+    FILE* out = fopen(path, "w");
+    if(NULL == out){
+        return -1;
+    }
+    fprintf(out, "{\n  \"config\": {\"use_float\": %d, \"use_pointers\": %d, \"compile_pruned\": %d},\n  \"results\": [\n",
+            USE_FLOAT, USE_POINTERS, COMPILE_PRUNED);
+    for(int i = 0; i < count; i++){
+        const bench_result_t* const result = &results[i];
+        fprintf(out, "    {\"model\": \"%s\", \"benchmark\": \"%s\", \"shape\": \"%s\", \"median_ns_per_sample\": %.4f, \"samples_per_s\": %.1f, ",
+                result->model, result->benchmark, result->shape, median(result), 1e9 / median(result));
+        print_misses(out, "l1d_misses_per_sample", result->l1d_misses);
+        print_misses(out, "llc_misses_per_sample", result->llc_misses);
+        fprintf(out, "\"ns_per_sample_runs\": [");
+        for(int r = 0; r < result->runs; r++){
+            fprintf(out, "%s%.4f", r ? ", " : "", result->ns_per_sample[r]);
+        }
+        fprintf(out, "]}%s\n", (i == count - 1) ? "" : ",");
+    }
+    fprintf(out, "  ]\n}\n");
+    return (0 == fclose(out)) ? 0 : -1;
+}
+
+/**
+ * @brief Copies the string value of key in a line of baseline_write, returning 0 if it was found.
+ */
+static int read_string(const char* const line, const char* const key, char* const value, const size_t size){
+    const char* start = strstr(line, key);
+    if(NULL == start){
+        return -1;
+    }
+    start += strlen(key);
+    const char* end = strchr(start, '"');
+    if(NULL == end || (size_t) (end - start) >= size){
+        return -1;
+    }
+    memcpy(value, start, end - start);
+    value[end - start] = '\0';
+    return 0;
+}
+
+/**
+ * @brief Reads the number of key in a line of baseline_write, -1 if it is null or missing.
+ */
+static double read_number(const char* const line, const char* const key){
+    const char* start = strstr(line, key);
+    if(NULL == start || 0 == strncmp(start + strlen(key), "null", 4)){
+        return -1;
+    }
+    return strtod(start + strlen(key), NULL);
+}
+
+static int read_result(const char* const line, bench_result_t* const result){
+    memset(result, 0, sizeof(*result));
+    const char* runs = strstr(line, "\"ns_per_sample_runs\": [");
+    if(0 != read_string(line, "\"model\": \"", result->model, sizeof(result->model)) ||
+       0 != read_string(line, "\"benchmark\": \"", result->benchmark, sizeof(result->benchmark)) ||
+       0 != read_string(line, "\"shape\": \"", result->shape, sizeof(result->shape)) || NULL == runs){
+        return -1;
+    }
+    result->l1d_misses = read_number(line, "\"l1d_misses_per_sample\": ");
+    result->llc_misses = read_number(line, "\"llc_misses_per_sample\": ");
+    runs += strlen("\"ns_per_sample_runs\": [");
+    int capacity = 0;
+    while(']' != *runs){
+        char* end;
+        double value = strtod(runs, &end);
+        if(end == runs){
+            return -1;
+        }
+        if(result->runs == capacity){
+            capacity = capacity ? 2 * capacity : 32;
+            double* ns_per_sample = realloc(result->ns_per_sample, capacity * sizeof(double));
+            if(NULL == ns_per_sample){
+                return -1;
+            }
+            result->ns_per_sample = ns_per_sample;
+        }
+        result->ns_per_sample[result->runs++] = value;
+        runs = end;
+        while(',' == *runs || ' ' == *runs){
+            runs++;
+        }
+    }
+    return (result->runs > 0) ? 0 : -1;
+}
+
+int baseline_read(const char* const path, baseline_t* const baseline){
+    memset(baseline, 0, sizeof(*baseline));
+    FILE* file = fopen(path, "r");
+    if(NULL == file){
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = (size > 0) ? malloc(size + 1) : NULL;
+    if(NULL == text || fread(text, 1, size, file) != (size_t) size){
+        free(text);
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+    text[size] = '\0';
+
+    int status = -1;
+    int capacity = 0;
+    for(char* line = strtok(text, "\n"); NULL != line; line = strtok(NULL, "\n")){
+        if(NULL != strstr(line, "\"config\": ")){
+            baseline->use_float = (int) read_number(line, "\"use_float\": ");
+            baseline->use_pointers = (int) read_number(line, "\"use_pointers\": ");
+            baseline->compile_pruned = (int) read_number(line, "\"compile_pruned\": ");
+            status = 0;
+            continue;
+        }
+        if(NULL == strstr(line, "\"benchmark\": ")){
+            continue;
+        }
+        if(baseline->count == capacity){
+            capacity = capacity ? 2 * capacity : 16;
+            bench_result_t* results = realloc(baseline->results, capacity * sizeof(bench_result_t));
+            if(NULL == results){
+                status = -1;
+                break;
+            }
+            baseline->results = results;
+        }
+        if(0 != read_result(line, &baseline->results[baseline->count])){
+            free(baseline->results[baseline->count].ns_per_sample);
+            status = -1;
+            break;
+        }
+        baseline->count++;
+    }
+    free(text);
+    if(0 != status){
+        baseline_free(baseline);
+    }
+    return status;
+}
+
+void baseline_free(baseline_t* const baseline){
+    for(int i = 0; i < baseline->count; i++){
+        free(baseline->results[i].ns_per_sample);
+    }
+    free(baseline->results);
+    memset(baseline, 0, sizeof(*baseline));
+}
+
+double mann_whitney_greater(const double* const x, const int nx, const double* const y, const int ny){
+    const int n = nx + ny;
+    ranked_value_t* pooled = malloc(n * sizeof(ranked_value_t));
+    if(NULL == pooled || nx < 1 || ny < 1){
+        free(pooled);
+        return 1.0;
+    }
+    for(int i = 0; i < nx; i++){
+        pooled[i] = (ranked_value_t) {x[i], 1};
+    }
+    for(int i = 0; i < ny; i++){
+        pooled[nx + i] = (ranked_value_t) {y[i], 0};
+    }
+    qsort(pooled, n, sizeof(ranked_value_t), compare_ranked);
+    // Tied values share the mean of their ranks, and reduce the variance of U by (t^3 - t) / (n (n - 1)) for each group of t ties.
+    double rank_sum_x = 0, ties = 0;
+    for(int i = 0; i < n;){
+        int j = i;
+        while(j < n && pooled[j].value == pooled[i].value){
+            j++;
+        }
+        double rank = 0.5 * (i + 1 + j);
+        for(int k = i; k < j; k++){
+            rank_sum_x += pooled[k].from_x ? rank : 0;
+        }
+        ties += (double) (j - i) * (j - i) * (j - i) - (j - i);
+        i = j;
+    }
+    free(pooled);
+    double u = rank_sum_x - 0.5 * nx * (nx + 1.0);
+    double variance = nx * (double) ny / 12.0 * ((n + 1.0) - ties / ((double) n * (n - 1.0)));
+    if(variance <= 0){
+        return 1.0;
+    }
+    double z = (u - 0.5 * nx * ny - 0.5) / sqrt(variance);
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+int baseline_compare(FILE* const out, const baseline_t* const baseline, const bench_result_t* const results, const int count,
+                     const double threshold_pct, const double alpha){
+    if(baseline->use_float != USE_FLOAT || baseline->use_pointers != USE_POINTERS || baseline->compile_pruned != COMPILE_PRUNED){
+        fprintf(out, "Baseline of USE_FLOAT=%d USE_POINTERS=%d COMPILE_PRUNED=%d, not comparable with USE_FLOAT=%d USE_POINTERS=%d COMPILE_PRUNED=%d\n",
+                baseline->use_float, baseline->use_pointers, baseline->compile_pruned, USE_FLOAT, USE_POINTERS, COMPILE_PRUNED);
+        return -1;
+    }
+    // Models are matched by name, and the synthetic forest keeps its name whatever its parameters.
+    for(int i = 0; i < count; i++){
+        for(int j = 0; j < baseline->count; j++){
+            if(0 == strcmp(baseline->results[j].model, results[i].model) && 0 != strcmp(baseline->results[j].shape, results[i].shape)){
+                fprintf(out, "Baseline model %s of %s, not comparable with %s\n", results[i].model, baseline->results[j].shape, results[i].shape);
+                return -1;
+            }
+        }
+    }
+    int regressions = 0, comparisons = 0, not_rerun = 0;
+    fprintf(out, "Baseline comparison, regression if the median is higher than the threshold (at least %.1f%%) with p-value < %g\n", threshold_pct, alpha);
+    fprintf(out, "%-12s %-32s %10s %10s %8s %9s %9s  %s\n", "model", "benchmark (ns/sample)", "baseline", "current", "change", "threshold", "p-value",
+            "verdict");
+    for(int i = 0; i < count; i++){
+        const bench_result_t* base = NULL;
+        for(int j = 0; j < baseline->count && NULL == base; j++){
+            if(0 == strcmp(baseline->results[j].model, results[i].model) && 0 == strcmp(baseline->results[j].benchmark, results[i].benchmark)){
+                base = &baseline->results[j];
+            }
+        }
+        if(NULL == base){
+            fprintf(out, "%-12s %-32s %10s %10.2f %8s %9s %9s  not in baseline\n", results[i].model, results[i].benchmark, "-", median(&results[i]), "-", "-",
+                    "-");
+            continue;
+        }
+        // The threshold grows with the noise of the noisiest of the two measures, so that the drift of a noisy benchmark is not reported.
+        double noise = 100.0 * fmax(relative_iqr(base), relative_iqr(&results[i]));
+        double threshold = fmax(threshold_pct, noise);
+        double change = 100.0 * (median(&results[i]) / median(base) - 1.0);
+        double slower = mann_whitney_greater(results[i].ns_per_sample, results[i].runs, base->ns_per_sample, base->runs);
+        double faster = mann_whitney_greater(base->ns_per_sample, base->runs, results[i].ns_per_sample, results[i].runs);
+        const char* verdict = "ok";
+        if(change > threshold && slower < alpha){
+            verdict = "REGRESSION";
+            regressions++;
+        }
+        else if(change < -threshold && faster < alpha){
+            verdict = "improvement";
+        }
+        comparisons++;
+        fprintf(out, "%-12s %-32s %10.2f %10.2f %+7.1f%% %8.1f%% %9.4f  %s\n", results[i].model, results[i].benchmark, median(base), median(&results[i]),
+                change, threshold, (change > 0) ? slower : faster, verdict);
+    }
+    for(int j = 0; j < baseline->count; j++){
+        int rerun = 0;
+        for(int i = 0; i < count && !rerun; i++){
+            rerun = (0 == strcmp(baseline->results[j].model, results[i].model) && 0 == strcmp(baseline->results[j].benchmark, results[i].benchmark));
+        }
+        if(!rerun){
+            fprintf(out, "%-12s %-32s %10.2f %10s %8s %9s %9s  not rerun\n", baseline->results[j].model, baseline->results[j].benchmark,
+                    median(&baseline->results[j]), "-", "-", "-", "-");
+            not_rerun++;
+        }
+    }
+    fprintf(out, "Regression check: %d regressions in %d comparisons, %d baseline results not rerun\n", regressions, comparisons, not_rerun);
+    return regressions;
+}
@@ -0,0 +1,64 @@
+#ifndef BASELINE_H
+#define BASELINE_H
+#include <stdio.h>
+
+#define BASELINE_MAX_NAME 64
+#define BASELINE_MAX_SHAPE 128
+
+/**
+ * @brief Measures of a benchmark on a model, the unit of the baseline comparisons.
+ */
+typedef struct{
+    char model[BASELINE_MAX_NAME];
+    char benchmark[BASELINE_MAX_NAME];
+    char shape[BASELINE_MAX_SHAPE];     /**< Trees, nodes, features, classes and samples of the model, as models are matched by name. */
+    int runs;
+    double* ns_per_sample;      /**< Sorted ns/sample of the timed runs. */
+    double l1d_misses;          /**< L1 data cache misses per sample, negative if not measured. */
+    double llc_misses;          /**< Last level cache misses per sample, negative if not measured. */
+} bench_result_t;
+
+/**
+ * @brief Results of a baseline file, with the build flags of the benchmark that wrote it.
+ */
+typedef struct{
+    int use_float;
+    int use_pointers;
+    int compile_pruned;
+    int count;
+    bench_result_t* results;
+} baseline_t;
+
+/**
+ * @brief Writes the results as a baseline JSON document, with one result per line so that baseline_read needs no JSON library.
+ *        Each result contains the median ns/sample, the throughput, the cache misses per sample (null if not measured) and the ns/sample of every run.
+ * @return int 0 on success, -1 if the file can not be written.
+ */
+int baseline_write(const char* const path, const bench_result_t* const results, const int count);
+
+/**
+ * @brief Reads a baseline written by baseline_write. It must be released with baseline_free.
+ * @return int 0 on success, -1 if the file can not be read or is not a baseline.
+ */
+int baseline_read(const char* const path, baseline_t* const baseline);
+
+void baseline_free(baseline_t* const baseline);
+
+/**
+ * @brief One-sided Mann-Whitney U test, with the normal approximation corrected for ties and continuity.
+ * @return double p-value of the hypothesis that the values of x are stochastically greater than the ones of y, 1 if all the values are equal.
+ */
+double mann_whitney_greater(const double* const x, const int nx, const double* const y, const int ny);
+
+/**
+ * @brief Compares the results with the baseline, printing a line per result. A result regresses if its median ns/sample is higher than
+ *        the baseline one by more than the threshold, i.e. the largest of threshold_pct and of the interquartile ranges of the two runs
+ *        relative to their medians, and the Mann-Whitney test rejects, with p-value below alpha, that its runs are not slower than the
+ *        baseline runs. So a noisy benchmark needs a larger difference to be reported. The baseline results that were not rerun are listed.
+ * @return int Number of regressions, or -1 if the baseline was built with other flags or a model has another shape in the baseline
+ *         (e.g. a synthetic forest generated with other parameters).
+ */
+int baseline_compare(FILE* const out, const baseline_t* const baseline, const bench_result_t* const results, const int count,
+                     const double threshold_pct, const double alpha);
+
+#endif
@@ -0,0 +1,577 @@
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../../../src/tree_conf.h"
+#include "../../../src/tree_dataset.h"
+#include "../../../src/tree_latency.h"
+#include "../../../src/tree_perf.h"
+#include "../../../src/tree_visit.h"
+#include "baseline.h"
+#if USE_FLOAT
+#include "../test_float_feat/model_test.h"
+#define STATLOG_MODEL_FILENAME "../test_float_feat/statlog_rf5.bin"
+#else
+#include "../inference_accuracy/model_test.h"
+#define STATLOG_MODEL_FILENAME "../inference_accuracy/statlog_rf5.bin"
+#endif
+
+#define MAX_RUNS 1000
+
+/**
+ * @brief Forest and input samples of a benchmarked model.
+ */
+typedef struct{
+    const char* name;
+    node_t** trees;
+    uint16_t num_trees;
+    uint16_t num_classes;
+    uint16_t num_features;
+    uint32_t num_nodes;
+    const feature_type_t* features;     /**< Row-major [num_samples x num_features] matrix. */
+    uint32_t num_samples;
+    class_t* class_per_tree;            /**< [num_samples x num_trees] classes of the trees, input of the majority_voting benchmark. */
+    class_t* results;                   /**< Output of the batched benchmarks. */
+} bench_model_t;
+
+/**
+ * @brief A benchmark processes all the samples of a model once, returning a checksum so that its work can not be optimized away.
+ */
+typedef uint64_t (*bench_fun_t)(const bench_model_t* const model);
+
+typedef struct{
+    int runs;
+    int warmup;
+    int cpu;
+    double min_run_ms;
+    int json;
+    double replay_rate;             /**< Requests per second of the replay mode, 0 to run the throughput benchmarks. */
+    double replay_seconds;          /**< Duration of the replay. */
+    double replay_interval_ms;      /**< Period of the merges of the service time histograms, printed as interval lines. */
+    const char* latency_dump;       /**< Path prefix of the .hgrm distributions of the replay, NULL to skip them. */
+    const char* save_baseline;      /**< Path of the baseline written with the results, NULL to skip it. */
+    const char* baseline;           /**< Path of the baseline the results are compared with, NULL to skip the comparison. */
+    double regression_threshold;    /**< Minimum increase (%) of the median ns/sample reported as a regression. */
+    double alpha;                   /**< Significance level of the Mann-Whitney test of the regressions. */
+} bench_options_t;
+
+static uint64_t bench_visit_tree(const bench_model_t* const model){
+    uint64_t checksum = 0;
+    class_t result;
+    for(uint32_t i = 0; i < model->num_samples; i++){
+        visit_tree(model->trees[0], &model->features[(size_t) i * model->num_features], &result);
+        checksum += result;
+    }
+    return checksum;
+}
+
+static uint64_t bench_visit_ensemble(const bench_model_t* const model){
+    uint64_t checksum = 0;
+    class_t class_per_tree[model->num_trees];
+    for(uint32_t i = 0; i < model->num_samples; i++){
+        visit_ensemble(model->trees, model->num_trees, &model->features[(size_t) i * model->num_features], class_per_tree);
+        checksum += class_per_tree[i % model->num_trees];
+    }
+    return checksum;
+}
+
+static uint64_t bench_majority_voting(const bench_model_t* const model){
+    uint64_t checksum = 0;
+    class_t result = -1;
+    for(uint32_t i = 0; i < model->num_samples; i++){
+        checksum += majority_voting(&model->class_per_tree[(size_t) i * model->num_trees], model->num_trees, &result);
+        checksum += result;
+    }
+    return checksum;
+}
+
+static uint64_t bench_visit_rf_majority_voting(const bench_model_t* const model){
+    uint64_t checksum = 0;
+    class_t result = -1;
+    uint16_t num_votes;
+    for(uint32_t i = 0; i < model->num_samples; i++){
+        visit_rf_majority_voting(model->trees, model->num_trees, &model->features[(size_t) i * model->num_features], &result, &num_votes);
+        checksum += result + num_votes;
+    }
+    return checksum;
+}
+
+static uint64_t bench_visit_rf_majority_voting_batch(const bench_model_t* const model){
+    visit_rf_majority_voting_batch(model->trees, model->num_trees, model->num_classes, model->features, model->num_samples, model->num_features,
+                                   model->results, NULL);
+    return (uint64_t) model->results[model->num_samples - 1];
+}
+
+static const struct{
+    const char* name;
+    bench_fun_t fun;
+} benchmarks[] = {
+    {"visit_tree", bench_visit_tree},
+    {"visit_ensemble", bench_visit_ensemble},
+    {"majority_voting", bench_majority_voting},
+    {"visit_rf_majority_voting", bench_visit_rf_majority_voting},
+    {"visit_rf_majority_voting_batch", bench_visit_rf_majority_voting_batch},
+};
+
+static double now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int compare_doubles(const void* a, const void* b){
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Nearest-rank percentile of a sorted array.
+ */
+static double percentile(const double* const sorted, const int count, const double p){
+    int rank = (int) (p / 100.0 * count + 0.999999);
+    return sorted[(rank < 1 ? 1 : rank) - 1];
+}
+
+/**
+ * @brief Misses per sample of a cache counter of tree_perf over the runs of a benchmark, -1 if the counter was not read.
+ */
+static double misses_per_sample(const bench_model_t* const model, const char* const name, const uint8_t counter){
+    tree_perf_stats_t stats[TREE_PERF_MAX_STATS];
+    uint16_t num_stats = tree_perf_get_stats(stats, TREE_PERF_MAX_STATS, NULL);
+    for(uint16_t s = 0; s < num_stats; s++){
+        if(stats[s].model == model && 0 == strcmp(stats[s].call_site, name) && (stats[s].available & (1U << counter)) &&
+           stats[s].measured_samples[counter] > 0){
+            return (double) stats[s].counters[counter] / stats[s].measured_samples[counter];
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Times a benchmark: a run repeats it enough passes to last at least min_run_ms, warmup runs are discarded and
+ *        the ns/sample of each timed run are sorted in result for the percentiles. The cache misses of the timed runs are read
+ *        with tree_perf when it is built with TREE_PERF=1 and the counters are available.
+ */
+static void run_benchmark(const bench_model_t* const model, const char* const name, const bench_fun_t fun, const bench_options_t* const options,
+                          bench_result_t* const result, uint64_t* const checksum){
+    double* const ns_per_sample = result->ns_per_sample;
+    double start = now_ns();
+    *checksum += fun(model);
+    double single_pass = now_ns() - start;
+    uint64_t passes = (uint64_t) (options->min_run_ms * 1e6 / (single_pass > 1 ? single_pass : 1)) + 1;
+    for(int r = 0; r < options->warmup; r++){
+        for(uint64_t p = 0; p < passes; p++){
+            *checksum += fun(model);
+        }
+    }
+    for(int r = 0; r < options->runs; r++){
+        tree_perf_scope_t scope;
+        tree_perf_begin(&scope);
+        start = now_ns();
+        for(uint64_t p = 0; p < passes; p++){
+            *checksum += fun(model);
+        }
+        ns_per_sample[r] = (now_ns() - start) / ((double) passes * model->num_samples);
+        tree_perf_end(&scope, name, model, passes * model->num_samples);
+    }
+    qsort(ns_per_sample, options->runs, sizeof(double), compare_doubles);
+    snprintf(result->model, sizeof(result->model), "%s", model->name);
+    snprintf(result->benchmark, sizeof(result->benchmark), "%s", name);
+    snprintf(result->shape, sizeof(result->shape), "%u trees, %u nodes, %u features, %u classes, %u samples", model->num_trees, model->num_nodes,
+             model->num_features, model->num_classes, model->num_samples);
+    result->runs = options->runs;
+    result->l1d_misses = misses_per_sample(model, name, TREE_PERF_L1D_MISSES);
+    result->llc_misses = misses_per_sample(model, name, TREE_PERF_LLC_MISSES);
+    if(options->json){
+        printf("    {\"model\": \"%s\", \"benchmark\": \"%s\", \"trees\": %u, \"nodes\": %u, \"samples\": %u, \"passes_per_run\": %llu, "
+               "\"ns_per_sample\": {\"min\": %.3f, \"median\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f}}",
+               model->name, name, model->num_trees, model->num_nodes, model->num_samples, (unsigned long long) passes, ns_per_sample[0],
+               percentile(ns_per_sample, options->runs, 50), percentile(ns_per_sample, options->runs, 90),
+               percentile(ns_per_sample, options->runs, 99), ns_per_sample[options->runs - 1]);
+    }
+    else{
+        printf("%-12s %-32s %10.2f %10.2f %10.2f %10.2f\n", model->name, name, ns_per_sample[0], percentile(ns_per_sample, options->runs, 50),
+               percentile(ns_per_sample, options->runs, 90), percentile(ns_per_sample, options->runs, 99));
+    }
+}
+
+static void print_latency_json(const char* const name, const tree_latency_histogram_t* const histogram){
+    printf("\"%s\": {\"count\": %llu, \"p50\": %llu, \"p99\": %llu, \"p99_9\": %llu, \"max\": %llu}", name,
+           (unsigned long long) histogram->total_count, (unsigned long long) tree_latency_percentile(histogram, 50.0),
+           (unsigned long long) tree_latency_percentile(histogram, 99.0), (unsigned long long) tree_latency_percentile(histogram, 99.9),
+           (unsigned long long) histogram->max);
+}
+
+static void dump_latency(const bench_options_t* const options, const bench_model_t* const model, const char* const name,
+                         const tree_latency_histogram_t* const histogram){
+    char path[512];
+    snprintf(path, sizeof(path), "%s_%s_%s.hgrm", options->latency_dump, model->name, name);
+    FILE* out = fopen(path, "w");
+    if(NULL == out){
+        fprintf(stderr, "Can not write %s\n", path);
+        return;
+    }
+    tree_latency_dump(out, histogram, 5);
+    fclose(out);
+}
+
+/**
+ * @brief Replays the samples of a model, one visit_rf_majority_voting request at a time, at a fixed rate (open loop): request i is scheduled
+ *        at i / replay_rate seconds from the start, whether the previous ones are late or not. The service time is recorded by
+ *        tree_latency_visit_rf_majority_voting and merged every replay_interval_ms, the response time is measured from the scheduled
+ *        start, so that it includes the queueing of the requests delayed by slow ones instead of omitting it.
+ */
+static void run_replay(const bench_model_t* const model, const bench_options_t* const options, uint64_t* const checksum){
+    static tree_latency_histogram_t service, response, interval;
+    tree_latency_clear(&service);
+    tree_latency_clear(&response);
+    tree_latency_reset();
+    uint64_t num_requests = (uint64_t) (options->replay_rate * options->replay_seconds);
+    uint64_t interval_ns = (uint64_t) (options->replay_interval_ms * 1e6);
+    double period_ns = 1e9 / options->replay_rate;
+    uint64_t start = tree_latency_now();
+    uint64_t next_merge = start + interval_ns;
+    uint32_t intervals = 0;
+    for(uint64_t i = 0; i < num_requests; i++){
+        uint64_t scheduled = start + (uint64_t) (i * period_ns);
+        while(tree_latency_now() < scheduled);
+        const feature_type_t* sample = &model->features[(size_t) (i % model->num_samples) * model->num_features];
+        class_t classification_result;
+        uint16_t num_votes;
+        tree_latency_visit_rf_majority_voting(model->trees, model->num_trees, sample, &classification_result, &num_votes);
+        uint64_t end = tree_latency_now();
+        tree_latency_add_value(&response, end - scheduled);
+        *checksum += (uint64_t) classification_result + num_votes;
+        if(end >= next_merge || i == num_requests - 1){
+            tree_latency_merge(&interval);
+            tree_latency_add(&service, &interval);
+            if(!options->json){
+                char name[32];
+                snprintf(name, sizeof(name), "  interval %u", intervals);
+                tree_latency_print(stdout, name, &interval);
+            }
+            intervals++;
+            next_merge += interval_ns;
+        }
+    }
+    double elapsed_s = (tree_latency_now() - start) / 1e9;
+    if(options->json){
+        printf("    {\"model\": \"%s\", \"benchmark\": \"replay\", \"trees\": %u, \"nodes\": %u, \"rate\": %.1f, \"achieved_rate\": %.1f, ",
+               model->name, model->num_trees, model->num_nodes, options->replay_rate, num_requests / elapsed_s);
+        print_latency_json("service_ns", &service);
+        printf(", ");
+        print_latency_json("response_ns", &response);
+        printf("}");
+    }
+    else{
+        printf("%s: %llu requests at %.1f/s (achieved %.1f/s)\n", model->name, (unsigned long long) num_requests, options->replay_rate,
+               num_requests / elapsed_s);
+        tree_latency_print(stdout, "  service", &service);
+        tree_latency_print(stdout, "  response", &response);
+    }
+    if(NULL != options->latency_dump){
+        dump_latency(options, model, "service", &service);
+        dump_latency(options, model, "response", &response);
+    }
+}
+
+/**
+ * @brief Precomputes the classes of the trees and allocates the outputs of a model whose trees and features are set.
+ */
+static int prepare_model(bench_model_t* const model){
+    model->class_per_tree = malloc((size_t) model->num_samples * model->num_trees * sizeof(class_t));
+    model->results = malloc((size_t) model->num_samples * sizeof(class_t));
+    if(NULL == model->class_per_tree || NULL == model->results){
+        return -1;
+    }
+    for(uint32_t i = 0; i < model->num_samples; i++){
+        visit_ensemble(model->trees, model->num_trees, &model->features[(size_t) i * model->num_features], &model->class_per_tree[(size_t) i * model->num_trees]);
+    }
+    return 0;
+}
+
+static uint64_t xorshift64(uint64_t* const state){
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static feature_type_t random_feature(uint64_t* const state){
+    return (feature_type_t) ((xorshift64(state) >> 11) * (1.0 / 9007199254740992.0));
+}
+
+/**
+ * @brief Generates a forest of complete trees of the given depth, with random features, thresholds in [0, 1) and leaf classes,
+ *        and uniform random samples, so that every path is equally likely. Nodes are stored in breadth-first order.
+ */
+static int synthetic_model(bench_model_t* const model, const uint16_t num_trees, const uint16_t depth, const uint16_t num_features,
+                           const uint16_t num_classes, const uint32_t num_samples, node_t** const nodes_out, feature_type_t** const features_out){
+    uint32_t tree_nodes = (2U << depth) - 1;
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    node_t* nodes = calloc((size_t) num_trees * tree_nodes, sizeof(node_t));
+    feature_type_t* features = malloc((size_t) num_samples * num_features * sizeof(feature_type_t));
+    model->trees = malloc(num_trees * sizeof(node_t*));
+    if(NULL == nodes || NULL == features || NULL == model->trees){
+        free(nodes);
+        free(features);
+        return -1;
+    }
+    for(uint16_t t = 0; t < num_trees; t++){
+        node_t* root = &nodes[(size_t) t * tree_nodes];
+        model->trees[t] = root;
+        for(uint32_t n = 0; n < tree_nodes; n++){
+            uint8_t is_leaf = 2 * n + 1 >= tree_nodes;
+            root[n].operator = 0;
+            root[n].feature_index = xorshift64(&state) % num_features;
+            root[n].threshold = random_feature(&state);
+            root[n].class = is_leaf ? (class_t) (xorshift64(&state) % num_classes) : -1;
+#if USE_POINTERS
+            root[n].left_child = is_leaf ? NULL : &root[2 * n + 1];
+            root[n].right_child = is_leaf ? NULL : &root[2 * n + 2];
+#else
+            root[n].left_node = is_leaf ? -1 : (nodes_idx_t) (2 * n + 1);
+            root[n].right_node = is_leaf ? -1 : (nodes_idx_t) (2 * n + 2);
+#endif
+        }
+    }
+    for(size_t i = 0; i < (size_t) num_samples * num_features; i++){
+        features[i] = random_feature(&state);
+    }
+    model->name = "synthetic";
+    model->num_trees = num_trees;
+    model->num_classes = num_classes;
+    model->num_features = num_features;
+    model->num_nodes = num_trees * tree_nodes;
+    model->features = features;
+    model->num_samples = num_samples;
+    *nodes_out = nodes;
+    *features_out = features;
+    return 0;
+}
+
+static int pin_cpu(const int cpu){
+    if(cpu < 0){
+        return 0;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return 0 == sched_setaffinity(0, sizeof(set), &set);
+}
+
+static void usage(const char* const program){
+    printf("Usage: %s [--json] [--runs N] [--warmup N] [--cpu N|-1] [--min_run_ms MS] [--model model.bin [--dataset dataset.dtcd]]\n"
+           "          [--synthetic_trees N] [--synthetic_depth N] [--synthetic_features N] [--synthetic_classes N] [--synthetic_samples N]\n"
+           "          [--replay_rate REQUESTS_PER_S [--replay_seconds S] [--replay_interval_ms MS] [--latency_dump PREFIX]]\n"
+           "          [--save_baseline baseline.json] [--baseline baseline.json [--regression_threshold PCT] [--alpha P]]\n", program);
+}
+
+/**
+ * Measures ns/sample of visit_tree (the first tree), visit_ensemble, majority_voting (on precomputed tree classes), visit_rf_majority_voting
+ * and visit_rf_majority_voting_batch on the statlog rf_5 model (or --model) and on a synthetic forest of complete trees.
+ * Each benchmark is calibrated to runs of at least --min_run_ms, warmed up and timed --runs times on the --cpu core; min, median and
+ * percentiles of the runs are printed as a table or, with --json, as a JSON document.
+ * The build flags are part of the output, build the variants with make USE_FLOAT=1 USE_POINTERS=1 COMPILE_PRUNED=1 or make variants.
+ * With --replay_rate the samples are instead replayed one request at a time at a fixed rate for --replay_seconds, and the p50/p99/p99.9/max
+ * of the service and response time of visit_rf_majority_voting are printed, with the service time of each --replay_interval_ms interval.
+ * --save_baseline writes the runs of the benchmarks as a baseline, and --baseline compares them with a baseline of the same build flags: the
+ * benchmark fails if the median of a (model, benchmark) is more than --regression_threshold % higher than in the baseline and a one-sided
+ * Mann-Whitney test of the runs is significant at --alpha.
+ */
+int main(int argc, char** argv) {
+    bench_options_t options = {21, 3, 0, 2.0, 0, 0.0, 1.0, 1000.0, NULL, NULL, NULL, 5.0, 0.01};
+    const char* model_path = NULL;
+    const char* dataset_path = NULL;
+    long synthetic_trees = 100, synthetic_depth = 8, synthetic_features = 32, synthetic_classes = 8, synthetic_samples = 1024;
+    for(int i = 1; i < argc; i++){
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if(0 == strcmp(argv[i], "--json")){ options.json = 1; continue; }
+        if(NULL == value){ usage(argv[0]); return EXIT_FAILURE; }
+        if(0 == strcmp(argv[i], "--runs")) options.runs = atoi(value);
+        else if(0 == strcmp(argv[i], "--warmup")) options.warmup = atoi(value);
+        else if(0 == strcmp(argv[i], "--cpu")) options.cpu = atoi(value);
+        else if(0 == strcmp(argv[i], "--min_run_ms")) options.min_run_ms = atof(value);
+        else if(0 == strcmp(argv[i], "--model")) model_path = value;
+        else if(0 == strcmp(argv[i], "--dataset")) dataset_path = value;
+        else if(0 == strcmp(argv[i], "--synthetic_trees")) synthetic_trees = atol(value);
+        else if(0 == strcmp(argv[i], "--synthetic_depth")) synthetic_depth = atol(value);
+        else if(0 == strcmp(argv[i], "--synthetic_features")) synthetic_features = atol(value);
+        else if(0 == strcmp(argv[i], "--synthetic_classes")) synthetic_classes = atol(value);
+        else if(0 == strcmp(argv[i], "--synthetic_samples")) synthetic_samples = atol(value);
+        else if(0 == strcmp(argv[i], "--replay_rate")) options.replay_rate = atof(value);
+        else if(0 == strcmp(argv[i], "--replay_seconds")) options.replay_seconds = atof(value);
+        else if(0 == strcmp(argv[i], "--replay_interval_ms")) options.replay_interval_ms = atof(value);
+        else if(0 == strcmp(argv[i], "--latency_dump")) options.latency_dump = value;
+        else if(0 == strcmp(argv[i], "--save_baseline")) options.save_baseline = value;
+        else if(0 == strcmp(argv[i], "--baseline")) options.baseline = value;
+        else if(0 == strcmp(argv[i], "--regression_threshold")) options.regression_threshold = atof(value);
+        else if(0 == strcmp(argv[i], "--alpha")) options.alpha = atof(value);
+        else{ usage(argv[0]); return EXIT_FAILURE; }
+        i++;
+    }
+    if(options.runs < 1 || options.runs > MAX_RUNS || options.warmup < 0 || synthetic_trees < 0 || synthetic_trees > 0xFFFF || synthetic_depth < 0 ||
+       synthetic_depth > 24 || synthetic_features < 1 || synthetic_features > 0xFFFF || synthetic_classes < 1 || synthetic_classes > num_classes ||
+       synthetic_samples < 1 || synthetic_samples > UINT32_MAX || options.replay_rate < 0 || options.replay_seconds <= 0 || options.replay_interval_ms <= 0 ||
+       options.regression_threshold < 0 || options.alpha <= 0 || options.alpha >= 1 || (options.replay_rate > 0 && (options.save_baseline || options.baseline))){
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    // The baseline is read before the benchmarks, so that a wrong path does not waste a whole run.
+    baseline_t baseline;
+    memset(&baseline, 0, sizeof(baseline));
+    if(NULL != options.baseline && 0 != baseline_read(options.baseline, &baseline)){
+        printf("Error reading the baseline %s\n", options.baseline);
+        return EXIT_FAILURE;
+    }
+    int pinned = pin_cpu(options.cpu);
+    if(options.cpu >= 0 && !pinned){
+        fprintf(stderr, "Can not pin the benchmark on cpu %d, running unpinned\n", options.cpu);
+    }
+
+    bench_model_t models[2];
+    int num_models = 0;
+    int status = EXIT_SUCCESS;
+    // Real model: the statlog rf_5 model with its test vectors, or --model with --dataset (uniform random samples without it).
+    tree_conf_t conf;
+    tree_dataset_t dataset;
+    int has_dataset = 0;
+    feature_type_t* random_features = NULL;
+    node_t* synthetic_nodes = NULL;
+    feature_type_t* synthetic_features_matrix = NULL;
+    if(load_tree_conf(model_path ? model_path : STATLOG_MODEL_FILENAME, &conf) != CONF_OK){
+        printf("Error loading %s\n", model_path ? model_path : STATLOG_MODEL_FILENAME);
+        baseline_free(&baseline);
+        return EXIT_FAILURE;
+    }
+    bench_model_t* model = &models[num_models++];
+    memset(model, 0, sizeof(*model));
+    model->name = model_path ? "model" : "statlog_rf5";
+    model->trees = conf.trees;
+    model->num_trees = conf.trailer.num_trees;
+    model->num_classes = conf.trailer.num_classes;
+    model->num_features = conf.trailer.num_features;
+    for(uint16_t t = 0; t < conf.trailer.num_trees; t++){
+        model->num_nodes += conf.num_nodes[t];
+    }
+    if(NULL == model_path){
+        model->features = &inputs[0][0];
+        model->num_samples = num_inputs;
+        (void) dataset_outs;
+    }
+    else if(NULL != dataset_path){
+        if(load_tree_dataset(dataset_path, &dataset) != DATASET_OK || dataset.header.num_features != conf.trailer.num_features){
+            printf("Error loading %s, or it does not match the model\n", dataset_path);
+            free_tree_conf(&conf);
+            baseline_free(&baseline);
+            return EXIT_FAILURE;
+        }
+        has_dataset = 1;
+        model->features = dataset.features;
+        model->num_samples = (uint32_t) dataset.header.num_samples;
+    }
+    else{
+        uint64_t state = 0x2545F4914F6CDD1DULL;
+        random_features = malloc((size_t) synthetic_samples * conf.trailer.num_features * sizeof(feature_type_t));
+        for(size_t i = 0; NULL != random_features && i < (size_t) synthetic_samples * conf.trailer.num_features; i++){
+            random_features[i] = random_feature(&state);
+        }
+        model->features = random_features;
+        model->num_samples = (uint32_t) synthetic_samples;
+    }
+    if(NULL == model->features || prepare_model(model) != 0){
+        status = EXIT_FAILURE;
+    }
+    if(EXIT_SUCCESS == status && synthetic_trees > 0){
+        model = &models[num_models++];
+        memset(model, 0, sizeof(*model));
+        if(synthetic_model(model, synthetic_trees, synthetic_depth, synthetic_features, synthetic_classes, synthetic_samples, &synthetic_nodes,
+                           &synthetic_features_matrix) != 0 || prepare_model(model) != 0){
+            status = EXIT_FAILURE;
+        }
+    }
+
+    const int num_benchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+    bench_result_t results[2 * sizeof(benchmarks) / sizeof(benchmarks[0])];
+    double* ns_per_sample = malloc((size_t) num_models * num_benchmarks * options.runs * sizeof(double));
+    uint64_t checksum = 0;
+    for(int r = 0; NULL != ns_per_sample && r < num_models * num_benchmarks; r++){
+        results[r].ns_per_sample = &ns_per_sample[(size_t) r * options.runs];
+    }
+    if(EXIT_SUCCESS == status && NULL != ns_per_sample){
+        if(options.json){
+            printf("{\n  \"config\": {\"use_float\": %d, \"use_pointers\": %d, \"compile_pruned\": %d, \"cpu\": %d, \"pinned\": %s, "
+                   "\"runs\": %d, \"warmup\": %d, \"min_run_ms\": %.3f, \"replay_rate\": %.1f, \"replay_seconds\": %.3f},\n  \"results\": [\n",
+                   USE_FLOAT, USE_POINTERS, COMPILE_PRUNED, options.cpu, pinned ? "true" : "false", options.runs, options.warmup, options.min_run_ms,
+                   options.replay_rate, options.replay_seconds);
+        }
+        else if(options.replay_rate > 0){
+            printf("USE_FLOAT=%d USE_POINTERS=%d COMPILE_PRUNED=%d, cpu %d%s, replay of visit_rf_majority_voting at %.1f requests/s for %.1f s\n",
+                   USE_FLOAT, USE_POINTERS, COMPILE_PRUNED, options.cpu, pinned ? "" : " (not pinned)", options.replay_rate, options.replay_seconds);
+        }
+        else{
+            printf("USE_FLOAT=%d USE_POINTERS=%d COMPILE_PRUNED=%d, cpu %d%s, %d runs of at least %.1f ms after %d warmup runs\n",
+                   USE_FLOAT, USE_POINTERS, COMPILE_PRUNED, options.cpu, pinned ? "" : " (not pinned)", options.runs, options.min_run_ms, options.warmup);
+            printf("%-12s %-32s %10s %10s %10s %10s\n", "model", "benchmark (ns/sample)", "min", "median", "p90", "p99");
+        }
+        for(int m = 0; m < num_models && options.replay_rate > 0; m++){
+            run_replay(&models[m], &options, &checksum);
+            if(options.json){
+                printf("%s\n", (m == num_models - 1) ? "" : ",");
+            }
+        }
+        for(int m = 0; m < num_models && 0 == options.replay_rate; m++){
+            for(int b = 0; b < num_benchmarks; b++){
+                run_benchmark(&models[m], benchmarks[b].name, benchmarks[b].fun, &options, &results[m * num_benchmarks + b], &checksum);
+                if(options.json){
+                    printf("%s\n", (m == num_models - 1 && b == num_benchmarks - 1) ? "" : ",");
+                }
+            }
+        }
+        if(options.json){
+            printf("  ],\n  \"checksum\": %llu\n}\n", (unsigned long long) checksum);
+        }
+        else{
+            printf("Checksum %llu\n", (unsigned long long) checksum);
+        }
+        if(0 == options.replay_rate && NULL != options.save_baseline){
+            if(0 == baseline_write(options.save_baseline, results, num_models * num_benchmarks)){
+                fprintf(options.json ? stderr : stdout, "Baseline written to %s\n", options.save_baseline);
+            }
+            else{
+                fprintf(stderr, "Can not write the baseline %s\n", options.save_baseline);
+                status = EXIT_FAILURE;
+            }
+        }
+        // With --json the comparison goes to stderr, so that stdout stays a JSON document.
+        if(0 == options.replay_rate && NULL != options.baseline &&
+           0 != baseline_compare(options.json ? stderr : stdout, &baseline, results, num_models * num_benchmarks, options.regression_threshold, options.alpha)){
+            status = EXIT_FAILURE;
+        }
+    }
+    else{
+        printf("Allocation failed\n");
+        status = EXIT_FAILURE;
+    }
+
+    free(ns_per_sample);
+    baseline_free(&baseline);
+    for(int m = 0; m < num_models; m++){
+        free(models[m].class_per_tree);
+        free(models[m].results);
+    }
+    if(num_models > 1){
+        free(models[1].trees);
+    }
+    free(synthetic_nodes);
+    free(synthetic_features_matrix);
+    free(random_features);
+    if(has_dataset){
+        free_tree_dataset(&dataset);
+    }
+    free_tree_conf(&conf);
+    return status;
+}
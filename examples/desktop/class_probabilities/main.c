@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../../../src/tree_conf.h"
+#include "../../../src/tree_visit.h"
+#define FILENAME "statlog_rf5_proba.bin"
+#include "../inference_accuracy/model_test.h"
+
+/**
+ * @brief Returns the absolute difference of two probabilities.
+ */
+static float abs_diff(const float a, const float b){
+    return (a > b) ? a - b : b - a;
+}
+
+/**
+ * @brief Returns the index of the most probable class.
+ */
+static class_t argmax(const float* const probabilities, const uint16_t number_classes){
+    class_t max_class = 0;
+    for(uint16_t c = 1; c < number_classes; c++){
+        if(probabilities[c] > probabilities[max_class]){
+            max_class = c;
+        }
+    }
+    return max_class;
+}
+
+/**
+ * @brief Checks that the votes of a leaf with a class out of the distribution (e.g. of a tree built without load_tree_conf) are not counted.
+ * @return uint16_t Number of mismatches.
+ */
+static uint16_t check_invalid_class(const uint16_t number_classes, const feature_type_t* const sample){
+#if USE_POINTERS
+    node_t leaf = {.class = (class_t) number_classes, .left_child = NULL, .right_child = NULL};
+#else
+    node_t leaf = {.class = (class_t) number_classes, .left_node = -1, .right_node = -1};
+#endif
+    node_t* trees[] = {&leaf};
+    float probabilities[number_classes];
+    uint16_t mismatches = 0;
+    if(CLASSIFICATION_INVALID_CLASS != visit_rf_class_probabilities(trees, 1, number_classes, NULL, sample, probabilities)){
+        mismatches++;
+    }
+    if(CLASSIFICATION_INVALID_CLASS != visit_rf_class_probabilities_batch(trees, 1, number_classes, NULL, sample, 1, 0, probabilities)){
+        mismatches++;
+    }
+    for(uint16_t c = 0; c < number_classes; c++){
+        mismatches += (0.0f != probabilities[c]);
+    }
+    return mismatches;
+}
+
+int main() {
+    tree_conf_t conf;
+    if(load_tree_conf(FILENAME, &conf) != CONF_OK){
+        printf("Error loading %s\n", FILENAME);
+        return EXIT_FAILURE;
+    }
+    if(NULL == conf.leaf_probabilities){
+        printf("The binary does not contain the leaf distributions\n");
+        free_tree_conf(&conf);
+        return EXIT_FAILURE;
+    }
+    const uint16_t number_classes = conf.trailer.num_classes;
+    printf("Num Classes: %u\n", number_classes);
+    printf("Num Features: %u\n", conf.trailer.num_features);
+    printf("Num Trees: %u\n", conf.trailer.num_trees);
+
+    // Batched soft voting, using the leaf distributions.
+    float* batch_probabilities = (float *) malloc(num_inputs * number_classes * sizeof(float));
+    visit_rf_class_probabilities_batch(conf.trees, conf.trailer.num_trees, number_classes, (const float **) conf.leaf_probabilities,
+                                        &inputs[0][0], num_inputs, conf.trailer.num_features, batch_probabilities);
+
+    float probabilities[number_classes];
+    float vote_fractions[number_classes];
+    class_t classification_result;
+    uint16_t num_votes;
+    uint16_t correctly_classified = 0;
+    uint16_t mismatches = 0;
+    for(unsigned int i = 0; i < num_inputs; i++){
+        visit_rf_class_probabilities(conf.trees, conf.trailer.num_trees, number_classes, (const float **) conf.leaf_probabilities, inputs[i], probabilities);
+        visit_rf_class_probabilities(conf.trees, conf.trailer.num_trees, number_classes, NULL, inputs[i], vote_fractions);
+        visit_rf_majority_voting(conf.trees, conf.trailer.num_trees, inputs[i], &classification_result, &num_votes);
+        // The single sample and batched versions must agree, the vote fraction of the majority class must match the votes.
+        for(uint16_t c = 0; c < number_classes; c++){
+            if(abs_diff(probabilities[c], batch_probabilities[i * number_classes + c]) > 1e-6f){
+                mismatches++;
+            }
+        }
+        if(abs_diff(vote_fractions[classification_result], (float) num_votes / conf.trailer.num_trees) > 1e-6f){
+            mismatches++;
+        }
+        if(argmax(probabilities, number_classes) == dataset_outs[i]){
+            correctly_classified++;
+        }
+        printf("Sample %d, Class: %d, Probability: %f\n", i, argmax(probabilities, number_classes), probabilities[argmax(probabilities, number_classes)]);
+    }
+    mismatches += check_invalid_class(number_classes, inputs[0]);
+    printf("Number of mismatches between the voting functions %u\n", mismatches);
+    printf("Number of correctly classified samples %u Accuracy : %f \n",correctly_classified, ((float) correctly_classified / num_inputs)*100);
+
+    free(batch_probabilities);
+    free_tree_conf(&conf);
+    return (0 == mismatches) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,109 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+#include "dtc.hpp"
+#define DOUBLE_MODEL_FILENAME "../inference_accuracy/statlog_rf5.bin"
+#define FLOAT_MODEL_FILENAME "../test_float_feat/statlog_rf5.bin"
+#define DATASET_FILENAME "../dataset_accuracy/test_dataset.dtcd"
+
+/**
+ * Computes the accuracy of a forest on the samples, using the batch interface.
+ */
+template <typename FeatureT>
+static double accuracy(const dtc::Forest<FeatureT>& forest, std::span<const FeatureT> features, std::span<const std::int16_t> labels) {
+    std::vector<std::int16_t> classes(labels.size());
+    forest.predict(features, classes);
+    std::size_t correctly_classified = 0;
+    for (std::size_t i = 0; i < labels.size(); i++) {
+        correctly_classified += (classes[i] == labels[i]);
+    }
+    return (static_cast<double>(correctly_classified) / labels.size()) * 100;
+}
+
+/**
+ * Writes a binary of 2 classes and 1 feature with a tree per element of trees, and returns whether dtc::Forest loads it.
+ */
+static bool loads(const std::vector<std::vector<dtc::node<double>>>& trees) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "cpp_forest_check.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        const std::uint16_t trailer[3] = {2, 1, static_cast<std::uint16_t>(trees.size())};
+        file.write(reinterpret_cast<const char*>(trailer), sizeof(trailer));
+        for (const std::vector<dtc::node<double>>& tree : trees) {
+            const std::uint16_t num_nodes = static_cast<std::uint16_t>(tree.size());
+            file.write(reinterpret_cast<const char*>(&num_nodes), sizeof(num_nodes));
+            file.write(reinterpret_cast<const char*>(tree.data()), static_cast<std::streamsize>(tree.size() * sizeof(dtc::node<double>)));
+        }
+    }
+    bool loaded = true;
+    try {
+        const dtc::Forest<double> forest(path);
+    }
+    catch (const dtc::error&) {
+        loaded = false;
+    }
+    std::filesystem::remove(path);
+    return loaded;
+}
+
+/**
+ * Checks that the binaries rejected by load_tree_conf are rejected by dtc::Forest too, as its visits do not check the nodes.
+ */
+static bool check_invalid_models() {
+    const dtc::node<double> split{dtc::op::less_or_equal, 0, 0, 1, 2, 0.5};
+    const dtc::node<double> leaf{dtc::op::less_or_equal, 0, 1, -1, -1, 0.0};
+    const dtc::node<double> bad_class_leaf{dtc::op::less_or_equal, 0, 2, -1, -1, 0.0};
+    const bool valid = loads({{split, leaf, leaf}});
+    const bool bad_class = loads({{split, leaf, bad_class_leaf}});
+    const bool empty_tree = loads({{leaf}, {}});
+    std::printf("Invalid models: valid %s, leaf class out of range %s, empty tree %s\n", valid ? "loaded" : "rejected",
+                bad_class ? "loaded" : "rejected", empty_tree ? "loaded" : "rejected");
+    return valid && !bad_class && !empty_tree;
+}
+
+/**
+ * Serves a double and a float model from the same program, which is not possible with the C interface as the feature type is fixed by USE_FLOAT.
+ * Usage: ./main [double_model.bin] [float_model.bin] [double_dataset.dtcd]
+ * The samples of the double dataset are converted to float for the float model.
+ */
+int main(int argc, char** argv) {
+    const char* double_model_path = (argc > 1) ? argv[1] : DOUBLE_MODEL_FILENAME;
+    const char* float_model_path = (argc > 2) ? argv[2] : FLOAT_MODEL_FILENAME;
+    const char* dataset_path = (argc > 3) ? argv[3] : DATASET_FILENAME;
+    if (!check_invalid_models()) {
+        return EXIT_FAILURE;
+    }
+    try {
+        const dtc::Forest<double> double_forest(double_model_path);
+        const dtc::Forest<float> float_forest(float_model_path);
+        const dtc::Dataset<double> dataset(dataset_path);
+        if (dataset.labels().empty() || dataset.num_features() != double_forest.num_features() || dataset.num_features() != float_forest.num_features()) {
+            std::printf("The dataset has %u features, the models %u and %u, or it has no labels\n", dataset.num_features(),
+                        double_forest.num_features(), float_forest.num_features());
+            return EXIT_FAILURE;
+        }
+        const std::vector<float> float_features(dataset.features().begin(), dataset.features().end());
+        std::printf("Num Trees: %u %u\n", double_forest.num_trees(), float_forest.num_trees());
+        std::printf("Num Samples: %zu\n", dataset.num_samples());
+
+        // The first sample is also classified alone, and by each tree.
+        const std::int16_t first_class = double_forest.predict(dataset.features().first(dataset.num_features()));
+        std::printf("First sample: class %d, label %d, leaves", first_class, dataset.labels()[0]);
+        for (std::size_t t = 0; t < double_forest.num_trees(); t++) {
+            std::printf(" %d", double_forest.leaf(t, dataset.features().first(dataset.num_features())).class_result);
+        }
+        std::printf("\n");
+
+        std::printf("Double model Accuracy : %f \n", accuracy(double_forest, dataset.features(), dataset.labels()));
+        std::printf("Float model Accuracy : %f \n", accuracy<float>(float_forest, float_features, dataset.labels()));
+    }
+    catch (const std::exception& e) {
+        std::printf("Error: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
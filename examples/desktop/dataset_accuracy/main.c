@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../../../src/tree_conf.h"
+#include "../../../src/tree_dataset.h"
+#include "../../../src/tree_visit.h"
+#define MODEL_FILENAME "../inference_accuracy/statlog_rf5.bin"
+#define DATASET_FILENAME "test_dataset.dtcd"
+
+/**
+ * Computes the accuracy of a model on a binary dataset generated by the dtc_pygen gen_test_bin command.
+ * Usage: ./main [model.bin] [dataset.dtcd]
+ * The dataset must be generated with the feature type of the build, i.e. double as USE_FLOAT=0.
+ */
+int main(int argc, char** argv) {
+    const char* model_path = (argc > 1) ? argv[1] : MODEL_FILENAME;
+    const char* dataset_path = (argc > 2) ? argv[2] : DATASET_FILENAME;
+    tree_conf_t conf;
+    if(load_tree_conf(model_path, &conf) != CONF_OK){
+        printf("Error loading %s\n", model_path);
+        return EXIT_FAILURE;
+    }
+    tree_dataset_t dataset;
+    int status = load_tree_dataset(dataset_path, &dataset);
+    if(status != DATASET_OK){
+        printf("Error loading %s: %s\n", dataset_path, (DATASET_ERR_TYPE == status) ? "feature type mismatch" : "invalid dataset");
+        free_tree_conf(&conf);
+        return EXIT_FAILURE;
+    }
+    if(dataset.header.num_features != conf.trailer.num_features || NULL == dataset.labels){
+        printf("The dataset has %u features instead of %u, or it has no labels\n", dataset.header.num_features, conf.trailer.num_features);
+        free_tree_dataset(&dataset);
+        free_tree_conf(&conf);
+        return EXIT_FAILURE;
+    }
+    printf("Num Trees: %u\n", conf.trailer.num_trees);
+    printf("Num Samples: %llu\n", (unsigned long long) dataset.header.num_samples);
+
+    class_t classification_result;
+    uint16_t num_votes;
+    uint64_t correctly_classified = 0;
+    for(uint64_t i = 0; i < dataset.header.num_samples; i++){
+        status = visit_rf_majority_voting(conf.trees, conf.trailer.num_trees, &dataset.features[i * dataset.header.num_features], &classification_result, &num_votes);
+        if(status != CLASSIFICATION_OK){
+            printf("Classification failed for sample %llu\n", (unsigned long long) i);
+            break;
+        }
+        if(classification_result == dataset.labels[i]){
+            correctly_classified++;
+        }
+    }
+    printf("Number of correctly classified samples %llu Accuracy : %f \n", (unsigned long long) correctly_classified,
+            ((double) correctly_classified / dataset.header.num_samples) * 100);
+
+    free_tree_dataset(&dataset);
+    free_tree_conf(&conf);
+    return (status == CLASSIFICATION_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,93 @@
+#include "dtc_engine.h"
+#include "dtc.hpp"
+#if !USE_FLOAT
+#include "../embedded_forest/statlog_rf5_forest.hpp"
+#endif
+
+#if USE_FLOAT
+using feature_t = float;
+#else
+using feature_t = double;
+#endif
+
+/** Features of a matrix of samples of forest. */
+static std::span<const feature_t> matrix(const dtc::Forest<feature_t>& forest, const void* features, uint32_t num_samples) {
+    return {static_cast<const feature_t*>(features), static_cast<std::size_t>(num_samples) * forest.num_features()};
+}
+
+int dtc_hpp_leaf_indices(const char* model_path, const void* features, uint32_t num_samples, int32_t* leaf_indices) {
+    try {
+        const dtc::Forest<feature_t> forest(model_path);
+        const feature_t* const samples = static_cast<const feature_t*>(features);
+        for (uint32_t s = 0; s < num_samples; s++) {
+            for (std::size_t t = 0; t < forest.num_trees(); t++) {
+                leaf_indices[static_cast<std::size_t>(s) * forest.num_trees() + t] =
+                    static_cast<int32_t>(forest.leaf_index(t, &samples[static_cast<std::size_t>(s) * forest.num_features()]));
+            }
+        }
+        return 0;
+    } catch (const dtc::error&) {
+        return -1;
+    }
+}
+
+int dtc_hpp_predict(const char* model_path, const void* features, uint32_t num_samples, int16_t* classes, uint16_t* votes) {
+    try {
+        const dtc::Forest<feature_t> forest(model_path);
+        forest.predict(matrix(forest, features, num_samples), std::span<int16_t>(classes, num_samples), std::span<uint16_t>(votes, num_samples));
+        return 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+int dtc_hpp_predict_proba(const char* model_path, const void* features, uint32_t num_samples, float* probabilities) {
+    try {
+        const dtc::Forest<feature_t> forest(model_path);
+        forest.predict_proba(matrix(forest, features, num_samples),
+                             std::span<float>(probabilities, static_cast<std::size_t>(num_samples) * forest.num_classes()));
+        return 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+int dtc_hpp_predict_mean(const char* model_path, const void* features, uint32_t num_samples, void* means) {
+    try {
+        const dtc::Forest<feature_t> forest(model_path);
+        forest.predict_mean(matrix(forest, features, num_samples), std::span<feature_t>(static_cast<feature_t*>(means), num_samples));
+        return 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+int dtc_hpp_predict_gbdt(const char* model_path, const void* features, uint32_t num_samples, void* outputs) {
+    try {
+        const dtc::Forest<feature_t> forest(model_path);
+        forest.predict_gbdt(matrix(forest, features, num_samples),
+                            std::span<feature_t>(static_cast<feature_t*>(outputs), static_cast<std::size_t>(num_samples) * forest.num_outputs()));
+        return 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+int dtc_embedded_statlog(const void* features, uint32_t num_samples, int32_t* leaf_indices, int16_t* classes, uint16_t* votes) {
+#if USE_FLOAT
+    (void) features, (void) num_samples, (void) leaf_indices, (void) classes, (void) votes;
+    return -1;
+#else
+    using embedded = statlog_rf5_forest::forest;
+    const double* const samples = static_cast<const double*>(features);
+    for (uint32_t s = 0; s < num_samples; s++) {
+        const embedded::sample_type sample(&samples[static_cast<std::size_t>(s) * embedded::num_features], embedded::num_features);
+        const auto leaves = embedded::leaf_indices(sample);
+        for (std::size_t t = 0; t < embedded::num_trees; t++) {
+            leaf_indices[static_cast<std::size_t>(s) * embedded::num_trees + t] = static_cast<int32_t>(leaves[t]);
+        }
+        classes[s] = embedded::predict(sample, &votes[s]);
+    }
+    return 0;
+#endif
+}
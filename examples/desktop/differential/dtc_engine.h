@@ -0,0 +1,68 @@
+#ifndef DTC_ENGINE_H
+#define DTC_ENGINE_H
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Visits every tree of the binary at model_path with dtc::Forest (dtc.hpp) for each sample.
+ *
+ * @param[in] model_path Binary configuration, with the feature type of the build (USE_FLOAT).
+ * @param[in] features Row-major [num_samples x num_features] matrix of feature_type_t.
+ * @param[in] num_samples Number of samples.
+ * @param[out] leaf_indices Row-major [num_samples x num_trees] indexes of the reached leaves, relative to their root.
+ * @return int 0 on success, -1 if the forest can not be loaded.
+ */
+int dtc_hpp_leaf_indices(const char* model_path, const void* features, uint32_t num_samples, int32_t* leaf_indices);
+
+/**
+ * @brief Majority voting of dtc::Forest::predict on a matrix of samples.
+ *
+ * @param[out] classes Class of each sample, -1 without votes.
+ * @param[out] votes Votes of the class of each sample.
+ * @return int 0 on success, -1 if the forest can not be loaded or it is not a classification forest.
+ */
+int dtc_hpp_predict(const char* model_path, const void* features, uint32_t num_samples, int16_t* classes, uint16_t* votes);
+
+/**
+ * @brief Class distributions of dtc::Forest::predict_proba on a matrix of samples.
+ *
+ * @param[out] probabilities Row-major [num_samples x num_classes] matrix.
+ * @return int 0 on success, -1 if the forest can not be loaded or it is not a classification forest.
+ */
+int dtc_hpp_predict_proba(const char* model_path, const void* features, uint32_t num_samples, float* probabilities);
+
+/**
+ * @brief Means of dtc::Forest::predict_mean on a matrix of samples.
+ *
+ * @param[out] means Mean of each sample, of feature_type_t.
+ * @return int 0 on success, -1 if the forest can not be loaded.
+ */
+int dtc_hpp_predict_mean(const char* model_path, const void* features, uint32_t num_samples, void* means);
+
+/**
+ * @brief Transformed margins of dtc::Forest::predict_gbdt on a matrix of samples.
+ *
+ * @param[out] outputs Row-major [num_samples x num_outputs] matrix of feature_type_t.
+ * @return int 0 on success, -1 if the forest can not be loaded or it is not a boosted model.
+ */
+int dtc_hpp_predict_gbdt(const char* model_path, const void* features, uint32_t num_samples, void* outputs);
+
+/**
+ * @brief Visits the statlog rf_5 forest embedded by gen_cpp (examples/desktop/embedded_forest) with dtc::embedded_forest for each sample.
+ *
+ * @param[in] features Row-major [num_samples x num_features] matrix of double.
+ * @param[out] leaf_indices Row-major [num_samples x num_trees] indexes of the reached leaves, relative to their root.
+ * @param[out] classes Majority voting class of each sample.
+ * @param[out] votes Votes of the class of each sample.
+ * @return int 0 on success, -1 in the float builds, as the embedded forest has double features.
+ */
+int dtc_embedded_statlog(const void* features, uint32_t num_samples, int32_t* leaf_indices, int16_t* classes, uint16_t* votes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
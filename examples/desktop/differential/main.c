@@ -0,0 +1,1085 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../../src/tree_boost.h"
+#include "../../../src/tree_conf.h"
+#include "../../../src/tree_visit.h"
+#include "dtc_engine.h"
+#if USE_FLOAT
+#define STATLOG_MODEL_FILENAME "../test_float_feat/statlog_rf5.bin"
+#define NEXTAFTER(x, y) nextafterf(x, y)
+#define TOLERANCE 1e-4
+#else
+#define STATLOG_MODEL_FILENAME "../inference_accuracy/statlog_rf5.bin"
+#define NEXTAFTER(x, y) nextafter(x, y)
+#define TOLERANCE 1e-9
+#endif
+#define NUM_SAMPLES 2000
+#define MAX_REPORTS 10
+#define TRACE_MAGIC 0x54435444U     /**< "DTCT" */
+
+/**
+ * @brief Node of the reference model, read from the binary independently of the library layout (thresholds are widened to double).
+ */
+typedef struct{
+    uint16_t operator;
+    uint16_t feature_index;
+    int16_t class;
+    int32_t left_node;
+    int32_t right_node;
+    double threshold;
+} ref_node_t;
+
+/**
+ * @brief Reference model: the trees of a binary, with its optional leaf distributions and boosting structure.
+ */
+typedef struct{
+    char name[64];
+    char path[256];
+    uint8_t exact;                  /**< Samples use only values exact in float and double, so that the float and double builds are comparable. */
+    uint8_t embedded;               /**< The model is the statlog forest embedded by gen_cpp in examples/desktop/embedded_forest. */
+    uint16_t num_classes;
+    uint16_t num_features;
+    uint16_t num_trees;
+    uint32_t* offsets;              /**< Index of the root of each tree in nodes. */
+    uint16_t* sizes;                /**< Number of nodes of each tree. */
+    ref_node_t* nodes;
+    float* leaf_probabilities;      /**< [nodes x num_classes] leaf distributions, NULL if absent. */
+    uint8_t boosted;
+    uint16_t objective;
+    uint16_t num_outputs;
+    double* base_scores;
+    uint16_t* tree_outputs;
+} ref_model_t;
+
+/**
+ * @brief Header of a trace, the reached leaf of every (sample, tree) of a build, compared by --compare with the trace of another build.
+ */
+typedef struct{
+    uint32_t magic;
+    uint32_t feature_size;
+    uint32_t num_samples;
+    uint16_t num_trees;
+    uint16_t reserved;
+    char model_path[256];
+    char flags[64];
+} trace_header_t;
+
+/**
+ * @brief Counters of the checks of an engine.
+ */
+typedef struct{
+    const char* model;
+    const char* engine;
+    uint64_t checks;
+    uint64_t mismatches;
+} check_t;
+
+static uint64_t total_checks = 0;
+static uint64_t total_mismatches = 0;
+
+static uint64_t xorshift64(uint64_t* const state){
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------------------------ */
+/* Reference model                                                                                                                      */
+/* ------------------------------------------------------------------------------------------------------------------------------------ */
+
+static void ref_free(ref_model_t* const model){
+    free(model->offsets);
+    free(model->sizes);
+    free(model->nodes);
+    free(model->leaf_probabilities);
+    free(model->base_scores);
+    free(model->tree_outputs);
+    memset(model, 0, sizeof(*model));
+}
+
+static int read_value(FILE* const file, void* const value, const size_t size){
+    return fread(value, size, 1, file) == 1 ? 0 : -1;
+}
+
+static int read_real(FILE* const file, const uint32_t feature_size, double* const value){
+    if(4 == feature_size){
+        float single;
+        int to_ret = read_value(file, &single, sizeof(single));
+        *value = single;
+        return to_ret;
+    }
+    return read_value(file, value, sizeof(double));
+}
+
+/**
+ * @brief Reads a binary configuration with thresholds of feature_size bytes, with explicit field offsets instead of the node_t layout.
+ */
+static int ref_load(const char* const path, const uint32_t feature_size, ref_model_t* const model){
+    memset(model, 0, sizeof(*model));
+    snprintf(model->path, sizeof(model->path), "%s", path);
+    FILE* file = fopen(path, "rb");
+    if(NULL == file){
+        return -1;
+    }
+    int to_ret = read_value(file, &model->num_classes, 2) | read_value(file, &model->num_features, 2) | read_value(file, &model->num_trees, 2);
+    model->offsets = calloc(model->num_trees + 1, sizeof(uint32_t));
+    model->sizes = calloc(model->num_trees + 1, sizeof(uint16_t));
+    uint32_t total = 0;
+    for(uint16_t t = 0; 0 == to_ret && NULL != model->offsets && NULL != model->sizes && t < model->num_trees; t++){
+        to_ret |= read_value(file, &model->sizes[t], 2);
+        model->offsets[t] = total;
+        total += model->sizes[t];
+        ref_node_t* nodes = realloc(model->nodes, (total + 1) * sizeof(ref_node_t));
+        if(NULL == nodes){
+            to_ret = -1;
+            break;
+        }
+        model->nodes = nodes;
+        for(uint32_t i = model->offsets[t]; 0 == to_ret && i < total; i++){
+            uint16_t padding;
+            ref_node_t* const n = &model->nodes[i];
+            to_ret |= read_value(file, &n->operator, 2) | read_value(file, &n->feature_index, 2) | read_value(file, &n->class, 2);
+            to_ret |= read_value(file, &padding, 2) | read_value(file, &n->left_node, 4) | read_value(file, &n->right_node, 4);
+            to_ret |= read_real(file, feature_size, &n->threshold);
+            if(n->left_node < -1 || n->left_node >= model->sizes[t] || n->right_node < -1 || n->right_node >= model->sizes[t]){
+                to_ret = -1;
+            }
+        }
+    }
+    if(NULL == model->offsets || NULL == model->sizes){
+        to_ret = -1;
+    }
+    uint16_t section[4];
+    while(0 == to_ret && fread(section, sizeof(uint16_t), 4, file) == 4){
+        uint32_t section_size = (uint32_t) section[2] | ((uint32_t) section[3] << 16);
+        if(BIN_SECTION_LEAF_PROBA == section[0] && section_size == total * model->num_classes * sizeof(float)){
+            model->leaf_probabilities = malloc(section_size + 1);
+            to_ret = (NULL == model->leaf_probabilities) ? -1 : read_value(file, model->leaf_probabilities, section_size);
+        }
+        else if(BIN_SECTION_BOOSTING == section[0]){
+            model->boosted = 1;
+            to_ret = read_value(file, &model->objective, 2) | read_value(file, &model->num_outputs, 2);
+            model->base_scores = calloc(model->num_outputs + 1, sizeof(double));
+            model->tree_outputs = calloc(model->num_trees + 1, sizeof(uint16_t));
+            for(uint16_t o = 0; 0 == to_ret && NULL != model->base_scores && o < model->num_outputs; o++){
+                to_ret = read_real(file, feature_size, &model->base_scores[o]);
+            }
+            to_ret |= (NULL == model->tree_outputs) ? -1 : (fread(model->tree_outputs, sizeof(uint16_t), model->num_trees, file) == model->num_trees ? 0 : -1);
+        }
+        else{
+            to_ret = -1;
+        }
+    }
+    fclose(file);
+    if(0 != to_ret){
+        ref_free(model);
+    }
+    return to_ret;
+}
+
+static int ref_compare(const uint16_t operator, const double a, const double b){
+    switch(operator){
+        case 0: return a <= b;
+        case 1: return a < b;
+        case 2: return a >= b;
+        case 3: return a > b;
+        case 4: return a == b;
+        default: return a != b;
+    }
+}
+
+/**
+ * @brief Visits a tree, storing the visited nodes in path (at most the size of the tree, so that cycles end). Returns the reached leaf, -1 if none.
+ */
+static int32_t ref_visit(const ref_model_t* const model, const uint16_t tree, const double* const sample, int32_t* const path, uint32_t* const path_length){
+    const ref_node_t* const root = &model->nodes[model->offsets[tree]];
+    int32_t current = 0;
+    uint32_t length = 0;
+    while(length < model->sizes[tree]){
+        path[length++] = current;
+        const ref_node_t* const n = &root[current];
+        if(-1 == n->left_node && -1 == n->right_node){
+            *path_length = length;
+            return current;
+        }
+        current = ref_compare(n->operator, sample[n->feature_index], n->threshold) ? n->left_node : n->right_node;
+    }
+    *path_length = length;
+    return -1;
+}
+
+/**
+ * @brief Returns 1 if target is reachable from node in a tree, i.e. if node is an ancestor of the target (trees may be DAGs).
+ */
+static int ref_reaches(const ref_model_t* const model, const uint16_t tree, const int32_t node, const int32_t target, uint8_t* const visited){
+    if(node < 0 || visited[node]){
+        return 0;
+    }
+    visited[node] = 1;
+    if(node == target){
+        return 1;
+    }
+    const ref_node_t* const n = &model->nodes[model->offsets[tree] + node];
+    return ref_reaches(model, tree, n->left_node, target, visited) || ref_reaches(model, tree, n->right_node, target, visited);
+}
+
+static int reaches(const ref_model_t* const model, const uint16_t tree, const int32_t node, const int32_t target){
+    uint8_t* visited = calloc(model->sizes[tree] + 1, 1);
+    int to_ret = (NULL != visited) && ref_reaches(model, tree, node, target, visited);
+    free(visited);
+    return to_ret;
+}
+
+static const char* operator_name(const uint16_t operator){
+    static const char* const names[] = {"<=", "<", ">=", ">", "==", "!="};
+    return (operator < 6) ? names[operator] : "?";
+}
+
+/**
+ * @brief Prints where the path of the reference leaf and the leaf reached by an engine diverged: the deepest node of the reference path
+ *        from which the other leaf is still reachable, with its split and the value of the sample.
+ */
+static void report_divergence(const ref_model_t* const model, const uint16_t tree, const double* const sample, const int32_t* const path,
+                              const uint32_t path_length, const int32_t other_leaf, const char* const reference, const char* const engine){
+    if(other_leaf < 0 || other_leaf >= model->sizes[tree]){
+        printf("      %s reached node %d, out of the %u nodes of the tree\n", engine, other_leaf, model->sizes[tree]);
+        return;
+    }
+    int32_t last_common = -1;
+    uint32_t position = 0;
+    for(uint32_t i = 0; i < path_length; i++){
+        if(reaches(model, tree, path[i], other_leaf)){
+            last_common = path[i];
+            position = i;
+        }
+    }
+    if(last_common < 0){
+        printf("      %s reached leaf %d, not reachable from the root\n", engine, other_leaf);
+        return;
+    }
+    const ref_node_t* const n = &model->nodes[model->offsets[tree] + last_common];
+    const char* reference_side = (position + 1 < path_length && path[position + 1] == n->left_node) ? "left" : "right";
+    const char* engine_side = reaches(model, tree, n->left_node, other_leaf) ? "left" : "right";
+    printf("      paths diverge at node %d (depth %u): feature %u %s %.17g with value %.17g, %s went %s to leaf %d, %s went %s to leaf %d\n",
+           last_common, position, n->feature_index, operator_name(n->operator), n->threshold, sample[n->feature_index],
+           reference, reference_side, path[path_length - 1], engine, engine_side, other_leaf);
+}
+
+/* ------------------------------------------------------------------------------------------------------------------------------------ */
+/* Synthetic models and samples                                                                                                         */
+/* ------------------------------------------------------------------------------------------------------------------------------------ */
+
+/**
+ * @brief Adds a random subtree in pre-order, returning its index. Thresholds are multiples of 1/64, exact in float and double.
+ */
+static int32_t synthetic_subtree(ref_model_t* const model, uint32_t* const count, const uint32_t capacity, const uint32_t base, const uint16_t depth,
+                                 const uint16_t max_depth, uint64_t* const state){
+    int32_t index = (int32_t) (*count - base);
+    ref_node_t* n = &model->nodes[(*count)++];
+    uint8_t leaf = depth >= max_depth || *count + 2 > capacity || (depth > 0 && xorshift64(state) % 100 < 10U + 6U * depth);
+    memset(n, 0, sizeof(*n));
+    if(leaf){
+        n->left_node = n->right_node = -1;
+        n->class = (model->num_classes > 0) ? (int16_t) (xorshift64(state) % model->num_classes) : 0;
+        n->threshold = ((int) (xorshift64(state) % 256) - 128) / 64.0;
+        return index;
+    }
+    n->operator = (uint16_t) (xorshift64(state) % 6);
+    n->feature_index = (uint16_t) (xorshift64(state) % model->num_features);
+    n->threshold = ((int) (xorshift64(state) % 192) - 64) / 64.0;
+    int32_t left = synthetic_subtree(model, count, capacity, base, depth + 1, max_depth, state);
+    int32_t right = synthetic_subtree(model, count, capacity, base, depth + 1, max_depth, state);
+    n = &model->nodes[base + index];
+    n->left_node = left;
+    n->right_node = right;
+    return index;
+}
+
+/**
+ * @brief Builds a random forest using every operator. The first tree is a single leaf. num_classes 0 builds a regression forest,
+ *        leaf_probabilities adds random leaf distributions and num_outputs > 0 a softmax boosting structure.
+ */
+static int synthetic_model(ref_model_t* const model, const char* const name, const uint16_t num_trees, const uint16_t max_depth, const uint16_t num_features,
+                           const uint16_t num_classes, const uint8_t leaf_probabilities, const uint16_t num_outputs, uint64_t seed){
+    memset(model, 0, sizeof(*model));
+    snprintf(model->name, sizeof(model->name), "%s", name);
+    model->exact = 1;
+    model->num_trees = num_trees;
+    model->num_features = num_features;
+    model->num_classes = num_classes;
+    uint32_t capacity_per_tree = 2U << max_depth;
+    capacity_per_tree = (capacity_per_tree > 4095) ? 4095 : capacity_per_tree;
+    model->offsets = calloc(num_trees + 1, sizeof(uint32_t));
+    model->sizes = calloc(num_trees + 1, sizeof(uint16_t));
+    model->nodes = malloc((size_t) num_trees * capacity_per_tree * sizeof(ref_node_t));
+    if(NULL == model->offsets || NULL == model->sizes || NULL == model->nodes){
+        return -1;
+    }
+    uint32_t count = 0;
+    for(uint16_t t = 0; t < num_trees; t++){
+        model->offsets[t] = count;
+        synthetic_subtree(model, &count, count + capacity_per_tree, count, 0, (0 == t) ? 0 : max_depth, &seed);
+        model->sizes[t] = (uint16_t) (count - model->offsets[t]);
+    }
+    if(leaf_probabilities){
+        model->leaf_probabilities = calloc((size_t) count * num_classes + 1, sizeof(float));
+        if(NULL == model->leaf_probabilities){
+            return -1;
+        }
+        for(uint32_t i = 0; i < count; i++){
+            for(uint16_t c = 0; -1 == model->nodes[i].left_node && c < num_classes; c++){
+                model->leaf_probabilities[(size_t) i * num_classes + c] = (float) (xorshift64(&seed) % 65) / 64.0f;
+            }
+        }
+    }
+    if(num_outputs > 0){
+        model->boosted = 1;
+        model->objective = BOOSTING_OBJECTIVE_SOFTMAX;
+        model->num_outputs = num_outputs;
+        model->base_scores = calloc(num_outputs, sizeof(double));
+        model->tree_outputs = calloc(num_trees, sizeof(uint16_t));
+        if(NULL == model->base_scores || NULL == model->tree_outputs){
+            return -1;
+        }
+        for(uint16_t o = 0; o < num_outputs; o++){
+            model->base_scores[o] = ((int) (xorshift64(&seed) % 64) - 32) / 64.0;
+        }
+        for(uint16_t t = 0; t < num_trees; t++){
+            model->tree_outputs[t] = t % num_outputs;
+        }
+    }
+    return 0;
+}
+
+static void write_real(FILE* const file, const double value){
+    feature_type_t converted = (feature_type_t) value;
+    fwrite(&converted, sizeof(converted), 1, file);
+}
+
+/**
+ * @brief Writes a reference model as a binary configuration with the feature type of the build, at model->path.
+ */
+static int write_model(const ref_model_t* const model){
+    FILE* file = fopen(model->path, "wb");
+    if(NULL == file){
+        return -1;
+    }
+    uint16_t trailer[3] = {model->num_classes, model->num_features, model->num_trees};
+    fwrite(trailer, sizeof(uint16_t), 3, file);
+    uint32_t total = 0;
+    for(uint16_t t = 0; t < model->num_trees; t++){
+        fwrite(&model->sizes[t], sizeof(uint16_t), 1, file);
+        for(uint32_t i = model->offsets[t]; i < model->offsets[t] + model->sizes[t]; i++){
+            bin_node_t n;
+            memset(&n, 0, sizeof(n));
+            n.operator = model->nodes[i].operator;
+            n.feature_index = model->nodes[i].feature_index;
+            n.class = model->nodes[i].class;
+            n.left_node = model->nodes[i].left_node;
+            n.right_node = model->nodes[i].right_node;
+            n.threshold = (feature_type_t) model->nodes[i].threshold;
+            fwrite(&n, sizeof(n), 1, file);
+        }
+        total += model->sizes[t];
+    }
+    if(NULL != model->leaf_probabilities){
+        bin_section_t section = {BIN_SECTION_LEAF_PROBA, 0, total * model->num_classes * (uint32_t) sizeof(float)};
+        fwrite(&section, sizeof(section), 1, file);
+        fwrite(model->leaf_probabilities, sizeof(float), (size_t) total * model->num_classes, file);
+    }
+    if(model->boosted){
+        bin_section_t section = {BIN_SECTION_BOOSTING, 0, (uint32_t) (sizeof(bin_boosting_t) + model->num_outputs * sizeof(feature_type_t) +
+                                                                       model->num_trees * sizeof(uint16_t))};
+        bin_boosting_t header = {model->objective, model->num_outputs};
+        fwrite(&section, sizeof(section), 1, file);
+        fwrite(&header, sizeof(header), 1, file);
+        for(uint16_t o = 0; o < model->num_outputs; o++){
+            write_real(file, model->base_scores[o]);
+        }
+        fwrite(model->tree_outputs, sizeof(uint16_t), model->num_trees, file);
+    }
+    return (0 == fclose(file)) ? 0 : -1;
+}
+
+/**
+ * @brief Draws samples around the thresholds of the model: exact ties, NaN, +-inf, signed zeros and random values.
+ *        For exact models values are multiples of 1/128, the same in float and double, otherwise the neighbours of the thresholds
+ *        in the feature type of the build are drawn too. Values are then rounded to the feature type, as seen by the library.
+ */
+static void generate_samples(const ref_model_t* const model, const uint32_t num_samples, uint64_t seed, double* const samples){
+    uint32_t total = model->offsets[model->num_trees - 1] + model->sizes[model->num_trees - 1];
+    for(size_t i = 0; i < (size_t) num_samples * model->num_features; i++){
+        uint16_t feature = (uint16_t) (i % model->num_features);
+        const ref_node_t* n = &model->nodes[xorshift64(&seed) % total];
+        for(uint32_t tries = 0; tries < 16 && (n->feature_index != feature || -1 == n->left_node); tries++){
+            n = &model->nodes[xorshift64(&seed) % total];
+        }
+        double threshold = (n->feature_index == feature && -1 != n->left_node) ? n->threshold : 0.0;
+        uint64_t choice = xorshift64(&seed) % 100;
+        double value;
+        if(choice < 35){
+            value = threshold;
+        }
+        else if(choice < 40){
+            value = NAN;
+        }
+        else if(choice < 45){
+            value = INFINITY;
+        }
+        else if(choice < 50){
+            value = -INFINITY;
+        }
+        else if(choice < 55){
+            value = (choice & 1) ? -0.0 : 0.0;
+        }
+        else if(choice < 70 && !model->exact){
+            value = NEXTAFTER((feature_type_t) threshold, (choice & 1) ? INFINITY : -INFINITY);
+        }
+        else if(model->exact){
+            value = ((int) (xorshift64(&seed) % 512) - 192) / 128.0;
+        }
+        else{
+            value = threshold + ((double) (xorshift64(&seed) % 2001) / 1000.0 - 1.0) * (fabs(threshold) + 1.0);
+        }
+        samples[i] = (double) (feature_type_t) value;
+    }
+}
+
+/* ------------------------------------------------------------------------------------------------------------------------------------ */
+/* Checks                                                                                                                               */
+/* ------------------------------------------------------------------------------------------------------------------------------------ */
+
+static int report(check_t* const check, const uint8_t equal){
+    check->checks++;
+    if(!equal){
+        check->mismatches++;
+    }
+    return !equal && check->mismatches <= MAX_REPORTS;
+}
+
+static void end_check(const check_t* const check){
+    printf("  %-44s %10llu checks %8llu mismatches\n", check->engine, (unsigned long long) check->checks, (unsigned long long) check->mismatches);
+    total_checks += check->checks;
+    total_mismatches += check->mismatches;
+}
+
+static int close_enough(const double value, const double expected){
+    return fabs(value - expected) <= TOLERANCE * (1.0 + fabs(expected));
+}
+
+/**
+ * @brief Reference outputs of a sample, from the reference leaves of its trees.
+ */
+typedef struct{
+    int32_t* leaves;            /**< [num_samples x num_trees] reference leaves. */
+    int32_t* paths;             /**< [num_samples x num_trees x max_path] reference paths. */
+    uint32_t* path_lengths;     /**< [num_samples x num_trees] lengths of the paths. */
+    uint32_t max_path;
+} ref_visits_t;
+
+static int ref_visit_all(const ref_model_t* const model, const double* const samples, const uint32_t num_samples, ref_visits_t* const visits){
+    visits->max_path = 0;
+    for(uint16_t t = 0; t < model->num_trees; t++){
+        visits->max_path = (model->sizes[t] > visits->max_path) ? model->sizes[t] : visits->max_path;
+    }
+    size_t pairs = (size_t) num_samples * model->num_trees;
+    visits->leaves = malloc(pairs * sizeof(int32_t));
+    visits->paths = malloc(pairs * visits->max_path * sizeof(int32_t));
+    visits->path_lengths = malloc(pairs * sizeof(uint32_t));
+    if(NULL == visits->leaves || NULL == visits->paths || NULL == visits->path_lengths){
+        return -1;
+    }
+    for(uint32_t s = 0; s < num_samples; s++){
+        for(uint16_t t = 0; t < model->num_trees; t++){
+            size_t pair = (size_t) s * model->num_trees + t;
+            visits->leaves[pair] = ref_visit(model, t, &samples[(size_t) s * model->num_features], &visits->paths[pair * visits->max_path],
+                                             &visits->path_lengths[pair]);
+        }
+    }
+    return 0;
+}
+
+static void ref_visits_free(ref_visits_t* const visits){
+    free(visits->leaves);
+    free(visits->paths);
+    free(visits->path_lengths);
+}
+
+static const ref_node_t* ref_leaf(const ref_model_t* const model, const ref_visits_t* const visits, const uint32_t sample, const uint16_t tree){
+    return &model->nodes[model->offsets[tree] + visits->leaves[(size_t) sample * model->num_trees + tree]];
+}
+
+/**
+ * @brief Reference majority voting, with the draw rule of the library: the first class to exceed the previous maximum wins.
+ */
+static class_t ref_majority(const ref_model_t* const model, const ref_visits_t* const visits, const uint32_t sample, uint16_t* const votes){
+    uint16_t counts[model->num_classes > 0 ? model->num_classes : 1];
+    class_t best = -1;
+    memset(counts, 0, sizeof(counts));
+    *votes = 0;
+    for(uint16_t t = 0; t < model->num_trees; t++){
+        class_t c = ref_leaf(model, visits, sample, t)->class;
+        if(c >= 0 && c < model->num_classes && ++counts[c] > *votes){
+            *votes = counts[c];
+            best = c;
+        }
+    }
+    return best;
+}
+
+static void ref_probabilities(const ref_model_t* const model, const ref_visits_t* const visits, const uint32_t sample, double* const probabilities){
+    memset(probabilities, 0, model->num_classes * sizeof(double));
+    for(uint16_t t = 0; t < model->num_trees; t++){
+        const ref_node_t* leaf = ref_leaf(model, visits, sample, t);
+        if(NULL == model->leaf_probabilities){
+            probabilities[leaf->class] += 1.0;
+        }
+        else{
+            const float* row = &model->leaf_probabilities[(size_t) (leaf - model->nodes) * model->num_classes];
+            for(uint16_t c = 0; c < model->num_classes; c++){
+                probabilities[c] += row[c];
+            }
+        }
+    }
+    for(uint16_t c = 0; c < model->num_classes; c++){
+        probabilities[c] /= model->num_trees;
+    }
+}
+
+static double ref_mean(const ref_model_t* const model, const ref_visits_t* const visits, const uint32_t sample){
+    double mean = 0.0;
+    for(uint16_t t = 0; t < model->num_trees; t++){
+        mean += ref_leaf(model, visits, sample, t)->threshold;
+    }
+    return mean / model->num_trees;
+}
+
+static void ref_gbdt(const ref_model_t* const model, const ref_visits_t* const visits, const uint32_t sample, double* const outputs){
+    memcpy(outputs, model->base_scores, model->num_outputs * sizeof(double));
+    for(uint16_t t = 0; t < model->num_trees; t++){
+        outputs[model->tree_outputs[t]] += ref_leaf(model, visits, sample, t)->threshold;
+    }
+    if(BOOSTING_OBJECTIVE_SIGMOID == model->objective){
+        for(uint16_t o = 0; o < model->num_outputs; o++){
+            outputs[o] = 1.0 / (1.0 + exp(-outputs[o]));
+        }
+    }
+    else if(BOOSTING_OBJECTIVE_SOFTMAX == model->objective){
+        double max_margin = outputs[0], sum = 0.0;
+        for(uint16_t o = 1; o < model->num_outputs; o++){
+            max_margin = (outputs[o] > max_margin) ? outputs[o] : max_margin;
+        }
+        for(uint16_t o = 0; o < model->num_outputs; o++){
+            outputs[o] = exp(outputs[o] - max_margin);
+            sum += outputs[o];
+        }
+        for(uint16_t o = 0; o < model->num_outputs; o++){
+            outputs[o] /= sum;
+        }
+    }
+}
+
+/**
+ * @brief Compares the leaves reached by an engine (indexes relative to the roots) with the reference, printing the divergence of the paths.
+ */
+static void check_leaves(const ref_model_t* const model, const ref_visits_t* const visits, const double* const samples, const uint32_t num_samples,
+                         const char* const engine, const int32_t* const leaves){
+    check_t check = {model->name, engine, 0, 0};
+    for(uint32_t s = 0; s < num_samples; s++){
+        for(uint16_t t = 0; t < model->num_trees; t++){
+            size_t pair = (size_t) s * model->num_trees + t;
+            if(report(&check, leaves[pair] == visits->leaves[pair])){
+                printf("    %s: sample %u tree %u reached leaf %d instead of %d\n", engine, s, t, leaves[pair], visits->leaves[pair]);
+                report_divergence(model, t, &samples[(size_t) s * model->num_features], &visits->paths[pair * visits->max_path],
+                                  visits->path_lengths[pair], leaves[pair], "reference", engine);
+            }
+        }
+    }
+    end_check(&check);
+}
+
+/**
+ * @brief Checks every engine of the library on a loaded classifier against the reference. For optimized classifiers the leaves
+ *        are renumbered, so their content is compared instead of their index.
+ */
+static void check_conf(const ref_model_t* const model, const ref_visits_t* const visits, tree_conf_t* const conf, const uint8_t optimized,
+                       const double* const samples, const feature_type_t* const features, const uint32_t num_samples, int32_t* const leaves){
+    char engine[64];
+    const char* prefix = optimized ? "optimized " : "";
+    const uint16_t num_trees = model->num_trees;
+    const size_t num_features = model->num_features;
+
+    // visit_tree_leaf: leaf indexes, or content for optimized classifiers.
+    check_t content = {model->name, "", 0, 0};
+    for(uint32_t s = 0; s < num_samples; s++){
+        for(uint16_t t = 0; t < num_trees; t++){
+            const node_t* leaf_node = NULL;
+            visit_tree_leaf(conf->trees[t], &features[s * num_features], &leaf_node);
+            size_t pair = (size_t) s * num_trees + t;
+            if(!optimized){
+                leaves[pair] = (NULL == leaf_node) ? -1 : (int32_t) (leaf_node - conf->trees[t]);
+                continue;
+            }
+            const ref_node_t* expected = ref_leaf(model, visits, s, t);
+            if(report(&content, NULL != leaf_node && leaf_node->class == expected->class && (double) leaf_node->threshold == expected->threshold)){
+                printf("    optimized visit_tree_leaf: sample %u tree %u reached a leaf of class %d value %.17g instead of leaf %d of class %d value %.17g\n",
+                       s, t, (NULL == leaf_node) ? -1 : leaf_node->class, (NULL == leaf_node) ? NAN : (double) leaf_node->threshold,
+                       visits->leaves[pair], expected->class, expected->threshold);
+            }
+        }
+    }
+    if(optimized){
+        content.engine = "optimized visit_tree_leaf (leaf content)";
+        end_check(&content);
+    }
+    else{
+        check_leaves(model, visits, samples, num_samples, "visit_tree_leaf", leaves);
+    }
+
+    if(model->boosted){
+        feature_type_t* outputs = malloc((size_t) num_samples * model->num_outputs * sizeof(feature_type_t));
+        double expected[model->num_outputs];
+        for(int batch = 0; batch < 2 && NULL != outputs; batch++){
+            snprintf(engine, sizeof(engine), "%s%s", prefix, batch ? "visit_gbdt_batch" : "visit_gbdt");
+            check_t check = {model->name, engine, 0, 0};
+            if(batch){
+                visit_gbdt_batch(conf->trees, num_trees, conf->boosting, features, num_samples, model->num_features, outputs);
+            }
+            for(uint32_t s = 0; s < num_samples; s++){
+                if(!batch){
+                    visit_gbdt(conf->trees, num_trees, conf->boosting, &features[s * num_features], &outputs[(size_t) s * model->num_outputs]);
+                }
+                ref_gbdt(model, visits, s, expected);
+                for(uint16_t o = 0; o < model->num_outputs; o++){
+                    if(report(&check, close_enough(outputs[(size_t) s * model->num_outputs + o], expected[o]))){
+                        printf("    %s: sample %u output %u is %.17g instead of %.17g\n", engine, s, o, (double) outputs[(size_t) s * model->num_outputs + o], expected[o]);
+                    }
+                }
+            }
+            end_check(&check);
+        }
+        free(outputs);
+        return;
+    }
+
+    if(0 == model->num_classes){
+        feature_type_t* means = malloc(num_samples * sizeof(feature_type_t));
+        for(int batch = 0; batch < 2 && NULL != means; batch++){
+            snprintf(engine, sizeof(engine), "%s%s", prefix, batch ? "visit_rf_mean_batch" : "visit_rf_mean");
+            check_t check = {model->name, engine, 0, 0};
+            if(batch){
+                visit_rf_mean_batch(conf->trees, num_trees, features, num_samples, model->num_features, means);
+            }
+            for(uint32_t s = 0; s < num_samples; s++){
+                if(!batch){
+                    visit_rf_mean(conf->trees, num_trees, &features[s * num_features], &means[s]);
+                }
+                const double expected = ref_mean(model, visits, s);
+                if(report(&check, close_enough(means[s], expected))){
+                    printf("    %s: sample %u mean %.17g instead of %.17g\n", engine, s, (double) means[s], expected);
+                }
+            }
+            end_check(&check);
+        }
+        free(means);
+        return;
+    }
+
+    // visit_ensemble: classes of the trees.
+    snprintf(engine, sizeof(engine), "%svisit_ensemble", prefix);
+    check_t ensemble = {model->name, engine, 0, 0};
+    class_t class_per_tree[num_trees];
+    for(uint32_t s = 0; s < num_samples; s++){
+        visit_ensemble(conf->trees, num_trees, &features[s * num_features], class_per_tree);
+        for(uint16_t t = 0; t < num_trees; t++){
+            if(report(&ensemble, class_per_tree[t] == ref_leaf(model, visits, s, t)->class)){
+                printf("    %s: sample %u tree %u class %d instead of %d (reference leaf %d)\n", engine, s, t, class_per_tree[t],
+                       ref_leaf(model, visits, s, t)->class, visits->leaves[(size_t) s * num_trees + t]);
+            }
+        }
+    }
+    end_check(&ensemble);
+
+    // Majority voting, per sample and batched. The per sample function counts the votes of the num_classes classes of the library.
+    num_classes = (model->num_classes > 256) ? model->num_classes : 256;
+    class_t* classes = malloc(num_samples * sizeof(class_t));
+    uint16_t* votes = malloc(num_samples * sizeof(uint16_t));
+    for(int batch = 0; batch < 2 && NULL != classes && NULL != votes; batch++){
+        snprintf(engine, sizeof(engine), "%s%s", prefix, batch ? "visit_rf_majority_voting_batch" : "visit_rf_majority_voting");
+        check_t check = {model->name, engine, 0, 0};
+        if(batch){
+            visit_rf_majority_voting_batch(conf->trees, num_trees, model->num_classes, features, num_samples, model->num_features, classes, votes);
+        }
+        for(uint32_t s = 0; s < num_samples; s++){
+            if(!batch){
+                visit_rf_majority_voting(conf->trees, num_trees, &features[s * num_features], &classes[s], &votes[s]);
+            }
+            uint16_t expected_votes;
+            class_t expected = ref_majority(model, visits, s, &expected_votes);
+            if(report(&check, classes[s] == expected && votes[s] == expected_votes)){
+                printf("    %s: sample %u class %d with %u votes instead of %d with %u votes\n", engine, s, classes[s], votes[s], expected, expected_votes);
+            }
+        }
+        end_check(&check);
+    }
+    free(classes);
+    free(votes);
+
+    // Class probabilities, per sample and batched, with the leaf distributions if present.
+    float* probabilities = malloc((size_t) num_samples * model->num_classes * sizeof(float));
+    double expected[model->num_classes];
+    const float* const* leaf_probabilities = (const float* const*) conf->leaf_probabilities;
+    for(int batch = 0; batch < 2 && NULL != probabilities; batch++){
+        snprintf(engine, sizeof(engine), "%s%s", prefix, batch ? "visit_rf_class_probabilities_batch" : "visit_rf_class_probabilities");
+        check_t check = {model->name, engine, 0, 0};
+        if(batch){
+            visit_rf_class_probabilities_batch(conf->trees, num_trees, model->num_classes, (const float**) leaf_probabilities, features, num_samples,
+                                               model->num_features, probabilities);
+        }
+        for(uint32_t s = 0; s < num_samples; s++){
+            float* row = &probabilities[(size_t) s * model->num_classes];
+            if(!batch){
+                visit_rf_class_probabilities(conf->trees, num_trees, model->num_classes, (const float**) leaf_probabilities, &features[s * num_features], row);
+            }
+            ref_probabilities(model, visits, s, expected);
+            for(uint16_t c = 0; c < model->num_classes; c++){
+                // The library accumulates in float whatever the feature type.
+                if(report(&check, fabs(row[c] - expected[c]) <= 1e-5 * (1.0 + fabs(expected[c])))){
+                    printf("    %s: sample %u class %u probability %.9g instead of %.9g\n", engine, s, c, row[c], expected[c]);
+                }
+            }
+        }
+        end_check(&check);
+    }
+    free(probabilities);
+}
+
+/**
+ * @brief Reports an engine which could not run, returning the mismatch it counts for.
+ */
+static uint64_t report_failure(const char* const engine, const int status){
+    if(0 != status){
+        printf("    %s: failed\n", engine);
+    }
+    return (0 != status);
+}
+
+/**
+ * @brief Checks dtc::Forest of dtc.hpp against the reference: the leaves of leaf_index, the outputs of predict and predict_proba,
+ *        predict_mean or predict_gbdt depending on the model, and for the embedded model the leaves and votes of dtc::embedded_forest.
+ */
+static void check_dtc_hpp(const ref_model_t* const model, const ref_visits_t* const visits, const double* const samples,
+                          const feature_type_t* const features, const uint32_t num_samples, int32_t* const leaves){
+    if(dtc_hpp_leaf_indices(model->path, features, num_samples, leaves) != 0){
+        printf("  dtc::Forest can not load %s\n", model->path);
+        total_mismatches++;
+        return;
+    }
+    check_leaves(model, visits, samples, num_samples, "dtc::Forest::leaf_index", leaves);
+    const size_t num_outputs = model->boosted ? model->num_outputs : (0 == model->num_classes) ? 1 : model->num_classes;
+    feature_type_t* outputs = malloc((size_t) num_samples * num_outputs * sizeof(feature_type_t));
+    float* probabilities = malloc((size_t) num_samples * num_outputs * sizeof(float));
+    class_t* classes = malloc(num_samples * sizeof(class_t));
+    uint16_t* votes = malloc(num_samples * sizeof(uint16_t));
+    double expected[num_outputs];
+    if(NULL == outputs || NULL == probabilities || NULL == classes || NULL == votes){
+        printf("  Allocation failed\n");
+        total_mismatches++;
+    }
+    else if(model->boosted){
+        check_t check = {model->name, "dtc::Forest::predict_gbdt", 0, 0};
+        const int status = dtc_hpp_predict_gbdt(model->path, features, num_samples, outputs);
+        check.mismatches = report_failure(check.engine, status);
+        for(uint32_t s = 0; s < num_samples && 0 == status; s++){
+            ref_gbdt(model, visits, s, expected);
+            for(uint16_t o = 0; o < model->num_outputs; o++){
+                if(report(&check, close_enough(outputs[(size_t) s * num_outputs + o], expected[o]))){
+                    printf("    %s: sample %u output %u is %.17g instead of %.17g\n", check.engine, s, o, (double) outputs[(size_t) s * num_outputs + o], expected[o]);
+                }
+            }
+        }
+        end_check(&check);
+    }
+    else if(0 == model->num_classes){
+        check_t check = {model->name, "dtc::Forest::predict_mean", 0, 0};
+        const int status = dtc_hpp_predict_mean(model->path, features, num_samples, outputs);
+        check.mismatches = report_failure(check.engine, status);
+        for(uint32_t s = 0; s < num_samples && 0 == status; s++){
+            if(report(&check, close_enough(outputs[s], ref_mean(model, visits, s)))){
+                printf("    %s: sample %u mean %.17g instead of %.17g\n", check.engine, s, (double) outputs[s], ref_mean(model, visits, s));
+            }
+        }
+        end_check(&check);
+    }
+    else{
+        check_t check = {model->name, "dtc::Forest::predict", 0, 0};
+        const int status = dtc_hpp_predict(model->path, features, num_samples, classes, votes);
+        check.mismatches = report_failure(check.engine, status);
+        for(uint32_t s = 0; s < num_samples && 0 == status; s++){
+            uint16_t expected_votes;
+            const class_t expected_class = ref_majority(model, visits, s, &expected_votes);
+            if(report(&check, classes[s] == expected_class && votes[s] == expected_votes)){
+                printf("    %s: sample %u class %d with %u votes instead of %d with %u votes\n", check.engine, s, classes[s], votes[s], expected_class,
+                       expected_votes);
+            }
+        }
+        end_check(&check);
+        check_t proba = {model->name, "dtc::Forest::predict_proba", 0, 0};
+        const int proba_status = dtc_hpp_predict_proba(model->path, features, num_samples, probabilities);
+        proba.mismatches = report_failure(proba.engine, proba_status);
+        for(uint32_t s = 0; s < num_samples && 0 == proba_status; s++){
+            ref_probabilities(model, visits, s, expected);
+            for(uint16_t c = 0; c < model->num_classes; c++){
+                const float probability = probabilities[(size_t) s * num_outputs + c];
+                if(report(&proba, fabs(probability - expected[c]) <= 1e-5 * (1.0 + fabs(expected[c])))){
+                    printf("    %s: sample %u class %u probability %.9g instead of %.9g\n", proba.engine, s, c, probability, expected[c]);
+                }
+            }
+        }
+        end_check(&proba);
+    }
+    // The embedded forest has double features, it is not built in the float builds.
+    if(model->embedded && NULL != classes && NULL != votes && dtc_embedded_statlog(features, num_samples, leaves, classes, votes) == 0){
+        check_leaves(model, visits, samples, num_samples, "dtc::embedded_forest::leaf_indices", leaves);
+        check_t check = {model->name, "dtc::embedded_forest::predict", 0, 0};
+        for(uint32_t s = 0; s < num_samples; s++){
+            uint16_t expected_votes;
+            const class_t expected_class = ref_majority(model, visits, s, &expected_votes);
+            if(report(&check, classes[s] == expected_class && votes[s] == expected_votes)){
+                printf("    %s: sample %u class %d with %u votes instead of %d with %u votes\n", check.engine, s, classes[s], votes[s], expected_class,
+                       expected_votes);
+            }
+        }
+        end_check(&check);
+    }
+    free(votes);
+    free(classes);
+    free(probabilities);
+    free(outputs);
+}
+
+static void write_trace(const char* const prefix, const ref_model_t* const model, const uint32_t num_samples, const int32_t* const leaves){
+    char path[512];
+    snprintf(path, sizeof(path), "%s_%s.trace", prefix, model->name);
+    FILE* file = fopen(path, "wb");
+    if(NULL == file){
+        printf("Can not write %s\n", path);
+        total_mismatches++;
+        return;
+    }
+    trace_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = TRACE_MAGIC;
+    header.feature_size = sizeof(feature_type_t);
+    header.num_samples = num_samples;
+    header.num_trees = model->num_trees;
+    snprintf(header.model_path, sizeof(header.model_path), "%s", model->path);
+    snprintf(header.flags, sizeof(header.flags), "USE_FLOAT=%d USE_POINTERS=%d COMPILE_PRUNED=%d", USE_FLOAT, USE_POINTERS, COMPILE_PRUNED);
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(leaves, sizeof(int32_t), (size_t) num_samples * model->num_trees, file);
+    fclose(file);
+}
+
+/**
+ * @brief Checks visit_rf_mean on a forest without trees, whose mean is 0 as no leaf is reached.
+ */
+static void check_empty_forest(void){
+    printf("empty_forest: 0 trees, 1 sample\n");
+    check_t check = {"empty_forest", "visit_rf_mean", 0, 0};
+    const feature_type_t features[1] = {0};
+    feature_type_t mean = 1;
+    const int status = visit_rf_mean(NULL, 0U, features, &mean);
+    if(report(&check, CLASSIFICATION_OK == status && 0 == mean)){
+        printf("    visit_rf_mean: status %d mean %.17g instead of %d and 0\n", status, (double) mean, CLASSIFICATION_OK);
+    }
+    end_check(&check);
+}
+
+/**
+ * @brief Checks every engine on a model: the leaves of visit_tree_leaf, and the outputs of all the visiting functions on the loaded
+ *        classifier, on its optimized copy and on dtc::Forest, against the reference. With trace_prefix the leaves are written for --compare.
+ */
+static int check_model(ref_model_t* const model, const char* const trace_prefix){
+    tree_conf_t conf, optimized;
+    if(load_tree_conf(model->path, &conf) != CONF_OK){
+        printf("Error loading %s\n", model->path);
+        return -1;
+    }
+    if(load_tree_conf(model->path, &optimized) != CONF_OK || optimize_tree_conf(&optimized, NULL) != CONF_OK){
+        printf("Error optimizing %s\n", model->path);
+        free_tree_conf(&conf);
+        return -1;
+    }
+    uint32_t num_samples = NUM_SAMPLES;
+    double* samples = malloc((size_t) num_samples * model->num_features * sizeof(double));
+    feature_type_t* features = malloc((size_t) num_samples * model->num_features * sizeof(feature_type_t));
+    int32_t* leaves = malloc((size_t) num_samples * model->num_trees * sizeof(int32_t));
+    ref_visits_t visits;
+    memset(&visits, 0, sizeof(visits));
+    int to_ret = (NULL == samples || NULL == features || NULL == leaves) ? -1 : 0;
+    if(0 == to_ret){
+        generate_samples(model, num_samples, 0x9E3779B97F4A7C15ULL ^ model->num_trees, samples);
+        for(size_t i = 0; i < (size_t) num_samples * model->num_features; i++){
+            features[i] = (feature_type_t) samples[i];
+        }
+        to_ret = ref_visit_all(model, samples, num_samples, &visits);
+    }
+    if(0 == to_ret){
+        printf("%s: %u trees, %u samples\n", model->name, model->num_trees, num_samples);
+        check_conf(model, &visits, &conf, 0, samples, features, num_samples, leaves);
+        if(NULL != trace_prefix){
+            write_trace(trace_prefix, model, num_samples, leaves);
+        }
+        check_conf(model, &visits, &optimized, 1, samples, features, num_samples, leaves);
+        check_dtc_hpp(model, &visits, samples, features, num_samples, leaves);
+    }
+    ref_visits_free(&visits);
+    free(leaves);
+    free(features);
+    free(samples);
+    free_tree_conf(&optimized);
+    free_tree_conf(&conf);
+    return to_ret;
+}
+
+/**
+ * @brief Compares the leaves of two traces of the same model, e.g. of builds with different flags, printing the divergence of the paths.
+ */
+static int compare_traces(const char* const path_a, const char* const path_b){
+    trace_header_t header_a, header_b;
+    FILE* file_a = fopen(path_a, "rb");
+    FILE* file_b = fopen(path_b, "rb");
+    int to_ret = (NULL == file_a || NULL == file_b) ? -1 : 0;
+    to_ret = to_ret || fread(&header_a, sizeof(header_a), 1, file_a) != 1 || fread(&header_b, sizeof(header_b), 1, file_b) != 1;
+    if(0 != to_ret || TRACE_MAGIC != header_a.magic || TRACE_MAGIC != header_b.magic || header_a.num_samples != header_b.num_samples ||
+       header_a.num_trees != header_b.num_trees){
+        printf("Invalid or incompatible traces %s and %s\n", path_a, path_b);
+        if(NULL != file_a) fclose(file_a);
+        if(NULL != file_b) fclose(file_b);
+        return -1;
+    }
+    ref_model_t model;
+    if(ref_load(header_a.model_path, header_a.feature_size, &model) != 0){
+        printf("Error loading %s\n", header_a.model_path);
+        fclose(file_a);
+        fclose(file_b);
+        return -1;
+    }
+    const char* name = strrchr(header_a.model_path, '/');
+    snprintf(model.name, sizeof(model.name), "%.63s", (NULL != name) ? name + 1 : header_a.model_path);
+    model.exact = (0 == strncmp(model.name, "diff_synthetic", 14));
+    size_t pairs = (size_t) header_a.num_samples * header_a.num_trees;
+    int32_t* leaves_a = malloc(pairs * sizeof(int32_t));
+    int32_t* leaves_b = malloc(pairs * sizeof(int32_t));
+    double* samples = malloc((size_t) header_a.num_samples * model.num_features * sizeof(double));
+    int32_t* path = malloc((model.offsets[model.num_trees - 1] + model.sizes[model.num_trees - 1] + 1) * sizeof(int32_t));
+    to_ret = (NULL == leaves_a || NULL == leaves_b || NULL == samples || NULL == path || fread(leaves_a, sizeof(int32_t), pairs, file_a) != pairs ||
+              fread(leaves_b, sizeof(int32_t), pairs, file_b) != pairs) ? -1 : 0;
+    if(0 == to_ret){
+        // The samples of the traced builds, regenerated from the model with the same seed.
+        generate_samples(&model, header_a.num_samples, 0x9E3779B97F4A7C15ULL ^ model.num_trees, samples);
+        check_t check = {model.name, "", 0, 0};
+        char engine[160];
+        snprintf(engine, sizeof(engine), "%s vs %s", header_a.flags, header_b.flags);
+        check.engine = engine;
+        printf("%s:\n", model.name);
+        for(uint32_t s = 0; s < header_a.num_samples; s++){
+            for(uint16_t t = 0; t < header_a.num_trees; t++){
+                size_t pair = (size_t) s * header_a.num_trees + t;
+                if(report(&check, leaves_a[pair] == leaves_b[pair])){
+                    uint32_t path_length;
+                    ref_visit(&model, t, &samples[(size_t) s * model.num_features], path, &path_length);
+                    printf("    sample %u tree %u: leaf %d with %s, leaf %d with %s\n", s, t, leaves_a[pair], header_a.flags, leaves_b[pair], header_b.flags);
+                    report_divergence(&model, t, &samples[(size_t) s * model.num_features], path, path_length, leaves_b[pair], "reference", header_b.flags);
+                }
+            }
+        }
+        end_check(&check);
+    }
+    free(path);
+    free(samples);
+    free(leaves_b);
+    free(leaves_a);
+    ref_free(&model);
+    fclose(file_a);
+    fclose(file_b);
+    return to_ret;
+}
+
+/**
+ * Differential check of the inference engines. Every engine (visit_tree_leaf, visit_ensemble, majority voting, class probabilities, mean
+ * and gradient boosting scores, per sample and batched, on the loaded and on the optimized classifier, dtc::Forest of dtc.hpp and, in the
+ * double builds, the statlog forest embedded by gen_cpp as a dtc::embedded_forest) is
+ * compared with a reference interpreter, which reads the binaries independently of the node_t layout, on the statlog rf_5 model and on
+ * synthetic forests using every operator, with NaN, +-inf, signed zeros and ties with the thresholds among the samples.
+ * Mismatching leaves are reported with the tree and the node where the paths diverged.
+ * With --trace PREFIX the leaves of visit_tree_leaf are written as PREFIX_<model>.trace, and --compare A B compares the traces of two builds,
+ * see make check, which builds and compares every combination of USE_FLOAT, USE_POINTERS and COMPILE_PRUNED. The synthetic forests have
+ * thresholds and samples exact in float and double, so that their traces are compared across the feature types too.
+ * Usage: ./main [--trace PREFIX] | --compare A.trace B.trace
+ */
+int main(int argc, char** argv) {
+    if(argc == 4 && 0 == strcmp(argv[1], "--compare")){
+        int status = compare_traces(argv[2], argv[3]);
+        printf("Differential check: %llu mismatches in %llu checks\n", (unsigned long long) total_mismatches, (unsigned long long) total_checks);
+        return (0 == status && 0 == total_mismatches) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    const char* trace_prefix = (argc == 3 && 0 == strcmp(argv[1], "--trace")) ? argv[2] : NULL;
+    if(argc > 1 && NULL == trace_prefix){
+        printf("Usage: %s [--trace PREFIX] | --compare A.trace B.trace\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    printf("USE_FLOAT=%d USE_POINTERS=%d COMPILE_PRUNED=%d\n", USE_FLOAT, USE_POINTERS, COMPILE_PRUNED);
+    int status = EXIT_SUCCESS;
+    ref_model_t model;
+    if(ref_load(STATLOG_MODEL_FILENAME, sizeof(feature_type_t), &model) != 0){
+        printf("Error loading %s\n", STATLOG_MODEL_FILENAME);
+        return EXIT_FAILURE;
+    }
+    snprintf(model.name, sizeof(model.name), "statlog_rf5");
+    model.embedded = !USE_FLOAT;
+    status |= check_model(&model, trace_prefix);
+    ref_free(&model);
+    check_empty_forest();
+
+    // name, trees, depth, features, classes, leaf distributions, boosting outputs
+    const struct{
+        const char* name;
+        uint16_t trees, depth, features, classes;
+        uint8_t leaf_probabilities;
+        uint16_t outputs;
+    } synthetic[] = {
+        {"synthetic_votes", 64, 10, 12, 5, 0, 0},
+        {"synthetic_proba", 24, 8, 8, 4, 1, 0},
+        {"synthetic_regression", 24, 9, 10, 0, 0, 0},
+        {"synthetic_gbdt", 30, 6, 10, 0, 0, 3},
+        // Shrunk blocks, and counters on the heap, of visit_rf_majority_voting_batch.
+        {"synthetic_wide_votes", 48, 8, 8, 300, 0, 0},
+        {"synthetic_many_classes", 48, 8, 8, 5000, 0, 0},
+        // Shrunk blocks, and margins accumulated in the outputs, of visit_gbdt_batch.
+        {"synthetic_wide_gbdt", 40, 6, 8, 0, 0, 100},
+        {"synthetic_many_outputs", 40, 6, 8, 0, 0, 5000},
+    };
+    for(size_t m = 0; m < sizeof(synthetic) / sizeof(synthetic[0]); m++){
+        if(synthetic_model(&model, synthetic[m].name, synthetic[m].trees, synthetic[m].depth, synthetic[m].features, synthetic[m].classes,
+                           synthetic[m].leaf_probabilities, synthetic[m].outputs, 0x2545F4914F6CDD1DULL + m) != 0){
+            printf("Allocation failed\n");
+            return EXIT_FAILURE;
+        }
+        snprintf(model.path, sizeof(model.path), "diff_%s_%c.bin", synthetic[m].name, USE_FLOAT ? 'f' : 'd');
+        if(write_model(&model) != 0){
+            printf("Error writing %s\n", model.path);
+            status = EXIT_FAILURE;
+        }
+        else{
+            status |= check_model(&model, trace_prefix);
+        }
+        ref_free(&model);
+    }
+    printf("Differential check: %llu mismatches in %llu checks\n", (unsigned long long) total_mismatches, (unsigned long long) total_checks);
+    return (EXIT_SUCCESS == status && 0 == total_mismatches) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
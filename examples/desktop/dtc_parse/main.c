@@ -7,51 +7,27 @@
 
 
 int main() {
-    // Open the binary file for reading
-    FILE *file = fopen(FILENAME, "rb");
-    if (file == NULL) {
-        perror("Error opening file");
+    // Load the classifier, whose trees are validated once so that the visits need no checks
+    tree_conf_t conf;
+    int conf_status = load_tree_conf(FILENAME, &conf);
+    if (conf_status != CONF_OK) {
+        printf("Error loading %s: %d\n", FILENAME, conf_status);
         return EXIT_FAILURE;
     }
-
-    // Read the structure from the file
-    bin_trailer_t tree_trailer;
-    if (fread(&tree_trailer, sizeof(bin_trailer_t), 1, file) != 1) {
-        perror("Error reading file");
-        fclose(file);
-        return EXIT_FAILURE;
-    }
-    printf("Num Classes: %u\n", tree_trailer.num_classes);
-    printf("Num Features: %u\n", tree_trailer.num_features);
-    printf("Num Trees: %u\n", tree_trailer.num_trees);
-    // Allocate a pointer to a pointer to a node_t ( each node is the first element of a tree)
-    node_t ** trees = (node_t **) malloc(tree_trailer.num_trees * sizeof(node_t *));
-    uint16_t num_nodes = 0;
-    for(int t = 0; t < tree_trailer.num_trees; t++){
-        // Read the number of nodes in the tree
-        fread(&num_nodes, sizeof(num_nodes), 1, file);
-        // Allocate the nodes of the tree
-        trees[t] = (node_t *) malloc(num_nodes * sizeof(node_t));
-        if (fread(trees[t], sizeof(node_t), num_nodes, file) != num_nodes) {
-            perror("Error reading file");
-            fclose(file);
-            free(trees);
-            return EXIT_FAILURE;
-        }    
-        printf("Tree: %u Num nodes %u\n", t, num_nodes);
+    printf("Num Classes: %u\n", conf.trailer.num_classes);
+    printf("Num Features: %u\n", conf.trailer.num_features);
+    printf("Num Trees: %u\n", conf.trailer.num_trees);
+    node_t ** trees = conf.trees;
+    for(int t = 0; t < conf.trailer.num_trees; t++){
+        uint16_t num_nodes = conf.num_nodes[t];
+        printf("Tree: %u Num nodes %u Max depth %u\n", t, num_nodes, conf.max_depth[t]);
         for(int i = 0; i < num_nodes; i++){
             printf("Node %u, Feature Idx: %u , Operator: %u, Thd: %f, RightIdx: %d, LeftIdx: %d, Class: %d \n", i, trees[t][i].feature_index, trees[t][i].operator, trees[t][i].threshold, trees[t][i].right_node, trees[t][i].left_node, trees[t][i].class);
         }
     }
     
-    // Free different trees mem areas
-    for(int i = 0; i < tree_trailer.num_trees; i++){
-        free(trees[i]);
-    }
-    // Free the initial trees pointer
-    free(trees);
-    // Close the file
-    fclose(file);
+    // Free the trees
+    free_tree_conf(&conf);
     
     return EXIT_SUCCESS;
 }
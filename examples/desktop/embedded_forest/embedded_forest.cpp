@@ -0,0 +1,26 @@
+#include "embedded_forest.h"
+#include "statlog_rf5_forest.hpp"
+
+using embedded = statlog_rf5_forest::forest;
+using sample_t = embedded::sample_type;
+
+uint16_t embedded_num_trees(void) {
+    return embedded::num_trees;
+}
+
+uint16_t embedded_num_features(void) {
+    return embedded::num_features;
+}
+
+void embedded_leaf_indices(const double* sample, size_t* leaf_indices) {
+    const auto leaves = embedded::leaf_indices(sample_t(sample, embedded::num_features));
+    std::copy(leaves.begin(), leaves.end(), leaf_indices);
+}
+
+int16_t embedded_predict(const double* sample, uint16_t* num_votes) {
+    return embedded::predict(sample_t(sample, embedded::num_features), num_votes);
+}
+
+void embedded_predict_batch(const double* features, size_t number_samples, int16_t* classification_results) {
+    embedded::predict(std::span<const double>(features, number_samples * embedded::num_features), std::span<int16_t>(classification_results, number_samples));
+}
@@ -0,0 +1,24 @@
+#ifndef EMBEDDED_FOREST_H
+#define EMBEDDED_FOREST_H
+#include <stddef.h>
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * C interface of the forest embedded in embedded_forest.cpp, so that it can be checked against the C library, whose headers are not valid C++.
+ */
+uint16_t embedded_num_trees(void);
+uint16_t embedded_num_features(void);
+/** Index of the leaf reached in each tree, relative to its root. */
+void embedded_leaf_indices(const double* sample, size_t* leaf_indices);
+/** Majority voting class of a sample and its votes. */
+int16_t embedded_predict(const double* sample, uint16_t* num_votes);
+/** Majority voting classes of a row-major [number_samples x num_features] matrix. */
+void embedded_predict_batch(const double* features, size_t number_samples, int16_t* classification_results);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../../../src/tree_conf.h"
+#include "../../../src/tree_dataset.h"
+#include "../../../src/tree_visit.h"
+#include "embedded_forest.h"
+#define MODEL_FILENAME "../inference_accuracy/statlog_rf5.bin"
+#define DATASET_FILENAME "../dataset_accuracy/test_dataset.dtcd"
+#define REPETITIONS 2000
+
+static double elapsed_ns(const struct timespec* start, const struct timespec* end){
+    return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+/**
+ * Checks the forest embedded by the dtc_pygen gen_cpp command against the runtime visit of the binary it was generated from:
+ * the leaf reached in every tree, the majority voting class and its votes must match for every sample.
+ * statlog_rf5_forest.hpp is generated from the dtc_pygen folder with:
+ * python dtc_pygen.py gen_cpp --feature_type double --input_bin ../examples/desktop/inference_accuracy/statlog_rf5.bin --output_cpp ../examples/desktop/embedded_forest/statlog_rf5_forest.hpp
+ */
+int main() {
+    tree_conf_t conf;
+    if(load_tree_conf(MODEL_FILENAME, &conf) != CONF_OK){
+        printf("Error loading %s\n", MODEL_FILENAME);
+        return EXIT_FAILURE;
+    }
+    tree_dataset_t dataset;
+    if(load_tree_dataset(DATASET_FILENAME, &dataset) != DATASET_OK){
+        printf("Error loading %s\n", DATASET_FILENAME);
+        free_tree_conf(&conf);
+        return EXIT_FAILURE;
+    }
+    if(conf.trailer.num_trees != embedded_num_trees() || conf.trailer.num_features != embedded_num_features() ||
+       dataset.header.num_features != conf.trailer.num_features || NULL == dataset.labels){
+        printf("The embedded forest was not generated from %s, or the dataset does not match it\n", MODEL_FILENAME);
+        free_tree_dataset(&dataset);
+        free_tree_conf(&conf);
+        return EXIT_FAILURE;
+    }
+    uint64_t num_samples = dataset.header.num_samples;
+    size_t* leaf_indices = malloc(conf.trailer.num_trees * sizeof(size_t));
+    class_t* classification_results = malloc(num_samples * sizeof(class_t));
+    uint64_t mismatches = 0, correctly_classified = 0;
+    for(uint64_t i = 0; i < num_samples; i++){
+        const feature_type_t* sample = &dataset.features[i * dataset.header.num_features];
+        embedded_leaf_indices(sample, leaf_indices);
+        for(uint16_t t = 0; t < conf.trailer.num_trees; t++){
+            const node_t* leaf;
+            visit_tree_leaf(conf.trees[t], sample, &leaf);
+            mismatches += ((size_t) (leaf - conf.trees[t]) != leaf_indices[t]);
+        }
+        class_t runtime_class;
+        uint16_t runtime_votes, embedded_votes;
+        visit_rf_majority_voting(conf.trees, conf.trailer.num_trees, sample, &runtime_class, &runtime_votes);
+        class_t embedded_class = embedded_predict(sample, &embedded_votes);
+        mismatches += (runtime_class != embedded_class || runtime_votes != embedded_votes);
+        correctly_classified += (embedded_class == dataset.labels[i]);
+    }
+
+    // Both the embedded and the runtime forest classify the dataset REPETITIONS times.
+    struct timespec start, middle, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int r = 0; r < REPETITIONS; r++){
+        embedded_predict_batch(dataset.features, num_samples, classification_results);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &middle);
+    for(int r = 0; r < REPETITIONS; r++){
+        visit_rf_majority_voting_batch(conf.trees, conf.trailer.num_trees, conf.trailer.num_classes, dataset.features, num_samples,
+                                       dataset.header.num_features, classification_results, NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Embedded: %.1f ns/sample, runtime batch: %.1f ns/sample\n", elapsed_ns(&start, &middle) / (REPETITIONS * num_samples),
+           elapsed_ns(&middle, &end) / (REPETITIONS * num_samples));
+    printf("Mismatches with the runtime visit: %llu\n", (unsigned long long) mismatches);
+    printf("Number of correctly classified samples %llu Accuracy : %f \n", (unsigned long long) correctly_classified,
+            ((double) correctly_classified / num_samples) * 100);
+
+    free(classification_results);
+    free(leaf_indices);
+    free_tree_dataset(&dataset);
+    free_tree_conf(&conf);
+    return (0 == mismatches) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,582 @@
+/**
+ * @file statlog_rf5_forest.hpp
+ * @brief Forest embedded by the dtc_pygen gen_cpp command from statlog_rf5.bin, 5 trees and 543 nodes.
+ *        Include it after adding the src folder of DTC to the include path, statlog_rf5_forest::forest is a dtc::embedded_forest.
+ */
+#ifndef STATLOG_RF5_FOREST_HPP
+#define STATLOG_RF5_FOREST_HPP
+#include <limits>
+#include "dtc.hpp"
+
+namespace statlog_rf5_forest {
+
+using feature_type = double;
+
+inline constexpr dtc::node<feature_type> tree_0[] = {
+    { dtc::op{ 0 }, 9, -1, 1, 100, 0x1.51a130164840ep+6 },
+    { dtc::op{ 0 }, 18, -1, 2, 99, 0x1.c1b37df147807p-1 },
+    { dtc::op{ 0 }, 1, -1, 3, 94, 0x1.3d00000000000p+7 },
+    { dtc::op{ 0 }, 12, -1, 4, 85, 0x1.61c71b4784231p+4 },
+    { dtc::op{ 0 }, 18, -1, 5, 68, -0x1.d855a477432d8p+0 },
+    { dtc::op{ 0 }, 18, -1, 6, 15, -0x1.14ed03a3f96efp+1 },
+    { dtc::op{ 0 }, 17, -1, 7, 10, 0x1.cdd63be1579e5p-2 },
+    { dtc::op{ 0 }, 5, -1, 8, 9, 0x1.4e38e29f9ce8ep+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 18, -1, 11, 12, -0x1.1aead0c3d2524p+1 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 17, -1, 13, 14, 0x1.bf24c028cf821p-1 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 10, -1, 16, 35, 0x1.1c71c89a38251p-2 },
+    { dtc::op{ 0 }, 1, -1, 17, 28, 0x1.1500000000000p+7 },
+    { dtc::op{ 0 }, 7, -1, 18, 21, 0x1.5555560c95d45p-4 },
+    { dtc::op{ 0 }, 16, -1, 19, 20, 0x1.38e38fdcd75bfp-1 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 18, -1, 22, 27, -0x1.0a99cbee807bcp+1 },
+    { dtc::op{ 0 }, 5, -1, 23, 26, 0x1.555555c7dda4bp-3 },
+    { dtc::op{ 0 }, 0, -1, 24, 25, 0x1.2c00000000000p+7 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, -1, 29, 34, 0x1.0100000000000p+7 },
+    { dtc::op{ 0 }, 0, -1, 30, 33, 0x1.3000000000000p+6 },
+    { dtc::op{ 0 }, 14, -1, 31, 32, 0x1.555555c7dda4bp-2 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 9, -1, 36, 61, 0x1.412f6837f7be1p+4 },
+    { dtc::op{ 0 }, 0, -1, 37, 44, 0x1.0c00000000000p+5 },
+    { dtc::op{ 0 }, 1, -1, 38, 41, 0x1.1900000000000p+7 },
+    { dtc::op{ 0 }, 10, -1, 39, 40, 0x1.e38e3ac0c62e5p-1 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 14, -1, 42, 43, 0x1.58e38eb0318b9p+3 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 14, -1, 45, 60, 0x1.d000000000000p+4 },
+    { dtc::op{ 0 }, 6, -1, 46, 55, 0x1.92a68463a76f4p+1 },
+    { dtc::op{ 0 }, 17, -1, 47, 50, 0x1.9a0e94426cb71p-2 },
+    { dtc::op{ 0 }, 17, -1, 48, 49, 0x1.85844d013a92ap-2 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 10, -1, 51, 54, 0x1.0000000000000p-1 },
+    { dtc::op{ 0 }, 6, -1, 52, 53, 0x1.4bc29fcd3a5afp-3 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 17, -1, 56, 59, 0x1.aa39e1f903e26p-1 },
+    { dtc::op{ 0 }, 5, -1, 57, 58, 0x1.91c71bb2e3ed8p+1 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 1, -1, 62, 67, 0x1.e400000000000p+6 },
+    { dtc::op{ 0 }, 14, -1, 63, 64, 0x1.b8e38da3c2118p+4 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 12, -1, 65, 66, 0x1.4638e4b87bdcfp+4 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 15, -1, 69, 82, -0x1.2e38e3e1bc482p+2 },
+    { dtc::op{ 0 }, 15, -1, 70, 79, -0x1.6e38e3e1bc482p+2 },
+    { dtc::op{ 0 }, 18, -1, 71, 76, -0x1.bfc1849a2e141p+0 },
+    { dtc::op{ 0 }, 11, -1, 72, 73, 0x1.5c71c75818c5dp+3 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 7, -1, 74, 75, 0x1.8000035afe535p-1 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 13, -1, 77, 78, -0x1.638e37d127a56p+2 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 12, -1, 80, 81, 0x1.b1c71bb2e3ed8p+1 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, -1, 83, 84, 0x1.2200000000000p+6 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 18, -1, 86, 89, -0x1.1e83771865519p+1 },
+    { dtc::op{ 0 }, 18, -1, 87, 88, -0x1.1f5d13d74d595p+1 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 18, -1, 90, 93, -0x1.1686bfa241decp+1 },
+    { dtc::op{ 0 }, 1, -1, 91, 92, 0x1.0700000000000p+7 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 10, -1, 95, 96, 0x1.3aaaa9f7b5aeap+4 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 18, -1, 97, 98, -0x1.d495ad7bcead7p+0 },
+    { dtc::op{ 0 }, 0, 5, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 6, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 1, -1, -1, 0x0.0p+0 }
+    
+};
+
+inline constexpr dtc::node<feature_type> tree_1[] = {
+    { dtc::op{ 0 }, 9, -1, 1, 116, 0x1.4bed080b673c5p+6 },
+    { dtc::op{ 0 }, 15, -1, 2, 115, 0x1.c71c72268e094p-1 },
+    { dtc::op{ 0 }, 1, -1, 3, 108, 0x1.3d00000000000p+7 },
+    { dtc::op{ 0 }, 11, -1, 4, 99, 0x1.338e3821af7d3p+5 },
+    { dtc::op{ 0 }, 18, -1, 5, 82, -0x1.d855a477432d8p+0 },
+    { dtc::op{ 0 }, 18, -1, 6, 11, -0x1.1ae8af81626b3p+1 },
+    { dtc::op{ 0 }, 17, -1, 7, 10, 0x1.67d79fe48c5c2p-2 },
+    { dtc::op{ 0 }, 16, -1, 8, 9, 0x1.555553ef6b5d4p+1 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 10, -1, 12, 33, 0x1.e38e3765c7dafp-1 },
+    { dtc::op{ 0 }, 18, -1, 13, 32, -0x1.0a99cbee807bcp+1 },
+    { dtc::op{ 0 }, 1, -1, 14, 19, 0x1.0900000000000p+7 },
+    { dtc::op{ 0 }, 13, -1, 15, 16, -0x1.c71c7429f36e7p-1 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 5, -1, 17, 18, 0x1.555555c7dda4bp-3 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, -1, 20, 31, 0x1.2f00000000000p+7 },
+    { dtc::op{ 0 }, 0, -1, 21, 28, 0x1.2400000000000p+6 },
+    { dtc::op{ 0 }, 0, -1, 22, 27, 0x1.ac00000000000p+5 },
+    { dtc::op{ 0 }, 17, -1, 23, 26, 0x1.e38e3765c7dafp-1 },
+    { dtc::op{ 0 }, 16, -1, 24, 25, 0x1.c71c72268e094p-2 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 13, -1, 29, 30, -0x1.eaaaac1094a2cp+1 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 6, -1, 34, 63, 0x1.e63a5c1c6088dp+0 },
+    { dtc::op{ 0 }, 18, -1, 35, 60, -0x1.e79f5c5139ae7p+0 },
+    { dtc::op{ 0 }, 0, -1, 36, 53, 0x1.de00000000000p+6 },
+    { dtc::op{ 0 }, 1, -1, 37, 50, 0x1.1f00000000000p+7 },
+    { dtc::op{ 0 }, 18, -1, 38, 41, -0x1.13f057ec501fdp+1 },
+    { dtc::op{ 0 }, 1, -1, 39, 40, 0x1.bc00000000000p+6 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 16, -1, 42, 49, 0x1.1b8e3821af7d3p+5 },
+    { dtc::op{ 0 }, 8, -1, 43, 48, 0x1.999d388a8b08ep+3 },
+    { dtc::op{ 0 }, 17, -1, 44, 47, 0x1.a4386fde09602p-2 },
+    { dtc::op{ 0 }, 1, -1, 45, 46, 0x1.e400000000000p+6 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 13, -1, 51, 52, -0x1.238e37d127a56p+2 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 11, -1, 54, 59, 0x1.2d5553ef6b5d4p+5 },
+    { dtc::op{ 0 }, 17, -1, 55, 56, 0x1.686112698f0fdp-1 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 5, -1, 57, 58, 0x1.038e383c876fdp+1 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 5, -1, 61, 62, 0x1.9555582129457p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 12, -1, 64, 73, 0x1.8e38e4b87bdcfp+3 },
+    { dtc::op{ 0 }, 17, -1, 65, 72, 0x1.a71f56069cd23p-1 },
+    { dtc::op{ 0 }, 1, -1, 66, 71, 0x1.3900000000000p+7 },
+    { dtc::op{ 0 }, 0, -1, 67, 70, 0x1.b200000000000p+6 },
+    { dtc::op{ 0 }, 7, -1, 68, 69, 0x1.e71c73d40d32fp+2 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 1, -1, 74, 81, 0x1.f000000000000p+6 },
+    { dtc::op{ 0 }, 16, -1, 75, 76, 0x1.ec71c864883fdp+4 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 9, -1, 77, 80, 0x1.c25ed06fef7c2p+4 },
+    { dtc::op{ 0 }, 13, -1, 78, 79, -0x1.c8e390c9107fbp+3 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 15, -1, 83, 94, -0x1.671c714fce747p+2 },
+    { dtc::op{ 0 }, 5, -1, 84, 89, 0x1.671c6fa24f4acp+1 },
+    { dtc::op{ 0 }, 15, -1, 85, 86, -0x1.ae38e3e1bc482p+2 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 13, -1, 87, 88, -0x1.638e3ac0c62e5p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 17, -1, 90, 91, 0x1.a64118cf03debp-2 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 11, -1, 92, 93, 0x1.4d5556084a516p+4 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, -1, 95, 98, 0x1.ce00000000000p+6 },
+    { dtc::op{ 0 }, 8, -1, 96, 97, 0x1.b05b119e8df52p-2 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 18, -1, 100, 101, -0x1.1fe42fbfe12c0p+1 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 18, -1, 102, 105, -0x1.1a59d3b0ec9c7p+1 },
+    { dtc::op{ 0 }, 12, -1, 103, 104, 0x1.8b8e379b77c03p+4 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 9, -1, 106, 107, 0x1.aa12f6e82949ap+4 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 16, -1, 109, 112, 0x1.dd5553ef6b5d4p+4 },
+    { dtc::op{ 0 }, 15, -1, 110, 111, -0x1.d8e38eb0318b9p+2 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 6, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 9, -1, 113, 114, 0x1.812f6837f7be1p+4 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 5, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 6, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 1, -1, -1, 0x0.0p+0 }
+    
+};
+
+inline constexpr dtc::node<feature_type> tree_2[] = {
+    { dtc::op{ 0 }, 16, -1, 1, 108, 0x1.9dc71b4784231p+6 },
+    { dtc::op{ 0 }, 18, -1, 2, 107, 0x1.c8943c0ca0a25p-1 },
+    { dtc::op{ 0 }, 1, -1, 3, 102, 0x1.3f00000000000p+7 },
+    { dtc::op{ 0 }, 10, -1, 4, 91, 0x1.8f1c725c3dee8p+4 },
+    { dtc::op{ 0 }, 18, -1, 5, 72, -0x1.e3b2b84e9086dp+0 },
+    { dtc::op{ 0 }, 18, -1, 6, 13, -0x1.1c70ade805377p+1 },
+    { dtc::op{ 0 }, 1, -1, 7, 12, 0x1.2500000000000p+7 },
+    { dtc::op{ 0 }, 17, -1, 8, 11, 0x1.772483c2eda5ep-2 },
+    { dtc::op{ 0 }, 0, -1, 9, 10, 0x1.5e00000000000p+6 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 17, -1, 14, 61, 0x1.d66c11f6f86f6p-1 },
+    { dtc::op{ 0 }, 1, -1, 15, 60, 0x1.3700000000000p+7 },
+    { dtc::op{ 0 }, 0, -1, 16, 35, 0x1.4800000000000p+6 },
+    { dtc::op{ 0 }, 10, -1, 17, 22, 0x1.1c71c89a38251p-2 },
+    { dtc::op{ 0 }, 1, -1, 18, 19, 0x1.1800000000000p+7 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 11, -1, 20, 21, 0x1.555555c7dda4bp-3 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 1, -1, 23, 24, 0x1.c600000000000p+6 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 17, -1, 25, 28, 0x1.02eb3c239cbd4p-1 },
+    { dtc::op{ 0 }, 1, -1, 26, 27, 0x1.e200000000000p+6 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 9, -1, 29, 32, 0x1.5a12f82a48a8ep+2 },
+    { dtc::op{ 0 }, 1, -1, 30, 31, 0x1.0900000000000p+7 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 10, -1, 33, 34, 0x1.c000000000000p+2 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 14, -1, 36, 59, 0x1.0e38e4b87bdcfp+5 },
+    { dtc::op{ 0 }, 6, -1, 37, 56, 0x1.c45377e1b8ed2p+3 },
+    { dtc::op{ 0 }, 7, -1, 38, 43, 0x1.b8e39134704a1p-1 },
+    { dtc::op{ 0 }, 13, -1, 39, 40, -0x1.555555c7dda4bp-3 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, -1, 41, 42, 0x1.e600000000000p+6 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 1, -1, 44, 51, 0x1.ec00000000000p+6 },
+    { dtc::op{ 0 }, 15, -1, 45, 48, -0x1.838e37d127a56p+2 },
+    { dtc::op{ 0 }, 10, -1, 46, 47, 0x1.738e379b77c03p+4 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 14, -1, 49, 50, 0x1.771c714fce747p+3 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 5, -1, 52, 53, 0x1.38e38fdcd75bfp-1 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 12, -1, 54, 55, 0x1.0000000000000p+1 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 1, -1, 57, 58, 0x1.2300000000000p+7 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 18, -1, 62, 71, -0x1.0a99cbee807bcp+1 },
+    { dtc::op{ 0 }, 5, -1, 63, 66, 0x1.8e38e19dea364p-3 },
+    { dtc::op{ 0 }, 6, -1, 64, 65, 0x1.8a6e006c3f210p-6 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, -1, 67, 70, 0x1.6000000000000p+5 },
+    { dtc::op{ 0 }, 0, -1, 68, 69, 0x1.1c00000000000p+5 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 15, -1, 73, 88, -0x1.271c714fce747p+2 },
+    { dtc::op{ 0 }, 1, -1, 74, 85, 0x1.2400000000000p+7 },
+    { dtc::op{ 0 }, 5, -1, 75, 82, 0x1.671c6fa24f4acp+1 },
+    { dtc::op{ 0 }, 13, -1, 76, 77, -0x1.6aaaac1094a2cp+3 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, -1, 78, 79, 0x1.8600000000000p+7 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 12, -1, 80, 81, 0x1.238e37d127a56p+2 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 11, -1, 83, 84, 0x1.af1c725c3dee8p+4 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 8, -1, 86, 87, 0x1.31bdb61bb05fbp+6 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, -1, 89, 90, 0x1.ce00000000000p+6 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 18, -1, 92, 95, -0x1.1d0cc001e32f1p+1 },
+    { dtc::op{ 0 }, 9, -1, 93, 94, 0x1.2aaaac1094a2cp+5 },
+    { dtc::op{ 0 }, 0, 5, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 12, -1, 96, 97, 0x1.6000000000000p+4 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 18, -1, 98, 101, -0x1.169533d94b605p+1 },
+    { dtc::op{ 0 }, 9, -1, 99, 100, 0x1.0284be40420f7p+5 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 9, -1, 103, 106, 0x1.738e379b77c03p+4 },
+    { dtc::op{ 0 }, 16, -1, 104, 105, 0x1.c55553ef6b5d4p+4 },
+    { dtc::op{ 0 }, 0, 6, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 5, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 6, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 1, -1, -1, 0x0.0p+0 }
+    
+};
+
+inline constexpr dtc::node<feature_type> tree_3[] = {
+    { dtc::op{ 0 }, 18, -1, 1, 124, 0x1.497cca55fa07ap-1 },
+    { dtc::op{ 0 }, 9, -1, 2, 123, 0x1.4bed080b673c5p+6 },
+    { dtc::op{ 0 }, 1, -1, 3, 118, 0x1.3f00000000000p+7 },
+    { dtc::op{ 0 }, 18, -1, 4, 95, -0x1.d67f1b6912125p+0 },
+    { dtc::op{ 0 }, 11, -1, 5, 82, 0x1.2a38e4b87bdcfp+5 },
+    { dtc::op{ 0 }, 18, -1, 6, 9, -0x1.1b7f27fe4bcaep+1 },
+    { dtc::op{ 0 }, 17, -1, 7, 8, 0x1.7ede49f7c5c9dp-2 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 17, -1, 10, 63, 0x1.c24d7a06565b5p-1 },
+    { dtc::op{ 0 }, 0, -1, 11, 48, 0x1.1100000000000p+7 },
+    { dtc::op{ 0 }, 10, -1, 12, 19, 0x1.aaaaace754379p-1 },
+    { dtc::op{ 0 }, 1, -1, 13, 18, 0x1.2600000000000p+7 },
+    { dtc::op{ 0 }, 8, -1, 14, 15, 0x1.2f683a1d7f8f2p-7 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, -1, 16, 17, 0x1.0000000000000p+7 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 9, -1, 20, 41, 0x1.4638e4b87bdcfp+4 },
+    { dtc::op{ 0 }, 13, -1, 21, 22, -0x1.ec71c75818c5dp+3 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 1, -1, 23, 34, 0x1.1e00000000000p+7 },
+    { dtc::op{ 0 }, 17, -1, 24, 27, 0x1.a15cebe947accp-2 },
+    { dtc::op{ 0 }, 1, -1, 25, 26, 0x1.e400000000000p+6 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 7, -1, 28, 33, 0x1.fe38e3e1bc482p+2 },
+    { dtc::op{ 0 }, 18, -1, 29, 32, -0x1.1723506720a09p+1 },
+    { dtc::op{ 0 }, 15, -1, 30, 31, -0x1.11c71c1e43b7ep+2 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 7, -1, 35, 38, 0x1.dc71c53f39d1bp+0 },
+    { dtc::op{ 0 }, 17, -1, 36, 37, 0x1.1952a1e36a1d3p-1 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 11, -1, 39, 40, 0x1.0800000000000p+4 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 1, -1, 42, 47, 0x1.e600000000000p+6 },
+    { dtc::op{ 0 }, 16, -1, 43, 44, 0x1.19c71b4784231p+5 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, -1, 45, 46, 0x1.3400000000000p+6 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 1, -1, 49, 62, 0x1.3900000000000p+7 },
+    { dtc::op{ 0 }, 15, -1, 50, 53, -0x1.d000000000000p+3 },
+    { dtc::op{ 0 }, 13, -1, 51, 52, -0x1.9aaaac1094a2cp+3 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 6, -1, 54, 61, 0x1.26c901d19157bp+4 },
+    { dtc::op{ 0 }, 5, -1, 55, 56, 0x1.18e38dd971f6cp+1 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 5, -1, 57, 58, 0x1.38e3905db0b54p+1 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 12, -1, 59, 60, 0x1.68e38da3c2118p+4 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 18, -1, 64, 79, -0x1.0a99cbee807bcp+1 },
+    { dtc::op{ 0 }, 6, -1, 65, 72, 0x1.18a6dd79ee2dap-4 },
+    { dtc::op{ 0 }, 1, -1, 66, 71, 0x1.0b00000000000p+7 },
+    { dtc::op{ 0 }, 1, -1, 67, 68, 0x1.0900000000000p+7 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 7, -1, 69, 70, 0x1.5555547044b69p-3 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 5, -1, 73, 74, 0x1.8e38e44d1c128p-3 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 17, -1, 75, 78, 0x1.c6e2a80064a9dp-1 },
+    { dtc::op{ 0 }, 6, -1, 76, 77, 0x1.0ed093964a59cp+3 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 5, -1, 80, 81, 0x1.8000000000000p-1 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 18, -1, 83, 86, -0x1.1fe42fbfe12c0p+1 },
+    { dtc::op{ 0 }, 13, -1, 84, 85, -0x1.0c71c864883fdp+4 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 5, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 9, -1, 87, 88, 0x1.aa12f6e82949ap+4 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 15, -1, 89, 94, -0x1.4aaaac1094a2cp+3 },
+    { dtc::op{ 0 }, 18, -1, 90, 93, -0x1.1b1633482be8cp+1 },
+    { dtc::op{ 0 }, 9, -1, 91, 92, 0x1.d471c864883fdp+4 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 17, -1, 96, 101, 0x1.2d293b62ac9d8p-2 },
+    { dtc::op{ 0 }, 16, -1, 97, 100, 0x1.7e38e4b87bdcfp+3 },
+    { dtc::op{ 0 }, 0, -1, 98, 99, 0x1.ce00000000000p+6 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 5, -1, 102, 113, 0x1.671c6fa24f4acp+1 },
+    { dtc::op{ 0 }, 15, -1, 103, 108, -0x1.671c714fce747p+2 },
+    { dtc::op{ 0 }, 15, -1, 104, 105, -0x1.bc71c82ed85aap+2 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 12, -1, 106, 107, 0x1.2000000000000p+2 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 10, -1, 109, 112, 0x1.6aaaa9f7b5aeap+2 },
+    { dtc::op{ 0 }, 12, -1, 110, 111, 0x1.1c71c89a38251p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 13, -1, 114, 115, -0x1.4000000000000p+2 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 11, -1, 116, 117, 0x1.7638e4b87bdcfp+4 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 9, -1, 119, 122, 0x1.738e379b77c03p+4 },
+    { dtc::op{ 0 }, 8, -1, 120, 121, 0x1.4eb26bf8769ecp+1 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 6, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 5, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 1, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 6, -1, -1, 0x0.0p+0 }
+    
+};
+
+inline constexpr dtc::node<feature_type> tree_4[] = {
+    { dtc::op{ 0 }, 9, -1, 1, 90, 0x1.5071c8216c615p+6 },
+    { dtc::op{ 0 }, 18, -1, 2, 89, 0x1.497cca55fa07ap-1 },
+    { dtc::op{ 0 }, 1, -1, 3, 84, 0x1.3f00000000000p+7 },
+    { dtc::op{ 0 }, 10, -1, 4, 79, 0x1.b471c864883fdp+4 },
+    { dtc::op{ 0 }, 18, -1, 5, 64, -0x1.d6993e2a073a8p+0 },
+    { dtc::op{ 0 }, 18, -1, 6, 11, -0x1.1c0683a7bfcd1p+1 },
+    { dtc::op{ 0 }, 17, -1, 7, 8, 0x1.748b3e371d4dap-2 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 1, -1, 9, 10, 0x1.2500000000000p+7 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 10, -1, 12, 27, 0x1.555555c7dda4bp-3 },
+    { dtc::op{ 0 }, 11, -1, 13, 20, 0x1.2aaaab39d50dep+0 },
+    { dtc::op{ 0 }, 0, -1, 14, 15, 0x1.b800000000000p+5 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, -1, 16, 19, 0x1.e400000000000p+6 },
+    { dtc::op{ 0 }, 0, -1, 17, 18, 0x1.d800000000000p+5 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 8, -1, 21, 22, 0x1.8a6df7d5392cfp-6 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 6, -1, 23, 26, 0x1.a8c533d9d4d0bp-5 },
+    { dtc::op{ 0 }, 15, -1, 24, 25, -0x1.9c71c7c378903p+1 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 1, -1, 28, 55, 0x1.2200000000000p+7 },
+    { dtc::op{ 0 }, 15, -1, 29, 32, -0x1.d55553ef6b5d4p+3 },
+    { dtc::op{ 0 }, 15, -1, 30, 31, -0x1.20e38da3c2118p+4 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 17, -1, 33, 50, 0x1.ba9ac6c043519p-1 },
+    { dtc::op{ 0 }, 1, -1, 34, 41, 0x1.ce00000000000p+6 },
+    { dtc::op{ 0 }, 7, -1, 35, 40, 0x1.0800000000000p+3 },
+    { dtc::op{ 0 }, 17, -1, 36, 39, 0x1.3acecfdc4bc5dp-2 },
+    { dtc::op{ 0 }, 16, -1, 37, 38, 0x1.2800000000000p+4 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 16, -1, 42, 47, 0x1.571c70435efa6p+4 },
+    { dtc::op{ 0 }, 7, -1, 43, 44, 0x1.355553ef6b5d4p+1 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 16, -1, 45, 46, 0x1.bc71c53f39d1bp+3 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, -1, 48, 49, 0x1.3800000000000p+7 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 18, -1, 51, 52, -0x1.0eb6de4dfe909p+1 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, -1, 53, 54, 0x1.4000000000000p+4 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 10, -1, 56, 61, 0x1.871c714fce747p+2 },
+    { dtc::op{ 0 }, 1, -1, 57, 60, 0x1.3a00000000000p+7 },
+    { dtc::op{ 0 }, 0, -1, 58, 59, 0x1.3000000000000p+5 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 7, -1, 62, 63, 0x1.f8e393b8af089p+1 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 15, -1, 65, 74, -0x1.3c71c82ed85aap+2 },
+    { dtc::op{ 0 }, 1, -1, 66, 71, 0x1.2400000000000p+7 },
+    { dtc::op{ 0 }, 13, -1, 67, 70, -0x1.8aaaac1094a2cp+2 },
+    { dtc::op{ 0 }, 16, -1, 68, 69, 0x1.a9c71b4784231p+4 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 10, -1, 72, 73, 0x1.671c714fce747p+2 },
+    { dtc::op{ 0 }, 0, 0, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, -1, 75, 78, 0x1.ce00000000000p+6 },
+    { dtc::op{ 0 }, 18, -1, 76, 77, -0x1.42e4502809d50p-9 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 4, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 18, -1, 80, 83, -0x1.203c1c1000ff0p+1 },
+    { dtc::op{ 0 }, 0, -1, 81, 82, 0x1.8700000000000p+7 },
+    { dtc::op{ 0 }, 0, 2, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 5, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 12, -1, 85, 88, 0x1.3f1c725c3dee8p+4 },
+    { dtc::op{ 0 }, 8, -1, 86, 87, 0x1.4eb26bf8769ecp+1 },
+    { dtc::op{ 0 }, 0, 3, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 6, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 5, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 6, -1, -1, 0x0.0p+0 },
+    { dtc::op{ 0 }, 0, 1, -1, -1, 0x0.0p+0 }
+    
+};
+
+using forest = dtc::embedded_forest<feature_type, 7, 19, tree_0, tree_1, tree_2, tree_3, tree_4>;
+
+} // namespace statlog_rf5_forest
+
+#endif // STATLOG_RF5_FOREST_HPP
\ No newline at end of file
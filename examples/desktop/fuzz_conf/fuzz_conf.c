@@ -0,0 +1,150 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../../../src/tree_conf.h"
+#include "../../../src/tree_visit.h"
+#include "fuzz_conf.h"
+
+static char input_path[64] = "";
+static uint64_t invariant_failures = 0;
+
+static void remove_input(void){
+    unlink(input_path);
+}
+
+/**
+ * @brief Writes the input in a temporary file, as load_tree_conf reads a path. The file is created once and removed at exit.
+ */
+static int write_input(const uint8_t* const data, const size_t size){
+    if('\0' == input_path[0]){
+        snprintf(input_path, sizeof(input_path), "/tmp/dtc_fuzz_conf_XXXXXX");
+        int fd = mkstemp(input_path);
+        if(fd < 0){
+            input_path[0] = '\0';
+            return -1;
+        }
+        close(fd);
+        atexit(remove_input);
+    }
+    FILE* file = fopen(input_path, "wb");
+    if(NULL == file){
+        return -1;
+    }
+    size_t written = fwrite(data, 1, size, file);
+    return (0 == fclose(file) && written == size) ? 0 : -1;
+}
+
+static int compare(const node_t* const node, const feature_type_t value){
+    switch(node -> operator){
+        case 0: return value <= node -> threshold;
+        case 1: return value < node -> threshold;
+        case 2: return value >= node -> threshold;
+        case 3: return value > node -> threshold;
+        case 4: return value == node -> threshold;
+        default: return value != node -> threshold;
+    }
+}
+
+/**
+ * @brief Walks a tree as visit_tree_leaf does, returning the number of crossed splits, so that it can be checked against max_depth.
+ */
+static uint32_t path_length(const node_t* const root_node, const feature_type_t* const features){
+    const node_t* node = root_node;
+    uint32_t length = 0;
+#if USE_POINTERS
+    while(NULL != node && (NULL != node -> left_child || NULL != node -> right_child)){
+        node = compare(node, features[node -> feature_index]) ? node -> left_child : node -> right_child;
+        length++;
+    }
+#else
+    while(-1 != node -> left_node || -1 != node -> right_node){
+        node = &root_node[compare(node, features[node -> feature_index]) ? node -> left_node : node -> right_node];
+        length++;
+    }
+#endif
+    return length;
+}
+
+static void fail(const char* const message, const uint16_t tree){
+    invariant_failures++;
+    fprintf(stderr, "Invariant failure on tree %u: %s\n", tree, message);
+#ifdef FUZZ_ABORT
+    abort();
+#endif
+}
+
+/**
+ * @brief Visits every tree of an accepted classifier with the given samples, checking that the paths are not longer than max_depth, and
+ *        stores the class and the value of the reached leaves (the class -1 and the value 0 for pruned visits).
+ */
+static void visit_all(const tree_conf_t* const conf, const feature_type_t* const samples, const uint32_t num_samples,
+                      class_t* const classes, feature_type_t* const values){
+    for(uint32_t s = 0; s < num_samples; s++){
+        const feature_type_t* const features = &samples[(size_t) s * conf -> trailer.num_features];
+        for(uint16_t t = 0; t < conf -> trailer.num_trees; t++){
+            const node_t* leaf_node = NULL;
+            const size_t i = (size_t) s * conf -> trailer.num_trees + t;
+            if(CLASSIFICATION_OK == visit_tree_leaf(conf -> trees[t], features, &leaf_node)){
+                classes[i] = leaf_node -> class;
+                values[i] = leaf_node -> leaf_value;
+            }
+            else{
+                classes[i] = -1;
+                values[i] = 0;
+            }
+            if(path_length(conf -> trees[t], features) > conf -> max_depth[t]){
+                fail("path longer than max_depth", t);
+            }
+        }
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size){
+    static const double specials[] = {0.0, -0.0, 0.5, -1.0, 1e30, -1e30, NAN, INFINITY, -INFINITY};
+    const uint32_t num_samples = sizeof(specials) / sizeof(specials[0]);
+    tree_conf_t conf;
+    if(0 != write_input(data, size) || CONF_OK != load_tree_conf(input_path, &conf)){
+        return 0;
+    }
+    // An accepted classifier must be visited without any out of bounds access (checked by the sanitizers) and always end in a leaf.
+    const size_t num_values = (size_t) num_samples * conf.trailer.num_trees;
+    feature_type_t* samples = (feature_type_t *) malloc((size_t) num_samples * conf.trailer.num_features * sizeof(feature_type_t) + 1);
+    class_t* classes = (class_t *) malloc(2 * num_values * sizeof(class_t) + 1);
+    feature_type_t* values = (feature_type_t *) malloc(2 * num_values * sizeof(feature_type_t) + 1);
+    uint16_t* max_depth = (uint16_t *) malloc(conf.trailer.num_trees * sizeof(uint16_t) + 1);
+    if(NULL != samples && NULL != classes && NULL != values && NULL != max_depth){
+        for(size_t i = 0; i < (size_t) num_samples * conf.trailer.num_features; i++){
+            // Each sample mixes the special values across its features.
+            samples[i] = (feature_type_t) specials[(i / conf.trailer.num_features + i) % num_samples];
+        }
+        visit_all(&conf, samples, num_samples, classes, values);
+        memcpy(max_depth, conf.max_depth, conf.trailer.num_trees * sizeof(uint16_t));
+        // The optimization is lossless and only shortens the paths.
+        if(CONF_OK == optimize_tree_conf(&conf, NULL)){
+            visit_all(&conf, samples, num_samples, &classes[num_values], &values[num_values]);
+            for(uint16_t t = 0; t < conf.trailer.num_trees; t++){
+                if(conf.max_depth[t] > max_depth[t]){
+                    fail("max_depth increased by optimize_tree_conf", t);
+                }
+            }
+            for(size_t i = 0; i < num_values; i++){
+                if(classes[i] != classes[num_values + i] || 0 != memcmp(&values[i], &values[num_values + i], sizeof(feature_type_t))){
+                    fail("leaf changed by optimize_tree_conf", (uint16_t) (i % conf.trailer.num_trees));
+                }
+            }
+        }
+    }
+    free(samples);
+    free(classes);
+    free(values);
+    free(max_depth);
+    free_tree_conf(&conf);
+    return 0;
+}
+
+uint64_t fuzz_conf_invariant_failures(void){
+    return invariant_failures;
+}
@@ -0,0 +1,18 @@
+#ifndef FUZZ_CONF_H
+#define FUZZ_CONF_H
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief libFuzzer entry point: loads the input as a binary configuration and, if load_tree_conf accepts it, visits every tree with
+ *        special values (signed zeros, NaN, +-inf, huge values), checks that no path is longer than max_depth, optimizes the classifier
+ *        and checks that the reached leaves are unchanged. Out of bounds accesses are left to the sanitizers.
+ */
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+/**
+ * @brief Returns the number of failed invariants of the accepted inputs. With FUZZ_ABORT the first failure aborts instead.
+ */
+uint64_t fuzz_conf_invariant_failures(void);
+
+#endif
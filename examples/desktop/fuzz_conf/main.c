@@ -0,0 +1,231 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../../../src/tree_conf.h"
+#include "../../../src/tree_visit.h"
+#include "fuzz_conf.h"
+#if USE_FLOAT
+#define SEED_FILENAME "../test_float_feat/statlog_rf5.bin"
+#else
+#define SEED_FILENAME "../inference_accuracy/statlog_rf5.bin"
+#endif
+#define NUM_MUTATIONS 20000
+#define FIRST_NODE_OFFSET (sizeof(bin_trailer_t) + sizeof(uint16_t))   /**< Offset of the first node of the first tree. */
+
+static char crafted_path[64] = "";
+
+static uint64_t xorshift64(uint64_t* const state){
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void remove_crafted(void){
+    unlink(crafted_path);
+}
+
+/**
+ * @brief Loads a buffer with load_tree_conf, returning its status.
+ */
+static int load_buffer(const uint8_t* const data, const size_t size){
+    if('\0' == crafted_path[0]){
+        snprintf(crafted_path, sizeof(crafted_path), "/tmp/dtc_crafted_conf_XXXXXX");
+        int fd = mkstemp(crafted_path);
+        if(fd < 0){
+            return CONF_ERR_OPEN;
+        }
+        close(fd);
+        atexit(remove_crafted);
+    }
+    FILE* file = fopen(crafted_path, "wb");
+    if(NULL == file){
+        return CONF_ERR_OPEN;
+    }
+    fwrite(data, 1, size, file);
+    fclose(file);
+    tree_conf_t conf;
+    int status = load_tree_conf(crafted_path, &conf);
+    if(CONF_OK == status){
+        free_tree_conf(&conf);
+    }
+    return status;
+}
+
+static bin_node_t* seed_node(uint8_t* const data, const uint16_t index){
+    return (bin_node_t *) &data[FIRST_NODE_OFFSET + index * sizeof(bin_node_t)];
+}
+
+/**
+ * @brief Corrupts a copy of the seed (whose first tree has an internal root) and checks the status of load_tree_conf. corrupt can be NULL.
+ */
+static int check_crafted(const uint8_t* const seed, const size_t size, const char* const name, const int expected,
+                         void (*corrupt)(uint8_t* const data, size_t* const size)){
+    uint8_t* data = (uint8_t *) malloc(size);
+    size_t crafted_size = size;
+    if(NULL == data){
+        return 1;
+    }
+    memcpy(data, seed, size);
+    if(NULL != corrupt){
+        corrupt(data, &crafted_size);
+    }
+    int status = load_buffer(data, crafted_size);
+    printf("%-36s status %d (expected %d)\n", name, status, expected);
+    free(data);
+    return status != expected;
+}
+
+static uint16_t seed_num_nodes(const uint8_t* const data){
+    uint16_t num_nodes;
+    memcpy(&num_nodes, &data[sizeof(bin_trailer_t)], sizeof(uint16_t));
+    return num_nodes;
+}
+
+static uint16_t first_leaf(uint8_t* const data){
+    uint16_t i = 0;
+    while(-1 != seed_node(data, i) -> left_node){
+        i++;
+    }
+    return i;
+}
+
+static void self_loop(uint8_t* const data, size_t* const size){ (void) size; seed_node(data, 0) -> left_node = 0; }
+static void child_after_tree(uint8_t* const data, size_t* const size){ (void) size; seed_node(data, 0) -> right_node = seed_num_nodes(data); }
+static void negative_child(uint8_t* const data, size_t* const size){ (void) size; seed_node(data, 0) -> left_node = -2; }
+static void invalid_operator(uint8_t* const data, size_t* const size){ (void) size; seed_node(data, 0) -> operator = NUM_OPERATORS; }
+static void invalid_feature(uint8_t* const data, size_t* const size){
+    (void) size;
+    bin_trailer_t trailer;
+    memcpy(&trailer, data, sizeof(bin_trailer_t));
+    seed_node(data, 0) -> feature_index = trailer.num_features;
+}
+static void single_child(uint8_t* const data, size_t* const size){ (void) size; seed_node(data, 0) -> right_node = -1; }
+static void invalid_class(uint8_t* const data, size_t* const size){
+    (void) size;
+    bin_trailer_t trailer;
+    memcpy(&trailer, data, sizeof(bin_trailer_t));
+    seed_node(data, first_leaf(data)) -> class = (class_t) trailer.num_classes;
+}
+static void back_edge(uint8_t* const data, size_t* const size){
+    // A leaf turned into a split whose children are the root and itself.
+    (void) size;
+    bin_node_t* const leaf = seed_node(data, first_leaf(data));
+    leaf -> left_node = 0;
+    leaf -> right_node = first_leaf(data);
+}
+static void shared_subtree(uint8_t* const data, size_t* const size){
+    // Both children of the root point to its left subtree, which is a valid DAG.
+    (void) size;
+    seed_node(data, 0) -> right_node = seed_node(data, 0) -> left_node;
+}
+static void empty_tree(uint8_t* const data, size_t* const size){
+    const bin_trailer_t trailer = {2, 4, 1};
+    const uint16_t num_nodes = 0;
+    memcpy(data, &trailer, sizeof(bin_trailer_t));
+    memcpy(&data[sizeof(bin_trailer_t)], &num_nodes, sizeof(uint16_t));
+    *size = FIRST_NODE_OFFSET;
+}
+static void truncated(uint8_t* const data, size_t* const size){ (void) data; *size = FIRST_NODE_OFFSET + sizeof(bin_node_t) / 2; }
+
+/**
+ * Fuzzing driver of load_tree_conf, for the compilers without libFuzzer. It first checks that corrupted binaries (cycles, children out of
+ * bounds, unknown operators, features and classes out of range, missing children, empty and truncated trees) are rejected, then runs
+ * the libFuzzer target of fuzz_conf.c on NUM_MUTATIONS random mutations of the statlog model (bit flips, overwritten 16 and 32 bits
+ * values and truncations), or on the files given as arguments (e.g. the corpus or the crashes of libFuzzer).
+ * Build it with CFLAGS="-fsanitize=address,undefined ..." to catch out of bounds accesses, and with make fuzz for libFuzzer.
+ * Usage: ./main [input ...]
+ */
+int main(int argc, char** argv) {
+    uint64_t inputs = 0, accepted = 0;
+    if(argc > 1){
+        for(int a = 1; a < argc; a++){
+            FILE* file = fopen(argv[a], "rb");
+            if(NULL == file){
+                printf("Can not open %s\n", argv[a]);
+                return EXIT_FAILURE;
+            }
+            static uint8_t buffer[1 << 20];
+            size_t size = fread(buffer, 1, sizeof(buffer), file);
+            fclose(file);
+            accepted += (CONF_OK == load_buffer(buffer, size));
+            LLVMFuzzerTestOneInput(buffer, size);
+            inputs++;
+        }
+        printf("Fuzzed %llu inputs: %llu accepted, %llu invariant failures\n", (unsigned long long) inputs, (unsigned long long) accepted,
+               (unsigned long long) fuzz_conf_invariant_failures());
+        return (0 == fuzz_conf_invariant_failures()) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    FILE* file = fopen(SEED_FILENAME, "rb");
+    if(NULL == file){
+        printf("Can not open %s\n", SEED_FILENAME);
+        return EXIT_FAILURE;
+    }
+    fseek(file, 0, SEEK_END);
+    size_t seed_size = (size_t) ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t* seed = (uint8_t *) malloc(seed_size);
+    uint8_t* data = (uint8_t *) malloc(seed_size);
+    if(NULL == seed || NULL == data || fread(seed, 1, seed_size, file) != seed_size){
+        printf("Can not read %s\n", SEED_FILENAME);
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+    fclose(file);
+
+    int crafted_failures = check_crafted(seed, seed_size, "seed", CONF_OK, NULL);
+    crafted_failures += check_crafted(seed, seed_size, "self loop", CONF_ERR_FORMAT, self_loop);
+    crafted_failures += check_crafted(seed, seed_size, "cycle through a leaf", CONF_ERR_FORMAT, back_edge);
+    crafted_failures += check_crafted(seed, seed_size, "child after the tree", CONF_ERR_FORMAT, child_after_tree);
+    crafted_failures += check_crafted(seed, seed_size, "negative child", CONF_ERR_FORMAT, negative_child);
+    crafted_failures += check_crafted(seed, seed_size, "unknown operator", CONF_ERR_FORMAT, invalid_operator);
+    crafted_failures += check_crafted(seed, seed_size, "feature out of range", CONF_ERR_FORMAT, invalid_feature);
+    crafted_failures += check_crafted(seed, seed_size, "leaf class out of range", CONF_ERR_FORMAT, invalid_class);
+    crafted_failures += check_crafted(seed, seed_size, "single child", (USE_POINTERS && COMPILE_PRUNED) ? CONF_OK : CONF_ERR_FORMAT, single_child);
+    crafted_failures += check_crafted(seed, seed_size, "shared subtree", CONF_OK, shared_subtree);
+    crafted_failures += check_crafted(seed, seed_size, "empty tree", CONF_ERR_FORMAT, empty_tree);
+    crafted_failures += check_crafted(seed, seed_size, "truncated tree", CONF_ERR_READ, truncated);
+
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for(uint32_t m = 0; m < NUM_MUTATIONS; m++){
+        size_t size = seed_size;
+        memcpy(data, seed, seed_size);
+        for(uint64_t k = 1 + xorshift64(&state) % 4; k > 0 && size > 0; k--){
+            size_t offset = xorshift64(&state) % size;
+            switch(xorshift64(&state) % 4){
+                case 0:
+                    data[offset] ^= (uint8_t) (1U << (xorshift64(&state) % 8));
+                    break;
+                case 1:
+                    // Small values hit the children indexes, the features and the classes.
+                    if(offset + sizeof(int32_t) <= size){
+                        int32_t value = (int32_t) (xorshift64(&state) % 300) - 2;
+                        memcpy(&data[offset & ~(size_t) 3], &value, sizeof(int32_t));
+                    }
+                    break;
+                case 2:
+                    if(offset + sizeof(uint16_t) <= size){
+                        uint16_t value = (uint16_t) xorshift64(&state);
+                        memcpy(&data[offset & ~(size_t) 1], &value, sizeof(uint16_t));
+                    }
+                    break;
+                default:
+                    size = offset;
+                    break;
+            }
+        }
+        accepted += (CONF_OK == load_buffer(data, size));
+        LLVMFuzzerTestOneInput(data, size);
+        inputs++;
+    }
+    free(seed);
+    free(data);
+    printf("Crafted binaries: %d unexpected statuses\n", crafted_failures);
+    printf("Fuzzed %llu inputs: %llu accepted, %llu invariant failures\n", (unsigned long long) inputs, (unsigned long long) accepted,
+           (unsigned long long) fuzz_conf_invariant_failures());
+    return (0 == crafted_failures && 0 == fuzz_conf_invariant_failures()) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
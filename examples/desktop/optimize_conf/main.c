@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../../src/tree_conf.h"
+#include "../../../src/tree_dataset.h"
+#include "../../../src/tree_visit.h"
+#define MODEL_FILENAME "../inference_accuracy/statlog_rf5.bin"
+#define DATASET_FILENAME "../dataset_accuracy/test_dataset.dtcd"
+
+/**
+ * Checks that optimize_tree_conf does not change the outcome of any tree on a binary dataset, and reports its savings.
+ * For each sample and tree, the leaves reached in the original and in the optimized classifier must have the same class,
+ * value and, if present, class distribution.
+ * Usage: ./main [model.bin] [dataset.dtcd]
+ * Build with CFLAGS="-Wall -Wextra -I../../../src -DUSE_FLOAT=0 -DUSE_POINTERS=1" to share the subtrees across trees too.
+ */
+int main(int argc, char** argv) {
+    const char* model_path = (argc > 1) ? argv[1] : MODEL_FILENAME;
+    const char* dataset_path = (argc > 2) ? argv[2] : DATASET_FILENAME;
+    tree_conf_t conf, optimized;
+    if(load_tree_conf(model_path, &conf) != CONF_OK || load_tree_conf(model_path, &optimized) != CONF_OK){
+        printf("Error loading %s\n", model_path);
+        free_tree_conf(&conf);
+        return EXIT_FAILURE;
+    }
+    conf_optimize_stats_t stats;
+    int status = optimize_tree_conf(&optimized, &stats);
+    if(status != CONF_OK){
+        printf("Error optimizing %s\n", model_path);
+        free_tree_conf(&optimized);
+        free_tree_conf(&conf);
+        return EXIT_FAILURE;
+    }
+    printf("Num Trees: %u\n", conf.trailer.num_trees);
+    printf("Nodes: %u -> %u (%u collapsed splits, %u shared nodes)\n", stats.nodes_before, stats.nodes_after, stats.collapsed_splits, stats.shared_nodes);
+    tree_dataset_t dataset;
+    status = load_tree_dataset(dataset_path, &dataset);
+    if(status != DATASET_OK || dataset.header.num_features != conf.trailer.num_features){
+        printf("Error loading %s, or the dataset does not have %u features\n", dataset_path, conf.trailer.num_features);
+        if(status == DATASET_OK){
+            free_tree_dataset(&dataset);
+        }
+        free_tree_conf(&optimized);
+        free_tree_conf(&conf);
+        return EXIT_FAILURE;
+    }
+    const uint16_t number_classes = conf.trailer.num_classes;
+    uint64_t mismatches = 0;
+    uint64_t correctly_classified = 0;
+    for(uint64_t i = 0; i < dataset.header.num_samples; i++){
+        const feature_type_t* features = &dataset.features[i * dataset.header.num_features];
+        for(uint16_t t = 0; t < conf.trailer.num_trees; t++){
+            const node_t* leaf = NULL;
+            const node_t* optimized_leaf = NULL;
+            visit_tree_leaf(conf.trees[t], features, &leaf);
+            visit_tree_leaf(optimized.trees[t], features, &optimized_leaf);
+            uint8_t same = leaf -> class == optimized_leaf -> class && 0 == memcmp(&leaf -> leaf_value, &optimized_leaf -> leaf_value, sizeof(feature_type_t));
+            if(NULL != conf.leaf_probabilities){
+                same = same && 0 == memcmp(&conf.leaf_probabilities[t][(leaf - conf.trees[t]) * number_classes],
+                                            &optimized.leaf_probabilities[t][(optimized_leaf - optimized.trees[t]) * number_classes],
+                                            number_classes * sizeof(float));
+            }
+            mismatches += !same;
+        }
+        if(number_classes > 0 && NULL == optimized.boosting && NULL != dataset.labels){
+            class_t classification_result;
+            uint16_t num_votes;
+            visit_rf_majority_voting(optimized.trees, optimized.trailer.num_trees, features, &classification_result, &num_votes);
+            correctly_classified += (classification_result == dataset.labels[i]);
+        }
+    }
+    printf("Mismatching leaves on %llu samples: %llu\n", (unsigned long long) dataset.header.num_samples, (unsigned long long) mismatches);
+    if(number_classes > 0 && NULL == optimized.boosting && NULL != dataset.labels){
+        printf("Number of correctly classified samples %llu Accuracy : %f \n", (unsigned long long) correctly_classified,
+                ((double) correctly_classified / dataset.header.num_samples) * 100);
+    }
+    free_tree_dataset(&dataset);
+    free_tree_conf(&optimized);
+    free_tree_conf(&conf);
+    return (0 == mismatches) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
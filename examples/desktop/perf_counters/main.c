@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../../../src/tree_conf.h"
+#include "../../../src/tree_dataset.h"
+#include "../../../src/tree_perf.h"
+#include "../../../src/tree_visit.h"
+#define MODEL_FILENAME "../inference_accuracy/statlog_rf5.bin"
+#define DATASET_FILENAME "../dataset_accuracy/test_dataset.dtcd"
+#define REPETITIONS 2
+
+/**
+ * Classifies a binary dataset with the instrumented functions of tree_perf.h, per sample and in batch, and prints the counters
+ * aggregated per call site and model. Without a PMU (e.g. in most virtual machines) or with a restrictive perf_event_paranoid only the
+ * available counters are printed, and the classification is the same.
+ * Each instrumented call reads the counters twice with read(), so the per-sample calls measure the syscalls too: prefer instrumenting batches.
+ * Usage: ./main [model.bin] [dataset.dtcd]
+ */
+int main(int argc, char** argv) {
+    const char* model_path = (argc > 1) ? argv[1] : MODEL_FILENAME;
+    const char* dataset_path = (argc > 2) ? argv[2] : DATASET_FILENAME;
+    tree_conf_t conf;
+    if(load_tree_conf(model_path, &conf) != CONF_OK){
+        printf("Error loading %s\n", model_path);
+        return EXIT_FAILURE;
+    }
+    tree_dataset_t dataset;
+    if(load_tree_dataset(dataset_path, &dataset) != DATASET_OK || dataset.header.num_features != conf.trailer.num_features || NULL == dataset.labels){
+        printf("Error loading %s, or it does not match the model\n", dataset_path);
+        free_tree_conf(&conf);
+        return EXIT_FAILURE;
+    }
+    uint32_t available;
+    int status = tree_perf_open(&available);
+    printf("Counters:");
+    for(uint8_t c = 0; c < TREE_PERF_NUM_COUNTERS; c++){
+        printf(" %s%s", tree_perf_counter_name(c), (available & (1U << c)) ? "" : " (unavailable)");
+    }
+    printf("%s\n", (TREE_PERF_ERR_UNSUPPORTED == status) ? ", built without TREE_PERF" : (TREE_PERF_ERR_OPEN == status) ? ", perf_event_open failed" : "");
+
+    uint32_t num_samples = (uint32_t) dataset.header.num_samples;
+    class_t* classification_results = malloc(num_samples * sizeof(class_t));
+    class_t* class_per_tree = malloc(conf.trailer.num_trees * sizeof(class_t));
+    for(int r = 0; r < REPETITIONS; r++){
+        for(uint32_t i = 0; i < num_samples; i++){
+            const feature_type_t* sample = &dataset.features[(size_t) i * dataset.header.num_features];
+            uint16_t num_votes;
+            tree_perf_visit_ensemble(TREE_PERF_SITE, conf.trees, conf.trailer.num_trees, sample, class_per_tree);
+            tree_perf_visit_rf_majority_voting(TREE_PERF_SITE, conf.trees, conf.trailer.num_trees, sample, &classification_results[i], &num_votes);
+        }
+        tree_perf_visit_rf_majority_voting_batch(TREE_PERF_SITE, conf.trees, conf.trailer.num_trees, conf.trailer.num_classes, dataset.features,
+                                                 num_samples, dataset.header.num_features, classification_results, NULL);
+    }
+    tree_perf_print(stdout);
+
+    uint64_t correctly_classified = 0;
+    for(uint32_t i = 0; i < num_samples; i++){
+        correctly_classified += (classification_results[i] == dataset.labels[i]);
+    }
+    printf("Number of correctly classified samples %llu Accuracy : %f \n", (unsigned long long) correctly_classified,
+            ((double) correctly_classified / num_samples) * 100);
+    tree_perf_close();
+    free(class_per_tree);
+    free(classification_results);
+    free_tree_dataset(&dataset);
+    free_tree_conf(&conf);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "../../../src/tree_conf.h"
+#include "../../../src/tree_dataset.h"
+#include "../../../src/tree_telemetry.h"
+#include "../../../src/tree_visit.h"
+#define MODEL_FILENAME "../inference_accuracy/statlog_rf5.bin"
+#define DATASET_FILENAME "../dataset_accuracy/test_dataset.dtcd"
+#define NUM_THREADS 2
+#define OUTLIER_RATIO 1.5
+
+/**
+ * @brief Half of the dataset, classified by a thread.
+ */
+typedef struct{
+    const tree_conf_t* conf;
+    const tree_dataset_t* dataset;
+    uint32_t first_sample;
+    uint32_t num_samples;
+    class_t* classification_results;
+} work_t;
+
+static void* classify(void* arg){
+    work_t* work = (work_t *) arg;
+    uint16_t num_features = work->dataset->header.num_features;
+    visit_rf_majority_voting_batch(work->conf->trees, work->conf->trailer.num_trees, work->conf->trailer.num_classes,
+                                   &work->dataset->features[(size_t) work->first_sample * num_features], work->num_samples, num_features,
+                                   &work->classification_results[work->first_sample], NULL);
+    return NULL;
+}
+
+/**
+ * Classifies a binary dataset with NUM_THREADS threads, each recording its visits in its own counters, and prints the per-tree path lengths.
+ * Trees whose mean path is more than OUTLIER_RATIO times the mean of the trees are marked, and the depth histograms per tree and per class
+ * are written in CSV if an output path is given. Built with TREE_TELEMETRY=0 the visits are not counted, and the classification is the same.
+ * Usage: ./main [model.bin] [dataset.dtcd] [histograms.csv]
+ */
+int main(int argc, char** argv) {
+    const char* model_path = (argc > 1) ? argv[1] : MODEL_FILENAME;
+    const char* dataset_path = (argc > 2) ? argv[2] : DATASET_FILENAME;
+    tree_conf_t conf;
+    if(load_tree_conf(model_path, &conf) != CONF_OK){
+        printf("Error loading %s\n", model_path);
+        return EXIT_FAILURE;
+    }
+    tree_dataset_t dataset;
+    if(load_tree_dataset(dataset_path, &dataset) != DATASET_OK || dataset.header.num_features != conf.trailer.num_features || NULL == dataset.labels){
+        printf("Error loading %s, or it does not match the model\n", dataset_path);
+        free_tree_conf(&conf);
+        return EXIT_FAILURE;
+    }
+    int status = tree_telemetry_register(conf.trees, conf.trailer.num_trees, conf.num_nodes, conf.trailer.num_classes);
+    if(TELEMETRY_OK != status){
+        printf("Telemetry %s\n", (TELEMETRY_ERR_UNSUPPORTED == status) ? "disabled, build with TREE_TELEMETRY=1" : "registration failed");
+    }
+
+    uint32_t num_samples = (uint32_t) dataset.header.num_samples;
+    class_t* classification_results = malloc(num_samples * sizeof(class_t));
+    pthread_t threads[NUM_THREADS];
+    work_t works[NUM_THREADS];
+    for(int t = 0; t < NUM_THREADS; t++){
+        works[t] = (work_t){&conf, &dataset, num_samples * t / NUM_THREADS, num_samples * (t + 1) / NUM_THREADS - num_samples * t / NUM_THREADS,
+                            classification_results};
+        pthread_create(&threads[t], NULL, classify, &works[t]);
+    }
+    for(int t = 0; t < NUM_THREADS; t++){
+        pthread_join(threads[t], NULL);
+    }
+
+    tree_telemetry_t snapshot;
+    if(TELEMETRY_OK == tree_telemetry_snapshot(&snapshot)){
+        tree_telemetry_print(stdout, &snapshot, OUTLIER_RATIO);
+        FILE* csv = (argc > 3) ? fopen(argv[3], "w") : NULL;
+        if(NULL != csv){
+            tree_telemetry_write_csv(csv, &snapshot);
+            fclose(csv);
+        }
+        tree_telemetry_free(&snapshot);
+    }
+    tree_telemetry_unregister();
+
+    uint64_t correctly_classified = 0;
+    for(uint32_t i = 0; i < num_samples; i++){
+        correctly_classified += (classification_results[i] == dataset.labels[i]);
+    }
+    printf("Number of correctly classified samples %llu Accuracy : %f \n", (unsigned long long) correctly_classified,
+            ((double) correctly_classified / num_samples) * 100);
+    free(classification_results);
+    free_tree_dataset(&dataset);
+    free_tree_conf(&conf);
+    return EXIT_SUCCESS;
+}
@@ -8,38 +8,19 @@
 
 
 int main() {
-    // Open the binary file for reading
-    FILE *file = fopen(FILENAME, "rb");
-    if (file == NULL) {
-        perror("Error opening file");
+    // Load the classifier, whose trees are validated once so that the visits need no checks
+    tree_conf_t conf;
+    int conf_status = load_tree_conf(FILENAME, &conf);
+    if (conf_status != CONF_OK) {
+        printf("Error loading %s: %d\n", FILENAME, conf_status);
         return EXIT_FAILURE;
     }
-
-    // Read the structure from the file
-    bin_trailer_t tree_trailer;
-    if (fread(&tree_trailer, sizeof(bin_trailer_t), 1, file) != 1) {
-        perror("Error reading file");
-        fclose(file);
-        return EXIT_FAILURE;
-    }
-    printf("Num Classes: %u\n", tree_trailer.num_classes);
-    printf("Num Features: %u\n", tree_trailer.num_features);
-    printf("Num Trees: %u\n", tree_trailer.num_trees);
-    // Allocate a pointer to a pointer to a node_t ( each node is the first element of a tree)
-    node_t ** trees = (node_t **) malloc(tree_trailer.num_trees * sizeof(node_t *));
-    uint16_t num_nodes = 0;
-    for(int t = 0; t < tree_trailer.num_trees; t++){
-        // Read the number of nodes in the tree
-        fread(&num_nodes, sizeof(num_nodes), 1, file);
-        // Allocate the nodes of the tree
-        trees[t] = (node_t *) malloc(num_nodes * sizeof(node_t));
-        if (fread(trees[t], sizeof(node_t), num_nodes, file) != num_nodes) {
-            perror("Error reading file");
-            fclose(file);
-            free(trees);
-            return EXIT_FAILURE;
-        }    
-        printf("Num nodes %u\n", num_nodes);
+    printf("Num Classes: %u\n", conf.trailer.num_classes);
+    printf("Num Features: %u\n", conf.trailer.num_features);
+    printf("Num Trees: %u\n", conf.trailer.num_trees);
+    node_t ** trees = conf.trees;
+    for(int t = 0; t < conf.trailer.num_trees; t++){
+        printf("Num nodes %u\n", conf.num_nodes[t]);
     }
 
     class_t classification_result;
@@ -48,7 +29,7 @@ int main() {
     int status = CLASSIFICATION_OK;
     for(unsigned int i = 0; i < num_inputs; i++){
 
-        status = visit_rf_majority_voting(trees, tree_trailer.num_trees, inputs[i], &classification_result, &num_votes);
+        status = visit_rf_majority_voting(trees, conf.trailer.num_trees, inputs[i], &classification_result, &num_votes);
         if(status == CLASSIFICATION_OK){
             if(classification_result == dataset_outs[i]){
                 correctly_classified++;
@@ -62,14 +43,8 @@ int main() {
     }
     printf("Number of correctly classified samples %u Accuracy : %f \n",correctly_classified, ((float) correctly_classified / num_inputs)*100);
     
-    // Free different trees mem areas
-    for(int i = 0; i < tree_trailer.num_trees; i++){
-        free(trees[i]);
-    }
-    // Free the initial trees pointer
-    free(trees);
-    // Close the file
-    fclose(file);
+    // Free the trees
+    free_tree_conf(&conf);
     
     return EXIT_SUCCESS;
 }
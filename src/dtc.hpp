@@ -0,0 +1,706 @@
+/*
+ * This file is part of DTC: Decision Tree in C-lang project.
+ *
+ * DTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DTC. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dtc.hpp
+ * @author Antonio Emmanuele (antony.35.ae@gmail.com)
+ * @brief  Header-only C++20 interface of the library, whose feature type is a template parameter instead of USE_FLOAT,
+ *         so that float and double models are served by the same program.
+ * @version 0.1
+ * @date 2024-12-29
+ *
+ * @copyright Copyright (c) 2024 Antonio Emmanuele
+ *
+ */
+#ifndef DTC_HPP
+#define DTC_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DTC_HPP_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define DTC_HPP_USE_MMAP 0
+#endif
+
+namespace dtc {
+
+inline constexpr std::uint16_t section_leaf_proba = 1;      /**< BIN_SECTION_LEAF_PROBA of tree_conf.h. */
+inline constexpr std::uint16_t section_boosting = 2;        /**< BIN_SECTION_BOOSTING of tree_conf.h. */
+inline constexpr std::uint32_t dataset_magic = 0x44435444U; /**< DATASET_MAGIC of tree_dataset.h. */
+inline constexpr std::uint16_t dataset_version = 1;         /**< DATASET_VERSION of tree_dataset.h. */
+inline constexpr std::size_t block_size = 64;               /**< Number of samples processed together by the batch functions. */
+
+/**
+ * @brief Operators of the splits, the left child is taken when the comparison of the feature with the threshold is true.
+ */
+enum class op : std::uint16_t { less_or_equal = 0, less_than = 1, greater_or_equal = 2, greater_than = 3, equal = 4, not_equal = 5 };
+
+/**
+ * @brief Transformations of the margins of boosted models, the BOOSTING_OBJECTIVE_* values of tree_boost.h.
+ */
+enum class objective : std::uint16_t { raw = 0, sigmoid = 1, softmax = 2 };
+
+/**
+ * @brief Thrown when a binary configuration or a binary dataset can not be loaded.
+ */
+class error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Node of a tree, with the layout of node_t (and of the binary configuration) for the feature type FeatureT.
+ */
+template <typename FeatureT>
+struct node {
+    op operation;                   /**< Operator used for the split. */
+    std::uint16_t feature_index;    /**< Index of the feature used for splitting. */
+    std::int16_t class_result;      /**< Classification result if the node is a leaf. */
+    std::int32_t left_node;         /**< Index of the left child, relative to the root, -1 for the leaves. */
+    std::int32_t right_node;        /**< Index of the right child, relative to the root, -1 for the leaves. */
+    FeatureT threshold;             /**< Threshold of the split, or value of the leaf in regression and boosted models. */
+
+    constexpr bool is_leaf() const noexcept { return -1 == left_node && -1 == right_node; }
+};
+
+static_assert(sizeof(node<float>) == 20 && sizeof(node<double>) == 24, "node must have the layout of the binary configuration");
+
+/**
+ * @brief Evaluates a split with the semantic of the C operators, i.e. comparisons with NaN are false except not_equal.
+ */
+template <typename FeatureT>
+constexpr bool compare(const op operation, const FeatureT value, const FeatureT threshold) noexcept {
+    switch (operation) {
+        case op::less_or_equal: return value <= threshold;
+        case op::less_than: return value < threshold;
+        case op::greater_or_equal: return value >= threshold;
+        case op::greater_than: return value > threshold;
+        case op::equal: return value == threshold;
+        case op::not_equal: return value != threshold;
+    }
+    return false;
+}
+
+namespace detail {
+
+/**
+ * @brief Reads a trivially copyable value at offset, checking the bounds of the buffer.
+ */
+template <typename T>
+T read(const std::vector<std::byte>& buffer, std::size_t& offset) {
+    if (buffer.size() - offset < sizeof(T) || offset > buffer.size()) {
+        throw error("truncated binary configuration");
+    }
+    T value;
+    std::memcpy(&value, buffer.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+}
+
+/**
+ * @brief Copies count values at offset in destination, checking the bounds of the buffer.
+ */
+template <typename T>
+void read_array(const std::vector<std::byte>& buffer, std::size_t& offset, T* const destination, const std::size_t count) {
+    if (offset > buffer.size() || count > (buffer.size() - offset) / sizeof(T)) {
+        throw error("truncated binary configuration");
+    }
+    std::memcpy(destination, buffer.data() + offset, count * sizeof(T));
+    offset += count * sizeof(T);
+}
+
+inline std::vector<std::byte> read_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw error("can not open " + path.string());
+    }
+    file.seekg(0, std::ios::end);
+    std::vector<std::byte> buffer(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    if (!file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()))) {
+        throw error("can not read " + path.string());
+    }
+    return buffer;
+}
+
+} // namespace detail
+
+/**
+ * @brief Forest loaded from a binary configuration generated by dtc_pygen with the feature type FeatureT (float or double).
+ *        The nodes of all the trees, and their leaf distributions, are copied in a single arena owned by the forest, which is move-only.
+ *        Children are checked while loading, so the visits never leave the arena.
+ *        The batch functions take row-major [rows x num_features] matrices as spans, and visit each tree for blocks of block_size samples.
+ *
+ * @tparam FeatureT Feature type of the model, i.e. the type of the thresholds of the binary.
+ * @tparam ClassT Signed integer type of the predicted classes.
+ */
+template <typename FeatureT, typename ClassT = std::int16_t>
+class Forest {
+    static_assert(std::is_same_v<FeatureT, float> || std::is_same_v<FeatureT, double>, "FeatureT must be float or double");
+    static_assert(std::is_integral_v<ClassT> && std::is_signed_v<ClassT>, "ClassT must be a signed integer type");
+
+public:
+    using feature_type = FeatureT;
+    using class_type = ClassT;
+    using node_type = node<FeatureT>;
+
+    /**
+     * @brief Loads the binary configuration at path.
+     * @throw dtc::error If the file can not be read or it is not a valid binary configuration for FeatureT.
+     */
+    explicit Forest(const std::filesystem::path& path) {
+        const std::vector<std::byte> buffer = detail::read_file(path);
+        std::size_t offset = 0;
+        num_classes_ = detail::read<std::uint16_t>(buffer, offset);
+        num_features_ = detail::read<std::uint16_t>(buffer, offset);
+        const std::uint16_t num_trees = detail::read<std::uint16_t>(buffer, offset);
+        // Sizes of the trees first, so that the arena is allocated once.
+        std::size_t total_nodes = 0;
+        std::vector<std::size_t> node_offsets(num_trees);
+        for (std::uint16_t t = 0; t < num_trees; t++) {
+            const std::uint16_t count = detail::read<std::uint16_t>(buffer, offset);
+            node_offsets[t] = offset;
+            tree_offsets_.push_back(static_cast<std::uint32_t>(total_nodes));
+            tree_sizes_.push_back(count);
+            total_nodes += count;
+            offset += count * sizeof(node_type);
+        }
+        tree_offsets_.push_back(static_cast<std::uint32_t>(total_nodes));
+        nodes_ = std::make_unique<node_type[]>(total_nodes);
+        for (std::uint16_t t = 0; t < num_trees; t++) {
+            std::size_t node_offset = node_offsets[t];
+            detail::read_array(buffer, node_offset, &nodes_[tree_offsets_[t]], tree_sizes_[t]);
+            check_tree(t);
+        }
+        while (offset < buffer.size()) {
+            const std::uint16_t section_id = detail::read<std::uint16_t>(buffer, offset);
+            detail::read<std::uint16_t>(buffer, offset);
+            const std::uint32_t section_size = detail::read<std::uint32_t>(buffer, offset);
+            const std::size_t section_end = offset + section_size;
+            if (section_leaf_proba == section_id && !leaf_probabilities_) {
+                if (section_size != total_nodes * num_classes_ * sizeof(float)) {
+                    throw error("invalid leaf distributions section");
+                }
+                leaf_probabilities_ = std::make_unique<float[]>(total_nodes * num_classes_);
+                detail::read_array(buffer, offset, leaf_probabilities_.get(), total_nodes * num_classes_);
+            }
+            else if (section_boosting == section_id && 0 == num_outputs_) {
+                objective_ = static_cast<objective>(detail::read<std::uint16_t>(buffer, offset));
+                num_outputs_ = detail::read<std::uint16_t>(buffer, offset);
+                if (0 == num_outputs_ || section_size != 2 * sizeof(std::uint16_t) + num_outputs_ * sizeof(FeatureT) + num_trees * sizeof(std::uint16_t)) {
+                    throw error("invalid boosting section");
+                }
+                base_scores_.resize(num_outputs_);
+                tree_outputs_.resize(num_trees);
+                detail::read_array(buffer, offset, base_scores_.data(), num_outputs_);
+                detail::read_array(buffer, offset, tree_outputs_.data(), num_trees);
+                if (std::any_of(tree_outputs_.begin(), tree_outputs_.end(), [this](std::uint16_t output) { return output >= num_outputs_; })) {
+                    throw error("invalid boosting section");
+                }
+            }
+            else {
+                throw error("unknown or repeated section " + std::to_string(section_id));
+            }
+            if (offset != section_end) {
+                throw error("invalid section size");
+            }
+        }
+    }
+
+    Forest(const Forest&) = delete;
+    Forest& operator=(const Forest&) = delete;
+    Forest(Forest&&) noexcept = default;
+    Forest& operator=(Forest&&) noexcept = default;
+    ~Forest() = default;
+
+    std::uint16_t num_classes() const noexcept { return num_classes_; }
+    std::uint16_t num_features() const noexcept { return num_features_; }
+    std::uint16_t num_trees() const noexcept { return static_cast<std::uint16_t>(tree_sizes_.size()); }
+    bool is_boosted() const noexcept { return num_outputs_ > 0; }
+    bool has_leaf_probabilities() const noexcept { return static_cast<bool>(leaf_probabilities_); }
+    /** Number of margins of boosted models, 1 otherwise. */
+    std::uint16_t num_outputs() const noexcept { return is_boosted() ? num_outputs_ : 1; }
+
+    /** Nodes of a tree, the root is the first one. */
+    std::span<const node_type> tree(const std::size_t tree_idx) const noexcept {
+        return {&nodes_[tree_offsets_[tree_idx]], tree_sizes_[tree_idx]};
+    }
+
+    /** Visits a tree for a sample of num_features values, returning the index of the reached leaf in the tree. */
+    std::size_t leaf_index(const std::size_t tree_idx, const FeatureT* const sample) const noexcept {
+        const node_type* const root = &nodes_[tree_offsets_[tree_idx]];
+        const node_type* current = root;
+        while (!current->is_leaf()) {
+            current = &root[compare(current->operation, sample[current->feature_index], current->threshold) ? current->left_node : current->right_node];
+        }
+        return static_cast<std::size_t>(current - root);
+    }
+
+    /** Visits a tree for a sample, returning the reached leaf. */
+    const node_type& leaf(const std::size_t tree_idx, std::span<const FeatureT> sample) const {
+        check_sample(sample);
+        return nodes_[tree_offsets_[tree_idx] + leaf_index(tree_idx, sample.data())];
+    }
+
+    /** Majority voting class of a sample, the first class reaching the maximum number of votes wins as in majority_voting. */
+    ClassT predict(std::span<const FeatureT> sample) const {
+        ClassT result;
+        predict(sample, std::span<ClassT>(&result, 1));
+        return result;
+    }
+
+    /**
+     * @brief Majority voting classes of a matrix of classes.size() samples, -1 for the samples without votes.
+     * @param[in] features Row-major [rows x num_features] matrix.
+     * @param[out] classes Class of each sample.
+     * @param[out] votes Votes of the class of each sample, empty if not needed.
+     */
+    void predict(std::span<const FeatureT> features, std::span<ClassT> classes, std::span<std::uint16_t> votes = {}) const {
+        check_matrix(features, classes.size());
+        if (!votes.empty() && votes.size() != classes.size()) {
+            throw std::invalid_argument("votes must be empty or contain a value per sample");
+        }
+        std::vector<std::uint16_t> counts(block_size * std::max<std::size_t>(num_classes_, 1));
+        std::uint16_t max_counts[block_size];
+        for (std::size_t begin = 0; begin < classes.size(); begin += block_size) {
+            const std::size_t rows = std::min(block_size, classes.size() - begin);
+            std::fill(counts.begin(), counts.end(), 0);
+            std::fill(std::begin(max_counts), std::end(max_counts), 0);
+            std::fill_n(&classes[begin], rows, ClassT(-1));
+            // Trees are visited in order, so that the draws are broken as in majority_voting.
+            for (std::size_t t = 0; t < tree_sizes_.size(); t++) {
+                const node_type* const root = &nodes_[tree_offsets_[t]];
+                for (std::size_t s = 0; s < rows; s++) {
+                    const std::int16_t leaf_class = root[leaf_index(t, &features[(begin + s) * num_features_])].class_result;
+                    if (leaf_class >= 0 && leaf_class < num_classes_) {
+                        std::uint16_t& count = counts[s * num_classes_ + leaf_class];
+                        if (++count > max_counts[s]) {
+                            max_counts[s] = count;
+                            classes[begin + s] = static_cast<ClassT>(leaf_class);
+                        }
+                    }
+                }
+            }
+            if (!votes.empty()) {
+                std::copy_n(max_counts, rows, &votes[begin]);
+            }
+        }
+    }
+
+    /**
+     * @brief Class distributions of a matrix of samples, as visit_rf_class_probabilities_batch: the average of the leaf distributions
+     *        if the binary contains them, the fraction of the trees voting each class otherwise.
+     * @param[in] features Row-major [rows x num_features] matrix.
+     * @param[out] probabilities Row-major [rows x num_classes] matrix.
+     */
+    void predict_proba(std::span<const FeatureT> features, std::span<float> probabilities) const {
+        if (0 == num_classes_ || probabilities.size() % num_classes_ != 0) {
+            throw std::invalid_argument("probabilities must contain num_classes values per sample");
+        }
+        const std::size_t samples = probabilities.size() / num_classes_;
+        check_matrix(features, samples);
+        std::fill(probabilities.begin(), probabilities.end(), 0.0f);
+        for (std::size_t begin = 0; begin < samples; begin += block_size) {
+            const std::size_t rows = std::min(block_size, samples - begin);
+            for (std::size_t t = 0; t < tree_sizes_.size(); t++) {
+                for (std::size_t s = 0; s < rows; s++) {
+                    const std::size_t leaf = leaf_index(t, &features[(begin + s) * num_features_]);
+                    float* const row = &probabilities[(begin + s) * num_classes_];
+                    if (leaf_probabilities_) {
+                        const float* const distribution = &leaf_probabilities_[(tree_offsets_[t] + leaf) * num_classes_];
+                        for (std::size_t c = 0; c < num_classes_; c++) {
+                            row[c] += distribution[c];
+                        }
+                    }
+                    else {
+                        row[nodes_[tree_offsets_[t] + leaf].class_result] += 1.0f;
+                    }
+                }
+            }
+        }
+        const float scale = tree_sizes_.empty() ? 0.0f : 1.0f / tree_sizes_.size();
+        for (float& probability : probabilities) {
+            probability *= scale;
+        }
+    }
+
+    /**
+     * @brief Mean of the leaf values of a regression forest for a matrix of means.size() samples.
+     */
+    void predict_mean(std::span<const FeatureT> features, std::span<FeatureT> means) const {
+        check_matrix(features, means.size());
+        std::fill(means.begin(), means.end(), FeatureT(0));
+        for (std::size_t begin = 0; begin < means.size(); begin += block_size) {
+            const std::size_t rows = std::min(block_size, means.size() - begin);
+            for (std::size_t t = 0; t < tree_sizes_.size(); t++) {
+                const node_type* const root = &nodes_[tree_offsets_[t]];
+                for (std::size_t s = 0; s < rows; s++) {
+                    means[begin + s] += root[leaf_index(t, &features[(begin + s) * num_features_])].threshold;
+                }
+            }
+        }
+        for (FeatureT& mean : means) {
+            mean = tree_sizes_.empty() ? FeatureT(0) : mean / static_cast<FeatureT>(tree_sizes_.size());
+        }
+    }
+
+    /**
+     * @brief Transformed margins of a boosted model, as visit_gbdt_batch.
+     * @param[in] features Row-major [rows x num_features] matrix.
+     * @param[out] outputs Row-major [rows x num_outputs] matrix.
+     */
+    void predict_gbdt(std::span<const FeatureT> features, std::span<FeatureT> outputs) const {
+        if (!is_boosted() || outputs.size() % num_outputs_ != 0) {
+            throw std::invalid_argument("outputs must contain num_outputs values per sample of a boosted model");
+        }
+        const std::size_t samples = outputs.size() / num_outputs_;
+        check_matrix(features, samples);
+        for (std::size_t s = 0; s < samples; s++) {
+            std::copy(base_scores_.begin(), base_scores_.end(), &outputs[s * num_outputs_]);
+        }
+        for (std::size_t begin = 0; begin < samples; begin += block_size) {
+            const std::size_t rows = std::min(block_size, samples - begin);
+            for (std::size_t t = 0; t < tree_sizes_.size(); t++) {
+                const node_type* const root = &nodes_[tree_offsets_[t]];
+                for (std::size_t s = 0; s < rows; s++) {
+                    outputs[(begin + s) * num_outputs_ + tree_outputs_[t]] += root[leaf_index(t, &features[(begin + s) * num_features_])].threshold;
+                }
+            }
+        }
+        for (std::size_t s = 0; s < samples; s++) {
+            transform(outputs.subspan(s * num_outputs_, num_outputs_));
+        }
+    }
+
+private:
+    void check_sample(std::span<const FeatureT> sample) const {
+        if (sample.size() != num_features_) {
+            throw std::invalid_argument("a sample must contain num_features values");
+        }
+    }
+
+    void check_matrix(std::span<const FeatureT> features, const std::size_t rows) const {
+        if (features.size() != rows * num_features_) {
+            throw std::invalid_argument("features must be a row-major [rows x num_features] matrix");
+        }
+    }
+
+    /**
+     * Checks operators, features and children of a tree, and that it does not contain cycles, so that visits always end in a leaf.
+     * As load_tree_conf, rejects empty trees and, in classification forests, reachable leaves whose class is out of [0, num_classes).
+     */
+    void check_tree(const std::size_t tree_idx) const {
+        const std::span<const node_type> nodes = tree(tree_idx);
+        if (nodes.empty()) {
+            throw error("empty tree " + std::to_string(tree_idx));
+        }
+        for (const node_type& n : nodes) {
+            const bool valid_children = n.is_leaf() || (n.left_node >= 0 && n.left_node < static_cast<std::int32_t>(nodes.size()) &&
+                                                        n.right_node >= 0 && n.right_node < static_cast<std::int32_t>(nodes.size()));
+            if (!valid_children || (!n.is_leaf() && (static_cast<std::uint16_t>(n.operation) > 5 || n.feature_index >= num_features_))) {
+                throw error("invalid node in tree " + std::to_string(tree_idx));
+            }
+        }
+        // 0 not visited, 1 on the path from the root, 2 visited.
+        std::vector<std::uint8_t> state(nodes.size(), 0);
+        std::vector<std::int32_t> stack{0};
+        while (!stack.empty()) {
+            const std::int32_t idx = stack.back();
+            if (2 == state[idx]) {
+                stack.pop_back();
+                continue;
+            }
+            if (nodes[idx].is_leaf() && num_classes_ > 0 && (nodes[idx].class_result < 0 || nodes[idx].class_result >= num_classes_)) {
+                throw error("invalid leaf class in tree " + std::to_string(tree_idx));
+            }
+            if (1 == state[idx] || nodes[idx].is_leaf()) {
+                state[idx] = 2;
+                stack.pop_back();
+                continue;
+            }
+            state[idx] = 1;
+            for (const std::int32_t child : {nodes[idx].left_node, nodes[idx].right_node}) {
+                if (1 == state[child]) {
+                    throw error("cycle in tree " + std::to_string(tree_idx));
+                }
+                if (0 == state[child]) {
+                    stack.push_back(child);
+                }
+            }
+        }
+    }
+
+    void transform(std::span<FeatureT> margins) const {
+        if (objective::sigmoid == objective_) {
+            for (FeatureT& margin : margins) {
+                margin = 1 / (1 + std::exp(-margin));
+            }
+        }
+        else if (objective::softmax == objective_) {
+            const FeatureT max_margin = *std::max_element(margins.begin(), margins.end());
+            FeatureT sum = 0;
+            for (FeatureT& margin : margins) {
+                margin = std::exp(margin - max_margin);
+                sum += margin;
+            }
+            for (FeatureT& margin : margins) {
+                margin /= sum;
+            }
+        }
+    }
+
+    std::uint16_t num_classes_ = 0;
+    std::uint16_t num_features_ = 0;
+    std::unique_ptr<node_type[]> nodes_;            /**< Arena of the nodes of all the trees. */
+    std::vector<std::uint32_t> tree_offsets_;       /**< Offset of the root of each tree in the arena, plus the total number of nodes. */
+    std::vector<std::uint16_t> tree_sizes_;         /**< Number of nodes of each tree. */
+    std::unique_ptr<float[]> leaf_probabilities_;   /**< [nodes x num_classes] leaf distributions, indexed as the arena. */
+    objective objective_ = objective::raw;
+    std::uint16_t num_outputs_ = 0;                 /**< Number of margins, 0 for forests. */
+    std::vector<FeatureT> base_scores_;
+    std::vector<std::uint16_t> tree_outputs_;
+};
+
+/**
+ * @brief Leaf reached in the embedded tree Nodes, a constexpr node table generated by the dtc_pygen gen_cpp command, starting from the node Index.
+ *        Every node is a distinct instantiation, so operators, feature indexes and thresholds are constants and the visit is unrolled in a
+ *        chain of comparisons with immediate operands.
+ */
+template <const auto& Nodes, std::int32_t Index = 0, typename FeatureT>
+constexpr const auto& embedded_leaf(const FeatureT* const sample) noexcept {
+    constexpr const auto& current = Nodes[Index];
+    if constexpr (current.is_leaf()) {
+        return current;
+    }
+    else {
+        if (compare(current.operation, sample[current.feature_index], current.threshold)) {
+            return embedded_leaf<Nodes, current.left_node>(sample);
+        }
+        return embedded_leaf<Nodes, current.right_node>(sample);
+    }
+}
+
+/**
+ * @brief Forest embedded in the program by the header generated by the dtc_pygen gen_cpp command. It has no state, the trees are constexpr
+ *        node tables given as template arguments and each of them is unrolled by embedded_leaf. The results are the ones of Forest.
+ *
+ * @tparam FeatureT Feature type of the model.
+ * @tparam NumClasses Number of classes, 0 for regression forests.
+ * @tparam NumFeatures Number of features of a sample.
+ * @tparam Trees Node tables of the trees, the root is the first node of each table.
+ */
+template <typename FeatureT, std::uint16_t NumClasses, std::uint16_t NumFeatures, const auto&... Trees>
+struct embedded_forest {
+    static_assert(std::is_same_v<FeatureT, float> || std::is_same_v<FeatureT, double>, "FeatureT must be float or double");
+    static_assert(sizeof...(Trees) > 0, "an embedded forest needs at least a tree");
+
+    using feature_type = FeatureT;
+    using node_type = node<FeatureT>;
+    using sample_type = std::span<const FeatureT, NumFeatures>;
+
+    static constexpr std::uint16_t num_classes = NumClasses;
+    static constexpr std::uint16_t num_features = NumFeatures;
+    static constexpr std::uint16_t num_trees = sizeof...(Trees);
+
+    /** Index of the leaf reached in each tree, relative to its root as in the binary configuration. */
+    static constexpr std::array<std::size_t, num_trees> leaf_indices(sample_type sample) noexcept {
+        return {static_cast<std::size_t>(&embedded_leaf<Trees>(sample.data()) - &Trees[0])...};
+    }
+
+    /** Majority voting class of a sample, the first class reaching the maximum number of votes wins as in majority_voting. */
+    template <typename ClassT = std::int16_t>
+    static constexpr ClassT predict(sample_type sample, std::uint16_t* const votes = nullptr) noexcept {
+        static_assert(NumClasses > 0, "predict needs a classification forest");
+        std::array<std::uint16_t, NumClasses> counts{};
+        std::uint16_t max_count = 0;
+        ClassT result = -1;
+        const auto vote = [&](const std::int16_t leaf_class) {
+            if (leaf_class >= 0 && leaf_class < NumClasses && ++counts[leaf_class] > max_count) {
+                max_count = counts[leaf_class];
+                result = static_cast<ClassT>(leaf_class);
+            }
+        };
+        // The comma fold visits the trees in order, so that the draws are broken as in majority_voting.
+        (vote(embedded_leaf<Trees>(sample.data()).class_result), ...);
+        if (nullptr != votes) {
+            *votes = max_count;
+        }
+        return result;
+    }
+
+    /** Majority voting classes of a row-major [classes.size() x num_features] matrix. */
+    template <typename ClassT>
+    static void predict(std::span<const FeatureT> features, std::span<ClassT> classes) {
+        if (features.size() != classes.size() * NumFeatures) {
+            throw std::invalid_argument("features must be a row-major [rows x num_features] matrix");
+        }
+        for (std::size_t s = 0; s < classes.size(); s++) {
+            classes[s] = predict<ClassT>(features.subspan(s * NumFeatures).template first<NumFeatures>());
+        }
+    }
+
+    /** Mean of the leaf values of a regression forest. */
+    static constexpr FeatureT predict_mean(sample_type sample) noexcept {
+        return (FeatureT(0) + ... + embedded_leaf<Trees>(sample.data()).threshold) / static_cast<FeatureT>(num_trees);
+    }
+};
+
+/**
+ * @brief Binary dataset generated by the dtc_pygen gen_test_bin command with the feature type FeatureT, mapped in memory as by
+ *        load_tree_dataset. The handle owns the mapping and is move-only, features and labels are read-only spans inside it.
+ */
+template <typename FeatureT>
+class Dataset {
+public:
+    /**
+     * @brief Maps the binary dataset at path.
+     * @throw dtc::error If the file can not be mapped, it is not a valid binary dataset or its features are not FeatureT.
+     */
+    explicit Dataset(const std::filesystem::path& path) {
+#if DTC_HPP_USE_MMAP
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat file_stat;
+        if (fd < 0 || ::fstat(fd, &file_stat) != 0 || file_stat.st_size < 64) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            throw error("can not map " + path.string());
+        }
+        size_ = static_cast<std::size_t>(file_stat.st_size);
+        void* const mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (MAP_FAILED == mapping) {
+            throw error("can not map " + path.string());
+        }
+        data_ = static_cast<const std::byte*>(mapping);
+#else
+        buffer_ = detail::read_file(path);
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+#endif
+        try {
+            parse_header();
+        }
+        catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    Dataset(const Dataset&) = delete;
+    Dataset& operator=(const Dataset&) = delete;
+    Dataset(Dataset&& other) noexcept { *this = std::move(other); }
+    Dataset& operator=(Dataset&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+#if !DTC_HPP_USE_MMAP
+            buffer_ = std::move(other.buffer_);
+#endif
+            features_ = std::exchange(other.features_, {});
+            labels_ = std::exchange(other.labels_, {});
+            num_features_ = std::exchange(other.num_features_, 0);
+        }
+        return *this;
+    }
+    ~Dataset() { release(); }
+
+    std::size_t num_samples() const noexcept { return 0 == num_features_ ? 0 : features_.size() / num_features_; }
+    std::uint16_t num_features() const noexcept { return num_features_; }
+    /** Row-major [num_samples x num_features] matrix. */
+    std::span<const FeatureT> features() const noexcept { return features_; }
+    /** Label of each sample, empty if the dataset has no labels. */
+    std::span<const std::int16_t> labels() const noexcept { return labels_; }
+
+private:
+    void parse_header() {
+        std::uint32_t magic;
+        std::uint16_t version, feature_size;
+        std::uint64_t num_samples, features_offset, labels_offset;
+        std::memcpy(&magic, data_, sizeof(magic));
+        std::memcpy(&version, data_ + 4, sizeof(version));
+        std::memcpy(&feature_size, data_ + 6, sizeof(feature_size));
+        std::memcpy(&num_samples, data_ + 8, sizeof(num_samples));
+        std::memcpy(&num_features_, data_ + 16, sizeof(num_features_));
+        std::memcpy(&features_offset, data_ + 24, sizeof(features_offset));
+        std::memcpy(&labels_offset, data_ + 32, sizeof(labels_offset));
+        if (dataset_magic != magic || dataset_version != version) {
+            throw error("not a binary dataset");
+        }
+        if (sizeof(FeatureT) != feature_size) {
+            throw error("the features of the dataset are not of the feature type of the forest");
+        }
+        if (0 == num_features_ || num_samples > UINT64_MAX / num_features_ || !valid_region(features_offset, num_samples * num_features_, sizeof(FeatureT)) ||
+            (0 != labels_offset && !valid_region(labels_offset, num_samples, sizeof(std::int16_t)))) {
+            throw error("invalid or truncated binary dataset");
+        }
+        features_ = {reinterpret_cast<const FeatureT*>(data_ + features_offset), static_cast<std::size_t>(num_samples * num_features_)};
+        if (0 != labels_offset) {
+            labels_ = {reinterpret_cast<const std::int16_t*>(data_ + labels_offset), static_cast<std::size_t>(num_samples)};
+        }
+    }
+
+    bool valid_region(const std::uint64_t offset, const std::uint64_t count, const std::uint64_t element_size) const noexcept {
+        return 0 == offset % 64 && offset >= 64 && offset <= size_ && count <= (size_ - offset) / element_size;
+    }
+
+    void release() noexcept {
+#if DTC_HPP_USE_MMAP
+        if (nullptr != data_) {
+            ::munmap(const_cast<std::byte*>(data_), size_);
+        }
+#else
+        buffer_.clear();
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+#if !DTC_HPP_USE_MMAP
+    std::vector<std::byte> buffer_;
+#endif
+    std::span<const FeatureT> features_;
+    std::span<const std::int16_t> labels_;
+    std::uint16_t num_features_ = 0;
+};
+
+} // namespace dtc
+
+#endif // DTC_HPP
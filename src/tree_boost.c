@@ -0,0 +1,141 @@
+/*
+ * This file is part of DTC: Decision Tree in C-lang project.
+ *
+ * DTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DTC. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tree_boost.c
+ * @author Antonio Emmanuele (antony.35.ae@gmail.com)
+ * @brief  Contains the function implementations for scoring gradient boosted ensembles of trees.
+ * @version 0.1
+ * @date 2025-01-20
+ * 
+ * @copyright Copyright (c) 2025 Antonio Emmanuele
+ * 
+ */
+#include "tree_boost.h"
+#include "string.h"
+#include "math.h"
+
+#if USE_FLOAT
+#define EXP(x) expf(x)
+#else
+#define EXP(x) exp(x)
+#endif
+
+/**
+ * @brief Applies the objective transformation to the margins of a sample.
+ * 
+ * @param[in] objective One of the BOOSTING_OBJECTIVE_* values.
+ * @param[in] number_outputs Number of margins.
+ * @param[in,out] margins Margins of the sample, replaced by the transformed values.
+ */
+static void transform_margins(const uint16_t objective, const uint16_t number_outputs, feature_type_t* const margins){
+    if(BOOSTING_OBJECTIVE_SIGMOID == objective){
+        for(uint16_t o = 0; o < number_outputs; o++){
+            margins[o] = 1 / (1 + EXP(-margins[o]));
+        }
+    }
+    else if(BOOSTING_OBJECTIVE_SOFTMAX == objective){
+        // Subtract the maximum margin to avoid overflows.
+        feature_type_t max_margin = margins[0];
+        for(uint16_t o = 1; o < number_outputs; o++){
+            max_margin = (margins[o] > max_margin) ? margins[o] : max_margin;
+        }
+        feature_type_t sum = 0;
+        for(uint16_t o = 0; o < number_outputs; o++){
+            margins[o] = EXP(margins[o] - max_margin);
+            sum += margins[o];
+        }
+        for(uint16_t o = 0; o < number_outputs; o++){
+            margins[o] /= sum;
+        }
+    }
+}
+
+int visit_gbdt(node_t* const trees[], const uint16_t number_trees, const boosting_t* const boosting, const feature_type_t* const features, feature_type_t* const outputs){
+    int to_ret = CLASSIFICATION_OK;
+    const node_t* leaf_node = NULL;
+    memcpy(outputs, boosting -> base_scores, boosting -> num_outputs * sizeof(feature_type_t));
+    for(uint16_t tree_idx = 0U; tree_idx < number_trees; tree_idx++){
+        if(CLASSIFICATION_OK == visit_tree_leaf(trees[tree_idx], features, &leaf_node)){
+            outputs[boosting -> tree_outputs[tree_idx]] += leaf_node -> leaf_value;
+        }
+#if COMPILE_PRUNED
+        else{
+            to_ret = CLASSIFICATION_PRUNED;
+        }
+#endif
+    }
+    transform_margins(boosting -> objective, boosting -> num_outputs, outputs);
+    return to_ret;
+}
+
+int visit_gbdt_batch(   node_t* const trees[],
+                        const uint16_t number_trees,
+                        const boosting_t* const boosting,
+                        const feature_type_t* const features,
+                        const uint32_t number_samples,
+                        const uint16_t number_features,
+                        feature_type_t* const outputs){
+    int to_ret = CLASSIFICATION_OK;
+    const node_t* leaf_node = NULL;
+    const uint16_t number_outputs = boosting -> num_outputs;
+    feature_type_t leaf_values[BOOSTING_BLOCK_SIZE];
+    // Margins of the block, one contiguous row of block_samples samples per output. They are not sized on the model, as a VLA of
+    // num_outputs x BOOSTING_BLOCK_SIZE could overflow the stack of a worker thread.
+    feature_type_t stack_margins[BOOSTING_STACK_MARGINS];
+    uint32_t block_samples = BOOSTING_STACK_MARGINS / number_outputs;
+    block_samples = (block_samples > BOOSTING_BLOCK_SIZE) ? BOOSTING_BLOCK_SIZE : block_samples;
+    // With more outputs than the stack margins, a block is a single sample, accumulated in place in its row of outputs.
+    const uint8_t in_place = (0U == block_samples);
+    block_samples = in_place ? 1U : block_samples;
+    for(uint32_t block_start = 0U; block_start < number_samples; block_start += block_samples){
+        const uint32_t block_size = (number_samples - block_start < block_samples) ? (number_samples - block_start) : block_samples;
+        feature_type_t* const block_margins = in_place ? &outputs[(size_t) block_start * number_outputs] : stack_margins;
+        for(uint16_t o = 0; o < number_outputs; o++){
+            for(uint32_t s = 0U; s < block_size; s++){
+                block_margins[o * block_samples + s] = boosting -> base_scores[o];
+            }
+        }
+        for(uint16_t tree_idx = 0U; tree_idx < number_trees; tree_idx++){
+            feature_type_t* const tree_margins = &block_margins[boosting -> tree_outputs[tree_idx] * block_samples];
+            for(uint32_t s = 0U; s < block_size; s++){
+                const feature_type_t* const sample = &features[(size_t) (block_start + s) * number_features];
+                if(CLASSIFICATION_OK == visit_tree_leaf(trees[tree_idx], sample, &leaf_node)){
+                    leaf_values[s] = leaf_node -> leaf_value;
+                }
+                else{
+                    leaf_values[s] = 0;
+#if COMPILE_PRUNED
+                    to_ret = CLASSIFICATION_PRUNED;
+#endif
+                }
+            }
+            for(uint32_t s = 0U; s < block_size; s++){
+                tree_margins[s] += leaf_values[s];
+            }
+        }
+        // Transpose the block in the row-major output and transform each sample.
+        for(uint32_t s = 0U; s < block_size; s++){
+            feature_type_t* const sample_outputs = &outputs[(size_t) (block_start + s) * number_outputs];
+            for(uint16_t o = 0; !in_place && o < number_outputs; o++){
+                sample_outputs[o] = block_margins[o * block_samples + s];
+            }
+            transform_margins(boosting -> objective, number_outputs, sample_outputs);
+        }
+    }
+    return to_ret;
+}
@@ -0,0 +1,100 @@
+/*
+ * This file is part of DTC: Decision Tree in C-lang project.
+ *
+ * DTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DTC. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tree_boost.h
+ * @author Antonio Emmanuele (antony.35.ae@gmail.com)
+ * @brief   Contains the function prototypes for scoring gradient boosted ensembles of trees (e.g. XGBoost and LightGBM models).
+ * @version 0.1
+ * @date 2025-01-20
+ * 
+ * @copyright Copyright (c) 2025 Antonio Emmanuele
+ * 
+ */
+#ifndef TREE_BOOST_H
+#define TREE_BOOST_H
+
+#include "tree_visit.h"
+
+#define BOOSTING_OBJECTIVE_RAW      0   /**< Outputs are the raw margins, e.g. regression models. */
+#define BOOSTING_OBJECTIVE_SIGMOID  1   /**< Outputs are the sigmoid of the margins, e.g. binary classification. */
+#define BOOSTING_OBJECTIVE_SOFTMAX  2   /**< Outputs are the softmax of the margins, e.g. multi-class classification. */
+
+#ifndef BOOSTING_BLOCK_SIZE
+#define BOOSTING_BLOCK_SIZE 64          /**< Number of samples processed together by visit_gbdt_batch. */
+#endif
+
+#ifndef BOOSTING_STACK_MARGINS
+#define BOOSTING_STACK_MARGINS 2048     /**< Margins of visit_gbdt_batch on the stack, shared by the samples of a block. */
+#endif
+
+/**
+ * @typedef boosting_t
+ * @brief   Additive structure of a gradient boosted ensemble.
+ *          Each tree adds the value of its reached leaf to a single output margin (i.e. a class for multi-class models).
+ */
+typedef struct{
+    uint16_t objective;                 /**< Transformation of the margins, i.e. one of the BOOSTING_OBJECTIVE_* values. */
+    uint16_t num_outputs;               /**< Number of margins. 1 for regression and binary classification, the number of classes otherwise. */
+    feature_type_t* base_scores;        /**< Initial value of each margin. */
+    uint16_t* tree_outputs;             /**< Margin to which each tree contributes. */
+} boosting_t;
+
+/**
+ * @brief Scores a gradient boosted ensemble for a single sample.
+ *        Margins are initialized with the base scores, each tree adds its leaf value to its margin and, finally, 
+ *        the objective transformation is applied.
+ * 
+ * @param[in] trees Array of pointers to the root nodes of the trees.
+ * @param[in] number_trees Number of trees in the ensemble.
+ * @param[in] boosting Additive structure of the ensemble.
+ * @param[in] features Array of feature values.
+ * @param[out] outputs Array of boosting->num_outputs transformed margins.
+ * @return int Status of the visit operation.
+ * @retval CLASSIFICATION_OK Scoring was successful.
+ * @retval CLASSIFICATION_PRUNED At least a tree was pruned. Pruned trees do not contribute to the margins.
+ */
+int visit_gbdt(node_t* const trees[], const uint16_t number_trees, const boosting_t* const boosting, const feature_type_t* const features, feature_type_t* const outputs);
+
+/**
+ * @brief Batched version of visit_gbdt.
+ *        Samples are processed in blocks of up to BOOSTING_BLOCK_SIZE. Each tree is visited for the whole block, and its leaf values 
+ *        are added to a per-margin contiguous accumulator, so that the additions are vectorized across samples.
+ *        The margins of a block are BOOSTING_STACK_MARGINS values on the stack, so that the stack usage does not depend on the model:
+ *        blocks are shrunk to BOOSTING_STACK_MARGINS / num_outputs samples, and models with more outputs are scored a sample at a time
+ *        directly in its row of outputs.
+ * 
+ * @param[in] trees Array of pointers to the root nodes of the trees.
+ * @param[in] number_trees Number of trees in the ensemble.
+ * @param[in] boosting Additive structure of the ensemble.
+ * @param[in] features Row-major matrix of [number_samples x number_features] input samples.
+ * @param[in] number_samples Number of samples (rows) of the features matrix.
+ * @param[in] number_features Number of features (columns) of the features matrix.
+ * @param[out] outputs Row-major matrix of [number_samples x boosting->num_outputs] transformed margins.
+ * @return int Status of the visit operation.
+ * @retval CLASSIFICATION_OK Scoring was successful.
+ * @retval CLASSIFICATION_PRUNED At least a tree was pruned for at least a sample.
+ */
+int visit_gbdt_batch(   node_t* const trees[],
+                        const uint16_t number_trees,
+                        const boosting_t* const boosting,
+                        const feature_type_t* const features,
+                        const uint32_t number_samples,
+                        const uint16_t number_features,
+                        feature_type_t* const outputs);
+
+#endif // TREE_BOOST_H
@@ -1 +1,659 @@
-#include "tree_conf.h"
\ No newline at end of file
+/*
+ * This file is part of DTC: Decision Tree in C-lang project.
+ *
+ * DTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DTC. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tree_conf.c
+ * @author Antonio Emmanuele (antony.35.ae@gmail.com)
+ * @brief  Contains the implementation of the functions loading the classifier from a binary file.
+ * @version 0.1
+ * @date 2024-12-29
+ *
+ * @copyright Copyright (c) 2024 Antonio Emmanuele
+ *
+ */
+#include "tree_conf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Validates the nodes of a tree read from the binary, see load_tree_conf, computing its longest path.
+ *        The tree is visited in post-order with an explicit stack, so the validation is O(num_nodes) even if subtrees are shared.
+ *
+ * @param[in] nodes Nodes of the tree.
+ * @param[in] num_nodes Number of nodes of the tree, at least 1.
+ * @param[in] trailer Trailer of the binary, giving the number of features and classes.
+ * @param[out] state Working memory of num_nodes elements: 0 not visited, 1 on the path from the root, 2 visited.
+ * @param[out] height Working memory of num_nodes elements, the longest path from each visited node.
+ * @param[out] stack Working memory of 2 * num_nodes + 3 elements.
+ * @param[out] max_depth Longest path of the tree.
+ * @return int CONF_OK, or CONF_ERR_FORMAT if the tree is not valid.
+ */
+static int validate_tree(const bin_node_t* const nodes, const uint16_t num_nodes, const bin_trailer_t* const trailer,
+                         uint8_t* const state, uint16_t* const height, int32_t* const stack, uint16_t* const max_depth){
+    size_t top = 0;
+    memset(state, 0, num_nodes);
+    stack[top++] = 0;
+    while(top > 0){
+        const int32_t idx = stack[top - 1];
+        if(2 == state[idx]){
+            top--;
+            continue;
+        }
+        const bin_node_t* const node = &nodes[idx];
+        const int32_t children[2] = {node -> left_node, node -> right_node};
+        uint8_t pending = 0;
+        for(uint8_t c = 0; c < 2; c++){
+            if(children[c] < -1 || children[c] >= num_nodes){
+                return CONF_ERR_FORMAT;
+            }
+            if(-1 != children[c] && 2 != state[children[c]]){
+                stack[top++] = children[c];
+                pending++;
+            }
+        }
+        if(pending > 0){
+            // The children of a node on the path from the root are not visited yet only if the node is its own descendant.
+            if(1 == state[idx]){
+                return CONF_ERR_FORMAT;
+            }
+            state[idx] = 1;
+            continue;
+        }
+        state[idx] = 2;
+        top--;
+        if(-1 == children[0] && -1 == children[1]){
+            if(trailer -> num_classes > 0 && (node -> class < 0 || node -> class >= trailer -> num_classes)){
+                return CONF_ERR_FORMAT;
+            }
+            height[idx] = 0;
+            continue;
+        }
+#if !(USE_POINTERS && COMPILE_PRUNED)
+        // Without pointers a missing child would be visited at index -1, a single child is only a pruned node with USE_POINTERS.
+        if(-1 == children[0] || -1 == children[1]){
+            return CONF_ERR_FORMAT;
+        }
+#endif
+        if(node -> operator >= NUM_OPERATORS || node -> feature_index >= trailer -> num_features){
+            return CONF_ERR_FORMAT;
+        }
+        const uint16_t left_height = (-1 == children[0]) ? 0 : height[children[0]];
+        const uint16_t right_height = (-1 == children[1]) ? 0 : height[children[1]];
+        height[idx] = 1 + ((left_height > right_height) ? left_height : right_height);
+    }
+    *max_depth = height[0];
+    return CONF_OK;
+}
+
+/**
+ * @brief Reads and validates the nodes of a tree. With USE_POINTERS the children indexes of the binary are converted in pointers.
+ *
+ * @param[in] file Binary file, positioned at the beginning of the nodes of the tree.
+ * @param[in] num_nodes Number of nodes of the tree, at least 1.
+ * @param[in] trailer Trailer of the binary.
+ * @param[out] tree Nodes of the tree.
+ * @param[out] max_depth Longest path of the tree.
+ * @return int CONF_OK or an error code.
+ */
+static int read_tree(FILE* const file, const uint16_t num_nodes, const bin_trailer_t* const trailer, node_t* const tree, uint16_t* const max_depth){
+    // A single block for the nodes of the binary and the working memory of the validation.
+    uint8_t* block = (uint8_t *) malloc(num_nodes * (sizeof(bin_node_t) + sizeof(uint16_t) + 2 * sizeof(int32_t) + 1) + 3 * sizeof(int32_t));
+    if(NULL == block){
+        return CONF_ERR_ALLOC;
+    }
+    bin_node_t* const nodes = (bin_node_t *) block;
+    int32_t* const stack = (int32_t *) &nodes[num_nodes];
+    uint16_t* const height = (uint16_t *) &stack[2 * num_nodes + 3];
+    uint8_t* const state = (uint8_t *) &height[num_nodes];
+    int to_ret = CONF_OK;
+    if(fread(nodes, sizeof(bin_node_t), num_nodes, file) != num_nodes){
+        to_ret = CONF_ERR_READ;
+    }
+    else{
+        to_ret = validate_tree(nodes, num_nodes, trailer, state, height, stack, max_depth);
+    }
+#if USE_POINTERS
+    for(uint16_t i = 0; CONF_OK == to_ret && i < num_nodes; i++){
+        tree[i].operator = nodes[i].operator;
+        tree[i].feature_index = nodes[i].feature_index;
+        tree[i].class = nodes[i].class;
+        tree[i].threshold = nodes[i].threshold;
+        tree[i].left_child = (-1 == nodes[i].left_node) ? NULL : &tree[nodes[i].left_node];
+        tree[i].right_child = (-1 == nodes[i].right_node) ? NULL : &tree[nodes[i].right_node];
+    }
+#else
+    if(CONF_OK == to_ret){
+        memcpy(tree, nodes, num_nodes * sizeof(node_t));
+    }
+#endif
+    free(block);
+    return to_ret;
+}
+
+/**
+ * @brief Reads the BIN_SECTION_LEAF_PROBA section content, allocating a single block for all the trees.
+ *
+ * @param[in] file Binary file, positioned at the beginning of the section content.
+ * @param[in] section_size Size of the section content.
+ * @param[in,out] conf Classifier whose trees are already loaded.
+ * @return int CONF_OK or an error code.
+ */
+static int read_leaf_probabilities(FILE* const file, const uint32_t section_size, tree_conf_t* const conf){
+    size_t total_values = 0U;
+    for(uint16_t t = 0; t < conf -> trailer.num_trees; t++){
+        total_values += (size_t) conf -> num_nodes[t] * conf -> trailer.num_classes;
+    }
+    if(total_values * sizeof(float) != section_size || NULL != conf -> leaf_probabilities){
+        return CONF_ERR_FORMAT;
+    }
+    conf -> leaf_probabilities = (float **) calloc(conf -> trailer.num_trees, sizeof(float *));
+    float* values = (float *) malloc(total_values * sizeof(float));
+    if(NULL == conf -> leaf_probabilities || NULL == values){
+        free(values);
+        return CONF_ERR_ALLOC;
+    }
+    if(fread(values, sizeof(float), total_values, file) != total_values){
+        free(values);
+        return CONF_ERR_READ;
+    }
+    // The first tree owns the block, so that free_tree_conf releases it with a single free.
+    for(uint16_t t = 0; t < conf -> trailer.num_trees; t++){
+        conf -> leaf_probabilities[t] = values;
+        values += (size_t) conf -> num_nodes[t] * conf -> trailer.num_classes;
+    }
+    return CONF_OK;
+}
+
+/**
+ * @brief Reads the BIN_SECTION_BOOSTING section content.
+ *
+ * @param[in] file Binary file, positioned at the beginning of the section content.
+ * @param[in] section_size Size of the section content.
+ * @param[in,out] conf Classifier whose trees are already loaded.
+ * @return int CONF_OK or an error code.
+ */
+static int read_boosting(FILE* const file, const uint32_t section_size, tree_conf_t* const conf){
+    bin_boosting_t header;
+    if(NULL != conf -> boosting || section_size < sizeof(bin_boosting_t)){
+        return CONF_ERR_FORMAT;
+    }
+    if(fread(&header, sizeof(bin_boosting_t), 1, file) != 1){
+        return CONF_ERR_READ;
+    }
+    if(0 == header.num_outputs || section_size != sizeof(bin_boosting_t) + header.num_outputs * sizeof(feature_type_t) + conf -> trailer.num_trees * sizeof(uint16_t)){
+        return CONF_ERR_FORMAT;
+    }
+    conf -> boosting = (boosting_t *) calloc(1, sizeof(boosting_t));
+    if(NULL == conf -> boosting){
+        return CONF_ERR_ALLOC;
+    }
+    conf -> boosting -> objective = header.objective;
+    conf -> boosting -> num_outputs = header.num_outputs;
+    conf -> boosting -> base_scores = (feature_type_t *) malloc(header.num_outputs * sizeof(feature_type_t));
+    conf -> boosting -> tree_outputs = (uint16_t *) malloc(conf -> trailer.num_trees * sizeof(uint16_t));
+    if(NULL == conf -> boosting -> base_scores || NULL == conf -> boosting -> tree_outputs){
+        return CONF_ERR_ALLOC;
+    }
+    if(fread(conf -> boosting -> base_scores, sizeof(feature_type_t), header.num_outputs, file) != header.num_outputs ||
+        fread(conf -> boosting -> tree_outputs, sizeof(uint16_t), conf -> trailer.num_trees, file) != conf -> trailer.num_trees){
+        return CONF_ERR_READ;
+    }
+    // Checked once here, so that visit_gbdt does not need to.
+    for(uint16_t t = 0; t < conf -> trailer.num_trees; t++){
+        if(conf -> boosting -> tree_outputs[t] >= header.num_outputs){
+            return CONF_ERR_FORMAT;
+        }
+    }
+    return CONF_OK;
+}
+
+int load_tree_conf(const char* const file_path, tree_conf_t* const conf){
+    int to_ret = CONF_OK;
+    memset(conf, 0, sizeof(tree_conf_t));
+    FILE* file = fopen(file_path, "rb");
+    if(NULL == file){
+        return CONF_ERR_OPEN;
+    }
+    if(fread(&conf -> trailer, sizeof(bin_trailer_t), 1, file) != 1){
+        fclose(file);
+        return CONF_ERR_READ;
+    }
+    conf -> trees = (node_t **) calloc(conf -> trailer.num_trees, sizeof(node_t *));
+    conf -> num_nodes = (uint16_t *) calloc(conf -> trailer.num_trees, sizeof(uint16_t));
+    conf -> max_depth = (uint16_t *) calloc(conf -> trailer.num_trees, sizeof(uint16_t));
+    if(NULL == conf -> trees || NULL == conf -> num_nodes || NULL == conf -> max_depth){
+        to_ret = CONF_ERR_ALLOC;
+    }
+    // Trees, each one preceded by its number of nodes.
+    for(uint16_t t = 0; CONF_OK == to_ret && t < conf -> trailer.num_trees; t++){
+        if(fread(&conf -> num_nodes[t], sizeof(uint16_t), 1, file) != 1){
+            to_ret = CONF_ERR_READ;
+            break;
+        }
+        // Empty trees can not be visited.
+        if(0 == conf -> num_nodes[t]){
+            to_ret = CONF_ERR_FORMAT;
+            break;
+        }
+        conf -> trees[t] = (node_t *) malloc(conf -> num_nodes[t] * sizeof(node_t));
+        if(NULL == conf -> trees[t]){
+            to_ret = CONF_ERR_ALLOC;
+        }
+        else{
+            to_ret = read_tree(file, conf -> num_nodes[t], &conf -> trailer, conf -> trees[t], &conf -> max_depth[t]);
+        }
+    }
+    // Optional sections, until the end of the file.
+    bin_section_t section;
+    while(CONF_OK == to_ret && fread(&section, sizeof(bin_section_t), 1, file) == 1){
+        switch(section.section_id){
+            case BIN_SECTION_LEAF_PROBA:
+                to_ret = read_leaf_probabilities(file, section.section_size, conf);
+                break;
+            case BIN_SECTION_BOOSTING:
+                to_ret = read_boosting(file, section.section_size, conf);
+                break;
+            default:
+                to_ret = CONF_ERR_FORMAT;
+                break;
+        }
+    }
+    fclose(file);
+    if(CONF_OK != to_ret){
+        free_tree_conf(conf);
+    }
+    return to_ret;
+}
+
+/**
+ * @brief Node of the canonical forest built by optimize_tree_conf, i.e. a node content stored only once.
+ */
+typedef struct{
+    node_t node;            /**< Copy of the first node with this content. Its children are left and right. */
+    int32_t left;           /**< Canonical left child, -1 if none. */
+    int32_t right;          /**< Canonical right child, -1 if none. */
+    int32_t position;       /**< Position in the optimized layout, -1 until the node is placed. */
+    uint32_t tree_stamp;    /**< Last tree (plus one) whose layout reached the node. */
+    uint16_t source;        /**< Index of the copied node in its tree, i.e. the row of its leaf distribution. */
+    uint16_t height;        /**< Longest path from the node. */
+} canon_node_t;
+
+/**
+ * @brief Working memory of optimize_tree_conf, allocated once for all the trees.
+ */
+typedef struct{
+    canon_node_t* canon_nodes;  /**< Canonical nodes. */
+    uint32_t num_canon;         /**< Number of canonical nodes. */
+    uint32_t* table;            /**< Open addressing hash table of the canonical nodes, each slot contains the index plus one or 0 if empty. */
+    size_t table_mask;          /**< Size of the table in use minus one, it is a power of two. */
+    int32_t* canon_of;          /**< Canonical node of each node of the current tree. */
+    uint8_t* state;             /**< 0 not visited, 1 on the path from the root, 2 visited, for each node of the current tree. */
+    int32_t* stack;             /**< Explicit stack of the visits. */
+    float* rows;                /**< Copy of the leaf distributions of the current tree, NULL without BIN_SECTION_LEAF_PROBA. */
+    uint16_t number_classes;    /**< Length of the rows. */
+} optimizer_t;
+
+/**
+ * @brief Returns the index of a child relative to the root of its tree, -1 if the node has no such child.
+ */
+static inline int32_t child_index(const node_t* const root_node, const node_t* const node, const uint8_t left){
+#if USE_POINTERS
+    const node_t* const child = left ? node -> left_child : node -> right_child;
+    return (NULL == child) ? -1 : (int32_t) (child - root_node);
+#else
+    (void) root_node;
+    return left ? node -> left_node : node -> right_node;
+#endif
+}
+
+/**
+ * @brief FNV-1a hash of size bytes, starting from hash.
+ */
+static uint32_t hash_bytes(uint32_t hash, const void* const data, const size_t size){
+    const uint8_t* const bytes = (const uint8_t *) data;
+    for(size_t i = 0; i < size; i++){
+        hash = (hash ^ bytes[i]) * 16777619U;
+    }
+    return hash;
+}
+
+/**
+ * @brief Returns the leaf distribution of a canonical node of the current tree, NULL for the internal nodes or without distributions.
+ */
+static inline const float* canon_row(const optimizer_t* const opt, const canon_node_t* const canon){
+    if(NULL == opt -> rows || -1 != canon -> left || -1 != canon -> right){
+        return NULL;
+    }
+    return &opt -> rows[(size_t) canon -> source * opt -> number_classes];
+}
+
+/**
+ * @brief Hashes the content of a canonical node. The threshold is hashed by its bytes, so that it is consistent with same_content.
+ */
+static uint32_t hash_canon(const optimizer_t* const opt, const canon_node_t* const canon){
+    uint32_t hash = 2166136261U;
+    const float* const row = canon_row(opt, canon);
+    hash = hash_bytes(hash, &canon -> node.operator, sizeof(operator_t));
+    hash = hash_bytes(hash, &canon -> node.feature_index, sizeof(feature_idx_t));
+    hash = hash_bytes(hash, &canon -> node.class, sizeof(class_t));
+    hash = hash_bytes(hash, &canon -> node.threshold, sizeof(feature_type_t));
+    hash = hash_bytes(hash, &canon -> left, sizeof(int32_t));
+    hash = hash_bytes(hash, &canon -> right, sizeof(int32_t));
+    if(NULL != row){
+        hash = hash_bytes(hash, row, opt -> number_classes * sizeof(float));
+    }
+    return hash;
+}
+
+/**
+ * @brief Checks whether two canonical nodes have the same content, i.e. whether the visiting functions can not tell them apart.
+ */
+static uint8_t same_content(const optimizer_t* const opt, const canon_node_t* const a, const canon_node_t* const b){
+    const float* const row_a = canon_row(opt, a);
+    const float* const row_b = canon_row(opt, b);
+    return a -> node.operator == b -> node.operator && a -> node.feature_index == b -> node.feature_index &&
+            a -> node.class == b -> node.class && a -> left == b -> left && a -> right == b -> right &&
+            0 == memcmp(&a -> node.threshold, &b -> node.threshold, sizeof(feature_type_t)) &&
+            (NULL == row_a || 0 == memcmp(row_a, row_b, opt -> number_classes * sizeof(float)));
+}
+
+/**
+ * @brief Maps each node reachable from the root of a tree on its canonical node, visiting the tree in post-order with an explicit stack.
+ *        Splits with identical canonical children are mapped on the child, the other nodes are looked up in the hash table and added if missing.
+ *
+ * @param[in,out] opt Working memory, whose canonical nodes and table are extended.
+ * @param[in] root_node Root of the tree.
+ * @param[in] num_nodes Number of nodes of the tree.
+ * @param[in,out] stats Collapsed splits and shared nodes are counted here.
+ * @param[out] canon_root Canonical node of the root.
+ * @return int CONF_OK, or CONF_ERR_FORMAT if children are out of bounds or the tree contains a cycle.
+ */
+static int build_canon_tree(optimizer_t* const opt, const node_t* const root_node, const uint16_t num_nodes,
+                            conf_optimize_stats_t* const stats, int32_t* const canon_root){
+    size_t top = 0;
+    memset(opt -> state, 0, num_nodes);
+    opt -> stack[top++] = 0;
+    while(top > 0){
+        const int32_t idx = opt -> stack[top - 1];
+        if(2 == opt -> state[idx]){
+            top--;
+            continue;
+        }
+        const int32_t children[2] = {child_index(root_node, &root_node[idx], 1), child_index(root_node, &root_node[idx], 0)};
+        uint8_t pending = 0;
+        for(uint8_t c = 0; c < 2; c++){
+            if(children[c] < -1 || children[c] >= num_nodes){
+                return CONF_ERR_FORMAT;
+            }
+            if(-1 != children[c] && 2 != opt -> state[children[c]]){
+                opt -> stack[top++] = children[c];
+                pending++;
+            }
+        }
+#if !(USE_POINTERS && COMPILE_PRUNED)
+        // Only pruned trees have nodes with a single child.
+        if((-1 == children[0]) != (-1 == children[1])){
+            return CONF_ERR_FORMAT;
+        }
+#endif
+        if(pending > 0){
+            // The children of a node on the path from the root are not visited yet only if the node is its own descendant.
+            if(1 == opt -> state[idx]){
+                return CONF_ERR_FORMAT;
+            }
+            opt -> state[idx] = 1;
+            continue;
+        }
+        opt -> state[idx] = 2;
+        top--;
+        canon_node_t candidate;
+        memset(&candidate, 0, sizeof(canon_node_t));
+        candidate.node = root_node[idx];
+        candidate.left = (-1 == children[0]) ? -1 : opt -> canon_of[children[0]];
+        candidate.right = (-1 == children[1]) ? -1 : opt -> canon_of[children[1]];
+        candidate.position = -1;
+        candidate.source = (uint16_t) idx;
+        // Children are canonical before their parents, so their height is known.
+        const uint16_t left_height = (-1 == candidate.left) ? 0 : opt -> canon_nodes[candidate.left].height;
+        const uint16_t right_height = (-1 == candidate.right) ? 0 : opt -> canon_nodes[candidate.right].height;
+        candidate.height = (-1 == candidate.left && -1 == candidate.right) ? 0 : 1 + ((left_height > right_height) ? left_height : right_height);
+        if(-1 != candidate.left && candidate.left == candidate.right){
+            opt -> canon_of[idx] = candidate.left;
+            stats -> collapsed_splits++;
+            continue;
+        }
+        size_t slot = hash_canon(opt, &candidate) & opt -> table_mask;
+        while(0 != opt -> table[slot] && !same_content(opt, &opt -> canon_nodes[opt -> table[slot] - 1], &candidate)){
+            slot = (slot + 1) & opt -> table_mask;
+        }
+        if(0 != opt -> table[slot]){
+            opt -> canon_of[idx] = (int32_t) opt -> table[slot] - 1;
+            stats -> shared_nodes++;
+        }
+        else{
+            opt -> canon_nodes[opt -> num_canon] = candidate;
+            opt -> canon_of[idx] = (int32_t) opt -> num_canon++;
+            opt -> table[slot] = opt -> num_canon;
+        }
+    }
+    *canon_root = opt -> canon_of[0];
+    return CONF_OK;
+}
+
+/**
+ * @brief Places in pre-order the canonical nodes reachable from a root that are not placed yet, so that left children follow their parent.
+ *
+ * @param[in,out] opt Working memory.
+ * @param[in] canon_root Canonical node of the root.
+ * @param[in] tree_stamp Stamp of the tree, marking the reached nodes.
+ * @param[in,out] next_position Next free position of the layout.
+ * @return uint16_t Number of nodes reachable from the root.
+ */
+static uint16_t place_canon_tree(optimizer_t* const opt, const int32_t canon_root, const uint32_t tree_stamp, int32_t* const next_position){
+    uint16_t reached = 0;
+    size_t top = 0;
+    opt -> stack[top++] = canon_root;
+    while(top > 0){
+        canon_node_t* const canon = &opt -> canon_nodes[opt -> stack[--top]];
+        if(tree_stamp == canon -> tree_stamp){
+            continue;
+        }
+        canon -> tree_stamp = tree_stamp;
+        reached++;
+        if(-1 == canon -> position){
+            canon -> position = (*next_position)++;
+        }
+        if(-1 != canon -> right){
+            opt -> stack[top++] = canon -> right;
+        }
+        if(-1 != canon -> left){
+            opt -> stack[top++] = canon -> left;
+        }
+    }
+    return reached;
+}
+
+/**
+ * @brief Writes the placed canonical nodes at their position in layout.
+ */
+static void write_canon_nodes(const optimizer_t* const opt, node_t* const layout){
+    for(uint32_t c = 0; c < opt -> num_canon; c++){
+        const canon_node_t* const canon = &opt -> canon_nodes[c];
+        if(-1 == canon -> position){
+            continue;
+        }
+        node_t* const node = &layout[canon -> position];
+        *node = canon -> node;
+#if USE_POINTERS
+        node -> left_child = (-1 == canon -> left) ? NULL : &layout[opt -> canon_nodes[canon -> left].position];
+        node -> right_child = (-1 == canon -> right) ? NULL : &layout[opt -> canon_nodes[canon -> right].position];
+#else
+        node -> left_node = (-1 == canon -> left) ? -1 : opt -> canon_nodes[canon -> left].position;
+        node -> right_node = (-1 == canon -> right) ? -1 : opt -> canon_nodes[canon -> right].position;
+#endif
+    }
+}
+
+int optimize_tree_conf(tree_conf_t* const conf, conf_optimize_stats_t* const stats){
+    conf_optimize_stats_t local_stats;
+    conf_optimize_stats_t* const st = (NULL == stats) ? &local_stats : stats;
+    memset(st, 0, sizeof(conf_optimize_stats_t));
+    size_t total_nodes = 0U;
+    uint16_t max_nodes = 0U;
+    for(uint16_t t = 0; t < conf -> trailer.num_trees; t++){
+        total_nodes += conf -> num_nodes[t];
+        max_nodes = (conf -> num_nodes[t] > max_nodes) ? conf -> num_nodes[t] : max_nodes;
+    }
+    if(NULL != conf -> node_pool || 0 == max_nodes){
+        return CONF_OK;
+    }
+#if USE_POINTERS
+    // Leaf distributions are indexed by the offset of the leaf from its root, so they prevent the sharing across trees.
+    const uint8_t share_trees = (NULL == conf -> leaf_probabilities);
+#else
+    const uint8_t share_trees = 0U;
+#endif
+    const size_t capacity = share_trees ? total_nodes : max_nodes;
+    size_t table_size = 1U;
+    while(table_size < 2 * capacity){
+        table_size <<= 1;
+    }
+    optimizer_t opt;
+    memset(&opt, 0, sizeof(optimizer_t));
+    opt.number_classes = (NULL == conf -> leaf_probabilities) ? 0U : conf -> trailer.num_classes;
+    opt.canon_nodes = (canon_node_t *) malloc(capacity * sizeof(canon_node_t));
+    opt.table = (uint32_t *) calloc(table_size, sizeof(uint32_t));
+    opt.canon_of = (int32_t *) malloc(max_nodes * sizeof(int32_t));
+    opt.state = (uint8_t *) malloc(max_nodes);
+    // Each node pushes its children at most once, plus the root and the children of a node closing a cycle.
+    opt.stack = (int32_t *) malloc((2 * capacity + 3) * sizeof(int32_t));
+    opt.rows = (opt.number_classes > 0) ? (float *) malloc((size_t) max_nodes * opt.number_classes * sizeof(float)) : NULL;
+    int32_t* canon_roots = (int32_t *) malloc(conf -> trailer.num_trees * sizeof(int32_t));
+    uint16_t* reached = (uint16_t *) malloc(conf -> trailer.num_trees * sizeof(uint16_t));
+    int to_ret = CONF_OK;
+    if(NULL == opt.canon_nodes || NULL == opt.table || NULL == opt.canon_of || NULL == opt.state || NULL == opt.stack ||
+        (opt.number_classes > 0 && NULL == opt.rows) || NULL == canon_roots || NULL == reached){
+        to_ret = CONF_ERR_ALLOC;
+    }
+    st -> nodes_before = (uint32_t) total_nodes;
+    for(uint16_t t = 0; CONF_OK == to_ret && t < conf -> trailer.num_trees; t++){
+        const uint16_t num_nodes = conf -> num_nodes[t];
+        canon_roots[t] = -1;
+        if(0 == num_nodes){
+            continue;
+        }
+        if(!share_trees){
+            // Each tree starts from an empty table, sized on the tree.
+            opt.num_canon = 0U;
+            opt.table_mask = 1U;
+            while(opt.table_mask < 2U * num_nodes){
+                opt.table_mask <<= 1;
+            }
+            memset(opt.table, 0, opt.table_mask * sizeof(uint32_t));
+            opt.table_mask--;
+        }
+        else{
+            opt.table_mask = table_size - 1;
+        }
+        if(opt.number_classes > 0){
+            memcpy(opt.rows, conf -> leaf_probabilities[t], (size_t) num_nodes * opt.number_classes * sizeof(float));
+        }
+        to_ret = build_canon_tree(&opt, conf -> trees[t], num_nodes, st, &canon_roots[t]);
+        if(CONF_OK != to_ret){
+            continue;
+        }
+        conf -> max_depth[t] = opt.canon_nodes[canon_roots[t]].height;
+        if(share_trees){
+            continue;
+        }
+        int32_t next_position = 0;
+        const uint16_t optimized_nodes = place_canon_tree(&opt, canon_roots[t], 1U, &next_position);
+        // Canonical nodes and rows are copies, so the tree is overwritten in place.
+        write_canon_nodes(&opt, conf -> trees[t]);
+        for(uint32_t c = 0; c < opt.num_canon && opt.number_classes > 0; c++){
+            const float* const row = canon_row(&opt, &opt.canon_nodes[c]);
+            float* const destination = &conf -> leaf_probabilities[t][(size_t) opt.canon_nodes[c].position * opt.number_classes];
+            if(NULL == row){
+                memset(destination, 0, opt.number_classes * sizeof(float));
+            }
+            else{
+                memcpy(destination, row, opt.number_classes * sizeof(float));
+            }
+        }
+#if !USE_POINTERS
+        // Shrinking can move the tree, which is fine with relative indexes.
+        node_t* const shrunk = (node_t *) realloc(conf -> trees[t], optimized_nodes * sizeof(node_t));
+        conf -> trees[t] = (NULL == shrunk) ? conf -> trees[t] : shrunk;
+#endif
+        conf -> num_nodes[t] = optimized_nodes;
+        st -> nodes_after += optimized_nodes;
+    }
+    if(CONF_OK == to_ret && share_trees){
+        int32_t next_position = 0;
+        for(uint16_t t = 0; t < conf -> trailer.num_trees; t++){
+            reached[t] = (-1 == canon_roots[t]) ? 0U : place_canon_tree(&opt, canon_roots[t], t + 1U, &next_position);
+        }
+        node_t* const pool = (node_t *) malloc(next_position * sizeof(node_t));
+        if(NULL == pool){
+            to_ret = CONF_ERR_ALLOC;
+        }
+        else{
+            write_canon_nodes(&opt, pool);
+            for(uint16_t t = 0; t < conf -> trailer.num_trees; t++){
+                free(conf -> trees[t]);
+                conf -> trees[t] = (-1 == canon_roots[t]) ? NULL : &pool[opt.canon_nodes[canon_roots[t]].position];
+                conf -> num_nodes[t] = reached[t];
+            }
+            conf -> node_pool = pool;
+            st -> nodes_after = (uint32_t) next_position;
+        }
+    }
+    free(opt.canon_nodes);
+    free(opt.table);
+    free(opt.canon_of);
+    free(opt.state);
+    free(opt.stack);
+    free(opt.rows);
+    free(canon_roots);
+    free(reached);
+    return to_ret;
+}
+
+void free_tree_conf(tree_conf_t* const conf){
+    if(NULL != conf -> node_pool){
+        free(conf -> node_pool);
+    }
+    else if(NULL != conf -> trees){
+        for(uint16_t t = 0; t < conf -> trailer.num_trees; t++){
+            free(conf -> trees[t]);
+        }
+    }
+    if(NULL != conf -> leaf_probabilities && conf -> trailer.num_trees > 0){
+        free(conf -> leaf_probabilities[0]);
+    }
+    free(conf -> trees);
+    free(conf -> num_nodes);
+    free(conf -> max_depth);
+    free(conf -> leaf_probabilities);
+    if(NULL != conf -> boosting){
+        free(conf -> boosting -> base_scores);
+        free(conf -> boosting -> tree_outputs);
+        free(conf -> boosting);
+    }
+    memset(conf, 0, sizeof(tree_conf_t));
+}
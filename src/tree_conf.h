@@ -28,6 +28,17 @@
 #ifndef TREE_CONF_H
 #define TREE_CONF_H
 #include <stdint.h>
+#include "tree_visit.h"
+#include "tree_boost.h"
+
+#define CONF_OK              0  /**< The configuration was successfully loaded. */
+#define CONF_ERR_OPEN       -1  /**< The binary file can not be opened. */
+#define CONF_ERR_READ       -2  /**< The binary file is truncated. */
+#define CONF_ERR_ALLOC      -3  /**< Memory allocation failed. */
+#define CONF_ERR_FORMAT     -4  /**< The binary file contains an invalid tree, or an invalid or unknown section. */
+
+#define BIN_SECTION_LEAF_PROBA 1 /**< Section containing the class distributions of the leaves, see load_tree_conf. */
+#define BIN_SECTION_BOOSTING   2 /**< Section containing the additive structure of gradient boosted ensembles, see load_tree_conf. */
 
 /**
  * @typedef bin_trailer_t
@@ -40,5 +51,117 @@ typedef struct{
     uint16_t num_trees;     /**< Number of trees in the ensemble. */
 } bin_trailer_t;
 
+/**
+ * @typedef bin_node_t
+ * @brief   Node of the binary configuration, whose children are indexes relative to the root of its tree (-1 for the leaves).
+ *          Without USE_POINTERS it is the layout of node_t, so the trees are read as they are. With USE_POINTERS the indexes are
+ *          converted in pointers while loading.
+ * 
+ */
+typedef struct{
+    operator_t operator;            /**< Operator used for the split. */
+    feature_idx_t feature_index;    /**< Index of the feature used for splitting. */
+    class_t class;                  /**< Classification result if the node is a leaf. */
+    int32_t left_node;              /**< Index of the left child node. */
+    int32_t right_node;             /**< Index of the right child node. */
+    feature_type_t threshold;       /**< Threshold value for the feature, or value of the leaf. */
+} bin_node_t;
+
+/**
+ * @typedef bin_section_t
+ * @brief   Header of an optional section of the binary configuration.
+ *          Sections follow the trees, so that binaries without sections are still valid.
+ * 
+ */
+typedef struct{
+    uint16_t section_id;    /**< Identifier of the section, i.e. one of the BIN_SECTION_* values. */
+    uint16_t reserved;      /**< Reserved, used for the alignment of section_size. */
+    uint32_t section_size;  /**< Size in bytes of the section content, which directly follows this header. */
+} bin_section_t;
+
+/**
+ * @typedef bin_boosting_t
+ * @brief   Header of the BIN_SECTION_BOOSTING section. 
+ *          It is followed by num_outputs feature_type_t base scores and by the uint16_t output index of each tree.
+ * 
+ */
+typedef struct{
+    uint16_t objective;     /**< One of the BOOSTING_OBJECTIVE_* values. */
+    uint16_t num_outputs;   /**< Number of margins of the model. */
+} bin_boosting_t;
+
+/**
+ * @typedef tree_conf_t
+ * @brief   Classifier loaded from a binary configuration file.
+ * 
+ */
+typedef struct{
+    bin_trailer_t trailer;      /**< Trailer of the binary. */
+    node_t** trees;             /**< Array of trailer.num_trees root nodes, directly usable by the visiting functions. */
+    uint16_t* num_nodes;        /**< Number of nodes of each tree. */
+    uint16_t* max_depth;        /**< Longest path of each tree, i.e. the maximum number of splits crossed by a visit. */
+    float** leaf_probabilities; /**< Per tree [num_nodes x num_classes] leaf class distributions. NULL if the binary does not contain them.*/
+    boosting_t* boosting;       /**< Additive structure of gradient boosted ensembles, to be used with visit_gbdt. NULL for forests. */
+    node_t* node_pool;          /**< Nodes shared by all the trees after optimize_tree_conf with USE_POINTERS, NULL if each tree owns its nodes. */
+} tree_conf_t;
+
+/**
+ * @typedef conf_optimize_stats_t
+ * @brief   Savings of optimize_tree_conf.
+ * 
+ */
+typedef struct{
+    uint32_t nodes_before;      /**< Number of nodes before the optimization. */
+    uint32_t nodes_after;       /**< Number of nodes stored after the optimization. */
+    uint32_t collapsed_splits;  /**< Splits replaced by their child as both children were identical, each one shortens by one the paths crossing it. */
+    uint32_t shared_nodes;      /**< Nodes replaced by an identical node, i.e. stored once for all their parents. */
+} conf_optimize_stats_t;
+
+/**
+ * @brief Loads the classifier from a binary configuration file generated by the dtc_pygen configurator.
+ *        Each tree is validated once while loading, so that the visiting functions need no check per hop on the loaded trees:
+ *        trees are not empty, children are in the bounds of their tree and no node is its own descendant (subtrees can be shared),
+ *        internal nodes have an operator lower than NUM_OPERATORS and a feature lower than num_features, nodes have either two children
+ *        or none (a single one only for the pruned nodes of USE_POINTERS and COMPILE_PRUNED) and, with num_classes > 0, leaves have a
+ *        class in [0, num_classes). Nodes not reachable from the root are not checked, as they are never visited.
+ *        If present, the BIN_SECTION_LEAF_PROBA section contains, for each tree, num_nodes x num_classes float values.
+ *        The row of the leaf with index i contains its class distribution, while rows of internal nodes are zero.
+ *        If present, the BIN_SECTION_BOOSTING section contains a bin_boosting_t header, the base scores and the output of each tree.
+ * 
+ * @param[in] file_path Path of the binary configuration file.
+ * @param[out] conf Loaded classifier. It must be released with free_tree_conf.
+ * @return int Status of the load operation.
+ * @retval CONF_OK The classifier was loaded.
+ * @retval CONF_ERR_FORMAT A tree failed the validation, or a section is invalid or unknown. conf does not need to be released.
+ * @retval CONF_ERR_OPEN, CONF_ERR_READ, CONF_ERR_ALLOC An error occurred, conf does not need to be released.
+ */
+int load_tree_conf(const char* const file_path, tree_conf_t* const conf);
+
+/**
+ * @brief Lossless optimization of a loaded classifier, equivalent to the optimize command of dtc_pygen for binaries generated without it.
+ *        Visiting each tree bottom-up, splits whose children are identical are replaced by their child, and identical subtrees are hash-consed,
+ *        i.e. stored once and shared by all their parents. Nodes are identical if they have the same operator, feature, class, threshold 
+ *        (the value of the leaves of regression and boosted trees), children and, with BIN_SECTION_LEAF_PROBA, leaf distribution, so every
+ *        visiting function returns the same results with fewer nodes and shorter paths. Nodes are renumbered in pre-order.
+ *        Without USE_POINTERS children are indexes relative to the root, so subtrees are only shared inside each tree. With USE_POINTERS and
+ *        without leaf distributions, which are indexed by the offset of the leaf from its root, subtrees are also shared across trees and all
+ *        the nodes are moved in conf->node_pool. In that case num_nodes contains the number of nodes reachable from each root, and a second
+ *        call leaves the classifier unchanged. max_depth is updated, as collapsed splits shorten the paths.
+ * 
+ * @param[in,out] conf Classifier loaded with load_tree_conf.
+ * @param[out] stats Savings of the optimization, it can be NULL.
+ * @return int Status of the optimization.
+ * @retval CONF_OK The classifier was optimized.
+ * @retval CONF_ERR_FORMAT A tree contains children out of its bounds or a cycle. The trees before it may be optimized, which does not change the results.
+ * @retval CONF_ERR_ALLOC Memory allocation failed, the classifier is unchanged.
+ */
+int optimize_tree_conf(tree_conf_t* const conf, conf_optimize_stats_t* const stats);
+
+/**
+ * @brief Releases the memory of a classifier loaded with load_tree_conf.
+ * 
+ * @param[in,out] conf Classifier to release.
+ */
+void free_tree_conf(tree_conf_t* const conf);
 
 #endif // TREE_CONF_H
\ No newline at end of file
@@ -0,0 +1,277 @@
+/*
+ * This file is part of DTC: Decision Tree in C-lang project.
+ *
+ * DTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DTC. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tree_csv.c
+ * @author Antonio Emmanuele (antony.35.ae@gmail.com)
+ * @brief  Contains the implementation of the CSV reader filling feature matrices.
+ * @version 0.1
+ * @date 2024-12-29
+ *
+ * @copyright Copyright (c) 2024 Antonio Emmanuele
+ *
+ */
+#include "tree_csv.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CSV_SIMD && defined(__AVX2__)
+#include <immintrin.h>
+#define CSV_BLOCK 32
+#elif CSV_SIMD && defined(__SSE2__)
+#include <emmintrin.h>
+#define CSV_BLOCK 16
+#else
+#define CSV_BLOCK 32
+#endif
+
+#define CSV_FAST_MAX_DIGITS 19      /**< Significant digits of the fast path, the most that fit in a uint64_t. */
+#define CSV_FAST_MAX_POWER  22      /**< Highest power of ten exactly representable in a double. */
+#define CSV_FIELD_BUFFER    128     /**< Stack copy of the fields parsed with strtod, longer fields are allocated. */
+
+static const double powers_of_ten[CSV_FAST_MAX_POWER + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * @brief Returns the mask of the separators and of the newlines of the CSV_BLOCK bytes starting at p, bit i for p[i].
+ */
+static inline uint32_t delimiter_mask(const char* const p, const char separator){
+#if CSV_SIMD && defined(__AVX2__)
+    const __m256i bytes = _mm256_loadu_si256((const __m256i *) p);
+    return (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(separator)),
+                                                           _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n'))));
+#elif CSV_SIMD && defined(__SSE2__)
+    const __m128i bytes = _mm_loadu_si128((const __m128i *) p);
+    return (uint32_t) _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(separator)), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n'))));
+#else
+    uint32_t mask = 0;
+    for(uint32_t i = 0; i < CSV_BLOCK; i++){
+        mask |= (uint32_t) (separator == p[i] || '\n' == p[i]) << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * @brief Parses a decimal field (sign, digits, optional fraction and exponent) whose value is m * 10^e with m < 2^53 and |e| <= 22,
+ *        so that the product or the quotient of two exact doubles is correctly rounded as by strtod (Clinger's fast path).
+ *
+ * @return int 1 if the field was parsed, 0 if it needs strtod.
+ */
+static inline int parse_fast(const char* p, const char* const end, double* const value){
+    int negative = 0, any_digit = 0, digits = 0, exponent = 0;
+    uint64_t mantissa = 0;
+    if(p < end && ('-' == *p || '+' == *p)){
+        negative = ('-' == *p);
+        p++;
+    }
+    for(; p < end && (unsigned) (*p - '0') < 10; p++){
+        // Leading zeros are not significant digits.
+        if(0 != mantissa || '0' != *p){
+            if(CSV_FAST_MAX_DIGITS == digits++){
+                return 0;
+            }
+            mantissa = mantissa * 10 + (uint64_t) (*p - '0');
+        }
+        any_digit = 1;
+    }
+    if(p < end && '.' == *p){
+        for(p++; p < end && (unsigned) (*p - '0') < 10; p++){
+            if(0 != mantissa || '0' != *p){
+                if(CSV_FAST_MAX_DIGITS == digits++){
+                    return 0;
+                }
+                mantissa = mantissa * 10 + (uint64_t) (*p - '0');
+            }
+            exponent--;
+            any_digit = 1;
+        }
+    }
+    if(!any_digit){
+        return 0;
+    }
+    if(p < end && ('e' == *p || 'E' == *p)){
+        int exponent_negative = 0, explicit_exponent = 0;
+        if(++p < end && ('-' == *p || '+' == *p)){
+            exponent_negative = ('-' == *p);
+            p++;
+        }
+        if(p == end || (unsigned) (*p - '0') >= 10){
+            return 0;
+        }
+        for(; p < end && (unsigned) (*p - '0') < 10; p++){
+            explicit_exponent = (explicit_exponent < 10000) ? explicit_exponent * 10 + (*p - '0') : explicit_exponent;
+        }
+        exponent += exponent_negative ? -explicit_exponent : explicit_exponent;
+    }
+    if(p != end){
+        return 0;
+    }
+    if(0 == mantissa){
+        *value = negative ? -0.0 : 0.0;
+        return 1;
+    }
+    if(mantissa > (1ULL << 53) || exponent < -CSV_FAST_MAX_POWER || exponent > CSV_FAST_MAX_POWER){
+        return 0;
+    }
+    double result = (double) mantissa;
+    result = (exponent < 0) ? result / powers_of_ten[-exponent] : result * powers_of_ten[exponent];
+    *value = negative ? -result : result;
+    return 1;
+}
+
+/**
+ * @brief Parses a field, NaN if it is empty. Fields out of the fast path are copied and parsed with strtod, which must consume them whole.
+ *
+ * @return int 1 if the field is a number, 0 otherwise.
+ */
+static int parse_field(const char* const begin, const char* const end, double* const value){
+    if(begin == end){
+        *value = NAN;
+        return 1;
+    }
+    if(parse_fast(begin, end, value)){
+        return 1;
+    }
+    const size_t length = (size_t) (end - begin);
+    char stack_copy[CSV_FIELD_BUFFER];
+    char* copy = (length < CSV_FIELD_BUFFER) ? stack_copy : malloc(length + 1);
+    if(NULL == copy){
+        return 0;
+    }
+    memcpy(copy, begin, length);
+    copy[length] = '\0';
+    char* parsed_end;
+    *value = strtod(copy, &parsed_end);
+    int parsed = (parsed_end == &copy[length]);
+    if(copy != stack_copy){
+        free(copy);
+    }
+    return parsed;
+}
+
+static inline void store(feature_type_t* const features, const tree_csv_options_t* const options, const uint32_t row, const uint16_t feature,
+                         const double value){
+    if(CSV_ROW_MAJOR == options->layout){
+        features[(size_t) row * options->num_features + feature] = (feature_type_t) value;
+    }
+    else{
+        features[(size_t) feature * options->max_rows + row] = (feature_type_t) value;
+    }
+}
+
+int tree_csv_parse(const char* const data, const size_t size, const uint8_t is_last, const tree_csv_options_t* const options,
+                   feature_type_t* const features, tree_csv_result_t* const result){
+    const uint16_t num_features = options->num_features;
+    size_t row_start = 0, field_start = 0, pos = 0;
+    uint16_t field = 0;
+    double value;
+    memset(result, 0, sizeof(*result));
+    if(0 == options->max_rows){
+        return CSV_OK;
+    }
+    for(;;){
+        size_t block = pos;
+        uint32_t mask;
+        if(pos < size && size - pos >= CSV_BLOCK){
+            mask = delimiter_mask(&data[pos], options->separator);
+        }
+        else if(pos < size){
+            // The tail is copied, so that the block is not loaded beyond the buffer.
+            char tail[CSV_BLOCK];
+            memset(tail, 0, CSV_BLOCK);
+            memcpy(tail, &data[pos], size - pos);
+            mask = delimiter_mask(tail, options->separator) & ((1U << (size - pos)) - 1);
+        }
+        else if(is_last && row_start < size){
+            // Virtual newline at size, ending the last line of the input.
+            block = size;
+            mask = 1;
+        }
+        else{
+            break;
+        }
+        pos = block + CSV_BLOCK;
+        while(0 != mask){
+            size_t i = block + (size_t) __builtin_ctz(mask);
+            mask &= mask - 1;
+            if(i < size && '\n' != data[i]){
+                // Separator: the first num_features fields are parsed, then the line is skipped up to its newline.
+                if(field < num_features){
+                    if(!parse_field(&data[field_start], &data[i], &value)){
+                        result->consumed = row_start;
+                        return CSV_ERR_FORMAT;
+                    }
+                    store(features, options, result->num_rows, field, value);
+                }
+                field_start = i + 1;
+                if(++field < num_features){
+                    continue;
+                }
+                const char* const newline = memchr(&data[field_start], '\n', size - field_start);
+                if(NULL == newline && !is_last){
+                    break;
+                }
+                i = (NULL != newline) ? (size_t) (newline - data) : size;
+                // The blocks restart after the newline.
+                mask = 0;
+                pos = i + 1;
+            }
+            // End of line at i, without the '\r' of CRLF lines.
+            const size_t line_end = (i > field_start && '\r' == data[i - 1]) ? i - 1 : i;
+            if(0 != field || line_end != row_start){
+                if(field < num_features){
+                    if(field != num_features - 1 || !parse_field(&data[field_start], &data[line_end], &value)){
+                        result->consumed = row_start;
+                        return CSV_ERR_FORMAT;
+                    }
+                    store(features, options, result->num_rows, field, value);
+                }
+                result->num_rows++;
+            }
+            result->num_lines++;
+            row_start = field_start = (i < size) ? i + 1 : size;
+            field = 0;
+            if(result->num_rows == options->max_rows || i >= size){
+                result->consumed = row_start;
+                return CSV_OK;
+            }
+        }
+        if(field >= num_features && pos == block + CSV_BLOCK){
+            // The skipped line does not end in the buffer.
+            break;
+        }
+    }
+    result->consumed = row_start;
+    return CSV_OK;
+}
+
+size_t tree_csv_header_length(const char* const data, const size_t size, const char separator){
+    const char* const newline = memchr(data, '\n', size);
+    const char* line_end = (NULL != newline) ? newline : &data[size];
+    const char* field_end = memchr(data, separator, (size_t) (line_end - data));
+    double value;
+    if(NULL == field_end){
+        field_end = (line_end > data && '\r' == line_end[-1]) ? line_end - 1 : line_end;
+    }
+    if(line_end == data || parse_field(data, field_end, &value)){
+        return 0;
+    }
+    return (NULL != newline) ? (size_t) (newline - data) + 1 : size;
+}
@@ -0,0 +1,100 @@
+/*
+ * This file is part of DTC: Decision Tree in C-lang project.
+ *
+ * DTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DTC. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tree_csv.h
+ * @author Antonio Emmanuele (antony.35.ae@gmail.com)
+ * @brief  Contains the CSV reader filling feature matrices from text buffers, with SIMD delimiter scanning and fast float parsing.
+ * @version 0.1
+ * @date 2024-12-29
+ *
+ * @copyright Copyright (c) 2024 Antonio Emmanuele
+ *
+ */
+#ifndef TREE_CSV_H
+#define TREE_CSV_H
+#include <stddef.h>
+#include <stdint.h>
+#include "tree_visit.h"
+
+#ifndef CSV_SIMD
+#define CSV_SIMD 1                  /**< If set to 1, delimiters are scanned with AVX2 or SSE2 when the compiler targets them. Otherwise one byte at a time. */
+#endif
+
+#define CSV_OK              0   /**< The buffer was parsed up to the end of its last complete line, or until the matrix was full. */
+#define CSV_ERR_FORMAT     -1   /**< A field is not a number, or a line has less fields than the columns of the matrix. */
+
+#define CSV_ROW_MAJOR       0   /**< Features of a row are contiguous, i.e. the [max_rows x num_features] input of the batched visiting functions. */
+#define CSV_COLUMN_MAJOR    1   /**< Values of a feature are contiguous, i.e. a [num_features x max_rows] matrix. */
+
+/**
+ * @typedef tree_csv_options_t
+ * @brief   Layout of the CSV lines and of the feature matrix they are parsed into.
+ *
+ */
+typedef struct{
+    char separator;             /**< Field separator, e.g. ';' as the datasets of the repository. */
+    uint8_t layout;             /**< CSV_ROW_MAJOR or CSV_COLUMN_MAJOR. */
+    uint16_t num_features;      /**< Columns of the matrix, i.e. the first num_features fields of each line. Further fields (e.g. the label) are skipped. */
+    uint32_t max_rows;          /**< Rows of the matrix, and stride of the columns of a CSV_COLUMN_MAJOR matrix. */
+} tree_csv_options_t;
+
+/**
+ * @typedef tree_csv_result_t
+ * @brief   Progress of tree_csv_parse, which stops at the first line it can not parse.
+ *
+ */
+typedef struct{
+    uint32_t num_rows;          /**< Rows written in the matrix. */
+    uint64_t num_lines;         /**< Consumed lines, i.e. the rows and the empty lines. */
+    size_t consumed;            /**< Consumed bytes, i.e. the offset of the first line not parsed (the incomplete last line, or the malformed one). */
+} tree_csv_result_t;
+
+/**
+ * @brief Parses the lines of a buffer into a feature matrix, until the end of the buffer or until max_rows rows are written.
+ *        Lines end with '\n' or "\r\n". Empty lines are skipped, and so are the fields after the first num_features ones.
+ *        Separators and newlines are found 32 (AVX2) or 16 (SSE2) bytes at a time, and decimal fields whose value is exactly computable from
+ *        at most 19 significant digits and a power of ten up to 1e22 are parsed without strtod, which is only called for the other fields
+ *        (e.g. long mantissas, nan, inf, hexadecimal values) and gives the same values. Empty fields are missing values, i.e. NaN.
+ *        The buffer does not need to be null terminated and is never read beyond its size.
+ *
+ * @param[in] data Text to parse.
+ * @param[in] size Size of the text in bytes.
+ * @param[in] is_last If set, the text after the last newline is parsed as a line, i.e. data ends the input.
+ *                    Otherwise it is not consumed, so that it can be parsed again with the following bytes of the input.
+ * @param[in] options Layout of the lines and of the matrix.
+ * @param[out] features Feature matrix of max_rows x num_features elements, whose first result->num_rows rows are written.
+ * @param[out] result Rows, lines and bytes consumed, also in case of error.
+ * @return int Status of the parsing.
+ * @retval CSV_OK The buffer was parsed up to result->consumed, which is lower than size for the incomplete last line or the full matrix.
+ * @retval CSV_ERR_FORMAT The line starting at result->consumed, i.e. line result->num_lines + 1 of the buffer, is malformed.
+ */
+int tree_csv_parse(const char* const data, const size_t size, const uint8_t is_last, const tree_csv_options_t* const options,
+                   feature_type_t* const features, tree_csv_result_t* const result);
+
+/**
+ * @brief Returns the length of the first line of a buffer, newline included, if it is a header, i.e. if its first field is not a number.
+ *        The buffer must contain the whole first line (or the whole input).
+ *
+ * @param[in] data Beginning of the input.
+ * @param[in] size Size of the text in bytes.
+ * @param[in] separator Field separator.
+ * @return size_t Length of the header, 0 if the first line is not a header.
+ */
+size_t tree_csv_header_length(const char* const data, const size_t size, const char separator);
+
+#endif // TREE_CSV_H
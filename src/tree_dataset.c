@@ -0,0 +1,150 @@
+/*
+ * This file is part of DTC: Decision Tree in C-lang project.
+ *
+ * DTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DTC. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tree_dataset.c
+ * @author Antonio Emmanuele (antony.35.ae@gmail.com)
+ * @brief  Contains the implementation of the functions mapping the binary datasets.
+ * @version 0.1
+ * @date 2024-12-29
+ *
+ * @copyright Copyright (c) 2024 Antonio Emmanuele
+ *
+ */
+#include "tree_dataset.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DATASET_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define DATASET_USE_MMAP 0
+#endif
+
+/**
+ * @brief Checks that a region of count elements of element_size bytes, starting at offset, is aligned and inside the file.
+ *
+ * @return int 1 if the region is valid, 0 otherwise.
+ */
+static int is_valid_region(const uint64_t offset, const uint64_t count, const uint64_t element_size, const size_t data_size){
+    if(0 != offset % DATASET_ALIGNMENT || offset < sizeof(dataset_header_t) || offset > data_size){
+        return 0;
+    }
+    // Written as a division, so that huge counts can not overflow.
+    return count <= (data_size - offset) / element_size;
+}
+
+/**
+ * @brief Validates the header of a mapped dataset and sets the features and the labels pointers.
+ *
+ * @param[in,out] dataset Dataset whose data and data_size are set.
+ * @return int DATASET_OK or an error code.
+ */
+static int parse_header(tree_dataset_t* const dataset){
+    if(dataset -> data_size < sizeof(dataset_header_t)){
+        return DATASET_ERR_FORMAT;
+    }
+    memcpy(&dataset -> header, dataset -> data, sizeof(dataset_header_t));
+    const dataset_header_t* const header = &dataset -> header;
+    if(DATASET_MAGIC != header -> magic || DATASET_VERSION != header -> version){
+        return DATASET_ERR_FORMAT;
+    }
+    if(sizeof(feature_type_t) != header -> feature_size){
+        return DATASET_ERR_TYPE;
+    }
+    if(0 == header -> num_features || header -> num_samples > UINT64_MAX / header -> num_features ||
+        !is_valid_region(header -> features_offset, header -> num_samples * header -> num_features, sizeof(feature_type_t), dataset -> data_size)){
+        return DATASET_ERR_FORMAT;
+    }
+    if(0 != header -> labels_offset && !is_valid_region(header -> labels_offset, header -> num_samples, sizeof(class_t), dataset -> data_size)){
+        return DATASET_ERR_FORMAT;
+    }
+    dataset -> features = (const feature_type_t *) ((const uint8_t *) dataset -> data + header -> features_offset);
+    dataset -> labels = (0 == header -> labels_offset) ? NULL : (const class_t *) ((const uint8_t *) dataset -> data + header -> labels_offset);
+    return DATASET_OK;
+}
+
+int load_tree_dataset(const char* const file_path, tree_dataset_t* const dataset){
+    memset(dataset, 0, sizeof(tree_dataset_t));
+#if DATASET_USE_MMAP
+    int fd = open(file_path, O_RDONLY);
+    if(fd < 0){
+        return DATASET_ERR_OPEN;
+    }
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) != 0){
+        close(fd);
+        return DATASET_ERR_READ;
+    }
+    if(file_stat.st_size < (off_t) sizeof(dataset_header_t)){
+        close(fd);
+        return DATASET_ERR_FORMAT;
+    }
+    dataset -> data_size = (size_t) file_stat.st_size;
+    dataset -> data = mmap(NULL, dataset -> data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file.
+    close(fd);
+    if(MAP_FAILED == dataset -> data){
+        memset(dataset, 0, sizeof(tree_dataset_t));
+        return DATASET_ERR_READ;
+    }
+#else
+    FILE* file = fopen(file_path, "rb");
+    if(NULL == file){
+        return DATASET_ERR_OPEN;
+    }
+    if(fseek(file, 0, SEEK_END) != 0 || ftell(file) <= 0){
+        fclose(file);
+        return DATASET_ERR_READ;
+    }
+    dataset -> data_size = (size_t) ftell(file);
+    rewind(file);
+    dataset -> data = malloc(dataset -> data_size);
+    if(NULL == dataset -> data){
+        fclose(file);
+        memset(dataset, 0, sizeof(tree_dataset_t));
+        return DATASET_ERR_ALLOC;
+    }
+    if(fread(dataset -> data, 1, dataset -> data_size, file) != dataset -> data_size){
+        fclose(file);
+        free_tree_dataset(dataset);
+        return DATASET_ERR_READ;
+    }
+    fclose(file);
+#endif
+    int to_ret = parse_header(dataset);
+    if(DATASET_OK != to_ret){
+        free_tree_dataset(dataset);
+    }
+    return to_ret;
+}
+
+void free_tree_dataset(tree_dataset_t* const dataset){
+    if(NULL != dataset -> data){
+#if DATASET_USE_MMAP
+        munmap(dataset -> data, dataset -> data_size);
+#else
+        free(dataset -> data);
+#endif
+    }
+    memset(dataset, 0, sizeof(tree_dataset_t));
+}
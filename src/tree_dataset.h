@@ -0,0 +1,97 @@
+/*
+ * This file is part of DTC: Decision Tree in C-lang project.
+ *
+ * DTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DTC. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tree_dataset.h
+ * @author Antonio Emmanuele (antony.35.ae@gmail.com)
+ * @brief  Contains the functions and datastructures to map the binary datasets generated by the dtc_pygen gen_test_bin command.
+ * @version 0.1
+ * @date 2024-12-29
+ *
+ * @copyright Copyright (c) 2024 Antonio Emmanuele
+ *
+ */
+#ifndef TREE_DATASET_H
+#define TREE_DATASET_H
+#include <stddef.h>
+#include <stdint.h>
+#include "tree_visit.h"
+
+#define DATASET_OK              0  /**< The dataset was successfully mapped. */
+#define DATASET_ERR_OPEN       -1  /**< The dataset file can not be opened. */
+#define DATASET_ERR_READ       -2  /**< The dataset file can not be mapped or read. */
+#define DATASET_ERR_ALLOC      -3  /**< Memory allocation failed. */
+#define DATASET_ERR_FORMAT     -4  /**< The dataset file is not a valid binary dataset, or it is truncated. */
+#define DATASET_ERR_TYPE       -5  /**< The features of the dataset do not have the size of feature_type_t (see USE_FLOAT). */
+
+#define DATASET_MAGIC       0x44435444U /**< "DTCD" in a little endian file. */
+#define DATASET_VERSION     1           /**< Version of the binary dataset format. */
+#define DATASET_ALIGNMENT   64          /**< Alignment of the header size and of the offsets of the features and of the labels. */
+
+/**
+ * @typedef dataset_header_t
+ * @brief   Header of a binary dataset, DATASET_ALIGNMENT bytes long.
+ *          It is followed by the row-major [num_samples x num_features] feature matrix and by the class_t label of each sample.
+ *
+ */
+typedef struct{
+    uint32_t magic;             /**< DATASET_MAGIC. */
+    uint16_t version;           /**< DATASET_VERSION. */
+    uint16_t feature_size;      /**< Size in bytes of each feature, i.e. 4 for float and 8 for double. */
+    uint64_t num_samples;       /**< Number of samples (rows) of the feature matrix. */
+    uint16_t num_features;      /**< Number of features (columns) of the feature matrix. */
+    uint16_t reserved_16;       /**< Reserved, used for the alignment of the following fields. */
+    uint32_t reserved_32;       /**< Reserved, used for the alignment of the following fields. */
+    uint64_t features_offset;   /**< Offset of the feature matrix from the beginning of the file, multiple of DATASET_ALIGNMENT. */
+    uint64_t labels_offset;     /**< Offset of the labels from the beginning of the file, multiple of DATASET_ALIGNMENT. 0 if the dataset has no labels. */
+    uint8_t reserved[24];       /**< Reserved, pads the header to DATASET_ALIGNMENT bytes. */
+} dataset_header_t;
+
+/**
+ * @typedef tree_dataset_t
+ * @brief   Binary dataset mapped in memory. Features and labels point inside the mapping, so they are read-only.
+ *
+ */
+typedef struct{
+    dataset_header_t header;            /**< Header of the dataset. */
+    const feature_type_t* features;     /**< Row-major [num_samples x num_features] feature matrix, directly usable by the batched visiting functions. */
+    const class_t* labels;              /**< Label of each sample, NULL if the dataset has no labels. */
+    void* data;                         /**< Beginning of the mapping of the file. */
+    size_t data_size;                   /**< Size in bytes of the mapping. */
+} tree_dataset_t;
+
+/**
+ * @brief Maps a binary dataset generated by the dtc_pygen gen_test_bin command.
+ *        On POSIX systems the file is mapped with mmap, so that only the accessed pages are loaded and datasets with millions of
+ *        rows do not need to be copied. Elsewhere the file is read in a single allocation.
+ *
+ * @param[in] file_path Path of the binary dataset.
+ * @param[out] dataset Mapped dataset. It must be released with free_tree_dataset.
+ * @return int Status of the load operation.
+ * @retval DATASET_OK The dataset was mapped.
+ * @retval DATASET_ERR_OPEN, DATASET_ERR_READ, DATASET_ERR_ALLOC, DATASET_ERR_FORMAT, DATASET_ERR_TYPE An error occurred, dataset does not need to be released.
+ */
+int load_tree_dataset(const char* const file_path, tree_dataset_t* const dataset);
+
+/**
+ * @brief Releases a dataset mapped with load_tree_dataset.
+ *
+ * @param[in,out] dataset Dataset to release.
+ */
+void free_tree_dataset(tree_dataset_t* const dataset);
+
+#endif // TREE_DATASET_H
@@ -0,0 +1,251 @@
+/*
+ * This file is part of DTC: Decision Tree in C-lang project.
+ *
+ * DTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DTC. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tree_latency.c
+ * @author Antonio Emmanuele (antony.35.ae@gmail.com)
+ * @brief  Contains the implementation of the latency histograms and of the per-thread latency recorder.
+ * @version 0.1
+ * @date 2024-12-29
+ *
+ * @copyright Copyright (c) 2024 Antonio Emmanuele
+ *
+ */
+#include "tree_latency.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Histogram of a thread. Counters are only written by their thread, with relaxed atomic loads and stores, while merged
+ *        holds the counters already returned by tree_latency_merge and is only accessed by the merging thread.
+ */
+typedef struct latency_block_t{
+    struct latency_block_t* next;               /**< Next block of the list. */
+    _Atomic uint64_t counts[TREE_LATENCY_BUCKETS];
+    _Atomic uint64_t sum;
+    _Atomic uint64_t max;
+    uint64_t merged_counts[TREE_LATENCY_BUCKETS];
+    uint64_t merged_sum;
+} latency_block_t;
+
+/** Incremented by tree_latency_reset, so that the threads drop their released blocks on their next record. */
+static _Atomic uint64_t generation = 1;
+static _Atomic(latency_block_t*) blocks = NULL;
+static atomic_flag merge_lock = ATOMIC_FLAG_INIT;
+static _Thread_local latency_block_t* thread_block = NULL;
+static _Thread_local uint64_t thread_generation = 0;
+
+/**
+ * @brief Index of the bucket of a value: values below 2^TREE_LATENCY_SUB_BUCKET_BITS have their own bucket, larger ones are shifted
+ *        so that their TREE_LATENCY_SUB_BUCKET_BITS most significant bits select one of the TREE_LATENCY_HALF_BUCKETS buckets of their power of two.
+ */
+static inline uint32_t bucket_index(const uint64_t value){
+    if(value < (1ULL << TREE_LATENCY_SUB_BUCKET_BITS)){
+        return (uint32_t) value;
+    }
+    if(value >= (1ULL << TREE_LATENCY_MAX_BITS)){
+        return TREE_LATENCY_BUCKETS - 1;
+    }
+    uint32_t shift = (63 - __builtin_clzll(value)) - (TREE_LATENCY_SUB_BUCKET_BITS - 1);
+    return shift * TREE_LATENCY_HALF_BUCKETS + (uint32_t) (value >> shift);
+}
+
+static inline uint64_t lowest_equivalent(const uint32_t index){
+    if(index < 2 * TREE_LATENCY_HALF_BUCKETS){
+        return index;
+    }
+    uint32_t shift = index / TREE_LATENCY_HALF_BUCKETS - 1;
+    return (uint64_t) (index - shift * TREE_LATENCY_HALF_BUCKETS) << shift;
+}
+
+static inline uint64_t highest_equivalent(const uint32_t index){
+    if(index < 2 * TREE_LATENCY_HALF_BUCKETS){
+        return index;
+    }
+    uint32_t shift = index / TREE_LATENCY_HALF_BUCKETS - 1;
+    return lowest_equivalent(index) + (1ULL << shift) - 1;
+}
+
+static inline void relaxed_add(_Atomic uint64_t* const counter, const uint64_t value){
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+void tree_latency_clear(tree_latency_histogram_t* const histogram){
+    memset(histogram, 0, sizeof(tree_latency_histogram_t));
+    histogram -> min = UINT64_MAX;
+}
+
+void tree_latency_add_value(tree_latency_histogram_t* const histogram, const uint64_t value_ns){
+    histogram -> counts[bucket_index(value_ns)]++;
+    histogram -> total_count++;
+    histogram -> sum += value_ns;
+    histogram -> min = (value_ns < histogram -> min) ? value_ns : histogram -> min;
+    histogram -> max = (value_ns > histogram -> max) ? value_ns : histogram -> max;
+}
+
+void tree_latency_add(tree_latency_histogram_t* const total, const tree_latency_histogram_t* const histogram){
+    for(uint32_t b = 0; b < TREE_LATENCY_BUCKETS; b++){
+        total -> counts[b] += histogram -> counts[b];
+    }
+    total -> total_count += histogram -> total_count;
+    total -> sum += histogram -> sum;
+    total -> min = (histogram -> min < total -> min) ? histogram -> min : total -> min;
+    total -> max = (histogram -> max > total -> max) ? histogram -> max : total -> max;
+}
+
+/**
+ * @brief Returns the index of the bucket reaching the percentile, and the number of values up to it in cumulative_count.
+ */
+static uint32_t percentile_bucket(const tree_latency_histogram_t* const histogram, const double percentile, uint64_t* const cumulative_count){
+    double clamped = (percentile < 0.0) ? 0.0 : (percentile > 100.0) ? 100.0 : percentile;
+    uint64_t target = (uint64_t) (clamped / 100.0 * histogram -> total_count + 0.5);
+    target = (target < 1) ? 1 : target;
+    uint64_t cumulative = 0;
+    uint32_t b = 0;
+    for(b = 0; b < TREE_LATENCY_BUCKETS; b++){
+        cumulative += histogram -> counts[b];
+        if(cumulative >= target){
+            break;
+        }
+    }
+    *cumulative_count = cumulative;
+    return (b < TREE_LATENCY_BUCKETS) ? b : TREE_LATENCY_BUCKETS - 1;
+}
+
+uint64_t tree_latency_percentile(const tree_latency_histogram_t* const histogram, const double percentile){
+    if(0 == histogram -> total_count){
+        return 0;
+    }
+    uint64_t cumulative;
+    uint64_t value = highest_equivalent(percentile_bucket(histogram, percentile, &cumulative));
+    return (value < histogram -> max) ? value : histogram -> max;
+}
+
+uint64_t tree_latency_now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+int tree_latency_record(const uint64_t value_ns){
+    uint64_t current = atomic_load_explicit(&generation, memory_order_acquire);
+    if(current != thread_generation || NULL == thread_block){
+        latency_block_t* block = (latency_block_t *) calloc(1, sizeof(latency_block_t));
+        if(NULL == block){
+            return LATENCY_ERR_ALLOC;
+        }
+        block -> next = atomic_load_explicit(&blocks, memory_order_relaxed);
+        while(!atomic_compare_exchange_weak_explicit(&blocks, &block -> next, block, memory_order_release, memory_order_relaxed));
+        thread_block = block;
+        thread_generation = current;
+    }
+    latency_block_t* const block = thread_block;
+    relaxed_add(&block -> counts[bucket_index(value_ns)], 1);
+    relaxed_add(&block -> sum, value_ns);
+    if(value_ns > atomic_load_explicit(&block -> max, memory_order_relaxed)){
+        atomic_store_explicit(&block -> max, value_ns, memory_order_relaxed);
+    }
+    return LATENCY_OK;
+}
+
+void tree_latency_merge(tree_latency_histogram_t* const interval){
+    tree_latency_clear(interval);
+    uint64_t max_recorded = 0;
+    while(atomic_flag_test_and_set_explicit(&merge_lock, memory_order_acquire));
+    for(latency_block_t* block = atomic_load_explicit(&blocks, memory_order_acquire); NULL != block; block = block -> next){
+        for(uint32_t b = 0; b < TREE_LATENCY_BUCKETS; b++){
+            uint64_t count = atomic_load_explicit(&block -> counts[b], memory_order_relaxed);
+            interval -> counts[b] += count - block -> merged_counts[b];
+            interval -> total_count += count - block -> merged_counts[b];
+            block -> merged_counts[b] = count;
+        }
+        uint64_t sum = atomic_load_explicit(&block -> sum, memory_order_relaxed);
+        interval -> sum += sum - block -> merged_sum;
+        block -> merged_sum = sum;
+        uint64_t max = atomic_load_explicit(&block -> max, memory_order_relaxed);
+        max_recorded = (max > max_recorded) ? max : max_recorded;
+    }
+    atomic_flag_clear_explicit(&merge_lock, memory_order_release);
+    for(uint32_t b = 0; b < TREE_LATENCY_BUCKETS && interval -> total_count > 0; b++){
+        if(interval -> counts[b] > 0){
+            interval -> min = (UINT64_MAX == interval -> min) ? lowest_equivalent(b) : interval -> min;
+            interval -> max = highest_equivalent(b);
+        }
+    }
+    // The max of the threads is exact but covers all their values, the highest bucket only the interval: the lowest is the best bound.
+    interval -> max = (max_recorded < interval -> max) ? max_recorded : interval -> max;
+}
+
+void tree_latency_reset(void){
+    while(atomic_flag_test_and_set_explicit(&merge_lock, memory_order_acquire));
+    atomic_fetch_add_explicit(&generation, 1, memory_order_release);
+    latency_block_t* block = atomic_exchange_explicit(&blocks, NULL, memory_order_acquire);
+    while(NULL != block){
+        latency_block_t* next = block -> next;
+        free(block);
+        block = next;
+    }
+    atomic_flag_clear_explicit(&merge_lock, memory_order_release);
+}
+
+void tree_latency_print(FILE* const out, const char* const name, const tree_latency_histogram_t* const histogram){
+    double mean = (histogram -> total_count > 0) ? (double) histogram -> sum / histogram -> total_count : 0.0;
+    fprintf(out, "%-24s count %10llu mean %10.3f p50 %10.3f p90 %10.3f p99 %10.3f p99.9 %10.3f p99.99 %10.3f max %10.3f us\n", name,
+            (unsigned long long) histogram -> total_count, mean / 1e3, tree_latency_percentile(histogram, 50.0) / 1e3,
+            tree_latency_percentile(histogram, 90.0) / 1e3, tree_latency_percentile(histogram, 99.0) / 1e3,
+            tree_latency_percentile(histogram, 99.9) / 1e3, tree_latency_percentile(histogram, 99.99) / 1e3, histogram -> max / 1e3);
+}
+
+void tree_latency_dump(FILE* const out, const tree_latency_histogram_t* const histogram, const uint32_t ticks_per_half_distance){
+    uint32_t ticks = (ticks_per_half_distance > 0) ? ticks_per_half_distance : 1;
+    fprintf(out, "%12s %14s %10s %14s\n\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+    if(histogram -> total_count > 0){
+        // Rows are spaced by 1 / ticks of the remaining distance to 100%, which halves at every level, as the percentile iterator of HdrHistogram.
+        for(uint32_t level = 0; level < 64; level++){
+            double remaining = 100.0 / (double) (1ULL << level);
+            uint8_t done = 0;
+            for(uint32_t tick = 0; tick < ticks && !done; tick++){
+                double percentile = 100.0 - remaining + remaining / 2.0 * tick / ticks;
+                uint64_t cumulative;
+                uint32_t b = percentile_bucket(histogram, percentile, &cumulative);
+                uint64_t value = highest_equivalent(b);
+                value = (value < histogram -> max) ? value : histogram -> max;
+                fprintf(out, "%12.3f %2.12f %10llu %14.2f\n", value / 1e3, percentile / 100.0, (unsigned long long) cumulative,
+                        100.0 / (100.0 - percentile));
+                done = (cumulative >= histogram -> total_count);
+            }
+            if(done){
+                break;
+            }
+        }
+        fprintf(out, "%12.3f %2.12f %10llu\n", histogram -> max / 1e3, 1.0, (unsigned long long) histogram -> total_count);
+    }
+    double mean = (histogram -> total_count > 0) ? (double) histogram -> sum / histogram -> total_count : 0.0;
+    fprintf(out, "#[Mean    = %12.3f, Max            = %12.3f]\n", mean / 1e3, histogram -> max / 1e3);
+    fprintf(out, "#[Buckets = %12u, SubBuckets     = %12u]\n", TREE_LATENCY_BUCKETS, 1U << TREE_LATENCY_SUB_BUCKET_BITS);
+    fprintf(out, "#[Total count    = %12llu]\n", (unsigned long long) histogram -> total_count);
+}
+
+int tree_latency_visit_rf_majority_voting(node_t* const trees[], const uint16_t number_trees, const feature_type_t* const features,
+                                          class_t* const classification_result, uint16_t* const num_votes){
+    uint64_t start = tree_latency_now();
+    int to_ret = visit_rf_majority_voting(trees, number_trees, features, classification_result, num_votes);
+    tree_latency_record(tree_latency_now() - start);
+    return to_ret;
+}
@@ -0,0 +1,144 @@
+/*
+ * This file is part of DTC: Decision Tree in C-lang project.
+ *
+ * DTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DTC. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tree_latency.h
+ * @author Antonio Emmanuele (antony.35.ae@gmail.com)
+ * @brief  Contains the HDR-style latency histograms and the per-thread latency recorder of the single-sample inference path.
+ * @version 0.1
+ * @date 2024-12-29
+ *
+ * @copyright Copyright (c) 2024 Antonio Emmanuele
+ *
+ */
+#ifndef TREE_LATENCY_H
+#define TREE_LATENCY_H
+#include <stdint.h>
+#include <stdio.h>
+#include "tree_visit.h"
+
+#ifndef TREE_LATENCY_SUB_BUCKET_BITS
+#define TREE_LATENCY_SUB_BUCKET_BITS 7  /**< Values below 2^TREE_LATENCY_SUB_BUCKET_BITS ns are exact, larger ones have a relative error below 2^-(TREE_LATENCY_SUB_BUCKET_BITS - 1). */
+#endif
+
+#ifndef TREE_LATENCY_MAX_BITS
+#define TREE_LATENCY_MAX_BITS 40        /**< Values of 2^TREE_LATENCY_MAX_BITS ns (about 18 minutes) or more are counted in the last bucket. */
+#endif
+
+#define TREE_LATENCY_HALF_BUCKETS (1U << (TREE_LATENCY_SUB_BUCKET_BITS - 1))   /**< Buckets per power of two above the linear range. */
+#define TREE_LATENCY_BUCKETS ((TREE_LATENCY_MAX_BITS - TREE_LATENCY_SUB_BUCKET_BITS + 2) * TREE_LATENCY_HALF_BUCKETS) /**< Number of buckets of a histogram. */
+
+#define LATENCY_OK          0   /**< The operation was successful. */
+#define LATENCY_ERR_ALLOC  -1   /**< Memory allocation failed. */
+
+/**
+ * @typedef tree_latency_histogram_t
+ * @brief   Log-linear histogram of latencies in nanoseconds, i.e. 2^TREE_LATENCY_SUB_BUCKET_BITS linear buckets followed by
+ *          TREE_LATENCY_HALF_BUCKETS buckets per power of two, so that every percentile has the same relative precision.
+ *
+ */
+typedef struct{
+    uint64_t counts[TREE_LATENCY_BUCKETS];  /**< Number of values of each bucket. */
+    uint64_t total_count;                   /**< Number of values. */
+    uint64_t sum;                           /**< Sum of the values, for the mean. */
+    uint64_t min;                           /**< Lowest value, UINT64_MAX if empty. */
+    uint64_t max;                           /**< Highest value, 0 if empty. */
+} tree_latency_histogram_t;
+
+/**
+ * @brief Empties a histogram.
+ */
+void tree_latency_clear(tree_latency_histogram_t* const histogram);
+
+/**
+ * @brief Records a value in a histogram owned by the calling thread (e.g. the response times of a benchmark). Use tree_latency_record
+ *        to record from several threads.
+ *
+ * @param[in,out] histogram Histogram to update.
+ * @param[in] value_ns Latency in nanoseconds.
+ */
+void tree_latency_add_value(tree_latency_histogram_t* const histogram, const uint64_t value_ns);
+
+/**
+ * @brief Adds the values of a histogram to another one, e.g. an interval of tree_latency_merge to the total.
+ */
+void tree_latency_add(tree_latency_histogram_t* const total, const tree_latency_histogram_t* const histogram);
+
+/**
+ * @brief Returns the value at a percentile, i.e. the highest value equivalent to the bucket reaching the percentile (capped to max),
+ *        so that reported percentiles are never lower than the recorded values. 0 for an empty histogram.
+ *
+ * @param[in] histogram Histogram to query.
+ * @param[in] percentile Percentile in [0, 100], e.g. 99.9.
+ * @return uint64_t Value in nanoseconds.
+ */
+uint64_t tree_latency_percentile(const tree_latency_histogram_t* const histogram, const double percentile);
+
+/**
+ * @brief Returns the current time of CLOCK_MONOTONIC in nanoseconds.
+ */
+uint64_t tree_latency_now(void);
+
+/**
+ * @brief Records a latency in the histogram of the calling thread. The first call of a thread allocates its histogram and pushes it on a
+ *        lock-free list. Afterwards recording only updates the histogram of the thread, with relaxed atomic loads and stores and without locks.
+ *
+ * @param[in] value_ns Latency in nanoseconds.
+ * @return int Status of the operation.
+ * @retval LATENCY_OK The value was recorded.
+ * @retval LATENCY_ERR_ALLOC The histogram of the thread can not be allocated, the value is lost.
+ */
+int tree_latency_record(const uint64_t value_ns);
+
+/**
+ * @brief Merges the values recorded by all the threads since the previous merge, i.e. the latencies of the last interval when called
+ *        periodically. It runs concurrently with the recording threads, values recorded meanwhile are part of this interval or of the next one.
+ *        Merges are serialized with a spinlock, which is never taken by the recording threads.
+ *        The min and max of an interval are the equivalent values of its lowest and highest non-empty buckets.
+ *
+ * @param[out] interval Values recorded since the previous merge.
+ */
+void tree_latency_merge(tree_latency_histogram_t* const interval);
+
+/**
+ * @brief Releases the histograms of all the threads. It must not be called while other threads are recording.
+ */
+void tree_latency_reset(void);
+
+/**
+ * @brief Prints count, mean, p50, p90, p99, p99.9, p99.99 and max of a histogram in microseconds, on one line prefixed by name.
+ */
+void tree_latency_print(FILE* const out, const char* const name, const tree_latency_histogram_t* const histogram);
+
+/**
+ * @brief Writes the percentile distribution of a histogram in the text format of HdrHistogram (.hgrm), i.e. the rows
+ *        "Value Percentile TotalCount 1/(1-Percentile)" with values in microseconds, followed by mean, max and count, so that
+ *        it can be plotted with the HdrHistogram tools.
+ *
+ * @param[in] out Output stream.
+ * @param[in] histogram Histogram to write.
+ * @param[in] ticks_per_half_distance Number of rows per halving of the remaining percentiles (e.g. 5).
+ */
+void tree_latency_dump(FILE* const out, const tree_latency_histogram_t* const histogram, const uint32_t ticks_per_half_distance);
+
+/**
+ * @brief visit_rf_majority_voting recording its latency with tree_latency_record.
+ */
+int tree_latency_visit_rf_majority_voting(node_t* const trees[], const uint16_t number_trees, const feature_type_t* const features,
+                                          class_t* const classification_result, uint16_t* const num_votes);
+
+#endif
@@ -0,0 +1,362 @@
+/*
+ * This file is part of DTC: Decision Tree in C-lang project.
+ *
+ * DTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DTC. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tree_perf.c
+ * @author Antonio Emmanuele (antony.35.ae@gmail.com)
+ * @brief  Contains the implementation of the perf_event_open instrumentation of the inference functions.
+ * @version 0.1
+ * @date 2024-12-29
+ *
+ * @copyright Copyright (c) 2024 Antonio Emmanuele
+ *
+ */
+#include "tree_perf.h"
+#include <string.h>
+
+#if TREE_PERF && defined(__linux__)
+#define TREE_PERF_ENABLED 1
+#include <linux/perf_event.h>
+#include <stdatomic.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#define TREE_PERF_ENABLED 0
+#endif
+
+static const char* const counter_names[TREE_PERF_NUM_COUNTERS] = {
+    "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses", "dtlb_misses", "task_clock_ns"
+};
+
+#if TREE_PERF_ENABLED
+
+#define HW_CACHE_READ_MISS(cache) ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+/**
+ * @brief perf_event_open type and config of each counter, indexed by TREE_PERF_*.
+ */
+static const struct{
+    uint32_t type;
+    uint64_t config;
+} events[TREE_PERF_NUM_COUNTERS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, HW_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HW_CACHE, HW_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL)},
+    {PERF_TYPE_HW_CACHE, HW_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB)},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+};
+
+/**
+ * @brief Counters of a thread. The hardware counters are a group, led by the first opened one, so that they are read with a single read
+ *        and scheduled together. The software counter is read alone, as it does not need the PMU.
+ */
+typedef struct{
+    int status;                                     /**< 0 if not opened yet, otherwise the result of tree_perf_open. */
+    int leader_fd;                                  /**< Leader of the group of the hardware counters, -1 if none was opened. */
+    int fds[TREE_PERF_NUM_COUNTERS];                /**< Descriptor of each counter, -1 if it was not opened. */
+    uint8_t group_position[TREE_PERF_NUM_COUNTERS]; /**< Position of each hardware counter in the group read. */
+    uint8_t group_size;                             /**< Number of counters of the group. */
+    uint32_t available;                             /**< Mask of the opened counters. */
+} thread_counters_t;
+
+static _Thread_local thread_counters_t thread_counters;
+
+static tree_perf_stats_t stats_table[TREE_PERF_MAX_STATS];
+static uint16_t num_stats = 0;
+static uint64_t dropped = 0;
+static atomic_flag stats_lock = ATOMIC_FLAG_INIT;
+
+static int open_event(const uint8_t counter, const int group_fd){
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[counter].type;
+    attr.config = events[counter].config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    if(PERF_TYPE_SOFTWARE != events[counter].type){
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    }
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+int tree_perf_open(uint32_t* const available){
+    thread_counters_t* const tc = &thread_counters;
+    if(0 == tc->status){
+        tc->leader_fd = -1;
+        tc->group_size = 0;
+        tc->available = 0;
+        for(uint8_t c = 0; c < TREE_PERF_NUM_COUNTERS; c++){
+            uint8_t is_hardware = PERF_TYPE_SOFTWARE != events[c].type;
+            tc->fds[c] = open_event(c, is_hardware ? tc->leader_fd : -1);
+            if(tc->fds[c] < 0){
+                continue;
+            }
+            tc->available |= 1U << c;
+            if(is_hardware){
+                if(tc->leader_fd < 0){
+                    tc->leader_fd = tc->fds[c];
+                }
+                tc->group_position[c] = tc->group_size++;
+            }
+        }
+        tc->status = (0 != tc->available) ? TREE_PERF_OK : TREE_PERF_ERR_OPEN;
+    }
+    if(NULL != available){
+        *available = tc->available;
+    }
+    return tc->status;
+}
+
+void tree_perf_close(void){
+    thread_counters_t* const tc = &thread_counters;
+    if(0 == tc->status){
+        return;
+    }
+    for(uint8_t c = 0; c < TREE_PERF_NUM_COUNTERS; c++){
+        if(tc->available & (1U << c)){
+            close(tc->fds[c]);
+        }
+    }
+    memset(tc, 0, sizeof(*tc));
+}
+
+void tree_perf_begin(tree_perf_scope_t* const scope){
+    thread_counters_t* const tc = &thread_counters;
+    memset(scope, 0, sizeof(*scope));
+    if(TREE_PERF_OK != tree_perf_open(NULL)){
+        return;
+    }
+    if(tc->leader_fd >= 0){
+        uint64_t buffer[3 + TREE_PERF_NUM_COUNTERS];
+        if(read(tc->leader_fd, buffer, sizeof(buffer)) >= (ssize_t) ((3 + tc->group_size) * sizeof(uint64_t))){
+            scope->time_enabled = buffer[1];
+            scope->time_running = buffer[2];
+            for(uint8_t c = 0; c < TREE_PERF_NUM_COUNTERS; c++){
+                if(PERF_TYPE_SOFTWARE != events[c].type && (tc->available & (1U << c))){
+                    scope->values[c] = buffer[3 + tc->group_position[c]];
+                    scope->available |= 1U << c;
+                }
+            }
+        }
+    }
+    if((tc->available & (1U << TREE_PERF_TASK_CLOCK)) &&
+       read(tc->fds[TREE_PERF_TASK_CLOCK], &scope->values[TREE_PERF_TASK_CLOCK], sizeof(uint64_t)) == sizeof(uint64_t)){
+        scope->available |= 1U << TREE_PERF_TASK_CLOCK;
+    }
+}
+
+void tree_perf_end(const tree_perf_scope_t* const scope, const char* const call_site, const void* const model, const uint64_t samples){
+    tree_perf_scope_t end;
+    tree_perf_begin(&end);
+    uint32_t available = scope->available & end.available;
+    uint64_t enabled = end.time_enabled - scope->time_enabled;
+    uint64_t running = end.time_running - scope->time_running;
+    uint64_t deltas[TREE_PERF_NUM_COUNTERS] = {0};
+    for(uint8_t c = 0; c < TREE_PERF_NUM_COUNTERS; c++){
+        // Counters going backwards (seen with the software clock of some hypervisors) are unknown for this call.
+        if(!(available & (1U << c)) || end.values[c] < scope->values[c]){
+            available &= ~(1U << c);
+            continue;
+        }
+        deltas[c] = end.values[c] - scope->values[c];
+        if(PERF_TYPE_SOFTWARE != events[c].type){
+            // The group did not run (e.g. its events do not fit in the PMU): the counters are unknown for this call.
+            if(0 == running){
+                available &= ~(1U << c);
+                deltas[c] = 0;
+            }
+            else if(running < enabled){
+                deltas[c] = (uint64_t) ((double) deltas[c] * enabled / running);
+            }
+        }
+    }
+
+    while(atomic_flag_test_and_set_explicit(&stats_lock, memory_order_acquire));
+    tree_perf_stats_t* entry = NULL;
+    for(uint16_t i = 0; i < num_stats && NULL == entry; i++){
+        if(stats_table[i].model == model && 0 == strcmp(stats_table[i].call_site, call_site)){
+            entry = &stats_table[i];
+        }
+    }
+    if(NULL == entry && num_stats < TREE_PERF_MAX_STATS){
+        entry = &stats_table[num_stats++];
+        memset(entry, 0, sizeof(*entry));
+        entry->call_site = call_site;
+        entry->model = model;
+    }
+    if(NULL != entry){
+        entry->calls++;
+        entry->samples += samples;
+        entry->available |= available;
+        for(uint8_t c = 0; c < TREE_PERF_NUM_COUNTERS; c++){
+            if(available & (1U << c)){
+                entry->counters[c] += deltas[c];
+                entry->measured_samples[c] += samples;
+            }
+        }
+    }
+    else{
+        dropped++;
+    }
+    atomic_flag_clear_explicit(&stats_lock, memory_order_release);
+}
+
+uint16_t tree_perf_get_stats(tree_perf_stats_t* const stats, const uint16_t max_stats, uint64_t* const dropped_calls){
+    while(atomic_flag_test_and_set_explicit(&stats_lock, memory_order_acquire));
+    uint16_t count = (num_stats < max_stats) ? num_stats : max_stats;
+    memcpy(stats, stats_table, count * sizeof(tree_perf_stats_t));
+    if(NULL != dropped_calls){
+        *dropped_calls = dropped;
+    }
+    atomic_flag_clear_explicit(&stats_lock, memory_order_release);
+    return count;
+}
+
+void tree_perf_reset(void){
+    while(atomic_flag_test_and_set_explicit(&stats_lock, memory_order_acquire));
+    num_stats = 0;
+    dropped = 0;
+    atomic_flag_clear_explicit(&stats_lock, memory_order_release);
+}
+
+/**
+ * @brief Measures a call returning its status, aggregating its counters on (call_site, model).
+ */
+#define MEASURE(call_site, model, samples, call) do{  \
+        tree_perf_scope_t scope;                        \
+        tree_perf_begin(&scope);                        \
+        int to_ret = (call);                            \
+        tree_perf_end(&scope, call_site, model, samples); \
+        return to_ret;                                  \
+    }while(0)
+
+#else
+
+int tree_perf_open(uint32_t* const available){
+    if(NULL != available){
+        *available = 0;
+    }
+    return TREE_PERF_ERR_UNSUPPORTED;
+}
+
+void tree_perf_close(void){
+}
+
+void tree_perf_begin(tree_perf_scope_t* const scope){
+    memset(scope, 0, sizeof(*scope));
+}
+
+void tree_perf_end(const tree_perf_scope_t* const scope, const char* const call_site, const void* const model, const uint64_t samples){
+    (void) scope;
+    (void) call_site;
+    (void) model;
+    (void) samples;
+}
+
+uint16_t tree_perf_get_stats(tree_perf_stats_t* const stats, const uint16_t max_stats, uint64_t* const dropped_calls){
+    (void) stats;
+    (void) max_stats;
+    if(NULL != dropped_calls){
+        *dropped_calls = 0;
+    }
+    return 0;
+}
+
+void tree_perf_reset(void){
+}
+
+/**
+ * @brief Without TREE_PERF the instrumented functions only call the wrapped ones.
+ */
+#define MEASURE(call_site, model, samples, call) do{  \
+        (void) (call_site);                             \
+        return (call);                                  \
+    }while(0)
+
+#endif
+
+const char* tree_perf_counter_name(const uint8_t counter){
+    return (counter < TREE_PERF_NUM_COUNTERS) ? counter_names[counter] : NULL;
+}
+
+void tree_perf_print(FILE* const out){
+    tree_perf_stats_t stats[TREE_PERF_MAX_STATS];
+    uint64_t dropped_calls;
+    uint16_t count = tree_perf_get_stats(stats, TREE_PERF_MAX_STATS, &dropped_calls);
+    if(!TREE_PERF_ENABLED){
+        fprintf(out, "Performance counters disabled, build with TREE_PERF=1 on Linux\n");
+        return;
+    }
+    fprintf(out, "%-32s %-14s %10s %12s", "call site", "model", "calls", "samples");
+    for(uint8_t c = 0; c < TREE_PERF_NUM_COUNTERS; c++){
+        fprintf(out, " %14s", counter_names[c]);
+    }
+    fprintf(out, " %6s  (counters per sample)\n", "ipc");
+    for(uint16_t i = 0; i < count; i++){
+        const tree_perf_stats_t* const s = &stats[i];
+        fprintf(out, "%-32s %-14p %10llu %12llu", s->call_site, s->model, (unsigned long long) s->calls, (unsigned long long) s->samples);
+        for(uint8_t c = 0; c < TREE_PERF_NUM_COUNTERS; c++){
+            if((s->available & (1U << c)) && s->measured_samples[c] > 0){
+                fprintf(out, " %14.2f", (double) s->counters[c] / s->measured_samples[c]);
+            }
+            else{
+                fprintf(out, " %14s", "-");
+            }
+        }
+        uint32_t ipc_mask = (1U << TREE_PERF_CYCLES) | (1U << TREE_PERF_INSTRUCTIONS);
+        if((s->available & ipc_mask) == ipc_mask && s->counters[TREE_PERF_CYCLES] > 0){
+            fprintf(out, " %6.2f\n", (double) s->counters[TREE_PERF_INSTRUCTIONS] / s->counters[TREE_PERF_CYCLES]);
+        }
+        else{
+            fprintf(out, " %6s\n", "-");
+        }
+    }
+    if(dropped_calls > 0){
+        fprintf(out, "%llu calls not aggregated, more than TREE_PERF_MAX_STATS call sites and models\n", (unsigned long long) dropped_calls);
+    }
+}
+
+int tree_perf_visit_ensemble(const char* const call_site, node_t* const trees[], const uint16_t number_trees, const feature_type_t* const features, class_t* const class_per_tree){
+    MEASURE(call_site, trees, 1, visit_ensemble(trees, number_trees, features, class_per_tree));
+}
+
+int tree_perf_visit_rf_majority_voting(const char* const call_site, node_t* const trees[], const uint16_t number_trees, const feature_type_t* const features,
+                                       class_t* const classification_result, uint16_t* const num_votes){
+    MEASURE(call_site, trees, 1, visit_rf_majority_voting(trees, number_trees, features, classification_result, num_votes));
+}
+
+int tree_perf_visit_rf_majority_voting_batch(const char* const call_site, node_t* const trees[], const uint16_t number_trees, const uint16_t number_classes,
+                                             const feature_type_t* const features, const uint32_t number_samples, const uint16_t number_features,
+                                             class_t* const classification_results, uint16_t* const num_votes){
+    MEASURE(call_site, trees, number_samples, visit_rf_majority_voting_batch(trees, number_trees, number_classes, features, number_samples, number_features,
+                                                                             classification_results, num_votes));
+}
+
+int tree_perf_visit_rf_class_probabilities_batch(const char* const call_site, node_t* const trees[], const uint16_t number_trees, const uint16_t number_classes,
+                                                 const float* const leaf_probabilities[], const feature_type_t* const features, const uint32_t number_samples,
+                                                 const uint16_t number_features, float* const class_probabilities){
+    MEASURE(call_site, trees, number_samples, visit_rf_class_probabilities_batch(trees, number_trees, number_classes, leaf_probabilities, features, number_samples,
+                                                                                 number_features, class_probabilities));
+}
+
+int tree_perf_visit_rf_mean_batch(const char* const call_site, node_t* const trees[], const uint16_t number_trees, const feature_type_t* const features,
+                                  const uint32_t number_samples, const uint16_t number_features, feature_type_t* const regression_results){
+    MEASURE(call_site, trees, number_samples, visit_rf_mean_batch(trees, number_trees, features, number_samples, number_features, regression_results));
+}
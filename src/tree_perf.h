@@ -0,0 +1,185 @@
+/*
+ * This file is part of DTC: Decision Tree in C-lang project.
+ *
+ * DTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DTC. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tree_perf.h
+ * @author Antonio Emmanuele (antony.35.ae@gmail.com)
+ * @brief  Contains the optional instrumentation of the inference functions with the Linux perf_event_open hardware counters.
+ * @version 0.1
+ * @date 2024-12-29
+ *
+ * @copyright Copyright (c) 2024 Antonio Emmanuele
+ *
+ */
+#ifndef TREE_PERF_H
+#define TREE_PERF_H
+#include <stdint.h>
+#include <stdio.h>
+#include "tree_visit.h"
+
+#ifndef TREE_PERF
+#define TREE_PERF 0                 /**< If set to 1 (on Linux), the tree_perf_* functions read the perf_event_open counters. Otherwise they only call the wrapped functions. */
+#endif
+
+#ifndef TREE_PERF_MAX_STATS
+#define TREE_PERF_MAX_STATS 64      /**< Number of (call site, model) pairs whose counters are aggregated, further pairs are counted in the dropped calls. */
+#endif
+
+#define TREE_PERF_OK                0  /**< At least a counter was opened. */
+#define TREE_PERF_ERR_UNSUPPORTED  -1  /**< The library was built without TREE_PERF, or not on Linux. */
+#define TREE_PERF_ERR_OPEN         -2  /**< No counter can be opened, e.g. because of perf_event_paranoid or of a virtual machine without PMU. */
+
+#define TREE_PERF_CYCLES            0  /**< CPU cycles. */
+#define TREE_PERF_INSTRUCTIONS      1  /**< Retired instructions. */
+#define TREE_PERF_BRANCH_MISSES     2  /**< Mispredicted branches. */
+#define TREE_PERF_L1D_MISSES        3  /**< L1 data cache read misses. */
+#define TREE_PERF_LLC_MISSES        4  /**< Last level cache read misses. */
+#define TREE_PERF_DTLB_MISSES       5  /**< Data TLB read misses. */
+#define TREE_PERF_TASK_CLOCK        6  /**< Nanoseconds of CPU time of the thread, a software counter available without PMU. */
+#define TREE_PERF_NUM_COUNTERS      7  /**< Number of counters. */
+
+/**
+ * @brief Expands to a string identifying the call site, i.e. "file:line".
+ */
+#define TREE_PERF_SITE TREE_PERF_SITE_(__FILE__, __LINE__)
+#define TREE_PERF_SITE_(file, line) TREE_PERF_SITE__(file, line)
+#define TREE_PERF_SITE__(file, line) file ":" #line
+
+/**
+ * @typedef tree_perf_scope_t
+ * @brief   Counters read by tree_perf_begin, the beginning of a measured region.
+ *
+ */
+typedef struct{
+    uint64_t values[TREE_PERF_NUM_COUNTERS];    /**< Value of each counter. */
+    uint64_t time_enabled;                      /**< Time the hardware counters were enabled, to scale them if the PMU is multiplexed. */
+    uint64_t time_running;                      /**< Time the hardware counters were running. */
+    uint32_t available;                         /**< Mask (1 << TREE_PERF_*) of the counters that were read. */
+} tree_perf_scope_t;
+
+/**
+ * @typedef tree_perf_stats_t
+ * @brief   Counters aggregated over the calls of a call site on a model.
+ *
+ */
+typedef struct{
+    const char* call_site;                      /**< Name of the call site, e.g. TREE_PERF_SITE. */
+    const void* model;                          /**< Model of the calls, e.g. the trees array. */
+    uint64_t calls;                             /**< Number of calls. */
+    uint64_t samples;                           /**< Number of classified samples. */
+    uint64_t counters[TREE_PERF_NUM_COUNTERS];  /**< Sum of the counters over the calls in which they were read, scaled if the PMU was multiplexed. */
+    uint64_t measured_samples[TREE_PERF_NUM_COUNTERS]; /**< Samples of the calls in which each counter was read, i.e. the divisor of its per-sample value. */
+    uint32_t available;                         /**< Mask (1 << TREE_PERF_*) of the counters read in at least a call. */
+} tree_perf_stats_t;
+
+/**
+ * @brief Opens the counters of the calling thread, which count the user space code of the thread only.
+ *        The instrumented functions call it on the first use in each thread, so calling it explicitly is only needed to check the available counters.
+ *        Counters are opened one by one, so that a missing event (e.g. no LLC events in a virtual machine) does not disable the others.
+ *
+ * @param[out] available Mask (1 << TREE_PERF_*) of the opened counters. It can be NULL.
+ * @return int Status of the operation.
+ * @retval TREE_PERF_OK At least a counter was opened.
+ * @retval TREE_PERF_ERR_UNSUPPORTED The library was built without TREE_PERF, or not on Linux.
+ * @retval TREE_PERF_ERR_OPEN No counter can be opened.
+ */
+int tree_perf_open(uint32_t* const available);
+
+/**
+ * @brief Closes the counters of the calling thread. The aggregated counters are kept.
+ */
+void tree_perf_close(void);
+
+/**
+ * @brief Reads the counters at the beginning of a measured region.
+ *
+ * @param[out] scope Counters at the beginning of the region.
+ */
+void tree_perf_begin(tree_perf_scope_t* const scope);
+
+/**
+ * @brief Reads the counters at the end of a measured region and adds their difference to the statistics of (call_site, model).
+ *        Call sites are compared by their content, so the same string in different translation units is the same call site.
+ *
+ * @param[in] scope Counters read by tree_perf_begin.
+ * @param[in] call_site Name of the call site, it must outlive the statistics (e.g. a string literal like TREE_PERF_SITE).
+ * @param[in] model Model of the call, only compared by address.
+ * @param[in] samples Number of samples processed in the region.
+ */
+void tree_perf_end(const tree_perf_scope_t* const scope, const char* const call_site, const void* const model, const uint64_t samples);
+
+/**
+ * @brief Copies the aggregated statistics, in order of first call.
+ *
+ * @param[out] stats Array of at least max_stats elements.
+ * @param[in] max_stats Maximum number of statistics to copy.
+ * @param[out] dropped_calls Number of calls not aggregated because TREE_PERF_MAX_STATS pairs were already used. It can be NULL.
+ * @return uint16_t Number of copied statistics.
+ */
+uint16_t tree_perf_get_stats(tree_perf_stats_t* const stats, const uint16_t max_stats, uint64_t* const dropped_calls);
+
+/**
+ * @brief Clears the aggregated statistics.
+ */
+void tree_perf_reset(void);
+
+/**
+ * @brief Returns the name of a counter, e.g. "cycles", or NULL for invalid counters.
+ */
+const char* tree_perf_counter_name(const uint8_t counter);
+
+/**
+ * @brief Prints a table of the aggregated statistics, with the counters per sample and the instructions per cycle.
+ *        A low IPC with many branch misses per sample points to a branch-bound model, many cache and TLB misses to a memory-bound one.
+ *        Unavailable counters are printed as "-".
+ *
+ * @param[in] out Output stream.
+ */
+void tree_perf_print(FILE* const out);
+
+/**
+ * @brief Instrumented visit_ensemble, whose counters are aggregated on (call_site, trees).
+ */
+int tree_perf_visit_ensemble(const char* const call_site, node_t* const trees[], const uint16_t number_trees, const feature_type_t* const features, class_t* const class_per_tree);
+
+/**
+ * @brief Instrumented visit_rf_majority_voting, whose counters are aggregated on (call_site, trees).
+ */
+int tree_perf_visit_rf_majority_voting(const char* const call_site, node_t* const trees[], const uint16_t number_trees, const feature_type_t* const features,
+                                       class_t* const classification_result, uint16_t* const num_votes);
+
+/**
+ * @brief Instrumented visit_rf_majority_voting_batch, whose counters are aggregated on (call_site, trees).
+ */
+int tree_perf_visit_rf_majority_voting_batch(const char* const call_site, node_t* const trees[], const uint16_t number_trees, const uint16_t number_classes,
+                                             const feature_type_t* const features, const uint32_t number_samples, const uint16_t number_features,
+                                             class_t* const classification_results, uint16_t* const num_votes);
+
+/**
+ * @brief Instrumented visit_rf_class_probabilities_batch, whose counters are aggregated on (call_site, trees).
+ */
+int tree_perf_visit_rf_class_probabilities_batch(const char* const call_site, node_t* const trees[], const uint16_t number_trees, const uint16_t number_classes,
+                                                 const float* const leaf_probabilities[], const feature_type_t* const features, const uint32_t number_samples,
+                                                 const uint16_t number_features, float* const class_probabilities);
+
+/**
+ * @brief Instrumented visit_rf_mean_batch, whose counters are aggregated on (call_site, trees).
+ */
+int tree_perf_visit_rf_mean_batch(const char* const call_site, node_t* const trees[], const uint16_t number_trees, const feature_type_t* const features,
+                                  const uint32_t number_samples, const uint16_t number_features, feature_type_t* const regression_results);
+
+#endif
@@ -0,0 +1,384 @@
+/*
+ * This file is part of DTC: Decision Tree in C-lang project.
+ *
+ * DTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DTC. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tree_telemetry.c
+ * @author Antonio Emmanuele (antony.35.ae@gmail.com)
+ * @brief  Contains the implementation of the per-tree path length and leaf hit counters.
+ * @version 0.1
+ * @date 2024-12-29
+ *
+ * @copyright Copyright (c) 2024 Antonio Emmanuele
+ *
+ */
+#include "tree_telemetry.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if TREE_TELEMETRY
+#include <stdatomic.h>
+
+/**
+ * @brief Root of a registered tree, the roots are sorted by address to find the index of a visited tree.
+ */
+typedef struct{
+    uintptr_t root;     /**< Address of the root node. */
+    uint16_t tree;      /**< Index of the tree in the registered array. */
+} root_entry_t;
+
+/**
+ * @brief Counters of a thread. They are only written by their thread, with relaxed atomic loads and stores instead of read-modify-write
+ *        operations, so that the snapshot can read them concurrently. Blocks are pushed on a lock-free list on the first visit of a thread.
+ */
+typedef struct telemetry_block_t{
+    struct telemetry_block_t* next;     /**< Next block of the list. */
+    _Atomic uint64_t counters[];        /**< Counters, laid out as described by counters_layout_t. */
+} telemetry_block_t;
+
+/**
+ * @brief Offsets of the counters of a block, i.e. the layout of tree_telemetry_t.
+ */
+typedef struct{
+    size_t visits;
+    size_t pruned;
+    size_t path_length;
+    size_t max_depth;
+    size_t tree_depths;
+    size_t class_depths;
+    size_t leaf_hits;
+    size_t unattributed_leaves;
+    size_t unregistered;
+    size_t size;
+} counters_layout_t;
+
+static struct{
+    root_entry_t* roots;        /**< Sorted roots, NULL if no model is registered. */
+    uint16_t number_trees;
+    uint16_t number_classes;
+    uint16_t* num_nodes;        /**< Number of nodes of each tree, NULL if not registered. */
+    uint32_t* leaf_offsets;     /**< Offsets of the trees in the leaf hits, NULL if the number of nodes is not registered. */
+    counters_layout_t layout;
+} model;
+
+/** Incremented at each registration, so that the threads drop the blocks of the previous model (already released) on their next visit. */
+static _Atomic uint64_t generation = 1;
+static _Atomic(telemetry_block_t*) blocks = NULL;
+static _Thread_local telemetry_block_t* thread_block = NULL;
+static _Thread_local uint64_t thread_generation = 0;
+
+static inline void add(_Atomic uint64_t* const counter, const uint64_t value){
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+static int compare_roots(const void* a, const void* b){
+    uintptr_t root_a = ((const root_entry_t *) a) -> root;
+    uintptr_t root_b = ((const root_entry_t *) b) -> root;
+    return (root_a > root_b) - (root_a < root_b);
+}
+
+/**
+ * @brief Returns the index of the tree with the given root, or -1 if it is not registered. Trees sharing the same root after
+ *        optimize_tree_conf are attributed to the first one.
+ */
+static int32_t find_tree(const node_t* const root_node){
+    uintptr_t root = (uintptr_t) root_node;
+    uint32_t low = 0, high = model.number_trees;
+    while(low < high){
+        uint32_t middle = (low + high) / 2;
+        if(model.roots[middle].root < root){
+            low = middle + 1;
+        }
+        else{
+            high = middle;
+        }
+    }
+    return (low < model.number_trees && model.roots[low].root == root) ? (int32_t) model.roots[low].tree : -1;
+}
+
+static void release_blocks(void){
+    telemetry_block_t* block = atomic_exchange_explicit(&blocks, NULL, memory_order_acquire);
+    while(NULL != block){
+        telemetry_block_t* next = block -> next;
+        free(block);
+        block = next;
+    }
+}
+
+void tree_telemetry_unregister(void){
+    atomic_fetch_add_explicit(&generation, 1, memory_order_release);
+    release_blocks();
+    free(model.roots);
+    free(model.num_nodes);
+    free(model.leaf_offsets);
+    memset(&model, 0, sizeof(model));
+}
+
+int tree_telemetry_register(node_t* const trees[], const uint16_t number_trees, const uint16_t* const num_nodes, const uint16_t number_classes){
+    tree_telemetry_unregister();
+    model.roots = (root_entry_t *) malloc((number_trees + 1) * sizeof(root_entry_t));
+    if(NULL != num_nodes){
+        model.num_nodes = (uint16_t *) malloc((number_trees + 1) * sizeof(uint16_t));
+        model.leaf_offsets = (uint32_t *) malloc((number_trees + 1) * sizeof(uint32_t));
+    }
+    if(NULL == model.roots || (NULL != num_nodes && (NULL == model.num_nodes || NULL == model.leaf_offsets))){
+        tree_telemetry_unregister();
+        return TELEMETRY_ERR_ALLOC;
+    }
+    uint32_t total_nodes = 0;
+    for(uint16_t t = 0; t < number_trees; t++){
+        model.roots[t].root = (uintptr_t) trees[t];
+        model.roots[t].tree = t;
+        if(NULL != num_nodes){
+            model.num_nodes[t] = num_nodes[t];
+            model.leaf_offsets[t] = total_nodes;
+            total_nodes += num_nodes[t];
+        }
+    }
+    if(NULL != num_nodes){
+        model.leaf_offsets[number_trees] = total_nodes;
+    }
+    // Stable on the tree index, so that shared roots are attributed to the first tree.
+    for(uint16_t t = 1; t < number_trees; t++){
+        root_entry_t entry = model.roots[t];
+        int32_t i = t - 1;
+        while(i >= 0 && compare_roots(&model.roots[i], &entry) > 0){
+            model.roots[i + 1] = model.roots[i];
+            i--;
+        }
+        model.roots[i + 1] = entry;
+    }
+    model.number_trees = number_trees;
+    model.number_classes = number_classes;
+    counters_layout_t* const layout = &model.layout;
+    layout -> visits = 0;
+    layout -> pruned = layout -> visits + number_trees;
+    layout -> path_length = layout -> pruned + number_trees;
+    layout -> max_depth = layout -> path_length + number_trees;
+    layout -> tree_depths = layout -> max_depth + number_trees;
+    layout -> class_depths = layout -> tree_depths + (size_t) number_trees * TREE_TELEMETRY_DEPTH_BUCKETS;
+    layout -> leaf_hits = layout -> class_depths + (size_t) number_classes * TREE_TELEMETRY_DEPTH_BUCKETS;
+    layout -> unattributed_leaves = layout -> leaf_hits + total_nodes;
+    layout -> unregistered = layout -> unattributed_leaves + 1;
+    layout -> size = layout -> unregistered + 1;
+    atomic_fetch_add_explicit(&generation, 1, memory_order_release);
+    return TELEMETRY_OK;
+}
+
+/**
+ * @brief Returns the counters of the calling thread for the registered model, allocating them on the first visit. NULL if no model
+ *        is registered or the allocation failed.
+ */
+static telemetry_block_t* get_thread_block(void){
+    uint64_t current = atomic_load_explicit(&generation, memory_order_acquire);
+    if(current == thread_generation){
+        return thread_block;
+    }
+    thread_generation = current;
+    thread_block = NULL;
+    if(NULL == model.roots){
+        return NULL;
+    }
+    telemetry_block_t* block = (telemetry_block_t *) calloc(1, sizeof(telemetry_block_t) + model.layout.size * sizeof(_Atomic uint64_t));
+    if(NULL == block){
+        return NULL;
+    }
+    block -> next = atomic_load_explicit(&blocks, memory_order_relaxed);
+    while(!atomic_compare_exchange_weak_explicit(&blocks, &block -> next, block, memory_order_release, memory_order_relaxed));
+    thread_block = block;
+    return block;
+}
+
+void tree_telemetry_record(const node_t* const root_node, const node_t* const leaf_node, const uint32_t depth){
+    telemetry_block_t* const block = get_thread_block();
+    if(NULL == block){
+        return;
+    }
+    _Atomic uint64_t* const counters = block -> counters;
+    const counters_layout_t* const layout = &model.layout;
+    int32_t tree = find_tree(root_node);
+    if(tree < 0){
+        add(&counters[layout -> unregistered], 1);
+        return;
+    }
+    if(NULL == leaf_node){
+        add(&counters[layout -> pruned + tree], 1);
+        return;
+    }
+    uint32_t bucket = (depth < TREE_TELEMETRY_MAX_DEPTH) ? depth : TREE_TELEMETRY_MAX_DEPTH;
+    add(&counters[layout -> visits + tree], 1);
+    add(&counters[layout -> path_length + tree], depth);
+    add(&counters[layout -> tree_depths + (size_t) tree * TREE_TELEMETRY_DEPTH_BUCKETS + bucket], 1);
+    if(depth > atomic_load_explicit(&counters[layout -> max_depth + tree], memory_order_relaxed)){
+        atomic_store_explicit(&counters[layout -> max_depth + tree], depth, memory_order_relaxed);
+    }
+    if(leaf_node -> class >= 0 && leaf_node -> class < model.number_classes){
+        add(&counters[layout -> class_depths + (size_t) leaf_node -> class * TREE_TELEMETRY_DEPTH_BUCKETS + bucket], 1);
+    }
+    if(NULL != model.leaf_offsets){
+        uintptr_t offset = (uintptr_t) leaf_node - (uintptr_t) root_node;
+        uintptr_t index = offset / sizeof(node_t);
+        if((uintptr_t) leaf_node >= (uintptr_t) root_node && 0 == offset % sizeof(node_t) && index < model.num_nodes[tree]){
+            add(&counters[layout -> leaf_hits + model.leaf_offsets[tree] + index], 1);
+        }
+        else{
+            add(&counters[layout -> unattributed_leaves], 1);
+        }
+    }
+}
+
+int tree_telemetry_snapshot(tree_telemetry_t* const snapshot){
+    memset(snapshot, 0, sizeof(tree_telemetry_t));
+    if(NULL == model.roots){
+        return TELEMETRY_ERR_NOT_REGISTERED;
+    }
+    const counters_layout_t* const layout = &model.layout;
+    uint16_t number_trees = model.number_trees;
+    uint64_t* sums = (uint64_t *) calloc(layout -> size, sizeof(uint64_t));
+    snapshot -> max_depth = (uint8_t *) calloc(number_trees + 1, sizeof(uint8_t));
+    if(NULL != model.leaf_offsets){
+        snapshot -> leaf_offsets = (uint32_t *) malloc((number_trees + 1) * sizeof(uint32_t));
+    }
+    if(NULL == sums || NULL == snapshot -> max_depth || (NULL != model.leaf_offsets && NULL == snapshot -> leaf_offsets)){
+        free(sums);
+        tree_telemetry_free(snapshot);
+        return TELEMETRY_ERR_ALLOC;
+    }
+    for(telemetry_block_t* block = atomic_load_explicit(&blocks, memory_order_acquire); NULL != block; block = block -> next){
+        for(size_t c = 0; c < layout -> size; c++){
+            uint64_t value = atomic_load_explicit(&block -> counters[c], memory_order_relaxed);
+            if(c >= layout -> max_depth && c < layout -> tree_depths){
+                sums[c] = (value > sums[c]) ? value : sums[c];
+            }
+            else{
+                sums[c] += value;
+            }
+        }
+        snapshot -> threads++;
+    }
+    // The arrays of the snapshot point into sums, owned through visits.
+    snapshot -> number_trees = number_trees;
+    snapshot -> number_classes = model.number_classes;
+    snapshot -> visits = &sums[layout -> visits];
+    snapshot -> pruned = &sums[layout -> pruned];
+    snapshot -> path_length = &sums[layout -> path_length];
+    snapshot -> tree_depths = &sums[layout -> tree_depths];
+    snapshot -> class_depths = &sums[layout -> class_depths];
+    snapshot -> unattributed_leaves = sums[layout -> unattributed_leaves];
+    snapshot -> unregistered = sums[layout -> unregistered];
+    for(uint16_t t = 0; t < number_trees; t++){
+        uint64_t depth = sums[layout -> max_depth + t];
+        snapshot -> max_depth[t] = (depth < UINT8_MAX) ? (uint8_t) depth : UINT8_MAX;
+    }
+    if(NULL != model.leaf_offsets){
+        memcpy(snapshot -> leaf_offsets, model.leaf_offsets, (number_trees + 1) * sizeof(uint32_t));
+        snapshot -> leaf_hits = &sums[layout -> leaf_hits];
+    }
+    return TELEMETRY_OK;
+}
+
+#else
+
+int tree_telemetry_register(node_t* const trees[], const uint16_t number_trees, const uint16_t* const num_nodes, const uint16_t number_classes){
+    (void) trees;
+    (void) number_trees;
+    (void) num_nodes;
+    (void) number_classes;
+    return TELEMETRY_ERR_UNSUPPORTED;
+}
+
+void tree_telemetry_unregister(void){
+}
+
+void tree_telemetry_record(const node_t* const root_node, const node_t* const leaf_node, const uint32_t depth){
+    (void) root_node;
+    (void) leaf_node;
+    (void) depth;
+}
+
+int tree_telemetry_snapshot(tree_telemetry_t* const snapshot){
+    memset(snapshot, 0, sizeof(tree_telemetry_t));
+    return TELEMETRY_ERR_UNSUPPORTED;
+}
+
+#endif
+
+void tree_telemetry_free(tree_telemetry_t* const snapshot){
+    free(snapshot -> visits);
+    free(snapshot -> max_depth);
+    free(snapshot -> leaf_offsets);
+    memset(snapshot, 0, sizeof(tree_telemetry_t));
+}
+
+void tree_telemetry_print(FILE* const out, const tree_telemetry_t* const snapshot, const double outlier_ratio){
+    if(NULL == snapshot -> visits){
+        fprintf(out, "Telemetry not collected, build with TREE_TELEMETRY=1 and register the model\n");
+        return;
+    }
+    double mean_of_means = 0.0;
+    uint16_t visited_trees = 0;
+    for(uint16_t t = 0; t < snapshot -> number_trees; t++){
+        if(snapshot -> visits[t] > 0){
+            mean_of_means += (double) snapshot -> path_length[t] / snapshot -> visits[t];
+            visited_trees++;
+        }
+    }
+    mean_of_means = (visited_trees > 0) ? mean_of_means / visited_trees : 0.0;
+    fprintf(out, "%6s %12s %10s %10s %10s %10s %12s\n", "tree", "visits", "pruned", "mean_depth", "max_depth", "ratio", "leaves_hit");
+    for(uint16_t t = 0; t < snapshot -> number_trees; t++){
+        double mean = (snapshot -> visits[t] > 0) ? (double) snapshot -> path_length[t] / snapshot -> visits[t] : 0.0;
+        double ratio = (mean_of_means > 0.0) ? mean / mean_of_means : 0.0;
+        fprintf(out, "%6u %12llu %10llu %10.2f %10u %10.2f", t, (unsigned long long) snapshot -> visits[t], (unsigned long long) snapshot -> pruned[t],
+                mean, snapshot -> max_depth[t], ratio);
+        if(NULL != snapshot -> leaf_hits){
+            uint32_t hit = 0;
+            for(uint32_t i = snapshot -> leaf_offsets[t]; i < snapshot -> leaf_offsets[t + 1]; i++){
+                hit += (snapshot -> leaf_hits[i] > 0);
+            }
+            fprintf(out, " %12u", hit);
+        }
+        else{
+            fprintf(out, " %12s", "-");
+        }
+        fprintf(out, "%s\n", (ratio > outlier_ratio) ? "  outlier" : "");
+    }
+    fprintf(out, "Mean depth of the trees %.2f, %u threads", mean_of_means, snapshot -> threads);
+    if(snapshot -> unattributed_leaves > 0 || snapshot -> unregistered > 0){
+        fprintf(out, ", %llu leaves out of their tree, %llu visits of unregistered trees", (unsigned long long) snapshot -> unattributed_leaves,
+                (unsigned long long) snapshot -> unregistered);
+    }
+    fprintf(out, "\n");
+}
+
+void tree_telemetry_write_csv(FILE* const out, const tree_telemetry_t* const snapshot){
+    fprintf(out, "histogram;index;depth;count\n");
+    for(uint16_t t = 0; NULL != snapshot -> tree_depths && t < snapshot -> number_trees; t++){
+        for(uint32_t d = 0; d < TREE_TELEMETRY_DEPTH_BUCKETS; d++){
+            uint64_t count = snapshot -> tree_depths[(size_t) t * TREE_TELEMETRY_DEPTH_BUCKETS + d];
+            if(count > 0){
+                fprintf(out, "tree;%u;%u;%llu\n", t, d, (unsigned long long) count);
+            }
+        }
+    }
+    for(uint16_t c = 0; NULL != snapshot -> class_depths && c < snapshot -> number_classes; c++){
+        for(uint32_t d = 0; d < TREE_TELEMETRY_DEPTH_BUCKETS; d++){
+            uint64_t count = snapshot -> class_depths[(size_t) c * TREE_TELEMETRY_DEPTH_BUCKETS + d];
+            if(count > 0){
+                fprintf(out, "class;%u;%u;%llu\n", c, d, (unsigned long long) count);
+            }
+        }
+    }
+}
@@ -0,0 +1,136 @@
+/*
+ * This file is part of DTC: Decision Tree in C-lang project.
+ *
+ * DTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DTC. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tree_telemetry.h
+ * @author Antonio Emmanuele (antony.35.ae@gmail.com)
+ * @brief  Contains the optional per-tree path length and leaf hit counters of visit_tree_leaf, enabled by TREE_TELEMETRY.
+ * @version 0.1
+ * @date 2024-12-29
+ *
+ * @copyright Copyright (c) 2024 Antonio Emmanuele
+ *
+ */
+#ifndef TREE_TELEMETRY_H
+#define TREE_TELEMETRY_H
+#include <stdint.h>
+#include <stdio.h>
+#include "tree_visit.h"
+
+#ifndef TREE_TELEMETRY_MAX_DEPTH
+#define TREE_TELEMETRY_MAX_DEPTH 63     /**< Last bucket of the depth histograms, deeper paths are counted in it. */
+#endif
+
+#define TREE_TELEMETRY_DEPTH_BUCKETS (TREE_TELEMETRY_MAX_DEPTH + 1) /**< Number of buckets of the depth histograms, i.e. depths 0 to TREE_TELEMETRY_MAX_DEPTH. */
+
+#define TELEMETRY_OK                0  /**< The operation was successful. */
+#define TELEMETRY_ERR_UNSUPPORTED  -1  /**< The library was built without TREE_TELEMETRY. */
+#define TELEMETRY_ERR_ALLOC        -2  /**< Memory allocation failed. */
+#define TELEMETRY_ERR_NOT_REGISTERED -3 /**< No model is registered. */
+
+/**
+ * @typedef tree_telemetry_t
+ * @brief   Counters of the visits of the registered model, summed over all the threads.
+ *          Depths are the number of splits crossed from the root to the reached leaf (0 for a tree made of a leaf).
+ *
+ */
+typedef struct{
+    uint16_t number_trees;      /**< Number of trees of the registered model. */
+    uint16_t number_classes;    /**< Number of classes of the registered model, 0 if the class histograms are not collected (e.g. regression). */
+    uint64_t* visits;           /**< Array of number_trees visits reaching a leaf, per tree. */
+    uint64_t* pruned;           /**< Array of number_trees visits ending in a pruned node, per tree. */
+    uint64_t* path_length;      /**< Array of number_trees sums of the depths of the reached leaves, per tree, i.e. path_length[t] / visits[t] is the mean path. */
+    uint8_t* max_depth;         /**< Array of number_trees maximum reached depths, per tree (saturated at 255). */
+    uint64_t* tree_depths;      /**< Row-major [number_trees x TREE_TELEMETRY_DEPTH_BUCKETS] histogram of the reached depths, per tree. */
+    uint64_t* class_depths;     /**< Row-major [number_classes x TREE_TELEMETRY_DEPTH_BUCKETS] histogram of the reached depths, per class of the reached leaf. */
+    uint32_t* leaf_offsets;     /**< Array of number_trees + 1 offsets of the trees in leaf_hits, NULL if the number of nodes was not registered. */
+    uint64_t* leaf_hits;        /**< Array of the visits ending in each node, i.e. leaf_hits[leaf_offsets[t] + i] for the node of index i of tree t. */
+    uint64_t unattributed_leaves; /**< Visits whose leaf is out of the registered nodes of its tree, e.g. shared across trees by optimize_tree_conf. */
+    uint64_t unregistered;      /**< Visits of trees which are not part of the registered model. */
+    uint16_t threads;           /**< Number of threads which recorded visits. */
+} tree_telemetry_t;
+
+/**
+ * @brief Registers the model whose visits are counted, and clears the counters of the previously registered one.
+ *        Trees are identified by the address of their root, so the visits of any other tree are only counted in unregistered.
+ *        It must not be called while other threads are visiting trees, and the trees must outlive the registration.
+ *
+ * @param[in] trees Array of pointers to the root nodes of the trees, e.g. tree_conf_t.trees.
+ * @param[in] number_trees Number of trees in the ensemble.
+ * @param[in] num_nodes Array of the number of nodes of each tree, e.g. tree_conf_t.num_nodes. If NULL, leaf hits are not counted.
+ * @param[in] number_classes Number of classes of the per-class histograms, 0 to skip them (e.g. for regression and boosted trees).
+ * @return int Status of the operation.
+ * @retval TELEMETRY_OK The model was registered.
+ * @retval TELEMETRY_ERR_ALLOC Memory allocation failed, no model is registered.
+ * @retval TELEMETRY_ERR_UNSUPPORTED The library was built without TREE_TELEMETRY.
+ */
+int tree_telemetry_register(node_t* const trees[], const uint16_t number_trees, const uint16_t* const num_nodes, const uint16_t number_classes);
+
+/**
+ * @brief Unregisters the model and releases the counters of all the threads. It must not be called while other threads are visiting trees.
+ */
+void tree_telemetry_unregister(void);
+
+/**
+ * @brief Records a visit of visit_tree_leaf. It is called by the visiting functions when TREE_TELEMETRY is set, and it only writes
+ *        the counters of the calling thread, without locks or atomic read-modify-write operations.
+ *        The first call of a thread allocates its counters and pushes them on a lock-free list, read by tree_telemetry_snapshot.
+ *
+ * @param[in] root_node Root of the visited tree.
+ * @param[in] leaf_node Reached leaf, NULL if the visit ended in a pruned node.
+ * @param[in] depth Number of splits crossed by the visit.
+ */
+void tree_telemetry_record(const node_t* const root_node, const node_t* const leaf_node, const uint32_t depth);
+
+/**
+ * @brief Sums the counters of all the threads. Visits running concurrently may be partially included.
+ *
+ * @param[out] snapshot Summed counters. It must be released with tree_telemetry_free.
+ * @return int Status of the operation.
+ * @retval TELEMETRY_OK The counters were summed.
+ * @retval TELEMETRY_ERR_NOT_REGISTERED, TELEMETRY_ERR_ALLOC, TELEMETRY_ERR_UNSUPPORTED An error occurred, snapshot does not need to be released.
+ */
+int tree_telemetry_snapshot(tree_telemetry_t* const snapshot);
+
+/**
+ * @brief Releases the memory of a snapshot.
+ *
+ * @param[in,out] snapshot Snapshot to release.
+ */
+void tree_telemetry_free(tree_telemetry_t* const snapshot);
+
+/**
+ * @brief Prints, for each tree, the visits, the mean and maximum depth, the ratio of the mean depth to the mean of all the trees and the
+ *        number of distinct leaves hit. Trees whose mean depth is more than outlier_ratio times the mean of the per-tree mean depths are
+ *        marked as outliers, the candidates for pruning and relayout.
+ *
+ * @param[in] out Output stream.
+ * @param[in] snapshot Snapshot to print.
+ * @param[in] outlier_ratio Ratio of the mean depth of a tree to the mean of all the trees over which it is marked (e.g. 1.5).
+ */
+void tree_telemetry_print(FILE* const out, const tree_telemetry_t* const snapshot, const double outlier_ratio);
+
+/**
+ * @brief Writes the histograms of a snapshot in ';' separated CSV, with the header "histogram;index;depth;count".
+ *        Rows of the "tree" histogram have the tree index, rows of the "class" histogram the class. Empty buckets are not written.
+ *
+ * @param[in] out Output stream.
+ * @param[in] snapshot Snapshot to write.
+ */
+void tree_telemetry_write_csv(FILE* const out, const tree_telemetry_t* const snapshot);
+
+#endif
@@ -26,16 +26,18 @@
  * 
  */
 #include "tree_visit.h"
-#include "assert.h"
 #include "string.h"
+#include "stdlib.h"
+#if TREE_TELEMETRY
+#include "tree_telemetry.h"
+#endif
 // #include "stdio.h"
-// #include "stdlib.h"
 #if USE_POINTERS
 /**
  * @brief Macro used to check if a leaf node is reached, i.e. if the current node is a leaf node.
  * 
  */
-#define IS_LEAF(current_node) ((NULL != current_node -> left_node) && (NULL != current_node -> right_node))
+#define IS_LEAF(current_node) ((NULL == current_node -> left_child) && (NULL == current_node -> right_child))
 #else
 /**
  * @brief Macro used to check if a leaf node is reached, i.e. if the current node is a leaf node.
@@ -121,16 +123,22 @@ static uint8_t not_equal(const feature_type_t a, const feature_type_t b){
 }
 static operator_fun_t operators[] = {less_or_equal, less_than, greater_or_equal, greater_than, equal, not_equal};
 
-int visit_tree(const node_t* const root_node, const feature_type_t * const features, class_t* const classification_result){
+int visit_tree_leaf(const node_t* const root_node, const feature_type_t * const features, const node_t** const leaf_node){
     const node_t* current_node = root_node; 
     int to_ret = CLASSIFICATION_DEFAULT;
     uint8_t is_leaf = IS_LEAF(current_node);
+#if TREE_TELEMETRY
+    uint32_t depth = 0;
+#endif
 #if COMPILE_PRUNED
     uint8_t is_pruned = IS_PRUNED(current_node);
     while( !is_leaf && !is_pruned){
 #else
     while(!is_leaf){
 #endif
+#if TREE_TELEMETRY
+        depth++;
+#endif
 
 #if USE_POINTERS
         if(operators[current_node->operator](features[current_node->feature_index], current_node->threshold)){
@@ -157,21 +165,36 @@ int visit_tree(const node_t* const root_node, const feature_type_t * const featu
         is_leaf = IS_LEAF(current_node);
 #endif
     }
+    // The loop only ends on a leaf or a pruned node: load_tree_conf rejects the trees with children out of bounds or cycles,
+    // so no check is needed per hop.
 #if COMPILE_PRUNED
     if(is_pruned){
         to_ret = CLASSIFICATION_PRUNED;
-        *classification_result = to_ret;
+        *leaf_node = NULL;
     }
-    else if (is_leaf){
+    else{
 #else
-    if(is_leaf){
+    {
 #endif
         to_ret = CLASSIFICATION_OK;
-        *classification_result = current_node -> class;
+        *leaf_node = current_node;
     }
-    else{
-        assert(1 == 0);
+#if TREE_TELEMETRY
+    tree_telemetry_record(root_node, *leaf_node, depth);
+#endif
+    return to_ret;
+}
+
+int visit_tree(const node_t* const root_node, const feature_type_t * const features, class_t* const classification_result){
+    const node_t* leaf_node = NULL;
+    int to_ret = visit_tree_leaf(root_node, features, &leaf_node);
+#if COMPILE_PRUNED
+    if(CLASSIFICATION_PRUNED == to_ret){
+        *classification_result = to_ret;
+        return to_ret;
     }
+#endif
+    *classification_result = leaf_node -> class;
     return to_ret;
 }
 
@@ -246,4 +269,250 @@ int visit_rf_majority_voting(   node_t* const trees[],
     // Do the majority voting.
     *num_votes = majority_voting(class_per_tree, number_trees, classification_result);
     return to_ret; 
-}
\ No newline at end of file
+}
+
+int visit_rf_majority_voting_batch( node_t* const trees[],
+                                    const uint16_t number_trees,
+                                    const uint16_t number_classes,
+                                    const feature_type_t* const features,
+                                    const uint32_t number_samples,
+                                    const uint16_t number_features,
+                                    class_t* const classification_results,
+                                    uint16_t* const num_votes){
+    int to_ret = CLASSIFICATION_OK;
+    const node_t* leaf_node = NULL;
+    // The counters are not sized on the model, as a VLA of VOTING_BLOCK_SIZE x number_classes could overflow the stack of a worker thread.
+    uint16_t stack_counts[VOTING_STACK_COUNTERS];
+    uint16_t* class_counts = stack_counts;
+    uint16_t max_counts[VOTING_BLOCK_SIZE];
+    uint32_t block_samples = VOTING_STACK_COUNTERS / (number_classes > 0U ? number_classes : 1U);
+    block_samples = (block_samples > VOTING_BLOCK_SIZE) ? VOTING_BLOCK_SIZE : block_samples;
+    if(0U == block_samples){
+        block_samples = 1U;
+        class_counts = (uint16_t *) malloc(number_classes * sizeof(uint16_t));
+        if(NULL == class_counts){
+            return CLASSIFICATION_NO_MEMORY;
+        }
+    }
+    for(uint32_t block_start = 0U; block_start < number_samples; block_start += block_samples){
+        const uint32_t block_size = (number_samples - block_start < block_samples) ? (number_samples - block_start) : block_samples;
+        class_t* const block_results = &classification_results[block_start];
+        memset(class_counts, 0, (size_t) block_size * number_classes * sizeof(uint16_t));
+        memset(max_counts, 0, sizeof(max_counts));
+        for(uint32_t s = 0U; s < block_size; s++){
+            block_results[s] = -1;
+        }
+        // Trees are visited in order, so that the draws are broken as in majority_voting.
+        for(uint16_t tree_idx = 0U; tree_idx < number_trees; tree_idx++){
+            for(uint32_t s = 0U; s < block_size; s++){
+                const feature_type_t* const sample = &features[(size_t) (block_start + s) * number_features];
+                if(CLASSIFICATION_OK == visit_tree_leaf(trees[tree_idx], sample, &leaf_node)){
+                    const class_t leaf_class = leaf_node -> class;
+                    if(leaf_class >= 0 && leaf_class < number_classes){
+                        uint16_t* const count = &class_counts[(size_t) s * number_classes + leaf_class];
+                        (*count)++;
+                        if(*count > max_counts[s]){
+                            max_counts[s] = *count;
+                            block_results[s] = leaf_class;
+                        }
+                    }
+                }
+#if COMPILE_PRUNED
+                else{
+                    to_ret = CLASSIFICATION_PRUNED;
+                }
+#endif
+            }
+        }
+        if(NULL != num_votes){
+            memcpy(&num_votes[block_start], max_counts, block_size * sizeof(uint16_t));
+        }
+    }
+    if(class_counts != stack_counts){
+        free(class_counts);
+    }
+    return to_ret;
+}
+
+/**
+ * @brief Adds the contribution of a reached leaf to a class distribution.
+ * 
+ * @param[in] root_node Root of the tree containing the leaf, used to compute the index of the leaf.
+ * @param[in] leaf_node Reached leaf.
+ * @param[in] number_classes Number of classes, i.e. the length of the distribution.
+ * @param[in] tree_probabilities Leaf class distributions of the tree, NULL if the votes are used.
+ * @param[in,out] class_probabilities Distribution to update.
+ * @return int CLASSIFICATION_OK, or CLASSIFICATION_INVALID_CLASS if the vote of the leaf is out of the distribution and it is not counted.
+ */
+static inline int accumulate_leaf(  const node_t* const root_node,
+                                    const node_t* const leaf_node,
+                                    const uint16_t number_classes,
+                                    const float* const tree_probabilities,
+                                    float* const class_probabilities){
+    if(NULL == tree_probabilities){
+        // Trees not loaded by load_tree_conf are not validated, so the class is checked before indexing the distribution.
+        if(leaf_node -> class < 0 || leaf_node -> class >= number_classes){
+            return CLASSIFICATION_INVALID_CLASS;
+        }
+        class_probabilities[leaf_node -> class] += 1.0f;
+    }
+    else{
+        const float* const leaf_probabilities = &tree_probabilities[(leaf_node - root_node) * number_classes];
+        for(uint16_t c = 0; c < number_classes; c++){
+            class_probabilities[c] += leaf_probabilities[c];
+        }
+    }
+    return CLASSIFICATION_OK;
+}
+
+int visit_rf_class_probabilities(   node_t* const trees[],
+                                    const uint16_t number_trees,
+                                    const uint16_t number_classes,
+                                    const float* const leaf_probabilities[],
+                                    const feature_type_t* const features,
+                                    float* const class_probabilities){
+    int to_ret = CLASSIFICATION_OK;
+    const node_t* leaf_node = NULL;
+    uint16_t valid_trees = 0U;
+    memset(class_probabilities, 0, number_classes * sizeof(float));
+    for(uint16_t tree_idx = 0U; tree_idx < number_trees; tree_idx++){
+        if(CLASSIFICATION_OK == visit_tree_leaf(trees[tree_idx], features, &leaf_node)){
+            if(CLASSIFICATION_OK == accumulate_leaf(trees[tree_idx], leaf_node, number_classes, (NULL == leaf_probabilities) ? NULL : leaf_probabilities[tree_idx], class_probabilities)){
+                valid_trees++;
+            }
+            else{
+                to_ret = CLASSIFICATION_INVALID_CLASS;
+            }
+        }
+#if COMPILE_PRUNED
+        else{
+            to_ret = (CLASSIFICATION_INVALID_CLASS == to_ret) ? to_ret : CLASSIFICATION_PRUNED;
+        }
+#endif
+    }
+    // Normalize, if no tree reached a leaf the distribution is left to zero.
+    if(valid_trees > 0U){
+        const float scale = 1.0f / valid_trees;
+        for(uint16_t c = 0; c < number_classes; c++){
+            class_probabilities[c] *= scale;
+        }
+    }
+    return to_ret;
+}
+
+int visit_rf_class_probabilities_batch( node_t* const trees[],
+                                        const uint16_t number_trees,
+                                        const uint16_t number_classes,
+                                        const float* const leaf_probabilities[],
+                                        const feature_type_t* const features,
+                                        const uint32_t number_samples,
+                                        const uint16_t number_features,
+                                        float* const class_probabilities){
+    int to_ret = CLASSIFICATION_OK;
+    const node_t* leaf_node = NULL;
+    // Number of trees reaching a leaf, per sample of the block.
+    uint16_t valid_trees[PROBABILITIES_BLOCK_SIZE];
+    for(uint32_t block_start = 0U; block_start < number_samples; block_start += PROBABILITIES_BLOCK_SIZE){
+        const uint32_t block_size = (number_samples - block_start < PROBABILITIES_BLOCK_SIZE) ? (number_samples - block_start) : PROBABILITIES_BLOCK_SIZE;
+        float* const block_probabilities = &class_probabilities[(size_t) block_start * number_classes];
+        memset(block_probabilities, 0, (size_t) block_size * number_classes * sizeof(float));
+        memset(valid_trees, 0, sizeof(valid_trees));
+        // Visit one tree for the whole block, so that its nodes stay in cache.
+        for(uint16_t tree_idx = 0U; tree_idx < number_trees; tree_idx++){
+            const float* const tree_probabilities = (NULL == leaf_probabilities) ? NULL : leaf_probabilities[tree_idx];
+            for(uint32_t s = 0U; s < block_size; s++){
+                const feature_type_t* const sample = &features[(size_t) (block_start + s) * number_features];
+                if(CLASSIFICATION_OK == visit_tree_leaf(trees[tree_idx], sample, &leaf_node)){
+                    if(CLASSIFICATION_OK == accumulate_leaf(trees[tree_idx], leaf_node, number_classes, tree_probabilities, &block_probabilities[(size_t) s * number_classes])){
+                        valid_trees[s]++;
+                    }
+                    else{
+                        to_ret = CLASSIFICATION_INVALID_CLASS;
+                    }
+                }
+#if COMPILE_PRUNED
+                else{
+                    to_ret = (CLASSIFICATION_INVALID_CLASS == to_ret) ? to_ret : CLASSIFICATION_PRUNED;
+                }
+#endif
+            }
+        }
+        // Normalize each row of the block.
+        for(uint32_t s = 0U; s < block_size; s++){
+            if(valid_trees[s] > 0U){
+                const float scale = 1.0f / valid_trees[s];
+                for(uint16_t c = 0; c < number_classes; c++){
+                    block_probabilities[(size_t) s * number_classes + c] *= scale;
+                }
+            }
+        }
+    }
+    return to_ret;
+}
+
+int visit_rf_mean(node_t* const trees[], const uint16_t number_trees, const feature_type_t* const features, feature_type_t* const regression_result){
+    int to_ret = CLASSIFICATION_OK;
+    const node_t* leaf_node = NULL;
+    uint16_t valid_trees = 0U;
+    // Independent accumulators, so that the additions of consecutive trees do not depend on each other. Pruned trees do not contribute.
+    feature_type_t lanes[MEAN_SIMD_LANES] = {0};
+    for(uint16_t tree_idx = 0U; tree_idx < number_trees; tree_idx++){
+        if(CLASSIFICATION_OK == visit_tree_leaf(trees[tree_idx], features, &leaf_node)){
+            lanes[tree_idx % MEAN_SIMD_LANES] += leaf_node -> leaf_value;
+            valid_trees++;
+        }
+#if COMPILE_PRUNED
+        else{
+            to_ret = CLASSIFICATION_PRUNED;
+        }
+#endif
+    }
+    feature_type_t sum = 0;
+    for(uint16_t l = 0U; l < MEAN_SIMD_LANES; l++){
+        sum += lanes[l];
+    }
+    *regression_result = (valid_trees > 0U) ? sum / valid_trees : 0;
+    return to_ret;
+}
+
+int visit_rf_mean_batch(node_t* const trees[],
+                        const uint16_t number_trees,
+                        const feature_type_t* const features,
+                        const uint32_t number_samples,
+                        const uint16_t number_features,
+                        feature_type_t* const regression_results){
+    int to_ret = CLASSIFICATION_OK;
+    const node_t* leaf_node = NULL;
+    feature_type_t leaf_values[MEAN_BLOCK_SIZE];
+    uint16_t valid_trees[MEAN_BLOCK_SIZE];
+    for(uint32_t block_start = 0U; block_start < number_samples; block_start += MEAN_BLOCK_SIZE){
+        const uint32_t block_size = (number_samples - block_start < MEAN_BLOCK_SIZE) ? (number_samples - block_start) : MEAN_BLOCK_SIZE;
+        feature_type_t* const block_sums = &regression_results[block_start];
+        memset(block_sums, 0, block_size * sizeof(feature_type_t));
+        memset(valid_trees, 0, sizeof(valid_trees));
+        for(uint16_t tree_idx = 0U; tree_idx < number_trees; tree_idx++){
+            // Gather the leaf values of the block ...
+            for(uint32_t s = 0U; s < block_size; s++){
+                const feature_type_t* const sample = &features[(size_t) (block_start + s) * number_features];
+                if(CLASSIFICATION_OK == visit_tree_leaf(trees[tree_idx], sample, &leaf_node)){
+                    leaf_values[s] = leaf_node -> leaf_value;
+                    valid_trees[s]++;
+                }
+#if COMPILE_PRUNED
+                else{
+                    leaf_values[s] = 0;
+                    to_ret = CLASSIFICATION_PRUNED;
+                }
+#endif
+            }
+            // ... and add them to the sums, this loop is vectorized across samples.
+            for(uint32_t s = 0U; s < block_size; s++){
+                block_sums[s] += leaf_values[s];
+            }
+        }
+        for(uint32_t s = 0U; s < block_size; s++){
+            block_sums[s] = (valid_trees[s] > 0U) ? block_sums[s] / valid_trees[s] : 0;
+        }
+    }
+    return to_ret;
+}
@@ -44,12 +44,38 @@
 #define USE_FLOAT      1            /**< If set to 1, the code uses float instead of double for feature values. */
 #endif
 
+#ifndef TREE_TELEMETRY
+#define TREE_TELEMETRY 0            /**< If set to 1, visit_tree_leaf records the path length and the reached leaf of every visit, see tree_telemetry.h. */
+#endif
+
 #define CLASSIFICATION_DEFAULT 0    /**< Classification default return value. Theoretically, never employed. */
 #define CLASSIFICATION_OK 1         /**< No draw or pruned conditions occurred during classification. */
 #if COMPILE_PRUNED
 #define CLASSIFICATION_PRUNED -1    /**< The tree was pruned, i.e. the current_node, during the execution of tree_visiting, is NULL and a leaf is not reached. */
 #endif
 #define CLASSIFICATION_DRAW -2      /**< Two or more classes share the majority voting condition. */
+#define CLASSIFICATION_INVALID_CLASS -3 /**< A reached leaf has a class out of [0, number_classes), it is not counted. */
+#define CLASSIFICATION_NO_MEMORY -4 /**< The vote counters could not be allocated, no sample was classified. */
+
+#ifndef PROBABILITIES_BLOCK_SIZE
+#define PROBABILITIES_BLOCK_SIZE 64 /**< Number of samples processed together by the batched probability functions. */
+#endif
+
+#ifndef VOTING_BLOCK_SIZE
+#define VOTING_BLOCK_SIZE 64        /**< Number of samples processed together by visit_rf_majority_voting_batch. */
+#endif
+
+#ifndef VOTING_STACK_COUNTERS
+#define VOTING_STACK_COUNTERS 4096  /**< Vote counters of visit_rf_majority_voting_batch on the stack, shared by the samples of a block. */
+#endif
+
+#ifndef MEAN_BLOCK_SIZE
+#define MEAN_BLOCK_SIZE 64          /**< Number of samples processed together by visit_rf_mean_batch. */
+#endif
+
+#ifndef MEAN_SIMD_LANES
+#define MEAN_SIMD_LANES 8           /**< Number of independent accumulators used by visit_rf_mean to sum the leaf values of a sample. */
+#endif
 
 extern int num_classes; /**< Number of classes. Initialized in the .c file, can be externally inizialized from main.*/
 
@@ -68,6 +94,8 @@ typedef int32_t nodes_idx_t;
  */
 typedef uint16_t operator_t;  // uint16 for alignment
 
+#define NUM_OPERATORS 6     /**< Number of split operators, i.e. operator_t values are in [0, NUM_OPERATORS). */
+
 /**
  * @typedef class_t
  * @brief A type representing the classification result.
@@ -110,7 +138,10 @@ typedef struct node_t {
     nodes_idx_t left_node;          /**< Index of the left child node. */
     nodes_idx_t right_node;         /**< Index of the right child node. */
 #endif
-    feature_type_t threshold;    /**< Threshold value for the feature. */
+    union {
+        feature_type_t threshold;    /**< Threshold value for the feature. */
+        feature_type_t leaf_value;   /**< Value of the leaf, used by regression trees instead of the class. */
+    };
 
 } node_t;
 
@@ -126,6 +157,19 @@ typedef struct node_t {
  */
 int visit_tree(const node_t* const root_node, const feature_type_t* const features, class_t* const classification_result);
 
+/**
+ * @brief Visits the decision tree providing in output the reached leaf node, instead of its class.
+ *        It is the building block of the functions requiring more than the class of the leaf (e.g. leaf distributions).
+ * 
+ * @param[in] root_node Pointer to the root node of the tree.
+ * @param[in] features Array of input feature values (i.e. the input sample).
+ * @param[out] leaf_node Pointer to store the address of the reached leaf. It is set to NULL if the tree was pruned.
+ * @return int Status of the visit operation.
+ * @retval CLASSIFICATION_OK A leaf was reached.
+ * @retval CLASSIFICATION_PRUNED Node was pruned, therefore leaf_node is NULL.
+ */
+int visit_tree_leaf(const node_t* const root_node, const feature_type_t* const features, const node_t** const leaf_node);
+
 /**
  * @brief Visits an ensemble of trees and classifies the given features.
  * 
@@ -154,6 +198,120 @@ int visit_ensemble(node_t* const trees[],  const uint16_t number_trees, const fe
  */
 int visit_rf_majority_voting(node_t* const trees[],  const uint16_t number_trees, const feature_type_t* const features, class_t* const classification_result, uint16_t * const num_votes);
 
+/**
+ * @brief Batched version of visit_rf_majority_voting, with the same draw rule (the first class reaching the maximum number of votes wins).
+ *        Samples are processed in blocks of up to VOTING_BLOCK_SIZE, visiting each tree for the whole block before moving to the next one.
+ *        The votes of a block are counted in VOTING_STACK_COUNTERS uint16_t counters on the stack, so that the stack usage does not depend
+ *        on the model: blocks are shrunk to VOTING_STACK_COUNTERS / number_classes samples, and models with more classes than the counters
+ *        count the votes of a sample at a time in number_classes counters allocated on the heap.
+ * 
+ * @param[in] trees Array of pointers to the root nodes of the trees.
+ * @param[in] number_trees Number of trees in the ensemble.
+ * @param[in] number_classes Number of classes. Leaf classes out of [0, number_classes) are not counted.
+ * @param[in] features Row-major matrix of [number_samples x number_features] input samples.
+ * @param[in] number_samples Number of samples (rows) of the features matrix.
+ * @param[in] number_features Number of features (columns) of the features matrix.
+ * @param[out] classification_results Array of number_samples majority classes, -1 for the samples without votes.
+ * @param[out] num_votes Array of number_samples votes of the majority classes. Can be NULL.
+ * @return int Status of the visit operation.
+ * @retval CLASSIFICATION_OK Classification was successful.
+ * @retval CLASSIFICATION_PRUNED At least a tree was pruned for at least a sample.
+ * @retval CLASSIFICATION_NO_MEMORY The counters of a model with more than VOTING_STACK_COUNTERS classes could not be allocated.
+ */
+int visit_rf_majority_voting_batch( node_t* const trees[],
+                                    const uint16_t number_trees,
+                                    const uint16_t number_classes,
+                                    const feature_type_t* const features,
+                                    const uint32_t number_samples,
+                                    const uint16_t number_features,
+                                    class_t* const classification_results,
+                                    uint16_t* const num_votes);
+
+/**
+ * @brief Computes the class distribution of a random forest for a single sample (soft voting).
+ *        If leaf_probabilities is NULL, the output contains the fraction of trees voting each class.
+ *        Otherwise, the output is the average of the class distributions of the reached leaves. 
+ * 
+ * @param[in] trees Array of pointers to the root nodes of the trees.
+ * @param[in] number_trees Number of trees in the ensemble.
+ * @param[in] number_classes Number of classes, i.e. the length of the output array.
+ * @param[in] leaf_probabilities Array, one per tree, of the leaf class distributions laid out as [number_of_nodes x number_classes]. Can be NULL.
+ * @param[in] features Array of feature values.
+ * @param[out] class_probabilities Array of number_classes elements containing the normalized class distribution.
+ * @return int Status of the visit operation.
+ * @retval CLASSIFICATION_OK Classification was successful.
+ * @retval CLASSIFICATION_PRUNED At least a tree was pruned. Pruned trees do not contribute to the distribution.
+ * @retval CLASSIFICATION_INVALID_CLASS Without leaf_probabilities, a reached leaf has a class out of [0, number_classes). It does not contribute to the distribution.
+ */
+int visit_rf_class_probabilities(   node_t* const trees[],
+                                    const uint16_t number_trees,
+                                    const uint16_t number_classes,
+                                    const float* const leaf_probabilities[],
+                                    const feature_type_t* const features,
+                                    float* const class_probabilities);
+
+/**
+ * @brief Batched version of visit_rf_class_probabilities. 
+ *        Samples are processed in blocks of PROBABILITIES_BLOCK_SIZE, visiting each tree for the whole block before moving
+ *        to the next one, so that the nodes of a tree are reused while they are still in cache.
+ * 
+ * @param[in] trees Array of pointers to the root nodes of the trees.
+ * @param[in] number_trees Number of trees in the ensemble.
+ * @param[in] number_classes Number of classes, i.e. the number of columns of the output matrix.
+ * @param[in] leaf_probabilities Array, one per tree, of the leaf class distributions laid out as [number_of_nodes x number_classes]. Can be NULL.
+ * @param[in] features Row-major matrix of [number_samples x number_features] input samples.
+ * @param[in] number_samples Number of samples (rows) of the features matrix.
+ * @param[in] number_features Number of features (columns) of the features matrix.
+ * @param[out] class_probabilities Row-major matrix of [number_samples x number_classes] class distributions.
+ * @return int Status of the visit operation.
+ * @retval CLASSIFICATION_OK Classification was successful.
+ * @retval CLASSIFICATION_PRUNED At least a tree was pruned for at least a sample.
+ * @retval CLASSIFICATION_INVALID_CLASS Without leaf_probabilities, a reached leaf has a class out of [0, number_classes) for at least a sample.
+ */
+int visit_rf_class_probabilities_batch( node_t* const trees[],
+                                        const uint16_t number_trees,
+                                        const uint16_t number_classes,
+                                        const float* const leaf_probabilities[],
+                                        const feature_type_t* const features,
+                                        const uint32_t number_samples,
+                                        const uint16_t number_features,
+                                        float* const class_probabilities);
+/**
+ * @brief Visits a regression forest, providing in output the mean of the values of the reached leaves.
+ *        The value of each reached leaf is added to one of MEAN_SIMD_LANES independent accumulators (tree_idx % MEAN_SIMD_LANES),
+ *        so that the additions of consecutive trees do not form a single dependency chain. No per-tree storage is needed.
+ * 
+ * @param[in] trees Array of pointers to the root nodes of the trees.
+ * @param[in] number_trees Number of trees in the ensemble.
+ * @param[in] features Array of feature values.
+ * @param[out] regression_result Pointer to store the mean of the leaf values.
+ * @return int Status of the visit operation.
+ * @retval CLASSIFICATION_OK Regression was successful.
+ * @retval CLASSIFICATION_PRUNED At least a tree was pruned. Pruned trees do not contribute to the mean.
+ */
+int visit_rf_mean(node_t* const trees[], const uint16_t number_trees, const feature_type_t* const features, feature_type_t* const regression_result);
+
+/**
+ * @brief Batched version of visit_rf_mean.
+ *        Samples are processed in blocks of MEAN_BLOCK_SIZE. Each tree is visited for the whole block and its leaf values 
+ *        are added to the per-sample sums with a vectorizable loop.
+ * 
+ * @param[in] trees Array of pointers to the root nodes of the trees.
+ * @param[in] number_trees Number of trees in the ensemble.
+ * @param[in] features Row-major matrix of [number_samples x number_features] input samples.
+ * @param[in] number_samples Number of samples (rows) of the features matrix.
+ * @param[in] number_features Number of features (columns) of the features matrix.
+ * @param[out] regression_results Array of number_samples mean leaf values.
+ * @return int Status of the visit operation.
+ * @retval CLASSIFICATION_OK Regression was successful.
+ * @retval CLASSIFICATION_PRUNED At least a tree was pruned for at least a sample.
+ */
+int visit_rf_mean_batch(node_t* const trees[],
+                        const uint16_t number_trees,
+                        const feature_type_t* const features,
+                        const uint32_t number_samples,
+                        const uint16_t number_features,
+                        feature_type_t* const regression_results);
 
 /**
  * @brief Determines the most popular classification result from an array of classifications.
@@ -0,0 +1,477 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../../src/tree_conf.h"
+#include "../../src/tree_csv.h"
+#include "../../src/tree_visit.h"
+
+#define DEFAULT_BATCH_ROWS  4096        /**< Rows of a batch, i.e. the unit of work of the reader, of the scoring threads and of the writer. */
+#define MAX_THREADS         256
+#define READ_CHUNK          (1 << 20)   /**< Bytes read at once from the CSV input. */
+
+#define FORMAT_CSV  0   /**< Text rows of separated features, the first num_features fields of each row are read. */
+#define FORMAT_F32  1   /**< Raw little-endian float32 rows of num_features features. */
+
+#define SLOT_FREE       0   /**< The batch can be filled by the reader. */
+#define SLOT_FILLED     1   /**< The batch contains rows to score. */
+#define SLOT_SCORED     2   /**< The predictions of the batch are formatted and can be written. */
+
+#if USE_FLOAT
+#define VALUE_FORMAT "%.9g"
+#else
+#define VALUE_FORMAT "%.17g"
+#endif
+
+typedef struct{
+    const char* model_path;
+    const char* input_path;     /**< NULL or "-" for stdin. */
+    int format;
+    char separator;
+    int threads;
+    uint32_t batch_rows;
+    int votes;
+    int optimize;
+} predict_options_t;
+
+/**
+ * @brief Rows of the input with their predictions. Batches are filled, scored and written in the order of their sequence number.
+ */
+typedef struct{
+    int state;
+    uint64_t sequence;
+    uint32_t num_rows;
+    feature_type_t* features;   /**< Row-major [batch_rows x num_features] matrix. */
+    class_t* classes;           /**< Majority class of each row of a classifier. */
+    uint16_t* votes;            /**< Votes of the majority class of each row of a classifier. */
+    feature_type_t* values;     /**< [batch_rows x num_outputs] outputs of a regression forest or of a boosted ensemble. */
+    char* text;                 /**< Formatted predictions. */
+    size_t text_length;
+    int status;                 /**< Status of the batched visit, the predictions are not formatted unless CLASSIFICATION_OK or PRUNED. */
+} batch_t;
+
+/**
+ * @brief Ring of batches shared by the reader, the scoring threads and the writer, protected by a single lock.
+ */
+typedef struct{
+    const tree_conf_t* conf;
+    const predict_options_t* options;
+    uint16_t num_outputs;
+    size_t max_line;            /**< Maximum length of the formatted predictions of a row. */
+    batch_t* batches;
+    int num_batches;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    uint64_t next_fill;         /**< Sequence number of the next batch to fill, i.e. number of filled batches. */
+    uint64_t next_score;        /**< Sequence number of the next batch to score. */
+    uint64_t next_write;        /**< Sequence number of the next batch to write. */
+    int reading_done;
+    int aborted;                /**< Set if the output can not be written or a batch can not be scored, to stop every thread. */
+    int visit_status;           /**< Status of the batch which could not be scored, CLASSIFICATION_OK if none. */
+    uint64_t visit_row;         /**< First row of the batch which could not be scored. */
+    FILE* input;
+    char input_error[256];      /**< Error which stopped the reader, empty at the end of the input. */
+} pipeline_t;
+
+/**
+ * @brief Buffered bytes of the CSV input, parsed in place by tree_csv_parse.
+ */
+typedef struct{
+    FILE* input;
+    char* buffer;
+    size_t capacity;
+    size_t start;               /**< Offset of the first unparsed byte. */
+    size_t end;                 /**< Offset after the last read byte. */
+    uint64_t line;              /**< Number of parsed lines, the header included. */
+    int eof;
+    int error;                  /**< Set if a line does not fit in memory. */
+    int header_checked;         /**< Set once the first line was skipped if it is a header. */
+} csv_reader_t;
+
+/**
+ * @brief Moves the unparsed bytes at the beginning of the buffer, growing it for lines longer than the buffer, and reads the following ones.
+ */
+static void fill_buffer(csv_reader_t* const reader){
+    memmove(reader->buffer, &reader->buffer[reader->start], reader->end - reader->start);
+    reader->end -= reader->start;
+    reader->start = 0;
+    if(reader->capacity == reader->end){
+        char* buffer = realloc(reader->buffer, reader->capacity + READ_CHUNK);
+        if(NULL == buffer){
+            reader->error = 1;
+            return;
+        }
+        reader->buffer = buffer;
+        reader->capacity += READ_CHUNK;
+    }
+    size_t read = fread(&reader->buffer[reader->end], 1, reader->capacity - reader->end, reader->input);
+    reader->end += read;
+    reader->eof = (0 == read);
+}
+
+/**
+ * @brief Fills a batch with the next CSV rows. The first line is skipped if its first field is not a number, i.e. if it is a header.
+ * @return uint32_t Number of filled rows, lower than batch_rows only at the end of the input or on errors.
+ */
+static uint32_t read_csv_batch(pipeline_t* const pipeline, csv_reader_t* const reader, batch_t* const batch){
+    const uint16_t num_features = pipeline->conf->trailer.num_features;
+    uint32_t rows = 0;
+    while(!reader->error){
+        const char* const data = &reader->buffer[reader->start];
+        const size_t size = reader->end - reader->start;
+        if(reader->header_checked || reader->eof || NULL != memchr(data, '\n', size)){
+            if(!reader->header_checked){
+                size_t header = tree_csv_header_length(data, size, pipeline->options->separator);
+                reader->start += header;
+                reader->line += (0 != header);
+                reader->header_checked = 1;
+                continue;
+            }
+            tree_csv_options_t options = {pipeline->options->separator, CSV_ROW_MAJOR, num_features, pipeline->options->batch_rows - rows};
+            tree_csv_result_t result;
+            int status = tree_csv_parse(data, size, (uint8_t) reader->eof, &options, &batch->features[(size_t) rows * num_features], &result);
+            rows += result.num_rows;
+            reader->line += result.num_lines;
+            reader->start += result.consumed;
+            if(CSV_OK != status){
+                snprintf(pipeline->input_error, sizeof(pipeline->input_error), "line %llu: expected %u numeric features separated by '%c'",
+                         (unsigned long long) reader->line + 1, num_features, pipeline->options->separator);
+                return rows;
+            }
+            if(rows == pipeline->options->batch_rows || reader->eof){
+                return rows;
+            }
+        }
+        fill_buffer(reader);
+    }
+    snprintf(pipeline->input_error, sizeof(pipeline->input_error), "out of memory");
+    return rows;
+}
+
+/**
+ * @brief Fills a batch with the next float32 rows.
+ */
+static uint32_t read_f32_batch(pipeline_t* const pipeline, float* const scratch, batch_t* const batch){
+    const uint16_t num_features = pipeline->conf->trailer.num_features;
+    size_t read = fread(scratch, sizeof(float), (size_t) pipeline->options->batch_rows * num_features, pipeline->input);
+    if(0 != read % num_features){
+        snprintf(pipeline->input_error, sizeof(pipeline->input_error), "truncated row %llu, the input must contain rows of %u float32",
+                 (unsigned long long) (pipeline->next_fill * pipeline->options->batch_rows + read / num_features + 1), num_features);
+    }
+    for(size_t i = 0; i < read - read % num_features; i++){
+        batch->features[i] = (feature_type_t) scratch[i];
+    }
+    return (uint32_t) (read / num_features);
+}
+
+static void* reader_thread(void* argument){
+    pipeline_t* const pipeline = argument;
+    csv_reader_t reader = {pipeline->input, malloc(READ_CHUNK), READ_CHUNK, 0, 0, 0, 0, 0, 0};
+    float* scratch = (FORMAT_F32 == pipeline->options->format) ?
+                     malloc((size_t) pipeline->options->batch_rows * pipeline->conf->trailer.num_features * sizeof(float)) : NULL;
+    if((FORMAT_CSV == pipeline->options->format && NULL == reader.buffer) || (FORMAT_F32 == pipeline->options->format && NULL == scratch)){
+        snprintf(pipeline->input_error, sizeof(pipeline->input_error), "out of memory");
+    }
+    while('\0' == pipeline->input_error[0]){
+        pthread_mutex_lock(&pipeline->lock);
+        batch_t* const batch = &pipeline->batches[pipeline->next_fill % pipeline->num_batches];
+        while(SLOT_FREE != batch->state && !pipeline->aborted){
+            pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+        }
+        int aborted = pipeline->aborted;
+        pthread_mutex_unlock(&pipeline->lock);
+        if(aborted){
+            break;
+        }
+        uint32_t rows = (FORMAT_CSV == pipeline->options->format) ? read_csv_batch(pipeline, &reader, batch) : read_f32_batch(pipeline, scratch, batch);
+        if(0 == rows){
+            break;
+        }
+        pthread_mutex_lock(&pipeline->lock);
+        batch->num_rows = rows;
+        batch->sequence = pipeline->next_fill++;
+        batch->state = SLOT_FILLED;
+        pthread_cond_broadcast(&pipeline->changed);
+        pthread_mutex_unlock(&pipeline->lock);
+        if(rows < pipeline->options->batch_rows){
+            break;
+        }
+    }
+    if('\0' == pipeline->input_error[0] && ferror(pipeline->input)){
+        snprintf(pipeline->input_error, sizeof(pipeline->input_error), "read error: %s", strerror(errno));
+    }
+    free(reader.buffer);
+    free(scratch);
+    pthread_mutex_lock(&pipeline->lock);
+    pipeline->reading_done = 1;
+    pthread_cond_broadcast(&pipeline->changed);
+    pthread_mutex_unlock(&pipeline->lock);
+    return NULL;
+}
+
+/**
+ * @brief Returns 1 if a status of a batched visit leaves valid predictions, i.e. CLASSIFICATION_OK or CLASSIFICATION_PRUNED.
+ */
+static int is_scored(const int status){
+#if COMPILE_PRUNED
+    return CLASSIFICATION_OK == status || CLASSIFICATION_PRUNED == status;
+#else
+    return CLASSIFICATION_OK == status;
+#endif
+}
+
+/**
+ * @brief Scores the rows of a batch with the batched visit of the model, and formats one line of predictions per row.
+ *        Pruned trees do not contribute to the predictions, the other failures of the visit leave the batch without predictions.
+ */
+static void score_batch(const pipeline_t* const pipeline, batch_t* const batch){
+    const tree_conf_t* const conf = pipeline->conf;
+    if(NULL != conf->boosting){
+        batch->status = visit_gbdt_batch(conf->trees, conf->trailer.num_trees, conf->boosting, batch->features, batch->num_rows,
+                                         conf->trailer.num_features, batch->values);
+    }
+    else if(0 == conf->trailer.num_classes){
+        batch->status = visit_rf_mean_batch(conf->trees, conf->trailer.num_trees, batch->features, batch->num_rows, conf->trailer.num_features,
+                                            batch->values);
+    }
+    else{
+        batch->status = visit_rf_majority_voting_batch(conf->trees, conf->trailer.num_trees, conf->trailer.num_classes, batch->features,
+                                                       batch->num_rows, conf->trailer.num_features, batch->classes,
+                                                       pipeline->options->votes ? batch->votes : NULL);
+    }
+    batch->text_length = 0;
+    if(!is_scored(batch->status)){
+        return;
+    }
+    char* text = batch->text;
+    for(uint32_t r = 0; r < batch->num_rows; r++){
+        if(NULL != conf->boosting || 0 == conf->trailer.num_classes){
+            for(uint16_t o = 0; o < pipeline->num_outputs; o++){
+                if(o > 0){
+                    *text++ = pipeline->options->separator;
+                }
+                text += snprintf(text, pipeline->max_line, VALUE_FORMAT, (double) batch->values[(size_t) r * pipeline->num_outputs + o]);
+            }
+        }
+        else if(pipeline->options->votes){
+            text += snprintf(text, pipeline->max_line, "%d%c%u", batch->classes[r], pipeline->options->separator, batch->votes[r]);
+        }
+        else{
+            text += snprintf(text, pipeline->max_line, "%d", batch->classes[r]);
+        }
+        *text++ = '\n';
+    }
+    batch->text_length = (size_t) (text - batch->text);
+}
+
+static void* scoring_thread(void* argument){
+    pipeline_t* const pipeline = argument;
+    pthread_mutex_lock(&pipeline->lock);
+    for(;;){
+        while(pipeline->next_score == pipeline->next_fill && !pipeline->reading_done && !pipeline->aborted){
+            pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+        }
+        if(pipeline->next_score == pipeline->next_fill || pipeline->aborted){
+            break;
+        }
+        batch_t* const batch = &pipeline->batches[pipeline->next_score++ % pipeline->num_batches];
+        pthread_mutex_unlock(&pipeline->lock);
+        score_batch(pipeline, batch);
+        pthread_mutex_lock(&pipeline->lock);
+        batch->state = SLOT_SCORED;
+        pthread_cond_broadcast(&pipeline->changed);
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+    return NULL;
+}
+
+/**
+ * @brief Writes the scored batches in input order, so that the output has a line per input row. Returns 0 if the whole output was written.
+ *        The first batch which could not be scored stops the pipeline, its status and first row are kept in visit_status and visit_row.
+ */
+static int write_batches(pipeline_t* const pipeline){
+    int status = 0;
+    pthread_mutex_lock(&pipeline->lock);
+    for(;;){
+        batch_t* const batch = &pipeline->batches[pipeline->next_write % pipeline->num_batches];
+        while(!(SLOT_SCORED == batch->state && batch->sequence == pipeline->next_write) &&
+              !(pipeline->reading_done && pipeline->next_write == pipeline->next_fill)){
+            pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+        }
+        if(SLOT_SCORED != batch->state || batch->sequence != pipeline->next_write){
+            break;
+        }
+        if(!is_scored(batch->status)){
+            pipeline->visit_status = batch->status;
+            pipeline->visit_row = batch->sequence * pipeline->options->batch_rows + 1;
+            pipeline->aborted = 1;
+            pthread_cond_broadcast(&pipeline->changed);
+            status = -1;
+            break;
+        }
+        pthread_mutex_unlock(&pipeline->lock);
+        status = (fwrite(batch->text, 1, batch->text_length, stdout) == batch->text_length) ? 0 : -1;
+        pthread_mutex_lock(&pipeline->lock);
+        if(0 != status){
+            pipeline->aborted = 1;
+            pthread_cond_broadcast(&pipeline->changed);
+            break;
+        }
+        batch->state = SLOT_FREE;
+        pipeline->next_write++;
+        pthread_cond_broadcast(&pipeline->changed);
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+    return (0 == status && 0 == fflush(stdout)) ? 0 : -1;
+}
+
+static int allocate_batches(pipeline_t* const pipeline){
+    const uint32_t rows = pipeline->options->batch_rows;
+    pipeline->batches = calloc(pipeline->num_batches, sizeof(batch_t));
+    if(NULL == pipeline->batches){
+        return -1;
+    }
+    for(int b = 0; b < pipeline->num_batches; b++){
+        batch_t* const batch = &pipeline->batches[b];
+        batch->features = malloc((size_t) rows * pipeline->conf->trailer.num_features * sizeof(feature_type_t));
+        batch->classes = malloc((size_t) rows * sizeof(class_t));
+        batch->votes = malloc((size_t) rows * sizeof(uint16_t));
+        batch->values = malloc((size_t) rows * pipeline->num_outputs * sizeof(feature_type_t));
+        batch->text = malloc((size_t) rows * pipeline->max_line);
+        if(NULL == batch->features || NULL == batch->classes || NULL == batch->votes || NULL == batch->values || NULL == batch->text){
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void free_batches(pipeline_t* const pipeline){
+    for(int b = 0; NULL != pipeline->batches && b < pipeline->num_batches; b++){
+        free(pipeline->batches[b].features);
+        free(pipeline->batches[b].classes);
+        free(pipeline->batches[b].votes);
+        free(pipeline->batches[b].values);
+        free(pipeline->batches[b].text);
+    }
+    free(pipeline->batches);
+}
+
+static void usage(const char* const program){
+    fprintf(stderr, "Usage: %s --model model.bin [--input rows.csv|rows.f32|-] [--format csv|f32] [--separator C] [--threads N] [--batch_rows N]\n"
+                    "          [--votes] [--no_optimize]\n", program);
+}
+
+/**
+ * dtc-predict: scores the rows of stdin (or --input) with a binary model and writes a prediction per row to stdout, in input order.
+ * Rows are CSV lines (--separator, ';' by default, as the datasets of the repository) whose first num_features fields are the features, so
+ * that the label column of a dataset is ignored and a header line is skipped, or raw float32 rows with --format f32.
+ * The predictions are the majority class of a forest (with its votes with --votes), the mean of a regression forest (num_classes 0)
+ * or the outputs of a boosted ensemble, separated by --separator.
+ * Reading, scoring and writing are pipelined on batches of --batch_rows rows: a thread reads and parses the input, --threads threads
+ * score the batches with the batched visiting functions and format their predictions, and the main thread writes them.
+ * The model is optimized with optimize_tree_conf, which is lossless, unless --no_optimize is given.
+ */
+int main(int argc, char** argv){
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    predict_options_t options = {NULL, NULL, FORMAT_CSV, ';', (online > 0) ? (int) online : 1, DEFAULT_BATCH_ROWS, 0, 1};
+    for(int i = 1; i < argc; i++){
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if(0 == strcmp(argv[i], "--votes")){ options.votes = 1; continue; }
+        if(0 == strcmp(argv[i], "--no_optimize")){ options.optimize = 0; continue; }
+        if(NULL == value){ usage(argv[0]); return EXIT_FAILURE; }
+        if(0 == strcmp(argv[i], "--model")) options.model_path = value;
+        else if(0 == strcmp(argv[i], "--input")) options.input_path = value;
+        else if(0 == strcmp(argv[i], "--format") && 0 == strcmp(value, "csv")) options.format = FORMAT_CSV;
+        else if(0 == strcmp(argv[i], "--format") && 0 == strcmp(value, "f32")) options.format = FORMAT_F32;
+        else if(0 == strcmp(argv[i], "--separator") && 1 == strlen(value)) options.separator = value[0];
+        else if(0 == strcmp(argv[i], "--threads")) options.threads = atoi(value);
+        else if(0 == strcmp(argv[i], "--batch_rows")) options.batch_rows = (uint32_t) atol(value);
+        else{ usage(argv[0]); return EXIT_FAILURE; }
+        i++;
+    }
+    if(NULL == options.model_path || options.threads < 1 || options.threads > MAX_THREADS || options.batch_rows < 1 || options.batch_rows > (1U << 24) ||
+       '\n' == options.separator || '\r' == options.separator){
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    tree_conf_t conf;
+    int status = load_tree_conf(options.model_path, &conf);
+    if(CONF_OK != status){
+        fprintf(stderr, "Error loading %s: %d\n", options.model_path, status);
+        return EXIT_FAILURE;
+    }
+    if(options.optimize && CONF_OK != optimize_tree_conf(&conf, NULL)){
+        fprintf(stderr, "Error optimizing %s\n", options.model_path);
+        free_tree_conf(&conf);
+        return EXIT_FAILURE;
+    }
+    pipeline_t pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.visit_status = CLASSIFICATION_OK;
+    pipeline.conf = &conf;
+    pipeline.options = &options;
+    pipeline.num_outputs = (NULL != conf.boosting) ? conf.boosting->num_outputs : 1;
+    // A value takes at most 24 characters plus its separator, a class and its votes 13.
+    pipeline.max_line = (NULL != conf.boosting || 0 == conf.trailer.num_classes) ? 25 * (size_t) pipeline.num_outputs + 1 : 16;
+    // Besides the batches being scored, one is read and two are written, so that no stage waits for a free batch.
+    pipeline.num_batches = options.threads + 3;
+    pipeline.input = (NULL == options.input_path || 0 == strcmp(options.input_path, "-")) ? stdin : fopen(options.input_path, "rb");
+    if(NULL == pipeline.input){
+        fprintf(stderr, "Can not open %s\n", options.input_path);
+        free_tree_conf(&conf);
+        return EXIT_FAILURE;
+    }
+    if(0 != allocate_batches(&pipeline)){
+        fprintf(stderr, "Allocation failed\n");
+        status = -1;
+    }
+    pthread_t reader, scorers[MAX_THREADS];
+    int reader_started = 0, started = 0;
+    pthread_mutex_init(&pipeline.lock, NULL);
+    pthread_cond_init(&pipeline.changed, NULL);
+    reader_started = (0 == status && 0 == pthread_create(&reader, NULL, reader_thread, &pipeline));
+    while(reader_started && started < options.threads && 0 == pthread_create(&scorers[started], NULL, scoring_thread, &pipeline)){
+        started++;
+    }
+    if(0 == status && started < options.threads){
+        // Stops the started threads, the reader waits for a free batch and the scoring threads for a filled one.
+        fprintf(stderr, "Can not start the pipeline threads\n");
+        pthread_mutex_lock(&pipeline.lock);
+        pipeline.aborted = 1;
+        pthread_cond_broadcast(&pipeline.changed);
+        pthread_mutex_unlock(&pipeline.lock);
+        status = -1;
+    }
+    if(0 == status && 0 != write_batches(&pipeline)){
+        if(CLASSIFICATION_OK != pipeline.visit_status){
+            fprintf(stderr, "Error scoring the batch starting at row %llu, status %d\n", (unsigned long long) pipeline.visit_row,
+                    pipeline.visit_status);
+        }
+        else{
+            fprintf(stderr, "Error writing the predictions\n");
+        }
+        status = -1;
+    }
+    for(int t = 0; t < started; t++){
+        pthread_join(scorers[t], NULL);
+    }
+    if(reader_started){
+        pthread_join(reader, NULL);
+    }
+    if(0 == status && '\0' != pipeline.input_error[0]){
+        fprintf(stderr, "Error reading the input, %s\n", pipeline.input_error);
+        status = -1;
+    }
+    pthread_cond_destroy(&pipeline.changed);
+    pthread_mutex_destroy(&pipeline.lock);
+    if(stdin != pipeline.input){
+        fclose(pipeline.input);
+    }
+    free_batches(&pipeline);
+    free_tree_conf(&conf);
+    return (0 == status) ? EXIT_SUCCESS : EXIT_FAILURE;
+}